@@ -0,0 +1,208 @@
+/**
+ * @file bench_hotspot_discovery.c
+ * @brief Hotspot discovery benchmark: batched nmcli query vs. one per connection
+ *
+ * Installs a stand-in `nmcli` script on PATH that answers for a given
+ * number of wireless profiles (every fiftieth one a hotspot), then times
+ * hotspot_list_configs() on its nmcli path against the previous listing,
+ * which asked for the mode of each wireless connection separately. The
+ * stand-in answers instantly, so the numbers show process and parsing
+ * cost only; a real nmcli adds a D-Bus round trip per process.
+ *
+ * Usage: bench_hotspot_discovery [iterations] [profiles...]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../src/core/hotspot_manager.h"
+#include "../src/utils/nm_keyfile.h"
+#include "../src/utils/query_cache.h"
+#include "../src/utils/safe_exec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_ITERATIONS 10
+#define HOTSPOT_EVERY 50 // Matches mode() in the stand-in script
+
+static const char fake_nmcli[] =
+    "#!/bin/sh\n"
+    "# nmcli -t -f FIELDS connection show [ids...]\n"
+    "n=${WTERM_BENCH_PROFILES:-10}\n"
+    "fields=$3\n"
+    "shift 5\n"
+    "mode() { if [ $(($1 % 50)) -eq 0 ]; then echo ap; else echo infrastructure; fi; }\n"
+    "case \"$fields\" in\n"
+    "NAME,UUID,TYPE|NAME,TYPE)\n"
+    "    i=0\n"
+    "    while [ $i -lt $n ]; do\n"
+    "        if [ \"$fields\" = NAME,TYPE ]; then echo \"profile-$i:802-11-wireless\"\n"
+    "        else echo \"profile-$i:uuid-$i:802-11-wireless\"; fi\n"
+    "        i=$((i + 1))\n"
+    "    done\n"
+    "    echo 'Wired connection 1:uuid-wired:802-3-ethernet' ;;\n"
+    "802-11-wireless.mode)\n"
+    "    echo \"802-11-wireless.mode:$(mode ${1##*-})\" ;;\n"
+    "connection.uuid,*)\n"
+    "    for id; do\n"
+    "        i=${id##*-}\n"
+    "        printf 'connection.uuid:%s\\n802-11-wireless.mode:%s\\n"
+    "802-11-wireless.ssid:network-%s\\n\\n' \"$id\" \"$(mode $i)\" \"$i\"\n"
+    "    done ;;\n"
+    "*) exit 1 ;;\n"
+    "esac\n";
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// The previous nmcli listing: NAME,TYPE, then the mode of each wireless connection
+static int list_per_connection(void) {
+    char *const args[] = {"nmcli", "-t", "-f", "NAME,TYPE", "connection", "show", NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("nmcli", args, &output)) {
+        return -1;
+    }
+
+    int hotspots = 0;
+    char *cursor = output.out;
+    char *line;
+    while ((line = safe_exec_next_line(&cursor)) && hotspots < MAX_HOTSPOTS) {
+        char *type_field = strrchr(line, ':');
+        if (!type_field) continue;
+        *type_field++ = '\0';
+        if (strcmp(type_field, "802-11-wireless") != 0) continue;
+
+        char *const mode_args[] = {"nmcli", "-t", "-f", "802-11-wireless.mode",
+                                   "connection", "show", line, NULL};
+        safe_exec_output_t mode;
+        if (!safe_exec_capture("nmcli", mode_args, &mode)) continue;
+        char *mode_cursor = mode.out;
+        const char *mode_line = safe_exec_next_line(&mode_cursor);
+        const char *value = mode_line ? strchr(mode_line, ':') : NULL;
+        if (value && strcmp(value + 1, "ap") == 0) {
+            hotspots++;
+        }
+        safe_exec_output_free(&mode);
+    }
+
+    safe_exec_output_free(&output);
+    return hotspots;
+}
+
+static int list_batched(int saved) {
+    hotspot_list_t list;
+    query_cache_invalidate();
+    if (hotspot_list_configs(&list) != WTERM_SUCCESS) {
+        return -1;
+    }
+    return list.count - saved;
+}
+
+static void report(const char *label, int profiles, double *samples, int iterations) {
+    qsort(samples, (size_t)iterations, sizeof(double), compare_double);
+    printf("%-16s %8d %12.2f %12.2f %12.2f\n", label, profiles, samples[iterations / 2] / 1e3,
+           samples[(int)(iterations * 0.99)] / 1e3, samples[iterations - 1] / 1e3);
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        fprintf(stderr, "usage: %s [iterations] [profiles...]\n", argv[0]);
+        return 1;
+    }
+
+    char dir[] = "/tmp/wterm-bench-nmcli-XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    char script[512];
+    snprintf(script, sizeof(script), "%s/nmcli", dir);
+    FILE *file = fopen(script, "w");
+    if (!file) {
+        perror(script);
+        return 1;
+    }
+    fputs(fake_nmcli, file);
+    fclose(file);
+    chmod(script, 0755);
+
+    char path[4096];
+    const char *old_path = getenv("PATH");
+    snprintf(path, sizeof(path), "%s:%s", dir, old_path ? old_path : "/usr/bin:/bin");
+    setenv("PATH", path, 1);
+    // No readable keyfiles, so hotspot_list_configs() takes the nmcli path
+    setenv(NM_KEYFILE_DIR_ENV, "/nonexistent/wterm-bench", 1);
+
+    if (hotspot_manager_init() != WTERM_SUCCESS) {
+        fprintf(stderr, "hotspot manager init failed\n");
+        return 1;
+    }
+    // Hotspots saved by wterm itself are listed too; count them once
+    hotspot_list_t saved;
+    setenv("WTERM_BENCH_PROFILES", "0", 1);
+    hotspot_list_configs(&saved);
+
+    static const int default_sizes[] = {10, 100, 500};
+    int sizes_count = argc > 2 ? argc - 2 : (int)(sizeof(default_sizes) / sizeof(int));
+    double *per_connection = malloc(sizeof(double) * (size_t)iterations);
+    double *batched = malloc(sizeof(double) * (size_t)iterations);
+    if (!per_connection || !batched) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    printf("hotspot listing through nmcli, %d runs per size\n\n", iterations);
+    printf("%-16s %8s %12s %12s %12s\n", "listing", "profiles", "p50 (ms)", "p99 (ms)",
+           "max (ms)");
+
+    int failures = 0;
+    for (int s = 0; s < sizes_count; s++) {
+        int profiles = argc > 2 ? atoi(argv[s + 2]) : default_sizes[s];
+        if (profiles < 0) continue;
+        char value[16];
+        snprintf(value, sizeof(value), "%d", profiles);
+        setenv("WTERM_BENCH_PROFILES", value, 1);
+
+        int expected = (profiles + HOTSPOT_EVERY - 1) / HOTSPOT_EVERY;
+        if (expected > MAX_HOTSPOTS - saved.count) {
+            expected = MAX_HOTSPOTS - saved.count;
+        }
+
+        for (int i = 0; i < iterations; i++) {
+            double t0 = now_us();
+            failures += list_per_connection() != expected;
+            per_connection[i] = now_us() - t0;
+
+            t0 = now_us();
+            failures += list_batched(saved.count) != expected;
+            batched[i] = now_us() - t0;
+        }
+
+        report("per connection", profiles, per_connection, iterations);
+        report("batched", profiles, batched, iterations);
+    }
+    if (failures) {
+        printf("\n%d listings found the wrong number of hotspots\n", failures);
+    }
+
+    // Cleanup stops active hotspots; let the stand-in report none
+    setenv("WTERM_BENCH_PROFILES", "0", 1);
+    hotspot_manager_cleanup();
+    unlink(script);
+    rmdir(dir);
+    free(per_connection);
+    free(batched);
+    return failures ? 1 : 0;
+}
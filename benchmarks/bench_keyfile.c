@@ -0,0 +1,137 @@
+/**
+ * @file bench_keyfile.c
+ * @brief Hotspot discovery benchmark: NetworkManager keyfiles read in-process
+ *
+ * Writes a directory of synthetic *.nmconnection profiles (every tenth one
+ * a hotspot), then times a cold read of the whole directory, a refresh of
+ * the unchanged directory (answered by the inotify watch), and a refresh
+ * after one profile changes. The nmcli path this replaces spawns one
+ * process per wireless profile.
+ *
+ * Usage: bench_keyfile [profiles] [iterations]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../src/utils/nm_keyfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_PROFILES 1000
+#define DEFAULT_ITERATIONS 50
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void write_profile(const char *dir, int i) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/profile-%d%s", dir, i, NM_KEYFILE_EXT);
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        exit(1);
+    }
+    fprintf(file,
+            "[connection]\nid=profile-%d\nuuid=00000000-0000-4000-8000-%012d\n"
+            "type=wifi\ninterface-name=wlan0\n\n[wifi]\nmode=%s\nssid=network-%d\n\n"
+            "[wifi-security]\nkey-mgmt=wpa-psk\npsk=password-%d\n\n"
+            "[ipv4]\nmethod=%s\n\n[ipv6]\naddr-gen-mode=default\nmethod=auto\n",
+            i, i, i % 10 == 0 ? "ap" : "infrastructure", i, i,
+            i % 10 == 0 ? "shared" : "auto");
+    fclose(file);
+}
+
+static int count_hotspots(const nm_keyfile_store_t *store) {
+    int hotspots = 0;
+    for (int i = 0; i < store->count; i++) {
+        hotspots += nm_keyfile_profile_is_ap(&store->profiles[i]);
+    }
+    return hotspots;
+}
+
+static void report(const char *label, double *samples, int iterations) {
+    qsort(samples, (size_t)iterations, sizeof(double), compare_double);
+    printf("%-24s %10.1f %10.1f %10.1f\n", label, samples[iterations / 2],
+           samples[(int)(iterations * 0.99)], samples[iterations - 1]);
+}
+
+int main(int argc, char *argv[]) {
+    int profiles = argc > 1 ? atoi(argv[1]) : DEFAULT_PROFILES;
+    int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+    if (profiles <= 0 || iterations <= 0) {
+        fprintf(stderr, "usage: %s [profiles] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    char dir[] = "/tmp/wterm-bench-keyfiles-XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    for (int i = 0; i < profiles; i++) {
+        write_profile(dir, i);
+    }
+
+    double *cold = malloc(sizeof(double) * (size_t)iterations);
+    double *unchanged = malloc(sizeof(double) * (size_t)iterations);
+    double *changed = malloc(sizeof(double) * (size_t)iterations);
+    if (!cold || !unchanged || !changed) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    int failures = 0;
+    int hotspots = 0;
+    for (int i = 0; i < iterations; i++) {
+        nm_keyfile_store_t store;
+        nm_keyfile_store_init(&store, dir);
+
+        double t0 = now_us();
+        failures += nm_keyfile_store_refresh(&store) != WTERM_SUCCESS;
+        hotspots = count_hotspots(&store);
+        cold[i] = now_us() - t0;
+
+        t0 = now_us();
+        failures += nm_keyfile_store_refresh(&store) != WTERM_SUCCESS;
+        unchanged[i] = now_us() - t0;
+
+        write_profile(dir, i % profiles);
+        t0 = now_us();
+        failures += nm_keyfile_store_refresh(&store) != WTERM_SUCCESS;
+        changed[i] = now_us() - t0;
+
+        failures += store.count != profiles;
+        nm_keyfile_store_free(&store);
+    }
+
+    printf("hotspot discovery over %d keyfiles (%d hotspots), %d runs\n\n", profiles,
+           hotspots, iterations);
+    printf("%-24s %10s %10s %10s\n", "refresh", "p50 (us)", "p99 (us)", "max (us)");
+    report("cold directory read", cold, iterations);
+    report("unchanged (inotify)", unchanged, iterations);
+    report("after one change", changed, iterations);
+    if (failures) {
+        printf("\n%d failed refreshes\n", failures);
+    }
+
+    for (int i = 0; i < profiles; i++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/profile-%d%s", dir, i, NM_KEYFILE_EXT);
+        unlink(path);
+    }
+    rmdir(dir);
+    free(cold);
+    free(unchanged);
+    free(changed);
+    return failures ? 1 : 0;
+}
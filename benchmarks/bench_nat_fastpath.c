@@ -0,0 +1,355 @@
+/**
+ * @file bench_nat_fastpath.c
+ * @brief Hotspot forwarding throughput: plain NAT vs. nftables flowtable
+ *
+ * Builds client <-> router <-> server network namespaces joined by veth
+ * pairs, loads the hotspot rules into the router with nat_engine (the
+ * client side plays the hotspot interface, the server side the uplink),
+ * and times a bulk TCP transfer from client to server. The router can be
+ * given extra non-matching forward rules to stand in for a large host
+ * firewall: plain NAT walks them for every packet, while the flowtable
+ * path skips them once a flow is established.
+ *
+ * Needs root, ip and nft. Namespaces are named wterm-bench-* and removed
+ * on exit.
+ *
+ * Usage: bench_nat_fastpath [seconds] [filler_rules] [runs]
+ */
+
+#define _GNU_SOURCE
+#include "../src/core/bridge_engine.h"
+#include "../src/core/nat_engine.h"
+#include "../src/utils/capability.h"
+#include "../src/utils/safe_exec.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_SECONDS 3
+#define DEFAULT_FILLER_RULES 1000
+#define DEFAULT_RUNS 3
+#define BENCH_PORT 5201
+#define CHUNK_SIZE (128 * 1024)
+
+#define NS_CLIENT "wterm-bench-client"
+#define NS_ROUTER "wterm-bench-router"
+#define NS_SERVER "wterm-bench-server"
+#define HOTSPOT_IFACE "wb-hot"
+#define UPLINK_IFACE "wb-up"
+#define SERVER_ADDR "192.0.2.2"
+
+typedef enum { MODE_NAT, MODE_FLOWTABLE, MODE_BRIDGE } sharing_mode_t;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static bool ip_cmd(const char *cmd) {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", cmd);
+
+    char *args[24];
+    int argc = 0;
+    args[argc++] = "ip";
+    for (char *save = NULL, *word = strtok_r(buffer, " ", &save); word && argc < 23;
+         word = strtok_r(NULL, " ", &save)) {
+        args[argc++] = word;
+    }
+    args[argc] = NULL;
+    if (safe_exec_command("ip", args) != 0) {
+        fprintf(stderr, "ip %s: failed\n", cmd);
+        return false;
+    }
+    return true;
+}
+
+// Deleting the namespaces also removes the veth pairs inside them
+static void teardown(void) {
+    static const char *const names[] = {NS_CLIENT, NS_ROUTER, NS_SERVER};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        char path[128];
+        snprintf(path, sizeof(path), "/run/netns/%s", names[i]);
+        if (access(path, F_OK) == 0) {
+            char *const args[] = {"ip", "netns", "del", (char *)names[i], NULL};
+            safe_exec_command("ip", args);
+        }
+    }
+}
+
+static bool setup(void) {
+    static const char *const commands[] = {
+        "netns add " NS_CLIENT,
+        "netns add " NS_ROUTER,
+        "netns add " NS_SERVER,
+        "link add " HOTSPOT_IFACE " netns " NS_ROUTER " type veth peer name wb-cli netns " NS_CLIENT,
+        "link add " UPLINK_IFACE " netns " NS_ROUTER " type veth peer name wb-srv netns " NS_SERVER,
+        "-n " NS_CLIENT " addr add 10.42.0.2/24 dev wb-cli",
+        "-n " NS_ROUTER " addr add 10.42.0.1/24 dev " HOTSPOT_IFACE,
+        "-n " NS_ROUTER " addr add 192.0.2.1/24 dev " UPLINK_IFACE,
+        "-n " NS_SERVER " addr add " SERVER_ADDR "/24 dev wb-srv",
+        "-n " NS_CLIENT " link set lo up",
+        "-n " NS_CLIENT " link set wb-cli up",
+        "-n " NS_ROUTER " link set lo up",
+        "-n " NS_ROUTER " link set " HOTSPOT_IFACE " up",
+        "-n " NS_ROUTER " link set " UPLINK_IFACE " up",
+        "-n " NS_SERVER " link set lo up",
+        "-n " NS_SERVER " link set wb-srv up",
+        "-n " NS_CLIENT " route add default via 10.42.0.1",
+    };
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (!ip_cmd(commands[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool enter_netns(const char *name) {
+    char path[128];
+    snprintf(path, sizeof(path), "/run/netns/%s", name);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = setns(fd, CLONE_NEWNET) == 0;
+    close(fd);
+    return ok;
+}
+
+static bool write_proc(const char *path, const char *value) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    bool ok = fputs(value, file) >= 0;
+    return fclose(file) == 0 && ok;
+}
+
+// Non-matching rules in a table of their own, walked by every slow-path packet
+static bool load_filler_rules(int count) {
+    size_t size = 128 + (size_t)count * 48;
+    char *script = malloc(size);
+    if (!script) {
+        return false;
+    }
+    size_t used = (size_t)snprintf(script, size,
+                                   "table ip wterm-bench-filler {\n"
+                                   "  chain forward {\n"
+                                   "    type filter hook forward priority -10; policy accept;\n");
+    for (int i = 0; i < count; i++) {
+        used += (size_t)snprintf(script + used, size - used,
+                                 "    ip daddr 198.18.%d.%d tcp dport 9 drop\n",
+                                 (i / 250) % 250, i % 250 + 1);
+    }
+    used += (size_t)snprintf(script + used, size - used, "  }\n}\n");
+
+    char *const args[] = {"nft", "-f", "-", NULL};
+    safe_exec_options_t options = {.input = script, .input_len = used};
+    safe_exec_output_t output;
+    bool ok = false;
+    if (safe_exec_capture_ex("nft", args, &options, &output) == WTERM_SUCCESS) {
+        ok = output.exit_code == 0;
+        safe_exec_output_free(&output);
+    }
+    free(script);
+    return ok;
+}
+
+// Router state for one mode; runs inside the router namespace
+static bool configure_router(sharing_mode_t mode) {
+    nat_rules_t rules;
+    if (nat_rules_init(&rules, HOTSPOT_IFACE, UPLINK_IFACE, "10.42.0.1") != WTERM_SUCCESS) {
+        return false;
+    }
+    if (mode == MODE_BRIDGE) {
+        // No NAT: the client takes an address on the server's segment
+        nat_engine_remove(&rules);
+        return bridge_engine_attach(HOTSPOT_IFACE, UPLINK_IFACE, NULL, 0) == WTERM_SUCCESS &&
+               ip_cmd("-n " NS_CLIENT " addr add 192.0.2.3/24 dev wb-cli");
+    }
+    rules.flowtable = mode == MODE_FLOWTABLE;
+    return nat_engine_apply(&rules) == WTERM_SUCCESS;
+}
+
+static void run_server(int ready_fd) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(BENCH_PORT)};
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listener, 1) != 0) {
+        _exit(1);
+    }
+    if (write(ready_fd, "r", 1) != 1) {
+        _exit(1);
+    }
+
+    int conn = accept(listener, NULL, NULL);
+    static char buffer[CHUNK_SIZE];
+    while (conn >= 0 && read(conn, buffer, sizeof(buffer)) > 0) {
+    }
+    _exit(0);
+}
+
+// Returns bytes sent per second, or a negative value on failure
+static double run_client(int seconds) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(BENCH_PORT)};
+    inet_pton(AF_INET, SERVER_ADDR, &addr.sin_addr);
+    if (sock < 0 || connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        return -1;
+    }
+
+    static char buffer[CHUNK_SIZE];
+    double start = now_s();
+    double elapsed = 0;
+    double sent = 0;
+    while (elapsed < seconds) {
+        ssize_t n = write(sock, buffer, sizeof(buffer));
+        if (n <= 0) {
+            close(sock);
+            return -1;
+        }
+        sent += (double)n;
+        elapsed = now_s() - start;
+    }
+    close(sock);
+    return sent / elapsed;
+}
+
+// One transfer; returns Gbit/s, or a negative value on failure
+static double measure(int seconds) {
+    int ready[2];
+    int result[2];
+    if (pipe(ready) != 0 || pipe(result) != 0) {
+        return -1;
+    }
+
+    pid_t server = fork();
+    if (server == 0) {
+        close(ready[0]);
+        if (!enter_netns(NS_SERVER)) {
+            _exit(1);
+        }
+        run_server(ready[1]);
+    }
+    close(ready[1]);
+    char byte;
+    bool listening = read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+
+    pid_t client = -1;
+    if (listening) {
+        client = fork();
+        if (client == 0) {
+            close(result[0]);
+            double rate = enter_netns(NS_CLIENT) ? run_client(seconds) : -1;
+            _exit(write(result[1], &rate, sizeof(rate)) == sizeof(rate) ? 0 : 1);
+        }
+    }
+    close(result[1]);
+
+    double rate = -1;
+    if (client < 0 || read(result[0], &rate, sizeof(rate)) != sizeof(rate)) {
+        rate = -1;
+    }
+    close(result[0]);
+    if (client > 0) {
+        waitpid(client, NULL, 0);
+    }
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    return rate < 0 ? -1 : rate * 8 / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    int seconds = argc > 1 ? atoi(argv[1]) : DEFAULT_SECONDS;
+    int filler = argc > 2 ? atoi(argv[2]) : DEFAULT_FILLER_RULES;
+    int runs = argc > 3 ? atoi(argv[3]) : DEFAULT_RUNS;
+    if (seconds <= 0 || filler < 0 || runs <= 0) {
+        fprintf(stderr, "usage: %s [seconds] [filler_rules] [runs]\n", argv[0]);
+        return 1;
+    }
+    if (geteuid() != 0 || !capability_available(CAPABILITY_IP)) {
+        fprintf(stderr, "%s needs root and ip\n", argv[0]);
+        return 1;
+    }
+    bool have_nft = nat_engine_backend() == NAT_BACKEND_NFTABLES;
+    bool have_nat = nat_engine_backend() != NAT_BACKEND_NONE;
+    if (!have_nft) {
+        filler = 0; // Extra rules are loaded with nft
+    }
+
+    int host_ns = open("/proc/self/ns/net", O_RDONLY | O_CLOEXEC);
+    teardown();
+    bool ok = host_ns >= 0 && setup() && enter_netns(NS_ROUTER) &&
+              write_proc("/proc/sys/net/ipv4/ip_forward", "1") &&
+              (filler == 0 || load_filler_rules(filler));
+    if (!ok) {
+        fprintf(stderr, "could not set up the namespaces\n");
+        if (host_ns >= 0) {
+            setns(host_ns, CLONE_NEWNET);
+        }
+        teardown();
+        return 1;
+    }
+
+    printf("client -> router (%d extra forward rules) -> server, %d s per run\n\n", filler,
+           seconds);
+    printf("%-16s %10s %10s %10s\n", "forwarding", "min Gb/s", "p50 Gb/s", "max Gb/s");
+
+    const struct {
+        const char *label;
+        sharing_mode_t mode;
+        bool supported;
+    } modes[] = {{"plain NAT", MODE_NAT, have_nat},
+                 {"flowtable", MODE_FLOWTABLE, have_nft},
+                 {"bridge", MODE_BRIDGE, true}};
+    double *samples = malloc(sizeof(double) * (size_t)runs);
+    int failures = 0;
+    for (size_t m = 0; samples && m < sizeof(modes) / sizeof(modes[0]); m++) {
+        if (!modes[m].supported) {
+            printf("%-16s %10s\n", modes[m].label, "skipped (no nft/iptables)");
+            continue;
+        }
+        // The namespace stays the router's; clients and servers fork from it
+        if (!configure_router(modes[m].mode)) {
+            fprintf(stderr, "%s: router setup failed\n", modes[m].label);
+            failures++;
+            continue;
+        }
+        for (int i = 0; i < runs; i++) {
+            samples[i] = measure(seconds);
+            failures += samples[i] < 0;
+        }
+        qsort(samples, (size_t)runs, sizeof(double), compare_double);
+        printf("%-16s %10.2f %10.2f %10.2f\n", modes[m].label, samples[0], samples[runs / 2],
+               samples[runs - 1]);
+    }
+    if (failures) {
+        printf("\n%d runs failed\n", failures);
+    }
+
+    free(samples);
+    setns(host_ns, CLONE_NEWNET);
+    close(host_ns);
+    teardown();
+    return failures ? 1 : 0;
+}
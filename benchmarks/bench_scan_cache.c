@@ -0,0 +1,97 @@
+/**
+ * @file bench_scan_cache.c
+ * @brief Startup snapshot benchmark: loading the persisted last scan
+ *
+ * Writes a snapshot of a synthetic scan to a temporary directory, then
+ * loads it repeatedly into a reused list, as the TUI does before its first
+ * paint, and reports latency percentiles.
+ *
+ * Usage: bench_scan_cache [iterations] [networks]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../src/utils/network_list.h"
+#include "../src/utils/scan_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_ITERATIONS 1000
+#define DEFAULT_NETWORKS 300
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    int networks = argc > 2 ? atoi(argv[2]) : DEFAULT_NETWORKS;
+    if (iterations <= 0 || networks <= 0) {
+        fprintf(stderr, "usage: %s [iterations] [networks]\n", argv[0]);
+        return 1;
+    }
+
+    char dir[] = "/tmp/wterm-bench-XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", dir, SCAN_CACHE_FILE);
+
+    network_list_t list = {0};
+    for (int i = 0; i < networks; i++) {
+        network_info_t *network = network_list_append(&list);
+        if (!network) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        snprintf(network->ssid, MAX_STR_SSID, "network-%d", i);
+        snprintf(network->security, MAX_STR_SECURITY, "WPA2");
+        scan_record_t record = {.bssid = {0x02, 0, 0, 0, (uint8_t)(i >> 8), (uint8_t)i},
+                                .frequency = 2412,
+                                .channel = 1,
+                                .quality = (uint8_t)(i % 101),
+                                .security_flags = NETWORK_SECURITY_WPA2};
+        network_list_set_record(&list, i, &record);
+    }
+
+    double *samples = malloc(sizeof(double) * (size_t)iterations);
+    if (!samples || scan_cache_save(path, &list) != WTERM_SUCCESS) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    network_list_t loaded = {0};
+    int failures = 0;
+    for (int i = 0; i < iterations; i++) {
+        double t0 = now_us();
+        if (scan_cache_load(path, &loaded, NULL) != WTERM_SUCCESS ||
+            loaded.count != networks) {
+            failures++;
+        }
+        samples[i] = now_us() - t0;
+    }
+
+    qsort(samples, (size_t)iterations, sizeof(double), compare_double);
+    printf("loading a %d-network snapshot %d times\n\n", networks, iterations);
+    printf("%10s %10s %10s %8s\n", "p50 (us)", "p99 (us)", "max (us)", "failed");
+    printf("%10.1f %10.1f %10.1f %8d\n", samples[iterations / 2],
+           samples[(int)(iterations * 0.99)], samples[iterations - 1], failures);
+
+    unlink(path);
+    rmdir(dir);
+    free(samples);
+    network_list_free(&loaded);
+    network_list_free(&list);
+    return failures ? 1 : 0;
+}
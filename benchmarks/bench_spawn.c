@@ -0,0 +1,122 @@
+/**
+ * @file bench_spawn.c
+ * @brief Spawn-cost benchmark: safe_exec launcher vs. plain fork/exec
+ *
+ * The parent first grows a resident "ballast" allocation to mimic a TUI
+ * holding termbox buffers and scan state, then spawns /bin/true repeatedly
+ * with each strategy and reports spawns per second and latency percentiles.
+ *
+ * Usage: bench_spawn [iterations] [ballast_mb]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../src/utils/safe_exec.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_ITERATIONS 500
+#define DEFAULT_BALLAST_MB 256
+
+typedef bool (*spawn_fn)(const char *program, char *const args[]);
+
+// The pre-posix_spawn implementation of safe_exec_check_silent()
+static bool fork_exec_check_silent(const char *program, char *const args[]) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        return false;
+    }
+
+    if (pid == 0) {
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDOUT_FILENO);
+            dup2(devnull, STDERR_FILENO);
+            close(devnull);
+        }
+        execvp(program, args);
+        _exit(127);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0) {
+        return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_benchmark(const char *label, spawn_fn spawn, int iterations) {
+    char *const args[] = {"true", NULL};
+    double *samples = malloc(sizeof(double) * (size_t)iterations);
+    if (!samples) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    // Warm up page cache and the dynamic loader
+    for (int i = 0; i < 10; i++) {
+        spawn("true", args);
+    }
+
+    int failures = 0;
+    double start = now_us();
+    for (int i = 0; i < iterations; i++) {
+        double t0 = now_us();
+        if (!spawn("true", args)) {
+            failures++;
+        }
+        samples[i] = now_us() - t0;
+    }
+    double total = now_us() - start;
+
+    qsort(samples, (size_t)iterations, sizeof(double), compare_double);
+    printf("%-22s %10.0f %10.1f %10.1f %10.1f %8d\n", label,
+           iterations / (total / 1e6), samples[iterations / 2],
+           samples[(int)(iterations * 0.99)], samples[iterations - 1],
+           failures);
+
+    free(samples);
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    int ballast_mb = argc > 2 ? atoi(argv[2]) : DEFAULT_BALLAST_MB;
+    if (iterations <= 0 || ballast_mb < 0) {
+        fprintf(stderr, "usage: %s [iterations] [ballast_mb]\n", argv[0]);
+        return 1;
+    }
+
+    // Touch every page so the ballast is resident and mapped
+    size_t ballast_size = (size_t)ballast_mb * 1024 * 1024;
+    char *ballast = ballast_size ? malloc(ballast_size) : NULL;
+    if (ballast) {
+        memset(ballast, 0xa5, ballast_size);
+    }
+
+    printf("spawning /bin/true %d times with %d MiB resident\n\n", iterations,
+           ballast_mb);
+    printf("%-22s %10s %10s %10s %10s %8s\n", "strategy", "spawns/s",
+           "p50 (us)", "p99 (us)", "max (us)", "failed");
+
+    run_benchmark("fork+execvp", fork_exec_check_silent, iterations);
+    run_benchmark("safe_exec (spawn)", safe_exec_check_silent, iterations);
+
+    free(ballast);
+    return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file bench_startup.c
+ * @brief Startup-cost benchmark for the wterm binary
+ *
+ * Runs `wterm --version` and `wterm list` repeatedly with
+ * WTERM_EXEC_STATS=1 and reports wall-clock latency together with the
+ * number of child processes each invocation spawned.
+ *
+ * Usage: bench_startup [iterations] [path/to/wterm]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../src/utils/safe_exec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 50
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Extract N from the "wterm: N child processes spawned" stats line
+static long parse_spawn_count(char *err) {
+    char *cursor = err;
+    char *line;
+    while ((line = safe_exec_next_line(&cursor))) {
+        long count;
+        if (sscanf(line, "wterm: %ld child processes spawned", &count) == 1) {
+            return count;
+        }
+    }
+    return -1;
+}
+
+static void run_benchmark(const char *wterm, const char *command, int iterations) {
+    char *const args[] = {(char *)wterm, (char *)command, NULL};
+    double *samples = malloc(sizeof(double) * (size_t)iterations);
+    if (!samples) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    long spawns = -1;
+    for (int i = 0; i < iterations; i++) {
+        safe_exec_output_t output;
+        double t0 = now_ms();
+        if (!safe_exec_capture(wterm, args, &output)) {
+            fprintf(stderr, "failed to run %s %s\n", wterm, command);
+            exit(1);
+        }
+        samples[i] = now_ms() - t0;
+
+        long count = parse_spawn_count(output.err);
+        if (count > spawns) {
+            spawns = count;
+        }
+        safe_exec_output_free(&output);
+    }
+
+    qsort(samples, (size_t)iterations, sizeof(double), compare_double);
+    printf("wterm %-12s %10.2f %10.2f %10.2f %10ld\n", command,
+           samples[iterations / 2], samples[(int)(iterations * 0.99)],
+           samples[iterations - 1], spawns);
+
+    free(samples);
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    const char *wterm = argc > 2 ? argv[2] : WTERM_BINARY;
+    if (iterations <= 0) {
+        fprintf(stderr, "usage: %s [iterations] [path/to/wterm]\n", argv[0]);
+        return 1;
+    }
+
+    // Inherited by every wterm run below
+    setenv("WTERM_EXEC_STATS", "1", 1);
+
+    printf("running %s %d times per command\n\n", wterm, iterations);
+    printf("%-18s %10s %10s %10s %10s\n", "command", "p50 (ms)", "p99 (ms)",
+           "max (ms)", "spawns");
+
+    run_benchmark(wterm, "--version", iterations);
+    run_benchmark(wterm, "list", iterations);
+    return 0;
+}
@@ -152,12 +152,10 @@ add_custom_target(security-audit
     COMMAND ${CMAKE_COMMAND} -E echo "✅ No system() calls found"
     COMMAND ${CMAKE_COMMAND} -E echo ""
 
-    COMMAND ${CMAKE_COMMAND} -E echo "Verifying shell_escape usage in command execution..."
+    COMMAND ${CMAKE_COMMAND} -E echo "Checking for popen() calls..."
     COMMAND ${CMAKE_COMMAND} -E chdir ${CMAKE_SOURCE_DIR}
-        bash -c "grep -q 'shell_escape' src/core/network_backends/nmcli_backend.c"
-    COMMAND ${CMAKE_COMMAND} -E chdir ${CMAKE_SOURCE_DIR}
-        bash -c "grep -q 'shell_escape' src/core/connection.c"
-    COMMAND ${CMAKE_COMMAND} -E echo "✅ Shell escaping implemented in critical paths"
+        bash -c "! grep -rn --include='*.c' --include='*.h' 'popen(' src/ 2>/dev/null"
+    COMMAND ${CMAKE_COMMAND} -E echo "✅ Commands run via argv (safe_exec), no shell involved"
     COMMAND ${CMAKE_COMMAND} -E echo ""
 
     COMMAND ${CMAKE_COMMAND} -E echo "Verifying input sanitization module..."
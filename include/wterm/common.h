@@ -7,6 +7,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // Version information
 #define WTERM_VERSION_MAJOR 2
@@ -18,7 +19,6 @@
 #define MAX_STR_SSID 33         // 32 bytes SSID + '\0'
 #define MAX_STR_SECURITY 17     // long enough for WPA2-Enterprise
 #define MAX_STR_SIGNAL 33       // flexible signal representation
-#define MAX_NETWORKS 32         // handle up to 32 available networks
 
 // Hotspot configuration limits
 #define MAX_STR_INTERFACE 16    // network interface name (e.g., wlan0)
@@ -44,7 +44,8 @@ typedef enum {
     WTERM_ERROR_HOTSPOT = 6,
     WTERM_ERROR_INTERFACE = 7,
     WTERM_ERROR_PERMISSION = 8,
-    WTERM_ERROR_CANCELLED = 9
+    WTERM_ERROR_CANCELLED = 9,
+    WTERM_ERROR_TIMEOUT = 10
 } wterm_result_t;
 
 // WiFi security types
@@ -58,11 +59,12 @@ typedef enum {
     WIFI_SECURITY_ENTERPRISE
 } wifi_security_t;
 
-// Hotspot sharing methods
+// Hotspot sharing methods (values are stored in saved configs)
 typedef enum {
-    HOTSPOT_SHARE_NONE = 0,    // No internet sharing
-    HOTSPOT_SHARE_NAT,         // NAT-based sharing (default)
-    HOTSPOT_SHARE_BRIDGE       // Bridge mode sharing
+    HOTSPOT_SHARE_NONE = 0,         // No internet sharing
+    HOTSPOT_SHARE_NAT = 1,          // NAT-based sharing (default)
+    HOTSPOT_SHARE_NAT_FASTPATH = 3, // NAT, established flows via an nft flowtable
+    HOTSPOT_SHARE_BRIDGE = 2        // Bridge mode sharing
 } hotspot_share_method_t;
 
 // Hotspot state enumeration
@@ -81,10 +83,43 @@ typedef struct {
     char signal[MAX_STR_SIGNAL];
 } network_info_t;
 
-// Network list structure
+// Security flags of a scan record
+#define NETWORK_SECURITY_WEP   0x01
+#define NETWORK_SECURITY_WPA1  0x02
+#define NETWORK_SECURITY_WPA2  0x04
+#define NETWORK_SECURITY_WPA3  0x08
+#define NETWORK_SECURITY_OWE   0x10
+#define NETWORK_SECURITY_8021X 0x20
+
+// BSSID-level scan record (row view of the numeric columns below)
+typedef struct {
+    uint8_t bssid[6];
+    uint16_t frequency;        // MHz, 0 if unknown
+    uint16_t channel;          // 0 if unknown
+    int16_t signal_dbm;        // 0 if unknown
+    uint8_t quality;           // Signal quality 0-100
+    uint8_t security_flags;    // NETWORK_SECURITY_* bits
+    uint16_t max_rate;         // Mbit/s, 0 if unknown
+} scan_record_t;
+
+struct arena;
+
+// Network list structure. Entries are stored column-wise in a per-list
+// arena (see src/utils/network_list.h), so sorting and filtering only touch
+// the columns they need. A zero-initialized list is a valid empty list.
 typedef struct {
-    network_info_t networks[MAX_NETWORKS];
+    network_info_t *networks;  // String views, as shown by display_networks()
+    uint8_t (*bssid)[6];
+    uint16_t *frequency;
+    uint16_t *channel;
+    int16_t *signal_dbm;
+    uint8_t *quality;
+    uint8_t *security_flags;
+    uint16_t *max_rate;
     int count;
+    int capacity;
+    bool is_stale;             // Results predate a requested rescan
+    struct arena *arena;
 } network_list_t;
 
 // Connected device information
@@ -112,8 +147,20 @@ typedef struct {
     bool client_isolation;                // Isolate clients from each other
     bool mac_filtering;                   // Enable MAC address filtering
     bool is_5ghz;                        // Use 5GHz band
+    unsigned int rate_limit_kbit;         // Download limit for the hotspot, 0 = none
+    unsigned int client_rate_limit_kbit;  // Download limit per client, 0 = none
 } hotspot_config_t;
 
+// Current WiFi connection, as reported by the network backend
+typedef struct {
+    bool is_connected;
+    char connected_ssid[MAX_STR_SSID];
+    char connection_name[MAX_STR_SSID];  // Connection profile name (may differ from SSID)
+    char connection_uuid[64];
+    char ip_address[16];
+    char device[MAX_STR_INTERFACE];      // Interface carrying the connection
+} connection_status_t;
+
 // Hotspot runtime status
 typedef struct {
     hotspot_config_t config;              // Configuration used
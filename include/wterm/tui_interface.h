@@ -12,6 +12,8 @@
 #include "common.h"
 #include <stdbool.h>
 
+struct scan_worker;
+
 /**
  * @brief Check if termbox2 TUI is available
  * @return true if TUI can be initialized, false otherwise
@@ -46,16 +48,22 @@ void tui_shutdown(void);
  * - ?: Help
  * - q/Esc: Quit
  *
- * @param networks List of scanned networks
+ * With a scan worker attached, r requests a background rescan and each
+ * completed scan is merged into the list in place while the interface
+ * stays interactive.
+ *
+ * @param networks List of scanned networks (replaced by worker results)
+ * @param worker Background scanner, or NULL to return "RESCAN" on r
  * @param selected_ssid Output buffer for selected SSID
  * @param buffer_size Size of output buffer
  * @return true if network selected, false if user quit
  *
  * Special return values in selected_ssid:
- * - "RESCAN" - User requested rescan
+ * - "RESCAN" - User requested rescan (only without a worker)
  * - "HOTSPOT" - User wants hotspot manager
  */
-bool tui_select_network(const network_list_t *networks,
+bool tui_select_network(network_list_t *networks,
+                        struct scan_worker *worker,
                         char *selected_ssid,
                         size_t buffer_size);
 
@@ -0,0 +1,361 @@
+/**
+ * @file bridge_engine.c
+ * @brief Bridged internet sharing: hotspot clients on the uplink's segment
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bridge_engine.h"
+#include "../utils/capability.h"
+#include "../utils/input_sanitizer.h"
+#include "../utils/safe_exec.h"
+#include "../utils/string_utils.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BRIDGE_SCRIPT_MAX 2048
+
+// Copy the whitespace-delimited word that follows key in text
+static bool word_after(const char *text, const char *key, char *out, size_t size) {
+  const char *start = strstr(text, key);
+  if (!start) {
+    return false;
+  }
+  start += strlen(key);
+  size_t len = strcspn(start, " \t\n\\");
+  if (len == 0 || len >= size) {
+    return false;
+  }
+  memcpy(out, start, len);
+  out[len] = '\0';
+  return true;
+}
+
+bool bridge_parse_link(const char *line, bridge_link_t *link) {
+  if (!line || !link || !isdigit((unsigned char)line[0]) ||
+      !strstr(line, ": ")) {
+    return false;
+  }
+
+  memset(link, 0, sizeof(*link));
+  word_after(line, " master ", link->master, sizeof(link->master));
+  word_after(line, "link/ether ", link->mac, sizeof(link->mac));
+  // -o joins detail lines with "\"; the link kind opens its own line
+  link->is_bridge = strstr(line, "\\    bridge ") != NULL;
+  return true;
+}
+
+void bridge_parse_l3(char *addr_output, char *route_output, bridge_l3_t *l3) {
+  if (!l3) {
+    return;
+  }
+  memset(l3, 0, sizeof(*l3));
+  l3->metric = -1;
+
+  char *cursor = addr_output;
+  char *line;
+  while (cursor && (line = safe_exec_next_line(&cursor)) &&
+         l3->address_count < BRIDGE_MAX_ADDRESSES) {
+    if (word_after(line, " inet ", l3->addresses[l3->address_count],
+                   sizeof(l3->addresses[0]))) {
+      l3->address_count++;
+    }
+  }
+
+  cursor = route_output;
+  while (cursor && (line = safe_exec_next_line(&cursor))) {
+    if (strncmp(line, "default ", 8) != 0 ||
+        !word_after(line, " via ", l3->gateway, sizeof(l3->gateway))) {
+      continue;
+    }
+    char metric[16];
+    if (word_after(line, " metric ", metric, sizeof(metric))) {
+      l3->metric = atoi(metric);
+    }
+    break;
+  }
+}
+
+void bridge_name_for_uplink(const char *uplink_iface, char *bridge, size_t size) {
+  // Interface names hold 15 characters; keep the prefix, trim the uplink
+  int room = 15 - (int)strlen(BRIDGE_PREFIX);
+  snprintf(bridge, size, BRIDGE_PREFIX "%.*s", room, uplink_iface);
+}
+
+// Append formatted text; *used passes size once anything is truncated
+static void append(char *buffer, size_t size, size_t *used, const char *format,
+                   ...) __attribute__((format(printf, 4, 5)));
+
+static void append(char *buffer, size_t size, size_t *used, const char *format,
+                   ...) {
+  if (*used >= size) {
+    return;
+  }
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buffer + *used, size - *used, format, args);
+  va_end(args);
+  *used += len > 0 ? (size_t)len : size;
+}
+
+static void append_default_route(char *buffer, size_t size, size_t *used,
+                                 const bridge_l3_t *l3, const char *dev) {
+  if (l3->gateway[0] == '\0') {
+    return;
+  }
+  if (l3->metric >= 0) {
+    append(buffer, size, used, "route replace default via %s dev %s metric %d\n",
+           l3->gateway, dev, l3->metric);
+  } else {
+    append(buffer, size, used, "route replace default via %s dev %s\n",
+           l3->gateway, dev);
+  }
+}
+
+size_t bridge_render_create(const char *bridge, const char *uplink_iface,
+                            const char *ap_iface, const char *mac,
+                            const bridge_l3_t *l3, char *buffer, size_t size) {
+  if (!bridge || !uplink_iface || !ap_iface || !l3 || !buffer) {
+    return 0;
+  }
+
+  size_t used = 0;
+  if (mac && mac[0]) {
+    append(buffer, size, &used, "link add name %s address %s type bridge\n",
+           bridge, mac);
+  } else {
+    append(buffer, size, &used, "link add name %s type bridge\n", bridge);
+  }
+  append(buffer, size, &used, "link set %s master %s\n", uplink_iface, bridge);
+  append(buffer, size, &used, "link set %s master %s\n", ap_iface, bridge);
+  for (int i = 0; i < l3->address_count; i++) {
+    append(buffer, size, &used, "addr del %s dev %s\n", l3->addresses[i],
+           uplink_iface);
+  }
+  append(buffer, size, &used, "link set %s up\n", bridge);
+  for (int i = 0; i < l3->address_count; i++) {
+    append(buffer, size, &used, "addr add %s brd + dev %s\n", l3->addresses[i],
+           bridge);
+  }
+  append_default_route(buffer, size, &used, l3, bridge);
+  return used < size ? used : 0;
+}
+
+size_t bridge_render_dissolve(const char *bridge, const char *uplink_iface,
+                              const bridge_l3_t *l3, char *buffer, size_t size) {
+  if (!bridge || !uplink_iface || !l3 || !buffer) {
+    return 0;
+  }
+
+  size_t used = 0;
+  append(buffer, size, &used, "link set %s nomaster\n", uplink_iface);
+  append(buffer, size, &used, "link del %s\n", bridge);
+  for (int i = 0; i < l3->address_count; i++) {
+    append(buffer, size, &used, "addr add %s brd + dev %s\n", l3->addresses[i],
+           uplink_iface);
+  }
+  append_default_route(buffer, size, &used, l3, uplink_iface);
+  return used < size ? used : 0;
+}
+
+// Run ip and keep its output; false if it could not run or failed
+static bool ip_query(char *const args[], safe_exec_output_t *output) {
+  if (!safe_exec_capture("ip", args, output)) {
+    return false;
+  }
+  if (output->exit_code != 0) {
+    safe_exec_output_free(output);
+    return false;
+  }
+  return true;
+}
+
+static bool query_link(const char *iface, bridge_link_t *link) {
+  char *const args[] = {"ip", "-o", "-d", "link", "show", "dev", (char *)iface, NULL};
+  safe_exec_output_t output;
+  if (!ip_query(args, &output)) {
+    return false;
+  }
+  bool ok = bridge_parse_link(output.out, link);
+  safe_exec_output_free(&output);
+  return ok;
+}
+
+static void query_l3(const char *iface, bridge_l3_t *l3) {
+  char *const addr_args[] = {"ip", "-o", "-4", "addr", "show", "dev", (char *)iface, NULL};
+  char *const route_args[] = {"ip", "-4", "route", "show", "default", "dev",
+                              (char *)iface, NULL};
+  safe_exec_output_t addrs = {0};
+  safe_exec_output_t routes = {0};
+  bool have_addrs = ip_query(addr_args, &addrs);
+  bool have_routes = ip_query(route_args, &routes);
+  bridge_parse_l3(have_addrs ? addrs.out : NULL, have_routes ? routes.out : NULL, l3);
+  if (have_addrs) {
+    safe_exec_output_free(&addrs);
+  }
+  if (have_routes) {
+    safe_exec_output_free(&routes);
+  }
+}
+
+// One `ip -batch`; with force, later lines still run after a failure
+static bool ip_batch(const char *script, size_t len, bool force) {
+  char *const args[] = {"ip", "-batch", "-", NULL};
+  char *const force_args[] = {"ip", "-force", "-batch", "-", NULL};
+  safe_exec_options_t options = {.input = script, .input_len = len};
+  safe_exec_output_t output;
+  if (safe_exec_capture_ex("ip", force ? force_args : args, &options, &output) !=
+      WTERM_SUCCESS) {
+    return false;
+  }
+  bool ok = output.exit_code == 0;
+  safe_exec_output_free(&output);
+  return ok;
+}
+
+static bool is_wireless(const char *iface) {
+  char path[96];
+  snprintf(path, sizeof(path), "/sys/class/net/%s/wireless", iface);
+  return access(path, F_OK) == 0;
+}
+
+static void set_4addr(const char *iface, bool on) {
+  char *const args[] = {"iw", "dev", (char *)iface, "set", "4addr",
+                        on ? "on" : "off", NULL};
+  safe_exec_check_silent("iw", args); // Drivers without 4addr still bridge
+}
+
+// NetworkManager would keep renewing DHCP and restoring routes on an uplink
+// whose addresses moved to the bridge; it leaves unmanaged devices alone
+static void set_nm_managed(const char *iface, bool on) {
+  if (!capability_available(CAPABILITY_NMCLI)) {
+    return;
+  }
+  char *const args[] = {"nmcli", "device", "set", (char *)iface, "managed",
+                        on ? "yes" : "no", NULL};
+  safe_exec_check_silent("nmcli", args); // Fails when NM is not running
+}
+
+wterm_result_t bridge_engine_attach(const char *ap_iface, const char *uplink_iface,
+                                    char *bridge, size_t bridge_size) {
+  if (!validate_interface_name(ap_iface) || !validate_interface_name(uplink_iface) ||
+      strcmp(ap_iface, uplink_iface) == 0) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+  if (!capability_available(CAPABILITY_IP)) {
+    return WTERM_ERROR_NETWORK;
+  }
+
+  bridge_link_t uplink;
+  if (!query_link(uplink_iface, &uplink)) {
+    return WTERM_ERROR_NETWORK;
+  }
+
+  char name[MAX_STR_INTERFACE];
+  if (uplink.is_bridge || uplink.master[0]) {
+    // Join the bridge the uplink already is or belongs to
+    safe_string_copy(name, uplink.is_bridge ? uplink_iface : uplink.master,
+                     sizeof(name));
+    char *const args[] = {"ip", "link", "set", (char *)ap_iface, "master", name, NULL};
+    if (!safe_exec_check_silent("ip", args)) {
+      return WTERM_ERROR_NETWORK;
+    }
+  } else {
+    bridge_name_for_uplink(uplink_iface, name, sizeof(name));
+    bridge_l3_t l3;
+    query_l3(uplink_iface, &l3);
+
+    char script[BRIDGE_SCRIPT_MAX];
+    size_t len = bridge_render_create(name, uplink_iface, ap_iface, uplink.mac,
+                                      &l3, script, sizeof(script));
+    if (len == 0) {
+      return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    bool wireless = is_wireless(uplink_iface);
+    set_nm_managed(uplink_iface, false);
+    if (wireless) {
+      set_4addr(uplink_iface, true);
+    }
+    if (!ip_batch(script, len, false)) {
+      // Roll back whatever part of the batch went through
+      len = bridge_render_dissolve(name, uplink_iface, &l3, script, sizeof(script));
+      ip_batch(script, len, true);
+      if (wireless) {
+        set_4addr(uplink_iface, false);
+      }
+      set_nm_managed(uplink_iface, true);
+      return WTERM_ERROR_NETWORK;
+    }
+  }
+
+  if (bridge) {
+    safe_string_copy(bridge, name, bridge_size);
+  }
+  return WTERM_SUCCESS;
+}
+
+wterm_result_t bridge_engine_detach(const char *ap_iface) {
+  if (!validate_interface_name(ap_iface)) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+  if (!capability_available(CAPABILITY_IP)) {
+    return WTERM_ERROR_NETWORK;
+  }
+
+  bridge_link_t ap;
+  if (!query_link(ap_iface, &ap) || ap.master[0] == '\0') {
+    return WTERM_SUCCESS; // Gone or not bridged: nothing to undo
+  }
+
+  char script[BRIDGE_SCRIPT_MAX];
+  size_t used = 0;
+  append(script, sizeof(script), &used, "link set %s nomaster\n", ap_iface);
+
+  // A bridge of our own is dissolved once only the uplink is left in it
+  char uplink[MAX_STR_INTERFACE] = {0};
+  int others = 0;
+  if (strncmp(ap.master, BRIDGE_PREFIX, strlen(BRIDGE_PREFIX)) == 0) {
+    char *const args[] = {"ip", "-o", "link", "show", "master", ap.master, NULL};
+    safe_exec_output_t ports;
+    if (ip_query(args, &ports)) {
+      char *cursor = ports.out;
+      char *line;
+      while ((line = safe_exec_next_line(&cursor))) {
+        // "<index>: <name>[@<peer>]: <flags> ..."
+        char *name = strstr(line, ": ");
+        if (!name) continue;
+        name += 2;
+        name[strcspn(name, "@:")] = '\0';
+        if (strcmp(name, ap_iface) == 0) continue;
+        safe_string_copy(uplink, name, sizeof(uplink));
+        others++;
+      }
+      safe_exec_output_free(&ports);
+    }
+  }
+
+  bool dissolve = others == 1;
+  if (dissolve) {
+    bridge_l3_t l3;
+    query_l3(ap.master, &l3);
+    size_t len = bridge_render_dissolve(ap.master, uplink, &l3, script + used,
+                                        sizeof(script) - used);
+    used = len ? used + len : sizeof(script);
+  }
+  if (used >= sizeof(script)) {
+    return WTERM_ERROR_GENERAL;
+  }
+
+  bool ok = ip_batch(script, used, true);
+  if (dissolve) {
+    if (is_wireless(uplink)) {
+      set_4addr(uplink, false);
+    }
+    set_nm_managed(uplink, true);
+  }
+  return ok ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+/**
+ * @file bridge_engine.h
+ * @brief Bridged internet sharing: hotspot clients on the uplink's segment
+ *
+ * The access point interface is enslaved to a Linux bridge together with
+ * the uplink, so clients get their addresses from the upstream network and
+ * traffic is switched without NAT or conntrack. If the uplink already is,
+ * or belongs to, a bridge, the AP joins that bridge. Otherwise wterm
+ * creates `wtbr-<uplink>` with the uplink's MAC address and moves the
+ * uplink's IPv4 addresses and default route onto it, so the host keeps
+ * its connectivity; detaching the last AP restores them and deletes the
+ * bridge. All changes of one step go to the kernel as one `ip -batch`.
+ *
+ * An uplink that is itself a WiFi station is switched to 4-address (WDS)
+ * mode before it is bridged, which the upstream AP must support. The AP
+ * side needs no 4addr mode.
+ *
+ * While its addresses live on a bridge wterm created, the uplink is set
+ * unmanaged in NetworkManager, so NM does not fight over them; the moved
+ * addresses are static, so a DHCP lease is not renewed until the bridge
+ * is dissolved and NM manages the uplink again.
+ */
+
+#include "../../include/wterm/common.h"
+#include <stddef.h>
+
+#define BRIDGE_PREFIX "wtbr-"
+#define BRIDGE_MAX_ADDRESSES 8
+#define BRIDGE_ADDRESS_MAX 48 // "a.b.c.d/nn"
+#define BRIDGE_MAC_MAX 18
+
+/**
+ * @brief What `ip -o -d link show dev <iface>` says about an interface
+ */
+typedef struct {
+  char master[MAX_STR_INTERFACE]; // Empty when not enslaved
+  char mac[BRIDGE_MAC_MAX];       // Empty when not Ethernet-like
+  bool is_bridge;
+} bridge_link_t;
+
+/**
+ * @brief IPv4 configuration that moves between uplink and bridge
+ */
+typedef struct {
+  char addresses[BRIDGE_MAX_ADDRESSES][BRIDGE_ADDRESS_MAX];
+  int address_count;
+  char gateway[MAX_STR_IP_ADDR]; // Default route next hop, empty if none
+  int metric;                    // Default route metric, -1 if unset
+} bridge_l3_t;
+
+/**
+ * @brief Parse one line of `ip -o -d link show dev <iface>` output
+ * @return true if the line describes an interface
+ */
+bool bridge_parse_link(const char *line, bridge_link_t *link);
+
+/**
+ * @brief Parse an interface's IPv4 addresses and default route
+ * @param addr_output Output of `ip -o -4 addr show dev <iface>` (modified)
+ * @param route_output Output of `ip -4 route show default dev <iface>`
+ *        (modified), or NULL
+ */
+void bridge_parse_l3(char *addr_output, char *route_output, bridge_l3_t *l3);
+
+/**
+ * @brief Name of the bridge wterm creates for an uplink
+ */
+void bridge_name_for_uplink(const char *uplink_iface, char *bridge, size_t size);
+
+/**
+ * @brief Write the `ip -batch` script that builds a bridge around the uplink
+ *
+ * Creates the bridge with the uplink's MAC, enslaves uplink and AP, moves
+ * the IPv4 addresses and the default route from uplink to bridge.
+ *
+ * @param mac Uplink MAC for the bridge, or NULL/empty for a random one
+ * @return Script length, or 0 if it does not fit
+ */
+size_t bridge_render_create(const char *bridge, const char *uplink_iface,
+                            const char *ap_iface, const char *mac,
+                            const bridge_l3_t *l3, char *buffer, size_t size);
+
+/**
+ * @brief Write the `ip -batch` script that undoes bridge_render_create()
+ * @param l3 The bridge's current IPv4 configuration, moved back to the uplink
+ * @return Script length, or 0 if it does not fit
+ */
+size_t bridge_render_dissolve(const char *bridge, const char *uplink_iface,
+                              const bridge_l3_t *l3, char *buffer, size_t size);
+
+/**
+ * @brief Put the AP into a bridge with the uplink
+ *
+ * @param ap_iface Access point interface (must exist)
+ * @param uplink_iface Interface towards the upstream network
+ * @param bridge Output: bridge used (may be NULL)
+ * @param bridge_size Size of bridge
+ * @return WTERM_SUCCESS, WTERM_ERROR_INVALID_INPUT, or WTERM_ERROR_NETWORK
+ *         if ip is missing or an interface could not be configured
+ */
+wterm_result_t bridge_engine_attach(const char *ap_iface, const char *uplink_iface,
+                                    char *bridge, size_t bridge_size);
+
+/**
+ * @brief Take the AP out of its bridge
+ *
+ * When the bridge is one wterm created and only the uplink is left in it,
+ * the uplink gets its addresses and default route back and the bridge is
+ * deleted. Succeeds if the AP is not in a bridge.
+ */
+wterm_result_t bridge_engine_detach(const char *ap_iface);
@@ -4,187 +4,406 @@
  */
 
 #define _POSIX_C_SOURCE 200809L
-#define _DEFAULT_SOURCE  // For explicit_bzero
 #include "connection.h"
 #include "../utils/input_sanitizer.h"
-#include "../utils/safe_exec.h"
+#include "../utils/link_watcher.h"
+#include "../utils/query_cache.h"
 #include "../utils/string_utils.h"
+#include "../utils/nl80211_helper.h"
 #include "error_handler.h"
+#include "network_backends/backend_interface.h"
+#include "profile_index.h"
+#include <linux/nl80211.h>
+#include <pthread.h>
 #include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
 #include <time.h>
 #include <unistd.h>
 
-// Global cancellation state for connection operations
-// Using volatile sig_atomic_t for thread-safety and signal-safety
-// Note: While sig_atomic_t is atomic, we use __atomic_* for proper memory ordering across pthreads
-static volatile sig_atomic_t connection_cancelled = 0;
+// How long to wait for NetworkManager to report the connection once the
+// backend has activated it
+#define CONNECT_CONFIRM_TIMEOUT_MS 15000
+
+// Re-check NetworkManager's view at this interval while the link is fully
+// configured but not yet reported as the target SSID
+#define CONNECT_RECHECK_MS 1000
+
+static long long monotonic_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Cancellation state lives in the context. The flag is a volatile
+// sig_atomic_t for signal-safety; __atomic_* gives proper memory ordering
+// across pthreads. The context's eventfd is readable while a cancellation
+// is pending, so in-flight backend operations can be aborted immediately
+// instead of at the next status poll.
+static int cancel_fd(wterm_ctx_t *ctx) {
+  return __atomic_load_n(&ctx->connection_cancel_fd, __ATOMIC_SEQ_CST);
+}
 
 void init_connection_cancel(void) {
-  __atomic_store_n(&connection_cancelled, 0, __ATOMIC_SEQ_CST);
+  init_connection_cancel_ctx(wterm_ctx_default());
+}
+
+void init_connection_cancel_ctx(wterm_ctx_t *ctx) {
+  int fd = cancel_fd(ctx);
+  if (fd < 0) {
+    int created = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (created >= 0 &&
+        !__atomic_compare_exchange_n(&ctx->connection_cancel_fd, &fd, created,
+                                     false, __ATOMIC_SEQ_CST,
+                                     __ATOMIC_SEQ_CST)) {
+      close(created); // Another thread won the race
+    }
+  }
+
+  __atomic_store_n(&ctx->connection_cancelled, 0, __ATOMIC_SEQ_CST);
+
+  // Drain any cancellation left over from a previous attempt
+  fd = cancel_fd(ctx);
+  if (fd >= 0) {
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) == sizeof(value)) {
+    }
+  }
 }
 
 void request_connection_cancel(void) {
-  __atomic_store_n(&connection_cancelled, 1, __ATOMIC_SEQ_CST);
+  request_connection_cancel_ctx(wterm_ctx_default());
+}
+
+void request_connection_cancel_ctx(wterm_ctx_t *ctx) {
+  __atomic_store_n(&ctx->connection_cancelled, 1, __ATOMIC_SEQ_CST);
+
+  int fd = cancel_fd(ctx);
+  if (fd >= 0) {
+    uint64_t one = 1;
+    ssize_t written = write(fd, &one, sizeof(one));
+    (void)written; // Counter overflow is the only failure; still signalled
+  }
 }
 
 bool is_connection_cancelled(void) {
-  return __atomic_load_n(&connection_cancelled, __ATOMIC_SEQ_CST) != 0;
+  return is_connection_cancelled_ctx(wterm_ctx_default());
 }
 
-// Helper function to check if a saved connection exists for the given SSID
-static bool connection_exists(const char *ssid) {
-  if (!ssid || is_string_empty(ssid)) {
-    return false;
-  }
+bool is_connection_cancelled_ctx(wterm_ctx_t *ctx) {
+  return __atomic_load_n(&ctx->connection_cancelled, __ATOMIC_SEQ_CST) != 0;
+}
 
-  char command[512];
-  snprintf(command, sizeof(command), "nmcli -t -f NAME,TYPE connection show");
+// Saved profiles, rebuilt after wterm changes NetworkManager state (every
+// mutation calls query_cache_invalidate()) or once they are
+// SAVED_PROFILES_MAX_AGE_MS old, to pick up changes made elsewhere
+static pthread_mutex_t saved_profiles_lock = PTHREAD_MUTEX_INITIALIZER;
+static profile_index_t saved_profiles;
+static unsigned long saved_profiles_generation;
+static long long saved_profiles_time_ms = -1;
 
-  FILE *fp = popen(command, "r");
-  if (!fp) {
+// Look up the saved wireless profile for an SSID
+static bool find_saved_profile(const char *ssid, saved_profile_t *profile) {
+  if (!ssid || is_string_empty(ssid)) {
     return false;
   }
 
-  bool exists = false;
-  char buffer[512];
-  while (fgets(buffer, sizeof(buffer), fp)) {
-    buffer[strcspn(buffer, "\n")] = '\0';
+  pthread_mutex_lock(&saved_profiles_lock);
 
-    // Parse line: NAME:TYPE
-    char *colon = strchr(buffer, ':');
-    if (colon) {
-      *colon = '\0';
-      const char *name = buffer;
-      const char *type = colon + 1;
-
-      // Check if this is a WiFi connection with matching SSID
-      if (strcmp(type, "802-11-wireless") == 0 && strcmp(name, ssid) == 0) {
-        exists = true;
-        break;
-      }
-    }
+  long long now = monotonic_ms();
+  unsigned long generation = query_cache_generation();
+  if (saved_profiles_time_ms < 0 || generation != saved_profiles_generation ||
+      now - saved_profiles_time_ms >= SAVED_PROFILES_MAX_AGE_MS) {
+    // If nmcli failed, the connection can't be verified; retry next time
+    bool loaded = profile_index_load(&saved_profiles) == WTERM_SUCCESS;
+    saved_profiles_generation = generation;
+    saved_profiles_time_ms = loaded ? now : -1;
   }
 
-  int exit_status = pclose(fp);
-  // If nmcli failed, return false (connection doesn't exist or can't be verified)
-  if (exit_status != 0) {
-    return false;
+  const saved_profile_t *found = profile_index_find_ssid(&saved_profiles, ssid);
+  if (found && profile) {
+    *profile = *found;
   }
 
-  return exists;
+  pthread_mutex_unlock(&saved_profiles_lock);
+  return found != NULL;
+}
+
+static bool connection_exists(const char *ssid) {
+  return find_saved_profile(ssid, NULL);
 }
 
 // Public function to check if a saved connection exists
 bool is_saved_connection(const char *ssid) { return connection_exists(ssid); }
 
-// Helper function to execute nmcli connection command and monitor result
-static connection_result_t execute_nmcli_connect(const char *command,
-                                                 const char *ssid) {
+static void set_connected_result(connection_result_t *result,
+                                 const char *ssid) {
+  result->result = WTERM_SUCCESS;
+  result->connected = true;
+  snprintf(result->error_message, sizeof(result->error_message),
+           "Successfully connected to %s", ssid);
+}
+
+static void set_cancelled_result(connection_result_t *result) {
+  result->result = WTERM_ERROR_CANCELLED;
+  safe_string_copy(result->error_message, "Connection cancelled by user",
+                   sizeof(result->error_message));
+}
+
+// Always a fresh query; the memo would only replay the previous check
+static bool connected_to_ssid(const char *ssid) {
+  connection_status_t status;
+  return get_connection_status_snapshot(&status, 0) == WTERM_SUCCESS &&
+         status.is_connected && strcmp(status.connected_ssid, ssid) == 0;
+}
+
+// WiFi interface whose link and address events signal connection progress
+static bool find_wifi_interface(char *ifname, size_t size) {
+  nl80211_iface_t ifaces[NL80211_MAX_INTERFACES];
+  int count = 0;
+  if (nl80211_get_interfaces(ifaces, NL80211_MAX_INTERFACES, &count) !=
+      WTERM_SUCCESS) {
+    return false;
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (ifaces[i].iftype == NL80211_IFTYPE_STATION) {
+      safe_string_copy(ifname, ifaces[i].name, size);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Fallback when rtnetlink is unavailable: poll NetworkManager every 100ms
+static connection_result_t poll_for_connection(wterm_ctx_t *ctx,
+                                               const char *ssid,
+                                               long long deadline) {
   connection_result_t result = {0};
   struct timespec sleep_time = {0, 100000000}; // 100ms
 
-  // Execute nmcli command and capture output for immediate error detection
-  FILE *fp = popen(command, "r");
-  if (!fp) {
-    result.result = WTERM_ERROR_NETWORK;
-    result.error_type = CONN_ERROR_NETWORKMANAGER_NOT_RUNNING;
-    safe_string_copy(result.error_message, "Failed to execute nmcli command",
-                     sizeof(result.error_message));
-    return result;
-  }
+  while (true) {
+    if (is_connection_cancelled_ctx(ctx)) {
+      set_cancelled_result(&result);
+      return result;
+    }
 
-  // Read output to detect immediate errors (wrong password, network not found, etc.)
-  char output[1024] = {0};
-  size_t offset = 0;
-  char line[256];
+    if (connected_to_ssid(ssid)) {
+      set_connected_result(&result, ssid);
+      return result;
+    }
 
-  while (fgets(line, sizeof(line), fp) && offset < sizeof(output) - 1) {
-    size_t len = strlen(line);
-    if (offset + len < sizeof(output) - 1) {
-      memcpy(output + offset, line, len);
-      offset += len;
+    if (monotonic_ms() >= deadline) {
+      break;
     }
+    nanosleep(&sleep_time, NULL);
   }
-  output[offset] = '\0';
 
-  // Check exit status
-  int exit_status = pclose(fp);
+  result.result = WTERM_ERROR_TIMEOUT;
+  result.error_type = CONN_ERROR_TIMEOUT;
+  snprintf(result.error_message, sizeof(result.error_message),
+           "Connection to %s timed out", ssid);
+  return result;
+}
 
-  // If command failed immediately, parse error and return early
-  if (exit_status != 0) {
-    result.result = WTERM_ERROR_NETWORK;
+// Watch the WiFi interface; false if there is none or no rtnetlink
+static bool open_wifi_watcher(link_watcher_t *watcher) {
+  char ifname[MAX_STR_INTERFACE];
+  return find_wifi_interface(ifname, sizeof(ifname)) &&
+         link_watcher_open(watcher, ifname) == WTERM_SUCCESS;
+}
 
-    // Parse common error patterns
-    if (strstr(output, "No network with SSID") || strstr(output, "not found")) {
-      result.error_type = CONN_ERROR_NETWORK_UNAVAILABLE;
-      snprintf(result.error_message, sizeof(result.error_message),
-               "Network '%s' not found", ssid);
-    } else if (strstr(output, "Secrets were required") || strstr(output, "password")) {
-      result.error_type = CONN_ERROR_AUTH_FAILED;
-      safe_string_copy(result.error_message, "Authentication failed - incorrect password",
-                       sizeof(result.error_message));
-    } else if (strstr(output, "Failed to activate connection")) {
-      result.error_type = CONN_ERROR_UNKNOWN;
-      snprintf(result.error_message, sizeof(result.error_message),
-               "Failed to activate connection to '%s'", ssid);
-    } else {
-      // Generic error with first line of output
-      result.error_type = CONN_ERROR_UNKNOWN;
-      char *newline = strchr(output, '\n');
-      if (newline) *newline = '\0';
-
-      // Use %.*s to safely limit output length in format string
-      // "Connection failed: " is 20 chars, leave room for null terminator
-      const int max_output_len = (int)(sizeof(result.error_message) - 21);
-      snprintf(result.error_message, sizeof(result.error_message),
-               "Connection failed: %.*s", max_output_len,
-               output[0] ? output : "Unknown error");
-    }
-    return result;
+/**
+ * Wait for the connection to @p ssid to come up.
+ *
+ * Association and DHCP completion are observed through rtnetlink link and
+ * address events on the WiFi interface, and NetworkManager is only asked to
+ * confirm the SSID once the link is configured. On timeout the message
+ * reports the last phase the interface reached.
+ *
+ * @p watcher was opened before the connection was started, so events that
+ * happened since are still queued on it; the wait takes it over and closes
+ * it. Without one, NetworkManager is polled instead.
+ */
+static connection_result_t wait_for_connection(wterm_ctx_t *ctx,
+                                               const char *ssid,
+                                               int timeout_ms,
+                                               link_watcher_t *watcher_in) {
+  connection_result_t result = {0};
+  long long deadline = monotonic_ms() + timeout_ms;
+
+  if (!watcher_in) {
+    return poll_for_connection(ctx, ssid, deadline);
   }
+  link_watcher_t watcher = *watcher_in;
 
-  // Poll connection status for up to 15 seconds (150 iterations * 100ms)
-  for (int i = 0; i < 150; i++) {
-    // Check for cancellation
-    if (is_connection_cancelled()) {
-      result.result = WTERM_ERROR_CANCELLED;
-      safe_string_copy(result.error_message, "Connection cancelled by user",
-                       sizeof(result.error_message));
-      return result;
+  int cancel = cancel_fd(ctx);
+  while (true) {
+    if (is_connection_cancelled_ctx(ctx)) {
+      set_cancelled_result(&result);
+      break;
     }
 
-    connection_status_t status = get_connection_status();
+    bool configured = link_watcher_phase(&watcher) == LINK_PHASE_CONFIGURED;
+    if (configured && connected_to_ssid(ssid)) {
+      set_connected_result(&result, ssid);
+      break;
+    }
 
-    // Check if connected to target SSID
-    if (status.is_connected && strcmp(status.connected_ssid, ssid) == 0) {
-      result.result = WTERM_SUCCESS;
-      result.connected = true;
+    long long remaining = deadline - monotonic_ms();
+    if (remaining <= 0) {
+      link_phase_t phase = link_watcher_phase(&watcher);
+      result.result = WTERM_ERROR_TIMEOUT;
+      result.error_type = CONN_ERROR_TIMEOUT;
       snprintf(result.error_message, sizeof(result.error_message),
-               "Successfully connected to %s", ssid);
-      return result;
+               "Connection to %s timed out (%s)", ssid,
+               phase == LINK_PHASE_CONFIGURED
+                   ? "address assigned, but not connected to this network"
+                   : link_phase_name(phase));
+      break;
     }
 
-    nanosleep(&sleep_time, NULL);
+    // While configured, NetworkManager may lag the kernel or still be on
+    // the previous network; re-check periodically besides on events
+    int wait_ms = (int)remaining;
+    if (configured && wait_ms > CONNECT_RECHECK_MS) {
+      wait_ms = CONNECT_RECHECK_MS;
+    }
+
+    wterm_result_t wait_result =
+        link_watcher_wait(&watcher, wait_ms, cancel);
+    if (wait_result == WTERM_ERROR_CANCELLED) {
+      set_cancelled_result(&result);
+      break;
+    }
+    if (wait_result != WTERM_SUCCESS && wait_result != WTERM_ERROR_TIMEOUT) {
+      link_watcher_close(&watcher);
+      return poll_for_connection(ctx, ssid, deadline);
+    }
+  }
+
+  link_watcher_close(&watcher);
+  return result;
+}
+
+// Map a failed backend connect onto a connection error
+static connection_result_t connect_error(const backend_result_t *outcome,
+                                         const char *ssid) {
+  connection_result_t result = {0};
+  const char *message = outcome->error_message;
+
+  if (outcome->result == WTERM_ERROR_CANCELLED) {
+    set_cancelled_result(&result);
+    return result;
+  }
+  if (outcome->result == WTERM_ERROR_TIMEOUT) {
+    result.result = WTERM_ERROR_TIMEOUT;
+    result.error_type = CONN_ERROR_TIMEOUT;
+    snprintf(result.error_message, sizeof(result.error_message),
+             "Connection to %s timed out (NetworkManager did not respond)",
+             ssid);
+    return result;
   }
 
-  // Connection didn't establish in time
+  // Parse common error patterns; nmcli and D-Bus report the same messages
   result.result = WTERM_ERROR_NETWORK;
-  result.error_type = CONN_ERROR_TIMEOUT;
-  snprintf(result.error_message, sizeof(result.error_message),
-           "Connection to %s timed out", ssid);
-  result.connected = false;
+  if (strstr(message, "Failed to execute nmcli command") ||
+      strstr(message, "Cannot connect to NetworkManager")) {
+    result.error_type = CONN_ERROR_NETWORKMANAGER_NOT_RUNNING;
+    safe_string_copy(result.error_message, message,
+                     sizeof(result.error_message));
+  } else if (strstr(message, "No network with SSID") ||
+             strstr(message, "not found")) {
+    result.error_type = CONN_ERROR_NETWORK_UNAVAILABLE;
+    snprintf(result.error_message, sizeof(result.error_message),
+             "Network '%s' not found", ssid);
+  } else if (strstr(message, "Secrets were required") ||
+             strstr(message, "Authentication failed") ||
+             strstr(message, "password")) {
+    result.error_type = CONN_ERROR_AUTH_FAILED;
+    safe_string_copy(result.error_message,
+                     "Authentication failed - incorrect password",
+                     sizeof(result.error_message));
+  } else if (strstr(message, "Failed to activate connection")) {
+    result.error_type = CONN_ERROR_UNKNOWN;
+    snprintf(result.error_message, sizeof(result.error_message),
+             "Failed to activate connection to '%s'", ssid);
+  } else {
+    // Generic error with the backend's message
+    result.error_type = CONN_ERROR_UNKNOWN;
 
+    // Use %.*s to safely limit output length in format string
+    // "Connection failed: " is 20 chars, leave room for null terminator
+    const int max_output_len = (int)(sizeof(result.error_message) - 21);
+    snprintf(result.error_message, sizeof(result.error_message),
+             "Connection failed: %.*s", max_output_len,
+             message[0] ? message : "Unknown error");
+  }
   return result;
 }
 
+/**
+ * Connect through the network backend and confirm the connection.
+ *
+ * With @p profile set, that saved profile is activated; otherwise a new one
+ * is created for @p ssid, secured with @p password when given. ESC aborts
+ * the backend's activation through the context's cancel descriptor.
+ */
+static connection_result_t execute_backend_connect(
+    wterm_ctx_t *ctx, const char *ssid, const saved_profile_t *profile,
+    const char *password) {
+  const network_backend_t *backend = get_current_backend_ctx(ctx);
+  if (!backend) {
+    connection_result_t result = {0};
+    result.result = WTERM_ERROR_NETWORK;
+    result.error_type = CONN_ERROR_NETWORKMANAGER_NOT_RUNNING;
+    safe_string_copy(result.error_message, "No network backend available",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  // Subscribe before the backend starts, so no link or address event of
+  // this attempt is missed and none has to be re-read afterwards
+  link_watcher_t watcher;
+  bool watching = open_wifi_watcher(&watcher);
+
+  // Whatever the outcome, the cached status is about to be wrong
+  invalidate_connection_status();
+
+  int cancel = cancel_fd(ctx);
+  backend_result_t outcome;
+  if (profile) {
+    outcome = backend->connect_saved_network(profile->uuid, cancel);
+  } else if (password) {
+    outcome = backend->connect_secured_network(ssid, password, cancel);
+  } else {
+    outcome = backend->connect_open_network(ssid, cancel);
+  }
+  query_cache_invalidate();
+
+  if (outcome.result != WTERM_SUCCESS) {
+    if (watching) {
+      link_watcher_close(&watcher);
+    }
+    return connect_error(&outcome, ssid);
+  }
+
+  return wait_for_connection(ctx, ssid, CONNECT_CONFIRM_TIMEOUT_MS,
+                             watching ? &watcher : NULL);
+}
 
 connection_result_t connect_to_open_network(const char *ssid) {
+  return connect_to_open_network_ctx(wterm_ctx_default(), ssid);
+}
+
+connection_result_t connect_to_open_network_ctx(wterm_ctx_t *ctx,
+                                                const char *ssid) {
   connection_result_t result = {0};
 
-  if (!ssid || is_string_empty(ssid)) {
+  if (!ctx || !ssid || is_string_empty(ssid)) {
     result.result = WTERM_ERROR_INVALID_INPUT;
     safe_string_copy(result.error_message, "Invalid SSID provided",
                      sizeof(result.error_message));
@@ -201,38 +420,26 @@ connection_result_t connect_to_open_network(const char *ssid) {
   }
 
   // Initialize cancellation state for this connection attempt
-  init_connection_cancel();
+  init_connection_cancel_ctx(ctx);
 
-  // Escape SSID for shell safety
-  char escaped_ssid[256];
-  if (!shell_escape(ssid, escaped_ssid, sizeof(escaped_ssid))) {
-    result.result = WTERM_ERROR_INVALID_INPUT;
-    safe_string_copy(result.error_message, "SSID too long for shell escaping",
-                     sizeof(result.error_message));
-    return result;
-  }
-
-  char command[512];
-
-  // Check if a saved connection exists
-  if (connection_exists(ssid)) {
-    // Use 'nmcli connection up' for existing connections
-    snprintf(command, sizeof(command), "nmcli connection up %s 2>&1",
-             escaped_ssid);
-  } else {
-    // Use 'nmcli device wifi connect' for new connections
-    snprintf(command, sizeof(command), "nmcli device wifi connect %s 2>&1",
-             escaped_ssid);
-  }
-
-  return execute_nmcli_connect(command, ssid);
+  // Existing profiles are activated by UUID; the profile may be named
+  // differently from the SSID
+  saved_profile_t profile;
+  bool saved = find_saved_profile(ssid, &profile);
+  return execute_backend_connect(ctx, ssid, saved ? &profile : NULL, NULL);
 }
 
 connection_result_t connect_to_secured_network(const char *ssid,
                                                const char *password) {
+  return connect_to_secured_network_ctx(wterm_ctx_default(), ssid, password);
+}
+
+connection_result_t connect_to_secured_network_ctx(wterm_ctx_t *ctx,
+                                                   const char *ssid,
+                                                   const char *password) {
   connection_result_t result = {0};
 
-  if (!ssid || is_string_empty(ssid)) {
+  if (!ctx || !ssid || is_string_empty(ssid)) {
     result.result = WTERM_ERROR_INVALID_INPUT;
     safe_string_copy(result.error_message, "Invalid SSID provided",
                      sizeof(result.error_message));
@@ -249,26 +456,12 @@ connection_result_t connect_to_secured_network(const char *ssid,
   }
 
   // Initialize cancellation state for this connection attempt
-  init_connection_cancel();
-
-  // Escape SSID for shell safety
-  char escaped_ssid[256];
-  if (!shell_escape(ssid, escaped_ssid, sizeof(escaped_ssid))) {
-    result.result = WTERM_ERROR_INVALID_INPUT;
-    safe_string_copy(result.error_message, "SSID too long for shell escaping",
-                     sizeof(result.error_message));
-    return result;
-  }
-
-  char command[1024];
+  init_connection_cancel_ctx(ctx);
 
   // Check if a saved connection exists for this SSID
-  if (connection_exists(ssid)) {
-    // Use 'nmcli connection up' for existing connections
-    // Password is stored in the saved connection, so we don't need to pass it
-    snprintf(command, sizeof(command), "nmcli connection up %s 2>&1",
-             escaped_ssid);
-  } else {
+  saved_profile_t profile;
+  bool saved = find_saved_profile(ssid, &profile);
+  if (!saved) {
     // New connection - password is required
     if (!password || is_string_empty(password)) {
       result.result = WTERM_ERROR_INVALID_INPUT;
@@ -277,160 +470,82 @@ connection_result_t connect_to_secured_network(const char *ssid,
                        sizeof(result.error_message));
       return result;
     }
+  }
 
-    // Escape password for shell safety
-    char escaped_password[512];
-    if (!shell_escape(password, escaped_password, sizeof(escaped_password))) {
-      result.result = WTERM_ERROR_INVALID_INPUT;
-      safe_string_copy(result.error_message,
-                       "Password too long for shell escaping",
-                       sizeof(result.error_message));
-      return result;
-    }
+  // A new profile stores the password with NetworkManager; saved profiles
+  // already hold theirs
+  return execute_backend_connect(ctx, ssid, saved ? &profile : NULL,
+                                 saved ? NULL : password);
+}
 
-    // For new connections: Create connection profile first (stores password securely),
-    // then activate it. This avoids exposing password in process list.
-    // Step 1: Create connection profile
-    char *const add_args[] = {
-      "nmcli", "connection", "add",
-      "type", "wifi",
-      "con-name", escaped_ssid,
-      "ssid", escaped_ssid,
-      "wifi-sec.key-mgmt", "wpa-psk",
-      "wifi-sec.psk", escaped_password,
-      NULL
-    };
-
-    wterm_result_t add_result = safe_exec_check("nmcli", add_args);
-
-    // Clear password from memory immediately after use
-    explicit_bzero(escaped_password, sizeof(escaped_password));
-
-    if (add_result != WTERM_SUCCESS) {
-      result.result = WTERM_ERROR_NETWORK;
-      safe_string_copy(result.error_message,
-                       "Failed to create connection profile",
-                       sizeof(result.error_message));
-      return result;
-    }
+// Memoized snapshot shared by every caller within CONNECTION_STATUS_MEMO_MS
+static pthread_mutex_t status_memo_lock = PTHREAD_MUTEX_INITIALIZER;
+static connection_status_t status_memo;
+static long long status_memo_time_ms = -1;
 
-    // Step 2: Activate the connection (password now stored securely by NetworkManager)
-    snprintf(command, sizeof(command), "nmcli connection up %s 2>&1",
-             escaped_ssid);
+wterm_result_t get_connection_status_snapshot(connection_status_t *status,
+                                              int max_age_ms) {
+  if (!status) {
+    return WTERM_ERROR_INVALID_INPUT;
   }
 
-  return execute_nmcli_connect(command, ssid);
-}
+  pthread_mutex_lock(&status_memo_lock);
 
-connection_status_t get_connection_status(void) {
-  connection_status_t status = {0};
-
-  // Get active connection profile name for WiFi
-  FILE *fp =
-      popen("nmcli -t -f NAME,TYPE,DEVICE connection show --active", "r");
-  if (!fp) {
-    return status;
-  }
-
-  char buffer[256];
-  while (fgets(buffer, sizeof(buffer), fp)) {
-    buffer[strcspn(buffer, "\n")] = '\0';
-
-    // Parse line: NAME:TYPE:DEVICE
-    char *first_colon = strchr(buffer, ':');
-    if (!first_colon)
-      continue;
-
-    char *second_colon = strchr(first_colon + 1, ':');
-    if (!second_colon)
-      continue;
-
-    // Extract fields
-    *first_colon = '\0';
-    *second_colon = '\0';
-    const char *name = buffer;
-    const char *type = first_colon + 1;
-
-    // Check if this is a WiFi connection
-    if (strcmp(type, "802-11-wireless") == 0) {
-      safe_string_copy(status.connection_name, name,
-                       sizeof(status.connection_name));
-      status.is_connected = true;
-      break;
-    }
+  long long now = monotonic_ms();
+  if (status_memo_time_ms >= 0 && max_age_ms > 0 &&
+      now - status_memo_time_ms < max_age_ms) {
+    *status = status_memo;
+    pthread_mutex_unlock(&status_memo_lock);
+    return WTERM_SUCCESS;
   }
 
-  int exit_status = pclose(fp);
-  // If nmcli failed, return disconnected status
-  if (exit_status != 0) {
-    status.is_connected = false;
-    return status;
-  }
-
-  // Get SSID from device wifi list if connected
-  if (status.is_connected) {
-    fp = popen("nmcli -t -f ACTIVE,SSID device wifi list", "r");
-    if (fp) {
-      while (fgets(buffer, sizeof(buffer), fp)) {
-        buffer[strcspn(buffer, "\n")] = '\0';
-
-        // Parse line: ACTIVE:SSID
-        if (strncmp(buffer, "yes:", 4) == 0) {
-          const char *ssid_start = buffer + 4;
-          safe_string_copy(status.connected_ssid, ssid_start,
-                           sizeof(status.connected_ssid));
-          break;
-        }
-      }
-      exit_status = pclose(fp);
-      // If getting SSID failed, clear connection status
-      if (exit_status != 0) {
-        status.connected_ssid[0] = '\0';
-      }
-    }
+  // Queried under the lock so concurrent callers share one backend query
+  const network_backend_t *backend = get_current_backend();
+  wterm_result_t result = backend ? backend->get_connection_status(status)
+                                  : WTERM_ERROR_NETWORK;
+  if (result == WTERM_SUCCESS) {
+    status_memo = *status;
+    status_memo_time_ms = now;
+  } else {
+    status_memo_time_ms = -1;
   }
 
-  // Get IP address if connected
-  if (status.is_connected) {
-    fp = popen("nmcli -t -f IP4.ADDRESS connection show --active 2>/dev/null | "
-               "head -1",
-               "r");
-    if (fp) {
-      if (fgets(buffer, sizeof(buffer), fp)) {
-        buffer[strcspn(buffer, "\n")] = '\0';
-        // Extract IP address (remove prefix like "IP4.ADDRESS[1]:")
-        const char *ip_start = strrchr(buffer, ':');
-        if (ip_start && ip_start[1] != '\0') {
-          safe_string_copy(status.ip_address, ip_start + 1,
-                           sizeof(status.ip_address));
-        } else if (strlen(buffer) > 0) {
-          safe_string_copy(status.ip_address, buffer,
-                           sizeof(status.ip_address));
-        }
-      }
-      exit_status = pclose(fp);
-      // If getting IP failed, clear IP address
-      if (exit_status != 0) {
-        status.ip_address[0] = '\0';
-      }
-    }
-  }
+  pthread_mutex_unlock(&status_memo_lock);
+  return result;
+}
+
+void invalidate_connection_status(void) {
+  pthread_mutex_lock(&status_memo_lock);
+  status_memo_time_ms = -1;
+  pthread_mutex_unlock(&status_memo_lock);
+}
 
+connection_status_t get_connection_status(void) {
+  connection_status_t status;
+  if (get_connection_status_snapshot(&status, CONNECTION_STATUS_MEMO_MS) !=
+      WTERM_SUCCESS) {
+    memset(&status, 0, sizeof(status));
+  }
   return status;
 }
 
 wterm_result_t disconnect_current_network(void) {
   connection_status_t status = get_connection_status();
 
-  // Disconnect active NetworkManager connection if one exists
-  if (status.is_connected && status.connection_name[0] != '\0') {
-    char *const args[] = {"nmcli", "connection", "down", status.connection_name,
-                          NULL};
-    return safe_exec_check_silent("nmcli", args);
+  // No active connection to disconnect
+  if (!status.is_connected) {
+    return WTERM_SUCCESS;
   }
 
-  // No active connection to disconnect
-  return WTERM_SUCCESS;
+  const network_backend_t *backend = get_current_backend();
+  if (!backend) {
+    return WTERM_ERROR_NETWORK;
+  }
+
+  invalidate_connection_status();
+  backend_result_t result = backend->disconnect_network();
+  query_cache_invalidate();
+  return result.result;
 }
 
 bool network_requires_password(const char *security) {
@@ -517,25 +632,8 @@ connection_result_t monitor_connection_progress(const char *ssid,
     return result;
   }
 
-  // Monitor connection for specified timeout
-  for (int i = 0; i < timeout_seconds; i++) {
-    if (is_connected_to_network(ssid)) {
-      result.result = WTERM_SUCCESS;
-      result.connected = true;
-      snprintf(result.error_message, sizeof(result.error_message),
-               "Successfully connected to %s", ssid);
-      return result;
-    }
-
-    sleep(1);
-  }
-
-  // Timeout reached
-  result.result = WTERM_ERROR_NETWORK;
-  result.error_type = CONN_ERROR_TIMEOUT;
-  result.connected = false;
-  snprintf(result.error_message, sizeof(result.error_message),
-           "Connection to %s timed out", ssid);
-
-  return result;
+  link_watcher_t watcher;
+  bool watching = open_wifi_watcher(&watcher);
+  return wait_for_connection(wterm_ctx_default(), ssid, timeout_seconds * 1000,
+                             watching ? &watcher : NULL);
 }
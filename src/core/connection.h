@@ -6,6 +6,7 @@
  */
 
 #include "../../include/wterm/common.h"
+#include "context.h"
 #include "error_handler.h"
 #include <stdbool.h>
 
@@ -30,23 +31,23 @@ typedef struct {
     bool is_open_network;
 } connection_attempt_t;
 
-/**
- * @brief Current connection status
- */
-typedef struct {
-    bool is_connected;
-    char connected_ssid[MAX_STR_SSID];
-    char connection_name[MAX_STR_SSID];  // Connection profile name (may differ from SSID)
-    char connection_uuid[64];
-    char ip_address[16];
-} connection_status_t;
+// Lifetime of the memoized status shared by get_connection_status() callers
+#define CONNECTION_STATUS_MEMO_MS 100
+
+// Saved profiles changed outside wterm are picked up after this long
+#define SAVED_PROFILES_MAX_AGE_MS 30000
 
 /**
  * @brief Connect to an open WiFi network
+ *
+ * The attempt can be cancelled through the context it runs on (the
+ * default context for the plain variant).
+ *
  * @param ssid Network SSID to connect to
  * @return connection_result_t Connection result and error info
  */
 connection_result_t connect_to_open_network(const char* ssid);
+connection_result_t connect_to_open_network_ctx(wterm_ctx_t* ctx, const char* ssid);
 
 /**
  * @brief Connect to a secured WiFi network with password
@@ -55,13 +56,41 @@ connection_result_t connect_to_open_network(const char* ssid);
  * @return connection_result_t Connection result and error info
  */
 connection_result_t connect_to_secured_network(const char* ssid, const char* password);
+connection_result_t connect_to_secured_network_ctx(wterm_ctx_t* ctx, const char* ssid,
+                                                   const char* password);
 
 /**
  * @brief Get current WiFi connection status
+ *
+ * Served from the status snapshot; callers within CONNECTION_STATUS_MEMO_MS
+ * of each other share one query.
+ *
  * @return connection_status_t Current connection information
  */
 connection_status_t get_connection_status(void);
 
+/**
+ * @brief Get a snapshot of the active WiFi connection
+ *
+ * Connection name, UUID, device, SSID and IPv4 address come from the
+ * network backend: NetworkManager's D-Bus API when available, otherwise a
+ * single `nmcli device show` query.
+ *
+ * @param status Output snapshot
+ * @param max_age_ms Reuse a memoized snapshot younger than this; 0 forces
+ *                   a fresh query
+ * @return WTERM_SUCCESS on success, WTERM_ERROR_NETWORK if the query failed
+ */
+wterm_result_t get_connection_status_snapshot(connection_status_t* status, int max_age_ms);
+
+/**
+ * @brief Drop the memoized connection status
+ *
+ * Called when a connect or disconnect changes what the next snapshot
+ * should report.
+ */
+void invalidate_connection_status(void);
+
 /**
  * @brief Disconnect from current WiFi network
  * @return wterm_result_t Result of disconnect operation
@@ -106,6 +135,11 @@ bool is_connected_to_network(const char* ssid);
 
 /**
  * @brief Monitor connection progress with timeout
+ *
+ * Driven by rtnetlink link and address events on the WiFi interface, so
+ * success is reported as soon as the link is configured. On timeout the
+ * error message names the phase that was reached.
+ *
  * @param ssid Network being connected to
  * @param timeout_seconds Maximum time to wait
  * @return connection_result_t Final connection result
@@ -114,6 +148,10 @@ connection_result_t monitor_connection_progress(const char* ssid, int timeout_se
 
 /**
  * @brief Check if a saved connection exists for the given SSID
+ *
+ * Answered from an index of saved profiles that is rebuilt only when
+ * NetworkManager state changes, so it is cheap enough to call per row.
+ *
  * @param ssid Network SSID to check
  * @return bool true if a saved connection exists, false otherwise
  */
@@ -124,15 +162,19 @@ bool is_saved_connection(const char* ssid);
  * Resets the cancellation flag to allow new connections
  */
 void init_connection_cancel(void);
+void init_connection_cancel_ctx(wterm_ctx_t* ctx);
 
 /**
  * @brief Request cancellation of ongoing connection attempt
- * Sets a flag that will be checked during connection polling
+ * Sets a flag that will be checked during connection polling and aborts
+ * the activation the attempt is currently waiting on
  */
 void request_connection_cancel(void);
+void request_connection_cancel_ctx(wterm_ctx_t* ctx);
 
 /**
  * @brief Check if connection cancellation was requested
  * @return bool true if cancellation was requested, false otherwise
  */
-bool is_connection_cancelled(void);
\ No newline at end of file
+bool is_connection_cancelled(void);
+bool is_connection_cancelled_ctx(wterm_ctx_t* ctx);
\ No newline at end of file
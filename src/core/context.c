@@ -0,0 +1,48 @@
+/**
+ * @file context.c
+ * @brief Explicit state for the wterm core
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "context.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static wterm_ctx_t default_ctx;
+static pthread_once_t default_ctx_once = PTHREAD_ONCE_INIT;
+
+static void ctx_init(wterm_ctx_t *ctx) {
+  memset(ctx, 0, sizeof(*ctx));
+  pthread_mutex_init(&ctx->lock, NULL);
+  nm_keyfile_store_init(&ctx->keyfiles, NULL);
+  ctx->connection_cancel_fd = -1;
+}
+
+static void default_ctx_init(void) { ctx_init(&default_ctx); }
+
+wterm_ctx_t *wterm_ctx_create(void) {
+  wterm_ctx_t *ctx = malloc(sizeof(*ctx));
+  if (ctx) {
+    ctx_init(ctx);
+  }
+  return ctx;
+}
+
+void wterm_ctx_destroy(wterm_ctx_t *ctx) {
+  if (!ctx || ctx == &default_ctx) {
+    return;
+  }
+
+  nm_keyfile_store_free(&ctx->keyfiles);
+  if (ctx->connection_cancel_fd >= 0) {
+    close(ctx->connection_cancel_fd);
+  }
+  pthread_mutex_destroy(&ctx->lock);
+  free(ctx);
+}
+
+wterm_ctx_t *wterm_ctx_default(void) {
+  pthread_once(&default_ctx_once, default_ctx_init);
+  return &default_ctx;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+/**
+ * @file context.h
+ * @brief Explicit state for the wterm core
+ *
+ * A context owns the state that the hotspot manager, backend selection and
+ * connection cancellation keep between calls. Operations on different
+ * contexts share nothing but the process-wide caches of system state
+ * (query cache, saved profile index, connection status memo), which lock
+ * internally, so independent operations can run on separate threads with
+ * a context each.
+ *
+ * The *_ctx functions take a context; the plain functions (e.g.
+ * hotspot_list_configs(), connect_to_open_network()) use the process
+ * default context from wterm_ctx_default().
+ */
+
+#include "../../include/wterm/common.h"
+#include "../utils/nm_keyfile.h"
+#include <pthread.h>
+#include <signal.h>
+
+struct network_backend;
+
+#define WTERM_CTX_DIR_MAX 256
+
+/**
+ * @brief Core state; fields belong to the module named in the comment
+ *
+ * Create with wterm_ctx_create(). Set hotspot_config_dir before
+ * hotspot_manager_init_ctx() to keep saved hotspots somewhere other than
+ * HOTSPOT_CONFIG_DIR (e.g. in tests).
+ */
+typedef struct wterm_ctx {
+  pthread_mutex_t lock; // Guards the hotspot manager state
+
+  // Hotspot manager (hotspot_manager.c)
+  bool hotspots_initialized;
+  hotspot_list_t saved_hotspots;
+  nm_keyfile_store_t keyfiles;
+  char hotspot_config_dir[WTERM_CTX_DIR_MAX]; // Empty for the default
+
+  // Backend selection (backend_manager.c)
+  const struct network_backend *backend;
+
+  // Connection cancellation (connection.c)
+  volatile sig_atomic_t connection_cancelled;
+  int connection_cancel_fd; // Readable while a cancellation is pending
+} wterm_ctx_t;
+
+/**
+ * @brief Allocate an empty context
+ * @return New context, or NULL if out of memory
+ */
+wterm_ctx_t *wterm_ctx_create(void);
+
+/**
+ * @brief Release a context created with wterm_ctx_create()
+ *
+ * Frees its memory and descriptors only; call hotspot_manager_cleanup_ctx()
+ * first to also stop running hotspots.
+ */
+void wterm_ctx_destroy(wterm_ctx_t *ctx);
+
+/**
+ * @brief Process default context used by the functions without a context
+ */
+wterm_ctx_t *wterm_ctx_default(void);
@@ -149,20 +149,17 @@ error_info_t get_error_info(connection_error_t error, const char* network_name)
 }
 
 bool is_wifi_enabled(void) {
-    FILE *fp = popen("nmcli radio wifi", "r");
-    if (!fp) {
+    char* const args[] = {"nmcli", "radio", "wifi", NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("nmcli", args, &output)) {
         return false;
     }
 
-    char buffer[32];
-    bool enabled = false;
-    if (fgets(buffer, sizeof(buffer), fp)) {
-        // Remove newline
-        buffer[strcspn(buffer, "\n")] = '\0';
-        enabled = (strcmp(buffer, "enabled") == 0);
-    }
+    char *cursor = output.out;
+    const char *line = safe_exec_next_line(&cursor);
+    bool enabled = line && strcmp(line, "enabled") == 0;
 
-    pclose(fp);
+    safe_exec_output_free(&output);
     return enabled;
 }
 
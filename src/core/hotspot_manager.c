@@ -7,76 +7,122 @@
 #include "hotspot_manager.h"
 #include "error_handler.h"
 #include "error_queue.h"
+#include "nat_engine.h"
+#include "bridge_engine.h"
+#include "traffic_shaper.h"
+#include "network_backends/backend_interface.h"
 #include "../utils/string_utils.h"
 #include "../utils/safe_exec.h"
+#include "../utils/query_cache.h"
 #include "../utils/input_sanitizer.h"
 #include "../utils/iw_helper.h"
+#include "../utils/nm_keyfile.h"
+#include "../utils/link_watcher.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <dirent.h>
 #include <errno.h>
+#include <time.h>
 
 // Configuration file path
-#define HOTSPOT_CONFIG_DIR "/tmp/wterm_hotspots"
 #define HOTSPOT_CONFIG_EXT ".conf"
 #define HOTSPOT_RUNTIME_DIR "/tmp/wterm_hotspot_runtime"
 
-// Global state
-static bool manager_initialized = false;
-static hotspot_list_t saved_configs = {0};
+// Station sync: neighbour events trigger it, the interval catches stations
+// that leave without one, and a burst of events is settled first (for at
+// most HOTSPOT_CLIENT_SETTLE_MAX_MS, so a steady stream cannot delay it)
+#define HOTSPOT_CLIENT_SYNC_INTERVAL_MS 30000
+#define HOTSPOT_CLIENT_SETTLE_MS 500
+#define HOTSPOT_CLIENT_SETTLE_MAX_MS 2000
 
 // Helper function declarations
-static wterm_result_t ensure_directories_exist(void);
-static wterm_result_t load_all_configs(void);
-static char *get_config_file_path(const char *name);
+static const char *config_dir(const wterm_ctx_t *ctx);
+static wterm_result_t ensure_directories_exist(const wterm_ctx_t *ctx);
+static wterm_result_t load_all_configs(wterm_ctx_t *ctx);
+static char *get_config_file_path(const wterm_ctx_t *ctx, const char *name);
+static wterm_result_t save_config_to_file(const wterm_ctx_t *ctx,
+                                          const hotspot_config_t *config);
+static bool find_saved_config(wterm_ctx_t *ctx, const char *name,
+                              hotspot_config_t *config);
 static wterm_result_t write_config_file(const char *file_path, const hotspot_config_t *config);
-static wterm_result_t execute_nmcli_command(const char *command, char *output, size_t output_size);
-static wterm_result_t execute_nmcli_command_silent(const char *command, char *output, size_t output_size);
+static wterm_result_t execute_nmcli_command(char *const args[], char *output, size_t output_size);
+static wterm_result_t execute_nmcli_command_silent(char *const args[], char *output, size_t output_size);
+static bool nmcli_connection_listed(const char *name, bool active_only);
+static wterm_result_t backend_start_hotspot(wterm_ctx_t *ctx, const char *name);
+static wterm_result_t backend_stop_hotspot(wterm_ctx_t *ctx, const char *name);
+static bool backend_hotspot_active(wterm_ctx_t *ctx, const char *name);
+static bool nmcli_hotspot_state(const char *name, char *ssid, size_t ssid_size,
+                                bool *is_active);
+static void nmcli_add_hotspots(hotspot_list_t *list,
+                               const char (*known_uuids)[NM_KEYFILE_UUID_MAX],
+                               int known_count);
 static void detect_gateway_ip(char *gateway_ip, size_t size);
 
 // NAT management function declarations
 static wterm_result_t get_default_route_interface(char *interface, size_t size);
-static bool check_iptables_rule_exists(char **args);
-static wterm_result_t setup_nat_rules(const char *hotspot_iface, const char *inet_iface, const char *hotspot_subnet);
-static wterm_result_t cleanup_nat_rules(const char *hotspot_iface, const char *hotspot_subnet);
+static wterm_result_t setup_nat_rules(const char *hotspot_iface, const char *inet_iface,
+                                      const char *gateway_ip, bool fast_path);
+static wterm_result_t cleanup_nat_rules(const char *hotspot_iface);
+static void setup_traffic_shaping(const hotspot_config_t *config,
+                                  const hotspot_client_t *stations, int count, bool sync);
+static void cleanup_traffic_shaping(const hotspot_config_t *config);
+static void teardown_sharing(wterm_ctx_t *ctx, const char *name);
 
 wterm_result_t hotspot_manager_init(void) {
-    if (manager_initialized) {
-        return WTERM_SUCCESS;
-    }
+    return hotspot_manager_init_ctx(wterm_ctx_default());
+}
 
-    wterm_result_t result = ensure_directories_exist();
-    if (result != WTERM_SUCCESS) {
-        return result;
+wterm_result_t hotspot_manager_init_ctx(wterm_ctx_t *ctx) {
+    if (!ctx) {
+        return WTERM_ERROR_INVALID_INPUT;
     }
 
-    result = load_all_configs();
-    if (result != WTERM_SUCCESS) {
-        return result;
+    pthread_mutex_lock(&ctx->lock);
+    wterm_result_t result = WTERM_SUCCESS;
+    if (!ctx->hotspots_initialized) {
+        result = ensure_directories_exist(ctx);
+        if (result == WTERM_SUCCESS) {
+            result = load_all_configs(ctx);
+        }
+        if (result == WTERM_SUCCESS) {
+            nm_keyfile_store_init(&ctx->keyfiles, NULL);
+            ctx->hotspots_initialized = true;
+        }
     }
-
-    manager_initialized = true;
-    return WTERM_SUCCESS;
+    pthread_mutex_unlock(&ctx->lock);
+    return result;
 }
 
 void hotspot_manager_cleanup(void) {
-    if (!manager_initialized) {
+    hotspot_manager_cleanup_ctx(wterm_ctx_default());
+}
+
+void hotspot_manager_cleanup_ctx(wterm_ctx_t *ctx) {
+    if (!ctx || !ctx->hotspots_initialized) {
         return;
     }
 
     // Stop all running hotspots
-    hotspot_stop(NULL);
+    hotspot_stop_ctx(ctx, NULL);
 
     // Clear saved configurations
-    memset(&saved_configs, 0, sizeof(saved_configs));
-
-    manager_initialized = false;
+    pthread_mutex_lock(&ctx->lock);
+    memset(&ctx->saved_hotspots, 0, sizeof(ctx->saved_hotspots));
+    nm_keyfile_store_free(&ctx->keyfiles);
+    ctx->hotspots_initialized = false;
+    pthread_mutex_unlock(&ctx->lock);
 }
 
 wterm_result_t hotspot_create_config(const hotspot_config_t *config) {
-    if (!manager_initialized) {
+    return hotspot_create_config_ctx(wterm_ctx_default(), config);
+}
+
+wterm_result_t hotspot_create_config_ctx(wterm_ctx_t *ctx, const hotspot_config_t *config) {
+    if (!ctx || !ctx->hotspots_initialized) {
         return WTERM_ERROR_GENERAL;
     }
 
@@ -105,51 +151,70 @@ wterm_result_t hotspot_create_config(const hotspot_config_t *config) {
         }
     }
 
+    pthread_mutex_lock(&ctx->lock);
+    hotspot_list_t *saved = &ctx->saved_hotspots;
+    wterm_result_t result = WTERM_SUCCESS;
+
     // Check if configuration already exists
-    for (int i = 0; i < saved_configs.count; i++) {
-        if (strcmp(saved_configs.hotspots[i].name, config->name) == 0) {
-            return WTERM_ERROR_GENERAL; // Configuration already exists
+    for (int i = 0; i < saved->count; i++) {
+        if (strcmp(saved->hotspots[i].name, config->name) == 0) {
+            result = WTERM_ERROR_GENERAL; // Configuration already exists
+            break;
         }
     }
 
     // Add to saved configurations
-    if (saved_configs.count >= MAX_HOTSPOTS) {
-        return WTERM_ERROR_MEMORY;
+    if (result == WTERM_SUCCESS && saved->count >= MAX_HOTSPOTS) {
+        result = WTERM_ERROR_MEMORY;
     }
 
-    memcpy(&saved_configs.hotspots[saved_configs.count], config, sizeof(hotspot_config_t));
-    saved_configs.count++;
+    if (result == WTERM_SUCCESS) {
+        memcpy(&saved->hotspots[saved->count], config, sizeof(hotspot_config_t));
+        saved->count++;
 
-    // Save to file
-    return hotspot_save_config_to_file(config);
+        // Save to file
+        result = save_config_to_file(ctx, config);
+    }
+
+    pthread_mutex_unlock(&ctx->lock);
+    return result;
 }
 
 wterm_result_t hotspot_start(const char *name, hotspot_status_t *status) {
-    if (!manager_initialized || !name) {
+    return hotspot_start_ctx(wterm_ctx_default(), name, status);
+}
+
+wterm_result_t hotspot_start_ctx(wterm_ctx_t *ctx, const char *name,
+                                 hotspot_status_t *status) {
+    if (!ctx || !ctx->hotspots_initialized || !name) {
         return WTERM_ERROR_INVALID_INPUT;
     }
 
     char output[512];
 
-    // Find configuration
-    hotspot_config_t *config = NULL;
-    for (int i = 0; i < saved_configs.count; i++) {
-        if (strcmp(saved_configs.hotspots[i].name, name) == 0) {
-            config = &saved_configs.hotspots[i];
-            break;
-        }
-    }
-
-    if (!config) {
+    // Find configuration; work on a copy so the context is not held
+    // locked while nmcli runs
+    hotspot_config_t saved_config;
+    if (!find_saved_config(ctx, name, &saved_config)) {
         return WTERM_ERROR_GENERAL; // Configuration not found
     }
+    hotspot_config_t *config = &saved_config;
 
     // Auto-detect gateway IP if not set (for old configs without gateway_ip)
     if (!config->gateway_ip[0]) {
         detect_gateway_ip(config->gateway_ip, sizeof(config->gateway_ip));
 
-        // Save the updated config back to disk
-        hotspot_save_config_to_file(config);
+        // Save the updated config back, in memory and on disk
+        pthread_mutex_lock(&ctx->lock);
+        for (int i = 0; i < ctx->saved_hotspots.count; i++) {
+            if (strcmp(ctx->saved_hotspots.hotspots[i].name, name) == 0) {
+                safe_string_copy(ctx->saved_hotspots.hotspots[i].gateway_ip,
+                                 config->gateway_ip,
+                                 sizeof(ctx->saved_hotspots.hotspots[i].gateway_ip));
+            }
+        }
+        save_config_to_file(ctx, config);
+        pthread_mutex_unlock(&ctx->lock);
     }
 
     // Validate gateway IP is set (should always pass after auto-detection)
@@ -160,98 +225,128 @@ wterm_result_t hotspot_start(const char *name, hotspot_status_t *status) {
 
     // Disconnect the WiFi interface if it's currently connected
     // (A WiFi interface can't be a client and AP at the same time - single radio limitation)
-    char disconnect_cmd[512];
-    snprintf(disconnect_cmd, sizeof(disconnect_cmd),
-             "nmcli device disconnect %s 2>/dev/null", config->wifi_interface);
-    execute_nmcli_command_silent(disconnect_cmd, output, sizeof(output));
+    char *const disconnect_args[] = {"nmcli", "device", "disconnect",
+                                     config->wifi_interface, NULL};
+    execute_nmcli_command_silent(disconnect_args, output, sizeof(output));
     // Ignore errors - interface might not be connected
 
     // Check if NetworkManager connection already exists
-    char check_command[256];
-    snprintf(check_command, sizeof(check_command),
-             "nmcli -t -f NAME connection show | grep -q '^%s$'", config->name);
+    bool connection_exists = nmcli_connection_listed(config->name, false);
 
-    wterm_result_t check_result = execute_nmcli_command(check_command, output, sizeof(output));
-    bool connection_exists = (check_result == WTERM_SUCCESS);
+    char ipv4_address[MAX_STR_IP_ADDR + 4];
+    snprintf(ipv4_address, sizeof(ipv4_address), "%.*s/24", MAX_STR_IP_ADDR - 1,
+             config->gateway_ip);
+    bool bridged = config->share_method == HOTSPOT_SHARE_BRIDGE;
 
     if (connection_exists) {
         // Connection exists - update its settings to ensure correct configuration
-        char modify_cmd[512];
-
-        // Fix IPv4 method to "shared" using configured gateway IP
-        snprintf(modify_cmd, sizeof(modify_cmd),
-                 "nmcli connection modify %s ipv4.method shared ipv4.addresses %s/24 2>/dev/null",
-                 config->name, config->gateway_ip);
-        execute_nmcli_command(modify_cmd, output, sizeof(output)); // Ignore errors
+        // Fix IPv4 method to "shared" using configured gateway IP, or drop
+        // local addressing when bridged clients use the upstream network.
+        // IPv6 goes back to NetworkManager's default, as for a new profile,
+        // in case the profile was bridged before.
+        char *const ipv4_args[] = {"nmcli", "connection", "modify", config->name,
+                                   "ipv4.method", "shared",
+                                   "ipv4.addresses", ipv4_address,
+                                   "ipv6.method", "auto", NULL};
+        char *const bridged_args[] = {"nmcli", "connection", "modify", config->name,
+                                      "ipv4.method", "disabled", "ipv4.addresses", "",
+                                      "ipv6.method", "ignore", NULL};
+        execute_nmcli_command_silent(bridged ? bridged_args : ipv4_args, output,
+                                     sizeof(output)); // Ignore errors
 
         // Ensure band is configured (default to 2.4GHz if not set)
-        snprintf(modify_cmd, sizeof(modify_cmd),
-                 "nmcli connection modify %s 802-11-wireless.band bg 2>/dev/null",
-                 config->name);
-        execute_nmcli_command(modify_cmd, output, sizeof(output)); // Ignore errors
+        char *const band_args[] = {"nmcli", "connection", "modify", config->name,
+                                   "802-11-wireless.band", "bg", NULL};
+        execute_nmcli_command_silent(band_args, output, sizeof(output)); // Ignore errors
     } else {
-        // Connection doesn't exist - create it
-        char command[2048];
-        int written;
-
-        // Build IPv4 configuration string with configured gateway IP
-        char ipv4_config[128];
-        snprintf(ipv4_config, sizeof(ipv4_config),
-                 "ipv4.method shared ipv4.addresses %s/24", config->gateway_ip);
+        // Connection doesn't exist - create it. Every value is passed as its
+        // own argv entry, so SSIDs and passwords need no quoting.
+        char *args[32];
+        int argc = 0;
+        args[argc++] = "nmcli";
+        args[argc++] = "connection";
+        args[argc++] = "add";
+        args[argc++] = "type";
+        args[argc++] = "wifi";
+        args[argc++] = "ifname";
+        args[argc++] = config->wifi_interface;
+        args[argc++] = "con-name";
+        args[argc++] = config->name;
+        args[argc++] = "ssid";
+        args[argc++] = config->ssid;
+        args[argc++] = "802-11-wireless.mode";
+        args[argc++] = "ap";
 
         if (config->password[0] != '\0') {
             // Secured hotspot with password
-            written = snprintf(command, sizeof(command),
-                "nmcli connection add type wifi ifname %s con-name %s ssid %s "
-                "802-11-wireless.mode ap "
-                "802-11-wireless-security.key-mgmt wpa-psk "
-                "802-11-wireless-security.psk \"%s\" "
-                "connection.autoconnect no "
-                "%s",
-                config->wifi_interface, config->name, config->ssid, config->password, ipv4_config);
-        } else {
-            // Open hotspot without password
-            written = snprintf(command, sizeof(command),
-                "nmcli connection add type wifi ifname %s con-name %s ssid %s "
-                "802-11-wireless.mode ap "
-                "connection.autoconnect no "
-                "%s",
-                config->wifi_interface, config->name, config->ssid, ipv4_config);
+            args[argc++] = "802-11-wireless-security.key-mgmt";
+            args[argc++] = "wpa-psk";
+            args[argc++] = "802-11-wireless-security.psk";
+            args[argc++] = config->password;
         }
 
-        if (written >= (int)sizeof(command)) {
-            return WTERM_ERROR_GENERAL;
+        args[argc++] = "connection.autoconnect";
+        args[argc++] = "no";
+        args[argc++] = "ipv4.method";
+        if (bridged) {
+            args[argc++] = "disabled";
+            args[argc++] = "ipv6.method";
+            args[argc++] = "ignore";
+        } else {
+            args[argc++] = "shared";
+            args[argc++] = "ipv4.addresses";
+            args[argc++] = ipv4_address;
         }
+        args[argc] = NULL;
 
         // Execute command to create connection
-        wterm_result_t result = execute_nmcli_command(command, output, sizeof(output));
+        wterm_result_t result = execute_nmcli_command(args, output, sizeof(output));
         if (result != WTERM_SUCCESS) {
             return result;
         }
     }
 
     // Start/activate the connection
-    char command[256];
-    snprintf(command, sizeof(command), "nmcli connection up %s", config->name);
-    wterm_result_t result = execute_nmcli_command(command, output, sizeof(output));
+    wterm_result_t result = backend_start_hotspot(ctx, config->name);
     if (result != WTERM_SUCCESS) {
         return result;
     }
 
+    if (bridged && geteuid() != 0) {
+        REPORT_ERROR(false, "Warning: Bridged sharing needs root; clients of %s get no address",
+                     config->wifi_interface);
+    } else if (bridged) {
+        // Clients join the uplink's network through a bridge; no NAT at all
+        char inet_iface[MAX_STR_INTERFACE] = {0};
+        if (config->internet_interface[0]) {
+            safe_string_copy(inet_iface, config->internet_interface, sizeof(inet_iface));
+        } else {
+            get_default_route_interface(inet_iface, sizeof(inet_iface));
+        }
+        if (!inet_iface[0] ||
+            bridge_engine_attach(config->wifi_interface, inet_iface, NULL, 0) != WTERM_SUCCESS) {
+            REPORT_ERROR(false, "Warning: Could not bridge %s to the uplink; clients get no address",
+                         config->wifi_interface);
+        }
+    }
+
     // Configure NAT for internet sharing if sharing is enabled
-    if (config->share_method == HOTSPOT_SHARE_NAT || config->share_method == HOTSPOT_SHARE_NONE) {
+    if (config->share_method == HOTSPOT_SHARE_NAT ||
+        config->share_method == HOTSPOT_SHARE_NAT_FASTPATH ||
+        config->share_method == HOTSPOT_SHARE_NONE) {
         // Try to detect internet interface
         char inet_iface[MAX_STR_INTERFACE] = {0};
         if (get_default_route_interface(inet_iface, sizeof(inet_iface)) == WTERM_SUCCESS) {
-            // Get hotspot subnet (use gateway_ip from config)
-            char subnet[64];
-            snprintf(subnet, sizeof(subnet), "%s", config->gateway_ip);
-
-            // Set up NAT rules (silently)
-            setup_nat_rules(config->wifi_interface, inet_iface, subnet);
+            // Set up NAT rules for the hotspot's /24 (silently)
+            setup_nat_rules(config->wifi_interface, inet_iface, config->gateway_ip,
+                            config->share_method == HOTSPOT_SHARE_NAT_FASTPATH);
         }
     }
 
+    // Rate limits on the AP; stations that join later get their own class
+    // whenever the client list is read (see hotspot_get_clients)
+    setup_traffic_shaping(config, NULL, 0, false);
+
     // Update status if requested
     if (status) {
         memcpy(&status->config, config, sizeof(hotspot_config_t));
@@ -268,82 +363,83 @@ wterm_result_t hotspot_start(const char *name, hotspot_status_t *status) {
 }
 
 wterm_result_t hotspot_stop(const char *name) {
-    if (!manager_initialized) {
+    return hotspot_stop_ctx(wterm_ctx_default(), name);
+}
+
+wterm_result_t hotspot_stop_ctx(wterm_ctx_t *ctx, const char *name) {
+    if (!ctx || !ctx->hotspots_initialized) {
         return WTERM_ERROR_GENERAL;
     }
 
-    // If stopping a specific hotspot, clean up NAT rules first
     if (name) {
-        // Find configuration to get interface and subnet info
-        hotspot_config_t *config = NULL;
-        for (int i = 0; i < saved_configs.count; i++) {
-            if (strcmp(saved_configs.hotspots[i].name, name) == 0) {
-                config = &saved_configs.hotspots[i];
-                break;
-            }
-        }
-
-        // Clean up NAT rules before stopping hotspot (silently)
-        if (config) {
-            cleanup_nat_rules(config->wifi_interface, config->gateway_ip);
-        }
+        teardown_sharing(ctx, name);
+        // Stop specific hotspot (silently - ignore errors if already stopped)
+        return backend_stop_hotspot(ctx, name);
     }
 
-    char command[256];
-    if (name) {
-        // Stop specific hotspot (silently - ignore errors if already stopped)
-        snprintf(command, sizeof(command), "nmcli connection down %s 2>/dev/null", name);
-    } else {
-        // Stop all active wifi connections in AP mode
-        snprintf(command, sizeof(command),
-                "nmcli -t -f NAME,TYPE connection show --active | grep wifi | cut -d: -f1 | xargs -I {} nmcli connection down {} 2>/dev/null");
+    // Stop all active wifi connections in AP mode
+    const network_backend_t *backend = get_current_backend_ctx(ctx);
+    char active[MAX_HOTSPOTS][MAX_STR_SSID];
+    int count = 0;
+    if (!backend ||
+        backend->list_active_hotspots(active, MAX_HOTSPOTS, &count) != WTERM_SUCCESS) {
+        return WTERM_ERROR_NETWORK;
     }
 
-    char output[512];
-    return execute_nmcli_command_silent(command, output, sizeof(output));
+    wterm_result_t result = WTERM_SUCCESS;
+    for (int i = 0; i < count; i++) {
+        teardown_sharing(ctx, active[i]);
+        if (backend_stop_hotspot(ctx, active[i]) != WTERM_SUCCESS) {
+            result = WTERM_ERROR_NETWORK;
+        }
+    }
+    return result;
 }
 
 wterm_result_t hotspot_get_status(const char *name, hotspot_status_t *status) {
-    if (!manager_initialized || !name || !status) {
+    return hotspot_get_status_ctx(wterm_ctx_default(), name, status);
+}
+
+wterm_result_t hotspot_get_status_ctx(wterm_ctx_t *ctx, const char *name,
+                                      hotspot_status_t *status) {
+    if (!ctx || !ctx->hotspots_initialized || !name || !status) {
         return WTERM_ERROR_INVALID_INPUT;
     }
 
     // Find configuration in saved configs (wterm-created)
+    hotspot_config_t saved_config;
     hotspot_config_t *config = NULL;
-    for (int i = 0; i < saved_configs.count; i++) {
-        if (strcmp(saved_configs.hotspots[i].name, name) == 0) {
-            config = &saved_configs.hotspots[i];
-            break;
-        }
+    if (find_saved_config(ctx, name, &saved_config)) {
+        config = &saved_config;
     }
 
     // If not found in saved configs, check if it's an external hotspot
     hotspot_config_t external_config;
+    bool state_known = false;
+    bool is_active = false;
     if (!config) {
-        // Verify this is actually a hotspot in NetworkManager
-        char check_cmd[512];
-        snprintf(check_cmd, sizeof(check_cmd),
-                 "nmcli -t -f 802-11-wireless.mode connection show '%s' 2>/dev/null",
-                 name);
-
-        FILE *mode_fp = popen(check_cmd, "r");
-        if (!mode_fp) {
-            return WTERM_ERROR_GENERAL;
-        }
-
-        char mode[64] = {0};
+        // Verify this is actually a hotspot in NetworkManager, reading its
+        // keyfile directly when we can
+        bool have_profile = false;
         bool is_hotspot = false;
-        if (fgets(mode, sizeof(mode), mode_fp)) {
-            mode[strcspn(mode, "\n")] = '\0';
-            char *mode_value = strchr(mode, ':');
-            if (mode_value) {
-                mode_value++; // Skip ':'
-                if (strcmp(mode_value, "ap") == 0) {
-                    is_hotspot = true;
-                }
+        char ssid[MAX_STR_SSID] = {0};
+
+        pthread_mutex_lock(&ctx->lock);
+        if (nm_keyfile_store_refresh(&ctx->keyfiles) == WTERM_SUCCESS) {
+            const nm_keyfile_profile_t *profile = nm_keyfile_store_find(&ctx->keyfiles, name);
+            if (profile) {
+                have_profile = true;
+                is_hotspot = nm_keyfile_profile_is_ap(profile);
+                safe_string_copy(ssid, profile->ssid, sizeof(ssid));
             }
         }
-        pclose(mode_fp);
+        pthread_mutex_unlock(&ctx->lock);
+
+        if (!have_profile) {
+            // Mode, SSID and active state in one nmcli query
+            is_hotspot = nmcli_hotspot_state(name, ssid, sizeof(ssid), &is_active);
+            state_known = true;
+        }
 
         if (!is_hotspot) {
             return WTERM_ERROR_GENERAL; // Not a hotspot
@@ -352,21 +448,19 @@ wterm_result_t hotspot_get_status(const char *name, hotspot_status_t *status) {
         // Create minimal config for external hotspot
         memset(&external_config, 0, sizeof(hotspot_config_t));
         safe_string_copy(external_config.name, name, sizeof(external_config.name));
-        safe_string_copy(external_config.ssid, name, sizeof(external_config.ssid));
+        safe_string_copy(external_config.ssid, ssid[0] ? ssid : name,
+                         sizeof(external_config.ssid));
         config = &external_config;
     }
 
     // Check if hotspot is active
-    char command[256];
-    snprintf(command, sizeof(command),
-            "nmcli -t -f NAME connection show --active | grep -q '^%s$'", name);
-
-    char output[512];
-    wterm_result_t result = execute_nmcli_command(command, output, sizeof(output));
+    if (!state_known) {
+        is_active = backend_hotspot_active(ctx, name);
+    }
 
     memcpy(&status->config, config, sizeof(hotspot_config_t));
 
-    if (result == WTERM_SUCCESS) {
+    if (is_active) {
         status->state = HOTSPOT_STATE_ACTIVE;
         safe_string_copy(status->status_message, "Hotspot is running",
                         sizeof(status->status_message));
@@ -384,103 +478,277 @@ wterm_result_t hotspot_get_status(const char *name, hotspot_status_t *status) {
     return WTERM_SUCCESS;
 }
 
-wterm_result_t hotspot_list_configs(hotspot_list_t *list) {
-    if (!manager_initialized || !list) {
+wterm_result_t hotspot_get_clients(const char *name, hotspot_client_t *clients,
+                                   int max_clients, int *client_count) {
+    return hotspot_get_clients_ctx(wterm_ctx_default(), name, clients, max_clients,
+                                   client_count);
+}
+
+// Fill in client IPs from the AP's neighbour table
+static void add_client_addresses(const char *iface, hotspot_client_t *clients, int count) {
+    char *const args[] = {"ip", "-4", "neigh", "show", "dev", (char *)iface, NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("ip", args, &output)) {
+        return;
+    }
+
+    // "192.168.12.34 lladdr aa:bb:cc:dd:ee:ff REACHABLE"
+    char *cursor = output.out;
+    char *line;
+    while ((line = safe_exec_next_line(&cursor))) {
+        char ip[MAX_STR_IP_ADDR];
+        char mac[MAX_STR_MAC_ADDR];
+        if (sscanf(line, "%15s lladdr %17s", ip, mac) != 2) {
+            continue;
+        }
+        for (int i = 0; i < count; i++) {
+            if (strcasecmp(clients[i].mac_address, mac) == 0) {
+                safe_string_copy(clients[i].ip_address, ip, sizeof(clients[i].ip_address));
+            }
+        }
+    }
+    safe_exec_output_free(&output);
+}
+
+// Stations of the AP with their IPs (requires root privileges)
+static wterm_result_t read_stations(const hotspot_config_t *config,
+                                    hotspot_client_t *clients, int max_clients,
+                                    int *client_count) {
+    *client_count = 0;
+
+    char *const args[] = {"iw", "dev", (char *)config->wifi_interface, "station", "dump", NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("iw", args, &output)) {
+        return WTERM_ERROR_NETWORK;
+    }
+
+    char *cursor = output.out;
+    char *line;
+    while ((line = safe_exec_next_line(&cursor)) && *client_count < max_clients) {
+        // "Station aa:bb:cc:dd:ee:ff (on wlan0)"
+        char mac[MAX_STR_MAC_ADDR];
+        if (sscanf(line, "Station %17s", mac) != 1) {
+            continue;
+        }
+        hotspot_client_t *client = &clients[(*client_count)++];
+        memset(client, 0, sizeof(*client));
+        safe_string_copy(client->mac_address, mac, sizeof(client->mac_address));
+        safe_string_copy(client->hostname, "Unknown", sizeof(client->hostname));
+        safe_string_copy(client->ip_address, "Unknown", sizeof(client->ip_address));
+        client->is_connected = true;
+    }
+    safe_exec_output_free(&output);
+
+    add_client_addresses(config->wifi_interface, clients, *client_count);
+    return WTERM_SUCCESS;
+}
+
+wterm_result_t hotspot_get_clients_ctx(wterm_ctx_t *ctx, const char *name,
+                                       hotspot_client_t *clients, int max_clients,
+                                       int *client_count) {
+    if (!ctx || !ctx->hotspots_initialized || !name || !clients || !client_count ||
+        max_clients <= 0) {
         return WTERM_ERROR_INVALID_INPUT;
     }
+    *client_count = 0;
 
-    list->count = 0;
+    hotspot_config_t config;
+    if (!find_saved_config(ctx, name, &config) ||
+        !validate_interface_name(config.wifi_interface)) {
+        return WTERM_ERROR_GENERAL; // Configuration not found
+    }
 
-    // First, add wterm-created hotspots from saved configs
-    for (int i = 0; i < saved_configs.count && list->count < MAX_HOTSPOTS; i++) {
-        memcpy(&list->hotspots[list->count], &saved_configs.hotspots[i],
-               sizeof(hotspot_config_t));
-        list->count++;
+    wterm_result_t result = read_stations(&config, clients, max_clients, client_count);
+    if (result != WTERM_SUCCESS) {
+        return result;
     }
 
-    // Then, scan NetworkManager for ALL hotspot connections (including external ones)
-    FILE *fp = popen("nmcli -t -f NAME,TYPE connection show 2>/dev/null", "r");
-    if (!fp) {
-        // Return what we have from saved configs
-        return WTERM_SUCCESS;
+    // Give every station its own rate limit class
+    setup_traffic_shaping(&config, clients, *client_count, true);
+    return WTERM_SUCCESS;
+}
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Same stations, with the same addresses, in the same order?
+static bool same_stations(const hotspot_client_t *a, int a_count,
+                          const hotspot_client_t *b, int b_count) {
+    if (a_count != b_count) {
+        return false;
+    }
+    for (int i = 0; i < a_count; i++) {
+        if (strcmp(a[i].mac_address, b[i].mac_address) != 0 ||
+            strcmp(a[i].ip_address, b[i].ip_address) != 0) {
+            return false;
+        }
     }
+    return true;
+}
 
-    char line[512];
-    while (fgets(line, sizeof(line), fp) && list->count < MAX_HOTSPOTS) {
-        line[strcspn(line, "\n")] = '\0';
+wterm_result_t hotspot_watch_clients(const char *name, int cancel_fd) {
+    return hotspot_watch_clients_ctx(wterm_ctx_default(), name, cancel_fd);
+}
 
-        // Parse: NAME:TYPE
-        char *name_field = strtok(line, ":");
-        char *type_field = strtok(NULL, ":");
+wterm_result_t hotspot_watch_clients_ctx(wterm_ctx_t *ctx, const char *name,
+                                         int cancel_fd) {
+    if (!ctx || !ctx->hotspots_initialized || !name) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    hotspot_config_t config;
+    if (!find_saved_config(ctx, name, &config) ||
+        !validate_interface_name(config.wifi_interface)) {
+        return WTERM_ERROR_GENERAL; // Configuration not found
+    }
+    if (config.rate_limit_kbit == 0 && config.client_rate_limit_kbit == 0) {
+        return WTERM_SUCCESS; // No limits, no classes to keep up to date
+    }
+    if (geteuid() != 0) {
+        return WTERM_ERROR_PERMISSION;
+    }
 
-        if (!name_field || !type_field) continue;
-        if (strcmp(type_field, "802-11-wireless") != 0) continue;
+    link_watcher_t watcher;
+    wterm_result_t result = link_watcher_open(&watcher, config.wifi_interface);
+    if (result != WTERM_SUCCESS) {
+        return result;
+    }
+    if (link_watcher_phase(&watcher) == LINK_PHASE_DOWN) {
+        link_watcher_close(&watcher);
+        return WTERM_ERROR_GENERAL; // Hotspot not running
+    }
+
+    hotspot_client_t synced[MAX_HOTSPOT_CLIENTS];
+    int synced_count = -1;
+    while (link_watcher_phase(&watcher) != LINK_PHASE_DOWN) {
+        hotspot_client_t stations[MAX_HOTSPOT_CLIENTS];
+        int count = 0;
+        if (read_stations(&config, stations, MAX_HOTSPOT_CLIENTS, &count) == WTERM_SUCCESS &&
+            !same_stations(stations, count, synced, synced_count)) {
+            setup_traffic_shaping(&config, stations, count, true);
+            memcpy(synced, stations, (size_t)count * sizeof(stations[0]));
+            synced_count = count;
+        }
 
-        // Check if already in list (from wterm configs)
-        bool already_listed = false;
-        for (int i = 0; i < list->count; i++) {
-            if (strcmp(list->hotspots[i].name, name_field) == 0) {
-                already_listed = true;
+        result = link_watcher_wait_neighbours(&watcher, HOTSPOT_CLIENT_SYNC_INTERVAL_MS,
+                                              cancel_fd);
+        // A joining station sends a burst of ARP and DHCP traffic
+        long long settle_deadline = monotonic_ms() + HOTSPOT_CLIENT_SETTLE_MAX_MS;
+        while (result == WTERM_SUCCESS) {
+            long long remaining = settle_deadline - monotonic_ms();
+            if (remaining <= 0) {
+                result = WTERM_ERROR_TIMEOUT; // Sync now, events keep coming
                 break;
             }
+            result = link_watcher_wait_neighbours(
+                &watcher,
+                remaining < HOTSPOT_CLIENT_SETTLE_MS ? (int)remaining : HOTSPOT_CLIENT_SETTLE_MS,
+                cancel_fd);
+        }
+        if (result != WTERM_ERROR_TIMEOUT) {
+            break;
+        }
+        result = WTERM_SUCCESS;
+    }
+
+    link_watcher_close(&watcher);
+    return result == WTERM_ERROR_CANCELLED ? WTERM_SUCCESS : result;
+}
+
+static bool hotspot_listed(const hotspot_list_t *list, const char *name) {
+    for (int i = 0; i < list->count; i++) {
+        if (strcmp(list->hotspots[i].name, name) == 0) {
+            return true;
         }
-        if (already_listed) continue;
+    }
+    return false;
+}
 
-        // Check if this WiFi connection is actually a hotspot (mode = ap)
-        char check_cmd[512];
-        snprintf(check_cmd, sizeof(check_cmd),
-                 "nmcli -t -f 802-11-wireless.mode connection show '%s' 2>/dev/null",
-                 name_field);
+// Append a hotspot not created by wterm, unless it is already listed
+static void add_external_hotspot(hotspot_list_t *list, const char *name, const char *ssid) {
+    if (hotspot_listed(list, name)) {
+        return;
+    }
 
-        FILE *mode_fp = popen(check_cmd, "r");
-        if (!mode_fp) continue;
+    hotspot_config_t *hs = &list->hotspots[list->count];
+    memset(hs, 0, sizeof(hotspot_config_t));
+    safe_string_copy(hs->name, name, sizeof(hs->name));
+    safe_string_copy(hs->ssid, ssid, sizeof(hs->ssid));
+    // Mark as external by leaving other fields empty
+    list->count++;
+}
 
-        char mode[64] = {0};
-        if (fgets(mode, sizeof(mode), mode_fp)) {
-            mode[strcspn(mode, "\n")] = '\0';
+wterm_result_t hotspot_list_configs(hotspot_list_t *list) {
+    return hotspot_list_configs_ctx(wterm_ctx_default(), list);
+}
 
-            // Extract mode value (format: "802-11-wireless.mode:ap")
-            char *mode_value = strchr(mode, ':');
-            if (mode_value) {
-                mode_value++; // Skip ':'
+wterm_result_t hotspot_list_configs_ctx(wterm_ctx_t *ctx, hotspot_list_t *list) {
+    if (!ctx || !ctx->hotspots_initialized || !list) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
 
-                if (strcmp(mode_value, "ap") == 0) {
-                    // This is a hotspot! Add it to the list
-                    hotspot_config_t *hs = &list->hotspots[list->count];
-                    memset(hs, 0, sizeof(hotspot_config_t));
+    list->count = 0;
+    pthread_mutex_lock(&ctx->lock);
 
-                    safe_string_copy(hs->name, name_field, sizeof(hs->name));
-                    safe_string_copy(hs->ssid, name_field, sizeof(hs->ssid)); // Use name as SSID
-                    // Mark as external by leaving other fields empty
+    // First, add wterm-created hotspots from saved configs
+    const hotspot_list_t *saved = &ctx->saved_hotspots;
+    for (int i = 0; i < saved->count && list->count < MAX_HOTSPOTS; i++) {
+        memcpy(&list->hotspots[list->count], &saved->hotspots[i],
+               sizeof(hotspot_config_t));
+        list->count++;
+    }
 
-                    list->count++;
-                }
+    // Then add external hotspots. Reading NetworkManager's keyfiles is one
+    // directory pass, but NetworkManager also keeps profiles in /run, /usr/lib
+    // and other plugins, so nmcli still lists the rest; only profiles the
+    // keyfiles did not cover need their details fetched.
+    const nm_keyfile_store_t *keyfiles = &ctx->keyfiles;
+    char (*known_uuids)[NM_KEYFILE_UUID_MAX] = NULL;
+    int known_count = 0;
+    if (nm_keyfile_store_refresh(&ctx->keyfiles) == WTERM_SUCCESS) {
+        known_uuids = malloc((size_t)(keyfiles->count + 1) * sizeof(*known_uuids));
+        for (int i = 0; i < keyfiles->count; i++) {
+            const nm_keyfile_profile_t *profile = &keyfiles->profiles[i];
+            if (nm_keyfile_profile_is_ap(profile) && list->count < MAX_HOTSPOTS) {
+                add_external_hotspot(list, profile->name,
+                                     profile->ssid[0] ? profile->ssid : profile->name);
+            }
+            if (known_uuids && profile->uuid[0]) {
+                safe_string_copy(known_uuids[known_count++], profile->uuid,
+                                 NM_KEYFILE_UUID_MAX);
             }
         }
-        pclose(mode_fp);
     }
-    pclose(fp);
+    pthread_mutex_unlock(&ctx->lock);
 
+    nmcli_add_hotspots(list, (const char (*)[NM_KEYFILE_UUID_MAX])known_uuids, known_count);
+    free(known_uuids);
     return WTERM_SUCCESS;
 }
 
 wterm_result_t hotspot_delete_config(const char *name) {
-    if (!manager_initialized || !name) {
+    return hotspot_delete_config_ctx(wterm_ctx_default(), name);
+}
+
+wterm_result_t hotspot_delete_config_ctx(wterm_ctx_t *ctx, const char *name) {
+    if (!ctx || !ctx->hotspots_initialized || !name) {
         return WTERM_ERROR_INVALID_INPUT;
     }
 
-    // Try to stop hotspot if running (silently - ignore errors if already stopped)
-    char stop_cmd[256];
-    snprintf(stop_cmd, sizeof(stop_cmd), "nmcli connection down %s 2>/dev/null", name);
-    FILE *fp = popen(stop_cmd, "r");
-    if (fp) {
-        pclose(fp); // Ignore return value - hotspot might already be stopped
-    }
+    // Try to stop hotspot if running (silently - ignore errors if already stopped).
+    // Sharing is undone first, while the saved config it needs still exists
+    teardown_sharing(ctx, name);
+    backend_stop_hotspot(ctx, name);
 
     // Check if this is a wterm-managed hotspot or external
+    pthread_mutex_lock(&ctx->lock);
+    hotspot_list_t *saved = &ctx->saved_hotspots;
     int found_index = -1;
-    for (int i = 0; i < saved_configs.count; i++) {
-        if (strcmp(saved_configs.hotspots[i].name, name) == 0) {
+    for (int i = 0; i < saved->count; i++) {
+        if (strcmp(saved->hotspots[i].name, name) == 0) {
             found_index = i;
             break;
         }
@@ -490,27 +758,29 @@ wterm_result_t hotspot_delete_config(const char *name) {
     bool was_wterm_managed = false;
     if (found_index != -1) {
         // Shift remaining configurations
-        for (int i = found_index; i < saved_configs.count - 1; i++) {
-            memcpy(&saved_configs.hotspots[i], &saved_configs.hotspots[i + 1],
+        for (int i = found_index; i < saved->count - 1; i++) {
+            memcpy(&saved->hotspots[i], &saved->hotspots[i + 1],
                    sizeof(hotspot_config_t));
         }
-        saved_configs.count--;
+        saved->count--;
 
         // Delete configuration file
-        char *config_path = get_config_file_path(name);
+        char *config_path = get_config_file_path(ctx, name);
         if (config_path) {
             unlink(config_path);
             free(config_path);
         }
         was_wterm_managed = true;
     }
+    pthread_mutex_unlock(&ctx->lock);
 
     // Delete NetworkManager connection (works for both wterm and external hotspots)
     // This is optional cleanup - ignore errors if connection doesn't exist
-    char command[256];
-    snprintf(command, sizeof(command), "nmcli connection delete %s 2>/dev/null", name);
-    char output[512];
-    execute_nmcli_command_silent(command, output, sizeof(output));
+    const network_backend_t *backend = get_current_backend_ctx(ctx);
+    if (backend) {
+        backend->delete_hotspot(name);
+        query_cache_invalidate();
+    }
 
     // Return success if we successfully deleted the wterm config
     // NetworkManager connection deletion is optional cleanup
@@ -593,17 +863,28 @@ static void detect_gateway_ip(char *gateway_ip, size_t size) {
         return;
     }
 
-    // Get current IP address
-    FILE *fp = popen("ip -4 addr show scope global 2>/dev/null | grep -oP '(?<=inet\\s)\\d+(\\.\\d+){3}' | head -1", "r");
-    if (!fp) {
+    // Get current IP address from the first global IPv4 address
+    char *const args[] = {"ip", "-4", "-o", "addr", "show", "scope", "global", NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("ip", args, &output)) {
         // Fallback to default
         safe_string_copy(gateway_ip, "192.168.12.1", size);
         return;
     }
 
+    // One-line format: "2: eth0    inet 192.168.1.5/24 brd ... scope global eth0"
     char current_ip[32] = {0};
-    if (fgets(current_ip, sizeof(current_ip), fp)) {
-        current_ip[strcspn(current_ip, "\n")] = '\0';
+    char *cursor = output.out;
+    char *line;
+    while ((line = safe_exec_next_line(&cursor))) {
+        char *inet = strstr(line, " inet ");
+        if (inet && sscanf(inet + 6, "%31[0-9.]", current_ip) == 1) {
+            break;
+        }
+    }
+    safe_exec_output_free(&output);
+
+    if (current_ip[0] != '\0') {
 
         // Parse first three octets to detect pattern
         int octet1 = 0, octet2 = 0, octet3 = 0;
@@ -632,8 +913,6 @@ static void detect_gateway_ip(char *gateway_ip, size_t size) {
         // No IP found, use default
         safe_string_copy(gateway_ip, "192.168.12.1", size);
     }
-
-    pclose(fp);
 }
 
 void hotspot_get_default_config(hotspot_config_t *config) {
@@ -661,11 +940,31 @@ void hotspot_get_default_config(hotspot_config_t *config) {
 }
 
 // Helper function implementations
-static wterm_result_t ensure_directories_exist(void) {
+static const char *config_dir(const wterm_ctx_t *ctx) {
+    return ctx->hotspot_config_dir[0] ? ctx->hotspot_config_dir : HOTSPOT_CONFIG_DIR;
+}
+
+// Copy a saved configuration out of the context
+static bool find_saved_config(wterm_ctx_t *ctx, const char *name,
+                              hotspot_config_t *config) {
+    bool found = false;
+    pthread_mutex_lock(&ctx->lock);
+    for (int i = 0; i < ctx->saved_hotspots.count; i++) {
+        if (strcmp(ctx->saved_hotspots.hotspots[i].name, name) == 0) {
+            memcpy(config, &ctx->saved_hotspots.hotspots[i], sizeof(hotspot_config_t));
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    return found;
+}
+
+static wterm_result_t ensure_directories_exist(const wterm_ctx_t *ctx) {
     struct stat st = {0};
 
-    if (stat(HOTSPOT_CONFIG_DIR, &st) == -1) {
-        if (mkdir(HOTSPOT_CONFIG_DIR, 0755) != 0) {
+    if (stat(config_dir(ctx), &st) == -1) {
+        if (mkdir(config_dir(ctx), 0755) != 0) {
             return WTERM_ERROR_GENERAL;
         }
     }
@@ -679,27 +978,35 @@ static wterm_result_t ensure_directories_exist(void) {
     return WTERM_SUCCESS;
 }
 
-static wterm_result_t load_all_configs(void) {
-    saved_configs.count = 0;
+static int is_config_file(const struct dirent *entry) {
+    size_t name_len = strlen(entry->d_name);
+    size_t ext_len = strlen(HOTSPOT_CONFIG_EXT);
+
+    return name_len > ext_len &&
+           strcmp(entry->d_name + name_len - ext_len, HOTSPOT_CONFIG_EXT) == 0;
+}
 
-    // Use shell command to list .conf files
-    char command[512];
-    snprintf(command, sizeof(command), "ls %s/*.conf 2>/dev/null", HOTSPOT_CONFIG_DIR);
+static wterm_result_t load_all_configs(wterm_ctx_t *ctx) {
+    hotspot_list_t *saved = &ctx->saved_hotspots;
+    saved->count = 0;
 
-    FILE *fp = popen(command, "r");
-    if (!fp) {
+    // List .conf files in name order
+    struct dirent **entries = NULL;
+    int entry_count = scandir(config_dir(ctx), &entries, is_config_file, alphasort);
+    if (entry_count < 0) {
         return WTERM_SUCCESS; // No configs found
     }
 
-    char filepath[512];
-    while (fgets(filepath, sizeof(filepath), fp) && saved_configs.count < MAX_HOTSPOTS) {
-        filepath[strcspn(filepath, "\n")] = '\0';
+    for (int e = 0; e < entry_count && saved->count < MAX_HOTSPOTS; e++) {
+        char filepath[512];
+        snprintf(filepath, sizeof(filepath), "%s/%s", config_dir(ctx),
+                 entries[e]->d_name);
 
         // Read config file
         FILE *conf_fp = fopen(filepath, "r");
         if (!conf_fp) continue;
 
-        hotspot_config_t *cfg = &saved_configs.hotspots[saved_configs.count];
+        hotspot_config_t *cfg = &saved->hotspots[saved->count];
         memset(cfg, 0, sizeof(hotspot_config_t));
 
         char line[512];
@@ -726,74 +1033,326 @@ static wterm_result_t load_all_configs(void) {
             else if (strcmp(key, "client_isolation") == 0) cfg->client_isolation = (atoi(value) != 0);
             else if (strcmp(key, "mac_filtering") == 0) cfg->mac_filtering = (atoi(value) != 0);
             else if (strcmp(key, "is_5ghz") == 0) cfg->is_5ghz = (atoi(value) != 0);
+            else if (strcmp(key, "rate_limit_kbit") == 0) cfg->rate_limit_kbit = (unsigned int)strtoul(value, NULL, 10);
+            else if (strcmp(key, "client_rate_limit_kbit") == 0) cfg->client_rate_limit_kbit = (unsigned int)strtoul(value, NULL, 10);
         }
 
         fclose(conf_fp);
 
         // Only add if name is valid
         if (cfg->name[0] != '\0') {
-            saved_configs.count++;
+            saved->count++;
         }
     }
 
-    pclose(fp);
+    for (int e = 0; e < entry_count; e++) {
+        free(entries[e]);
+    }
+    free(entries);
     return WTERM_SUCCESS;
 }
 
-static char *get_config_file_path(const char *name) {
+static char *get_config_file_path(const wterm_ctx_t *ctx, const char *name) {
     if (!name) {
         return NULL;
     }
 
-    size_t path_len = strlen(HOTSPOT_CONFIG_DIR) + strlen(name) + strlen(HOTSPOT_CONFIG_EXT) + 2;
+    const char *dir = config_dir(ctx);
+    size_t path_len = strlen(dir) + strlen(name) + strlen(HOTSPOT_CONFIG_EXT) + 2;
     char *path = malloc(path_len);
     if (!path) {
         return NULL;
     }
 
-    snprintf(path, path_len, "%s/%s%s", HOTSPOT_CONFIG_DIR, name, HOTSPOT_CONFIG_EXT);
+    snprintf(path, path_len, "%s/%s%s", dir, name, HOTSPOT_CONFIG_EXT);
     return path;
 }
 
-static wterm_result_t execute_nmcli_command(const char *command, char *output, size_t output_size) {
-    if (!command) {
+static wterm_result_t execute_nmcli_command(char *const args[], char *output, size_t output_size) {
+    if (!args) {
         return WTERM_ERROR_INVALID_INPUT;
     }
 
-    FILE *fp = popen(command, "r");
-    if (!fp) {
+    if (output && output_size > 0) {
+        output[0] = '\0';
+    }
+
+    // Every command run through here changes NetworkManager state
+    safe_exec_output_t result;
+    bool ran = safe_exec_capture("nmcli", args, &result);
+    query_cache_invalidate();
+    if (!ran) {
         return WTERM_ERROR_NETWORK;
     }
 
     if (output && output_size > 0) {
-        // Read the first line of output (could be error message)
-        if (fgets(output, output_size, fp) == NULL) {
-            output[0] = '\0';
-        } else {
-            // Remove trailing newline for cleaner error messages
-            output[strcspn(output, "\n")] = '\0';
+        // Keep the first line of output (the error message on failure)
+        char *cursor = (result.exit_code != 0 && result.err[0] != '\0') ? result.err : result.out;
+        char *first_line = safe_exec_next_line(&cursor);
+        if (first_line) {
+            safe_string_copy(output, first_line, output_size);
         }
     }
 
-    int status = pclose(fp);
-    if (status != 0) {
+    int exit_code = result.exit_code;
+    safe_exec_output_free(&result);
+
+    return exit_code == 0 ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
+}
+
+// Silent version - doesn't print errors
+static wterm_result_t execute_nmcli_command_silent(char *const args[], char *output, size_t output_size) {
+    return execute_nmcli_command(args, output, output_size);
+}
+
+// Activation, deactivation and state go through the network backend, so
+// the D-Bus backend serves them without an nmcli process
+static wterm_result_t backend_start_hotspot(wterm_ctx_t *ctx, const char *name) {
+    const network_backend_t *backend = get_current_backend_ctx(ctx);
+    if (!backend) {
+        return WTERM_ERROR_NETWORK;
+    }
+
+    backend_result_t result = backend->start_hotspot(name);
+    query_cache_invalidate();
+    return result.result;
+}
+
+static wterm_result_t backend_stop_hotspot(wterm_ctx_t *ctx, const char *name) {
+    const network_backend_t *backend = get_current_backend_ctx(ctx);
+    if (!backend) {
         return WTERM_ERROR_NETWORK;
     }
 
-    return WTERM_SUCCESS;
+    backend_result_t result = backend->stop_hotspot(name);
+    query_cache_invalidate();
+    return result.result;
 }
 
-// Silent version - doesn't print errors
-static wterm_result_t execute_nmcli_command_silent(const char *command, char *output, size_t output_size) {
-    return execute_nmcli_command(command, output, output_size);
+static bool backend_hotspot_active(wterm_ctx_t *ctx, const char *name) {
+    const network_backend_t *backend = get_current_backend_ctx(ctx);
+    hotspot_status_t state;
+    return backend && backend->get_hotspot_status(name, &state) == WTERM_SUCCESS &&
+           state.state == HOTSPOT_STATE_ACTIVE;
+}
+
+/**
+ * @brief Check if a connection name is listed by nmcli (exact match)
+ */
+static bool nmcli_connection_listed(const char *name, bool active_only) {
+    char *const all_args[] = {"nmcli", "-t", "-f", "NAME", "connection", "show", NULL};
+    char *const active_args[] = {"nmcli", "-t", "-f", "NAME", "connection", "show",
+                                 "--active", NULL};
+    safe_exec_output_t output;
+    if (!query_cache_capture("nmcli", active_only ? active_args : all_args,
+                             QUERY_CACHE_DEFAULT_TTL_MS, &output)) {
+        return false;
+    }
+
+    bool found = false;
+    char *cursor = output.out;
+    char *line;
+    while ((line = safe_exec_next_line(&cursor))) {
+        if (strcmp(line, name) == 0) {
+            found = true;
+            break;
+        }
+    }
+
+    safe_exec_output_free(&output);
+    return found;
+}
+
+/**
+ * @brief Mode, SSID and active state of one connection in a single query
+ *
+ * GENERAL.STATE is only reported for active connections.
+ *
+ * @return true if the connection is in AP (hotspot) mode
+ */
+static bool nmcli_hotspot_state(const char *name, char *ssid, size_t ssid_size,
+                                bool *is_active) {
+    char *const args[] = {"nmcli", "-t", "-f",
+                          "802-11-wireless.mode,802-11-wireless.ssid,GENERAL.STATE",
+                          "connection", "show", (char *)name, NULL};
+    *is_active = false;
+    safe_exec_output_t output;
+    if (!query_cache_capture("nmcli", args, QUERY_CACHE_DEFAULT_TTL_MS, &output)) {
+        return false;
+    }
+
+    bool is_ap = false;
+    if (output.exit_code == 0) {
+        char *cursor = output.out;
+        char *line;
+        while ((line = safe_exec_next_line(&cursor))) {
+            char *fields[2];
+            if (split_terse_fields(line, fields, 2) != 2) continue;
+
+            if (strcmp(fields[0], "802-11-wireless.mode") == 0) {
+                is_ap = strcmp(fields[1], "ap") == 0;
+            } else if (strcmp(fields[0], "802-11-wireless.ssid") == 0) {
+                safe_string_copy(ssid, fields[1], ssid_size);
+            } else if (strcmp(fields[0], "GENERAL.STATE") == 0) {
+                *is_active = strcmp(fields[1], "activated") == 0;
+            }
+        }
+    }
+
+    safe_exec_output_free(&output);
+    return is_ap;
+}
+
+// Wireless connection from the nmcli listing; strings point into its output
+typedef struct {
+    const char *name;
+    const char *uuid;
+    const char *ssid;
+    bool is_ap;
+} nmcli_wireless_t;
+
+// Find a listed connection by UUID. Details come back in request order, so
+// the search starts where the previous one matched.
+static nmcli_wireless_t *find_wireless(nmcli_wireless_t *wireless, int count, int *next,
+                                       const char *uuid) {
+    for (int n = 0; n < count; n++) {
+        int i = (*next + n) % count;
+        if (strcmp(wireless[i].uuid, uuid) == 0) {
+            *next = (i + 1) % count;
+            return &wireless[i];
+        }
+    }
+    return NULL;
+}
+
+// Whether a UUID is among the profiles already read from keyfiles
+static bool uuid_known(const char (*known_uuids)[NM_KEYFILE_UUID_MAX], int known_count,
+                       const char *uuid) {
+    for (int i = 0; i < known_count; i++) {
+        if (strcmp(known_uuids[i], uuid) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Add every AP-mode wireless connection known to nmcli
+ *
+ * One query lists the connections and one more fetches the mode and SSID
+ * of all wireless ones at once, instead of a process per connection.
+ * Connections with a UUID in known_uuids were already classified from
+ * their keyfile and are skipped.
+ */
+static void nmcli_add_hotspots(hotspot_list_t *list,
+                               const char (*known_uuids)[NM_KEYFILE_UUID_MAX],
+                               int known_count) {
+    char *const list_args[] = {"nmcli", "-t", "-f", "NAME,UUID,TYPE", "connection",
+                               "show", NULL};
+    safe_exec_output_t listing;
+    if (!query_cache_capture("nmcli", list_args, QUERY_CACHE_DEFAULT_TTL_MS, &listing)) {
+        return;
+    }
+
+    int lines = 0;
+    for (const char *p = listing.out; *p; p++) {
+        lines += *p == '\n';
+    }
+
+    nmcli_wireless_t *wireless = malloc((size_t)(lines + 1) * sizeof(nmcli_wireless_t));
+    char **args = malloc((size_t)(lines + 8) * sizeof(char *));
+    if (!wireless || !args) {
+        free(wireless);
+        free(args);
+        safe_exec_output_free(&listing);
+        return;
+    }
+
+    int count = 0;
+    char *cursor = listing.out;
+    char *line;
+    while ((line = safe_exec_next_line(&cursor))) {
+        // Parse: NAME:UUID:TYPE
+        char *fields[3];
+        if (split_terse_fields(line, fields, 3) != 3) continue;
+        if (strcmp(fields[2], "802-11-wireless") != 0 || !fields[1][0]) continue;
+        if (hotspot_listed(list, fields[0])) continue;
+        if (uuid_known(known_uuids, known_count, fields[1])) continue;
+
+        wireless[count].name = fields[0];
+        wireless[count].uuid = fields[1];
+        wireless[count].ssid = NULL;
+        wireless[count].is_ap = false;
+        count++;
+    }
+
+    safe_exec_output_t details = {0};
+    bool have_details = false;
+    if (count > 0) {
+        int argc = 0;
+        args[argc++] = "nmcli";
+        args[argc++] = "-t";
+        args[argc++] = "-f";
+        args[argc++] = "connection.uuid,802-11-wireless.mode,802-11-wireless.ssid";
+        args[argc++] = "connection";
+        args[argc++] = "show";
+        for (int i = 0; i < count; i++) {
+            args[argc++] = (char *)wireless[i].uuid;
+        }
+        args[argc] = NULL;
+        have_details = query_cache_capture("nmcli", args, QUERY_CACHE_DEFAULT_TTL_MS,
+                                           &details);
+    }
+
+    if (have_details && details.exit_code == 0) {
+        // Blocks of "connection.uuid:...", "802-11-wireless.mode:..." and
+        // "802-11-wireless.ssid:..." lines, one block per connection
+        nmcli_wireless_t *current = NULL;
+        int next = 0;
+        cursor = details.out;
+        while ((line = safe_exec_next_line(&cursor))) {
+            char *fields[2];
+            if (split_terse_fields(line, fields, 2) != 2) continue;
+
+            if (strcmp(fields[0], "connection.uuid") == 0) {
+                current = find_wireless(wireless, count, &next, fields[1]);
+            } else if (!current) {
+                continue;
+            } else if (strcmp(fields[0], "802-11-wireless.mode") == 0) {
+                current->is_ap = strcmp(fields[1], "ap") == 0;
+            } else if (strcmp(fields[0], "802-11-wireless.ssid") == 0) {
+                current->ssid = fields[1];
+            }
+        }
+
+        for (int i = 0; i < count && list->count < MAX_HOTSPOTS; i++) {
+            if (wireless[i].is_ap) {
+                add_external_hotspot(list, wireless[i].name,
+                                     (wireless[i].ssid && wireless[i].ssid[0])
+                                         ? wireless[i].ssid : wireless[i].name);
+            }
+        }
+    }
+    if (have_details) {
+        safe_exec_output_free(&details);
+    }
+
+    free(args);
+    free(wireless);
+    safe_exec_output_free(&listing);
 }
 
 wterm_result_t hotspot_save_config_to_file(const hotspot_config_t *config) {
+    return save_config_to_file(wterm_ctx_default(), config);
+}
+
+static wterm_result_t save_config_to_file(const wterm_ctx_t *ctx,
+                                          const hotspot_config_t *config) {
     if (!config) {
         return WTERM_ERROR_INVALID_INPUT;
     }
 
-    char *config_path = get_config_file_path(config->name);
+    char *config_path = get_config_file_path(ctx, config->name);
     if (!config_path) {
         return WTERM_ERROR_MEMORY;
     }
@@ -823,6 +1382,8 @@ static wterm_result_t write_config_file(const char *file_path, const hotspot_con
     fprintf(fp, "client_isolation=%d\n", config->client_isolation ? 1 : 0);
     fprintf(fp, "mac_filtering=%d\n", config->mac_filtering ? 1 : 0);
     fprintf(fp, "is_5ghz=%d\n", config->is_5ghz ? 1 : 0);
+    fprintf(fp, "rate_limit_kbit=%u\n", config->rate_limit_kbit);
+    fprintf(fp, "client_rate_limit_kbit=%u\n", config->client_rate_limit_kbit);
 
     fclose(fp);
     return WTERM_SUCCESS;
@@ -846,6 +1407,7 @@ const char *hotspot_share_method_to_string(hotspot_share_method_t share_method)
     switch (share_method) {
         case HOTSPOT_SHARE_NONE: return "None";
         case HOTSPOT_SHARE_NAT: return "NAT";
+        case HOTSPOT_SHARE_NAT_FASTPATH: return "NAT (fast path)";
         case HOTSPOT_SHARE_BRIDGE: return "Bridge";
         default: return "Unknown";
     }
@@ -861,17 +1423,18 @@ static wterm_result_t get_default_route_interface(char *interface, size_t size)
         return WTERM_ERROR_INVALID_INPUT;
     }
 
-    // Use popen to capture output from: ip route show default
-    // Note: This is safe as we're not passing user input to the command
-    FILE *fp = popen("ip route show default 2>/dev/null", "r");
-    if (!fp) {
+    // Capture output from: ip route show default
+    char *const args[] = {"ip", "route", "show", "default", NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("ip", args, &output)) {
         return WTERM_ERROR_NETWORK;
     }
 
-    char line[256];
     bool found = false;
+    char *cursor = output.out;
+    char *line = safe_exec_next_line(&cursor);
 
-    if (fgets(line, sizeof(line), fp)) {
+    if (line) {
         // Parse: "default via 10.246.251.85 dev enp0s20f0u5 proto dhcp..."
         char *dev_pos = strstr(line, " dev ");
         if (dev_pos) {
@@ -882,179 +1445,119 @@ static wterm_result_t get_default_route_interface(char *interface, size_t size)
             if (len < size) {
                 strncpy(interface, dev_pos, len);
                 interface[len] = '\0';
-                // Remove newline if present
-                interface[strcspn(interface, "\n")] = '\0';
                 found = true;
             }
         }
     }
 
-    pclose(fp);
+    safe_exec_output_free(&output);
     return found ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
 }
 
 /**
- * @brief Check if an iptables rule already exists
+ * @brief Set up NAT rules for internet sharing
+ *
+ * Replaces any rules left from an earlier start in one transaction (see
+ * nat_engine.h). With fast_path, established flows are offloaded to an
+ * nftables flowtable when nft is installed.
  */
-static bool check_iptables_rule_exists(char **args) {
-    if (!args) {
-        return false;
-    }
-
-    // Convert -A to -C (check mode) for iptables
-    // Build check args by replacing -A with -C
-    int arg_count = 0;
-    while (args[arg_count] != NULL) {
-        arg_count++;
-    }
-
-    char **check_args = malloc(sizeof(char*) * (arg_count + 1));
-    if (!check_args) {
-        return false;
+static wterm_result_t setup_nat_rules(const char *hotspot_iface, const char *inet_iface,
+                                      const char *gateway_ip, bool fast_path) {
+    // Check if running as root - NAT requires root privileges
+    // Silently skip NAT setup if not root (hotspot will still work, just no internet sharing)
+    if (geteuid() != 0) {
+        return WTERM_SUCCESS;
     }
 
-    for (int i = 0; i < arg_count; i++) {
-        if (strcmp(args[i], "-A") == 0) {
-            check_args[i] = "-C"; // Check mode instead of append
-        } else {
-            check_args[i] = args[i];
-        }
+    nat_rules_t rules;
+    wterm_result_t result = nat_rules_init(&rules, hotspot_iface, inet_iface, gateway_ip);
+    if (result != WTERM_SUCCESS) {
+        return result;
     }
-    check_args[arg_count] = NULL;
-
-    // Execute check command (returns 0 if rule exists)
-    int result = safe_exec_command("iptables", check_args);
-    free(check_args);
-
-    return (result == 0);
+    rules.flowtable = fast_path;
+    return nat_engine_apply(&rules);
 }
 
 /**
- * @brief Set up NAT rules for internet sharing (with duplicate prevention)
+ * @brief Clean up NAT rules when stopping hotspot
  */
-static wterm_result_t setup_nat_rules(const char *hotspot_iface, const char *inet_iface,
-                                      const char *hotspot_subnet) {
-    if (!hotspot_iface || !inet_iface || !hotspot_subnet) {
-        return WTERM_ERROR_INVALID_INPUT;
-    }
-
-    // Check if running as root - NAT requires root privileges
-    // Silently skip NAT setup if not root (hotspot will still work, just no internet sharing)
+static wterm_result_t cleanup_nat_rules(const char *hotspot_iface) {
+    // Check if running as root - NAT cleanup requires root privileges
+    // Silently skip if not root
     if (geteuid() != 0) {
         return WTERM_SUCCESS;
     }
 
-    // Validate interface names
-    if (!validate_interface_name(hotspot_iface) || !validate_interface_name(inet_iface)) {
-        return WTERM_ERROR_INVALID_INPUT;
+    nat_rules_t rules;
+    wterm_result_t result = nat_rules_init(&rules, hotspot_iface, NULL, NULL);
+    if (result != WTERM_SUCCESS) {
+        return result;
     }
+    nat_engine_remove(&rules); // Ignore errors: the rules may already be gone
+    return WTERM_SUCCESS;
+}
 
-    // Extract subnet (e.g., "192.168.12.1/24" -> "192.168.12.0/24")
-    char subnet[32];
-    safe_string_copy(subnet, hotspot_subnet, sizeof(subnet));
-
-    // Create NAT MASQUERADE rule (check if exists first)
-    char *masq_args[] = {
-        "iptables", "-t", "nat", "-A", "POSTROUTING",
-        "-s", subnet, "!", "-d", subnet,
-        "-j", "MASQUERADE",
-        NULL
-    };
-
-    if (!check_iptables_rule_exists(masq_args)) {
-        if (safe_exec_command("iptables", masq_args) != 0) {
-            return WTERM_ERROR_NETWORK;
-        }
+/**
+ * @brief Apply the hotspot's rate limits to its AP interface
+ *
+ * Without sync the shaping tree is rebuilt from scratch; with sync only the
+ * station classes of an applied tree are brought up to date. Nothing
+ * happens when the hotspot has no limits configured.
+ */
+static void setup_traffic_shaping(const hotspot_config_t *config,
+                                  const hotspot_client_t *stations, int count, bool sync) {
+    // tc changes need root privileges, like the NAT rules
+    if (geteuid() != 0) {
+        return;
     }
 
-    // Add FORWARD rule (hotspot -> internet)
-    char *forward_out_args[] = {
-        "iptables", "-A", "FORWARD",
-        "-i", (char*)hotspot_iface, "-o", (char*)inet_iface,
-        "-j", "ACCEPT",
-        NULL
-    };
-
-    if (!check_iptables_rule_exists(forward_out_args)) {
-        if (safe_exec_command("iptables", forward_out_args) != 0) {
-            return WTERM_ERROR_NETWORK;
-        }
+    shaper_plan_t plan;
+    if (shaper_plan_init(&plan, config->wifi_interface, config->rate_limit_kbit,
+                         config->client_rate_limit_kbit) != WTERM_SUCCESS ||
+        !shaper_plan_active(&plan)) {
+        return;
     }
+    shaper_plan_add_stations(&plan, stations, count);
 
-    // Add FORWARD rule (internet -> hotspot, established connections)
-    char *forward_in_args[] = {
-        "iptables", "-A", "FORWARD",
-        "-i", (char*)inet_iface, "-o", (char*)hotspot_iface,
-        "-m", "state", "--state", "RELATED,ESTABLISHED",
-        "-j", "ACCEPT",
-        NULL
-    };
-
-    if (!check_iptables_rule_exists(forward_in_args)) {
-        safe_exec_command("iptables", forward_in_args);  // Non-critical, ignore errors
+    if (sync) {
+        traffic_shaper_sync(&plan); // Ignore errors: the hotspot may be down
+    } else if (traffic_shaper_apply(&plan) != WTERM_SUCCESS) {
+        REPORT_ERROR(false, "Warning: Could not apply rate limits on %s",
+                     config->wifi_interface);
     }
-
-    return WTERM_SUCCESS;
 }
 
 /**
- * @brief Clean up NAT rules when stopping hotspot
+ * @brief Remove the hotspot's rate limits when stopping it
  */
-static wterm_result_t cleanup_nat_rules(const char *hotspot_iface, const char *hotspot_subnet) {
-    if (!hotspot_iface || !hotspot_subnet) {
-        return WTERM_ERROR_INVALID_INPUT;
-    }
-
-    // Check if running as root - NAT cleanup requires root privileges
-    // Silently skip if not root
-    if (geteuid() != 0) {
-        return WTERM_SUCCESS;
+static void cleanup_traffic_shaping(const hotspot_config_t *config) {
+    if (geteuid() != 0 || (config->rate_limit_kbit == 0 &&
+                           config->client_rate_limit_kbit == 0)) {
+        return;
     }
+    traffic_shaper_remove(config->wifi_interface); // Ignore errors
+}
 
-    // Extract subnet
-    char subnet[32];
-    safe_string_copy(subnet, hotspot_subnet, sizeof(subnet));
-
-    // Remove NAT MASQUERADE rule
-    char *del_masq_args[] = {
-        "iptables", "-t", "nat", "-D", "POSTROUTING",
-        "-s", subnet, "!", "-d", subnet,
-        "-j", "MASQUERADE",
-        NULL
-    };
-    safe_exec_command("iptables", del_masq_args); // Ignore errors
-
-    // Remove FORWARD rules - try to remove all matching rules
-    // We use a loop because there might be multiple rules
-    for (int i = 0; i < 10; i++) {  // Max 10 attempts
-        char *del_forward_args[] = {
-            "iptables", "-D", "FORWARD",
-            "-i", (char*)hotspot_iface,
-            "-j", "ACCEPT",
-            NULL
-        };
-
-        if (safe_exec_command("iptables", del_forward_args) != 0) {
-            break; // No more rules to delete
-        }
+/**
+ * @brief Undo the sharing setup of a saved hotspot before stopping it
+ *
+ * Silent; hotspots without a saved config were not started by us and have
+ * nothing to undo.
+ */
+static void teardown_sharing(wterm_ctx_t *ctx, const char *name) {
+    hotspot_config_t config;
+    if (!find_saved_config(ctx, name, &config)) {
+        return;
     }
 
-    // Remove inbound FORWARD rules
-    for (int i = 0; i < 10; i++) {
-        char *del_forward_in_args[] = {
-            "iptables", "-D", "FORWARD",
-            "-o", (char*)hotspot_iface,
-            "-m", "state", "--state", "RELATED,ESTABLISHED",
-            "-j", "ACCEPT",
-            NULL
-        };
-
-        if (safe_exec_command("iptables", del_forward_in_args) != 0) {
-            break;
+    cleanup_traffic_shaping(&config);
+    if (config.share_method == HOTSPOT_SHARE_BRIDGE) {
+        if (geteuid() == 0) {
+            bridge_engine_detach(config.wifi_interface);
         }
+    } else {
+        cleanup_nat_rules(config.wifi_interface);
     }
-
-    return WTERM_SUCCESS;
 }
 
 // UI Helper Functions
@@ -1071,26 +1574,22 @@ wterm_result_t hotspot_get_interface_list(interface_info_t *interfaces,
     *count = 0;
 
     // Use nmcli to list WiFi interfaces
-    FILE *fp = popen("nmcli device status 2>/dev/null", "r");
-    if (!fp) {
-        return WTERM_ERROR_NETWORK;
-    }
-
-    char line[256];
-    // Skip header line
-    if (fgets(line, sizeof(line), fp) == NULL) {
-        pclose(fp);
+    char *const args[] = {"nmcli", "-t", "-f", "DEVICE,TYPE,STATE", "device", "status", NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("nmcli", args, &output)) {
         return WTERM_ERROR_NETWORK;
     }
 
     // Parse each interface line
-    while (fgets(line, sizeof(line), fp) && *count < max_count) {
+    char *cursor = output.out;
+    char *line;
+    while ((line = safe_exec_next_line(&cursor)) && *count < max_count) {
         char device[MAX_STR_INTERFACE];
         char type[32];
         char state[32];
 
-        // Parse: DEVICE TYPE STATE CONNECTION
-        if (sscanf(line, "%15s %31s %31s", device, type, state) == 3) {
+        // Parse: DEVICE:TYPE:STATE
+        if (sscanf(line, "%15[^:]:%31[^:]:%31s", device, type, state) == 3) {
             // Only include WiFi interfaces
             if (strcmp(type, "wifi") == 0) {
                 safe_string_copy(interfaces[*count].name, device, sizeof(interfaces[*count].name));
@@ -1110,7 +1609,7 @@ wterm_result_t hotspot_get_interface_list(interface_info_t *interfaces,
         }
     }
 
-    pclose(fp);
+    safe_exec_output_free(&output);
     return (*count > 0) ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
 }
 
@@ -3,21 +3,30 @@
 /**
  * @file hotspot_manager.h
  * @brief WiFi hotspot management functionality for wterm
+ *
+ * Saved hotspots belong to a wterm_ctx_t. The *_ctx functions take the
+ * context explicitly; the others use wterm_ctx_default().
  */
 
 #include "../../include/wterm/common.h"
+#include "context.h"
 #include <stdbool.h>
 
+// Where saved hotspot configurations live unless the context says otherwise
+#define HOTSPOT_CONFIG_DIR "/tmp/wterm_hotspots"
+
 /**
  * @brief Initialize the hotspot manager
  * @return WTERM_SUCCESS on success, error code on failure
  */
 wterm_result_t hotspot_manager_init(void);
+wterm_result_t hotspot_manager_init_ctx(wterm_ctx_t *ctx);
 
 /**
  * @brief Cleanup hotspot manager resources
  */
 void hotspot_manager_cleanup(void);
+void hotspot_manager_cleanup_ctx(wterm_ctx_t *ctx);
 
 /**
  * @brief Create a new hotspot configuration
@@ -25,6 +34,7 @@ void hotspot_manager_cleanup(void);
  * @return WTERM_SUCCESS on success, error code on failure
  */
 wterm_result_t hotspot_create_config(const hotspot_config_t *config);
+wterm_result_t hotspot_create_config_ctx(wterm_ctx_t *ctx, const hotspot_config_t *config);
 
 /**
  * @brief Start a hotspot by name
@@ -33,6 +43,8 @@ wterm_result_t hotspot_create_config(const hotspot_config_t *config);
  * @return WTERM_SUCCESS on success, error code on failure
  */
 wterm_result_t hotspot_start(const char *name, hotspot_status_t *status);
+wterm_result_t hotspot_start_ctx(wterm_ctx_t *ctx, const char *name,
+                                 hotspot_status_t *status);
 
 /**
  * @brief Stop a running hotspot
@@ -40,6 +52,7 @@ wterm_result_t hotspot_start(const char *name, hotspot_status_t *status);
  * @return WTERM_SUCCESS on success, error code on failure
  */
 wterm_result_t hotspot_stop(const char *name);
+wterm_result_t hotspot_stop_ctx(wterm_ctx_t *ctx, const char *name);
 
 /**
  * @brief Get hotspot status
@@ -48,6 +61,8 @@ wterm_result_t hotspot_stop(const char *name);
  * @return WTERM_SUCCESS on success, error code on failure
  */
 wterm_result_t hotspot_get_status(const char *name, hotspot_status_t *status);
+wterm_result_t hotspot_get_status_ctx(wterm_ctx_t *ctx, const char *name,
+                                      hotspot_status_t *status);
 
 /**
  * @brief List all configured hotspots
@@ -55,6 +70,7 @@ wterm_result_t hotspot_get_status(const char *name, hotspot_status_t *status);
  * @return WTERM_SUCCESS on success, error code on failure
  */
 wterm_result_t hotspot_list_configs(hotspot_list_t *list);
+wterm_result_t hotspot_list_configs_ctx(wterm_ctx_t *ctx, hotspot_list_t *list);
 
 /**
  * @brief Delete a hotspot configuration
@@ -62,6 +78,7 @@ wterm_result_t hotspot_list_configs(hotspot_list_t *list);
  * @return WTERM_SUCCESS on success, error code on failure
  */
 wterm_result_t hotspot_delete_config(const char *name);
+wterm_result_t hotspot_delete_config_ctx(wterm_ctx_t *ctx, const char *name);
 
 /**
  * @brief Update an existing hotspot configuration
@@ -74,6 +91,10 @@ wterm_result_t hotspot_update_config(const char *name,
 
 /**
  * @brief Get list of connected clients for a hotspot
+ *
+ * When the hotspot has rate limits, each listed station also gets its own
+ * rate limit class on the AP interface.
+ *
  * @param name Hotspot name
  * @param clients Output array of client information
  * @param max_clients Maximum number of clients to return
@@ -82,6 +103,27 @@ wterm_result_t hotspot_update_config(const char *name,
  */
 wterm_result_t hotspot_get_clients(const char *name, hotspot_client_t *clients,
                                    int max_clients, int *client_count);
+wterm_result_t hotspot_get_clients_ctx(wterm_ctx_t *ctx, const char *name,
+                                       hotspot_client_t *clients, int max_clients,
+                                       int *client_count);
+
+/**
+ * @brief Keep the per-station rate limit classes of a running hotspot current
+ *
+ * Blocks while the hotspot runs. The station list is re-read whenever the
+ * AP's neighbour table changes, and at least every 30 seconds, and the
+ * shaping tree is synced when the stations differ from the last sync.
+ * Returns at once when the hotspot has no rate limits.
+ *
+ * @param name Hotspot name
+ * @param cancel_fd Descriptor that stops the watch when readable (<0 for none)
+ * @return WTERM_SUCCESS once the hotspot stops or the watch is cancelled,
+ *         WTERM_ERROR_GENERAL if the hotspot is unknown or not running,
+ *         WTERM_ERROR_PERMISSION without root, or WTERM_ERROR_NETWORK
+ */
+wterm_result_t hotspot_watch_clients(const char *name, int cancel_fd);
+wterm_result_t hotspot_watch_clients_ctx(wterm_ctx_t *ctx, const char *name,
+                                         int cancel_fd);
 
 /**
  * @brief Validate hotspot configuration
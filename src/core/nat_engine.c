@@ -0,0 +1,270 @@
+/**
+ * @file nat_engine.c
+ * @brief Internet sharing rules for a hotspot, applied as one transaction
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "nat_engine.h"
+#include "../utils/capability.h"
+#include "../utils/input_sanitizer.h"
+#include "../utils/safe_exec.h"
+#include "../utils/string_utils.h"
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NAT_SCRIPT_MAX 2048
+
+wterm_result_t nat_rules_init(nat_rules_t *rules, const char *hotspot_iface,
+                              const char *uplink_iface, const char *gateway_ip) {
+  if (!rules || !validate_interface_name(hotspot_iface) ||
+      (uplink_iface && !validate_interface_name(uplink_iface))) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  memset(rules, 0, sizeof(*rules));
+  safe_string_copy(rules->hotspot_iface, hotspot_iface,
+                   sizeof(rules->hotspot_iface));
+  if (uplink_iface) {
+    safe_string_copy(rules->uplink_iface, uplink_iface,
+                     sizeof(rules->uplink_iface));
+  }
+
+  // The hotspot is always set up as a /24 around its gateway address
+  struct in_addr address;
+  if (gateway_ip && inet_pton(AF_INET, gateway_ip, &address) == 1) {
+    address.s_addr &= htonl(0xFFFFFF00u);
+    char network[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &address, network, sizeof(network));
+    snprintf(rules->subnet, sizeof(rules->subnet), "%s/24", network);
+  } else if (uplink_iface) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+  return WTERM_SUCCESS;
+}
+
+size_t nat_render_apply(const nat_rules_t *rules, char *buffer, size_t size) {
+  if (!rules || !buffer || rules->uplink_iface[0] == '\0' ||
+      rules->subnet[0] == '\0') {
+    return 0;
+  }
+
+  const char *hotspot = rules->hotspot_iface;
+  const char *uplink = rules->uplink_iface;
+  const char *subnet = rules->subnet;
+  int len = snprintf(
+      buffer, size,
+      "*filter\n"
+      ":" NAT_CHAIN_PREFIX_FORWARD "%s - [0:0]\n"
+      "-A FORWARD -m comment --comment wterm:%s -j " NAT_CHAIN_PREFIX_FORWARD "%s\n"
+      "-A " NAT_CHAIN_PREFIX_FORWARD "%s -i %s -o %s -s %s -j ACCEPT\n"
+      "-A " NAT_CHAIN_PREFIX_FORWARD "%s -i %s -o %s -d %s"
+      " -m conntrack --ctstate RELATED,ESTABLISHED -j ACCEPT\n"
+      "COMMIT\n"
+      "*nat\n"
+      ":" NAT_CHAIN_PREFIX_POSTROUTING "%s - [0:0]\n"
+      "-A POSTROUTING -m comment --comment wterm:%s -j " NAT_CHAIN_PREFIX_POSTROUTING "%s\n"
+      "-A " NAT_CHAIN_PREFIX_POSTROUTING "%s -s %s ! -d %s -o %s -j MASQUERADE\n"
+      "COMMIT\n",
+      hotspot, hotspot, hotspot, hotspot, hotspot, uplink, subnet, hotspot,
+      uplink, hotspot, subnet, hotspot, hotspot, hotspot, hotspot, subnet,
+      subnet, uplink);
+  return len > 0 && (size_t)len < size ? (size_t)len : 0;
+}
+
+size_t nat_render_remove(const nat_rules_t *rules, const char *table,
+                         char *buffer, size_t size) {
+  if (!rules || !table || !buffer) {
+    return 0;
+  }
+
+  const char *parent;
+  const char *prefix;
+  if (strcmp(table, "filter") == 0) {
+    parent = "FORWARD";
+    prefix = NAT_CHAIN_PREFIX_FORWARD;
+  } else if (strcmp(table, "nat") == 0) {
+    parent = "POSTROUTING";
+    prefix = NAT_CHAIN_PREFIX_POSTROUTING;
+  } else {
+    return 0;
+  }
+
+  const char *hotspot = rules->hotspot_iface;
+  int len = snprintf(buffer, size,
+                     "*%s\n"
+                     "-D %s -m comment --comment wterm:%s -j %s%s\n"
+                     "-F %s%s\n"
+                     "-X %s%s\n"
+                     "COMMIT\n",
+                     table, parent, hotspot, prefix, hotspot, prefix, hotspot,
+                     prefix, hotspot);
+  return len > 0 && (size_t)len < size ? (size_t)len : 0;
+}
+
+size_t nat_render_nft(const nat_rules_t *rules, char *buffer, size_t size) {
+  if (!rules || !buffer || rules->uplink_iface[0] == '\0' ||
+      rules->subnet[0] == '\0') {
+    return 0;
+  }
+
+  // "table" then "delete table" empties a table from an earlier start
+  // without failing when there is none, all in the same batch
+  const char *hotspot = rules->hotspot_iface;
+  const char *uplink = rules->uplink_iface;
+  const char *subnet = rules->subnet;
+  int len = snprintf(buffer, size,
+                     "table ip " NAT_TABLE_PREFIX "%s\n"
+                     "delete table ip " NAT_TABLE_PREFIX "%s\n"
+                     "table ip " NAT_TABLE_PREFIX "%s {\n",
+                     hotspot, hotspot, hotspot);
+  size_t used = len > 0 ? (size_t)len : size;
+
+  if (rules->flowtable && used < size) {
+    len = snprintf(buffer + used, size - used,
+                   "  flowtable fastpath {\n"
+                   "    hook ingress priority 0; devices = { \"%s\", \"%s\" };\n"
+                   "  }\n",
+                   hotspot, uplink);
+    used += len > 0 ? (size_t)len : size;
+  }
+  if (used < size) {
+    len = snprintf(buffer + used, size - used,
+                   "  chain forward {\n"
+                   "    type filter hook forward priority 0; policy accept;\n"
+                   "    iifname \"%s\" oifname \"%s\" ip saddr %s%s accept\n"
+                   "    iifname \"%s\" oifname \"%s\" ip daddr %s ct state related,established accept\n"
+                   "  }\n"
+                   "  chain postrouting {\n"
+                   "    type nat hook postrouting priority 100; policy accept;\n"
+                   "    oifname \"%s\" ip saddr %s ip daddr != %s masquerade\n"
+                   "  }\n"
+                   "}\n",
+                   hotspot, uplink, subnet,
+                   rules->flowtable ? " meta l4proto { tcp, udp } flow add @fastpath" : "",
+                   uplink, hotspot, subnet, uplink,
+                   subnet, subnet);
+    used += len > 0 ? (size_t)len : size;
+  }
+  return used < size ? used : 0;
+}
+
+// Run a rule tool, feeding it a script on stdin when one is given
+static wterm_result_t run_tool(capability_t tool, char *const args[],
+                               const char *script, size_t len) {
+  if (!capability_available(tool)) {
+    return WTERM_ERROR_NETWORK;
+  }
+
+  safe_exec_options_t options = {.input = script, .input_len = len};
+  safe_exec_output_t output;
+  wterm_result_t result =
+      safe_exec_capture_ex(args[0], args, &options, &output);
+  if (result != WTERM_SUCCESS) {
+    return WTERM_ERROR_NETWORK;
+  }
+
+  bool ok = output.exit_code == 0;
+  safe_exec_output_free(&output);
+  return ok ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
+}
+
+// Load a script with iptables-restore, keeping all other rules in place
+static wterm_result_t restore(const char *script, size_t len) {
+  char *const args[] = {"iptables-restore", "--noflush", "--wait", NULL};
+  return run_tool(CAPABILITY_IPTABLES_RESTORE, args, script, len);
+}
+
+static wterm_result_t iptables_apply(const nat_rules_t *rules) {
+  char script[NAT_SCRIPT_MAX];
+  size_t len = nat_render_apply(rules, script, sizeof(script));
+  if (len == 0) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  // Drop the jumps of an earlier start first; the chains themselves are
+  // emptied by their declaration in the new script
+  nat_engine_remove_backend(NAT_BACKEND_IPTABLES, rules);
+  return restore(script, len);
+}
+
+static wterm_result_t iptables_remove(const nat_rules_t *rules) {
+  static const char *const tables[] = {"filter", "nat"};
+  wterm_result_t result = WTERM_SUCCESS;
+  char script[NAT_SCRIPT_MAX];
+
+  for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++) {
+    size_t len = nat_render_remove(rules, tables[i], script, sizeof(script));
+    if (len == 0) {
+      return WTERM_ERROR_INVALID_INPUT;
+    }
+    if (restore(script, len) != WTERM_SUCCESS) {
+      result = WTERM_ERROR_NETWORK;
+    }
+  }
+  return result;
+}
+
+static wterm_result_t nft_apply(const nat_rules_t *rules) {
+  char script[NAT_SCRIPT_MAX];
+  size_t len = nat_render_nft(rules, script, sizeof(script));
+  if (len == 0) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  char *const args[] = {"nft", "-f", "-", NULL};
+  return run_tool(CAPABILITY_NFT, args, script, len);
+}
+
+static wterm_result_t nft_remove(const nat_rules_t *rules) {
+  if (!rules || rules->hotspot_iface[0] == '\0') {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  char table[sizeof(NAT_TABLE_PREFIX) + MAX_STR_INTERFACE];
+  snprintf(table, sizeof(table), NAT_TABLE_PREFIX "%s", rules->hotspot_iface);
+  char *const args[] = {"nft", "delete", "table", "ip", table, NULL};
+  return run_tool(CAPABILITY_NFT, args, NULL, 0);
+}
+
+nat_backend_t nat_engine_backend(void) {
+  if (capability_available(CAPABILITY_NFT)) {
+    return NAT_BACKEND_NFTABLES;
+  }
+  if (capability_available(CAPABILITY_IPTABLES_RESTORE)) {
+    return NAT_BACKEND_IPTABLES;
+  }
+  return NAT_BACKEND_NONE;
+}
+
+wterm_result_t nat_engine_apply_backend(nat_backend_t backend,
+                                        const nat_rules_t *rules) {
+  switch (backend) {
+  case NAT_BACKEND_NFTABLES:
+    return nft_apply(rules);
+  case NAT_BACKEND_IPTABLES:
+    return iptables_apply(rules);
+  default:
+    return WTERM_ERROR_NETWORK;
+  }
+}
+
+wterm_result_t nat_engine_remove_backend(nat_backend_t backend,
+                                         const nat_rules_t *rules) {
+  switch (backend) {
+  case NAT_BACKEND_NFTABLES:
+    return nft_remove(rules);
+  case NAT_BACKEND_IPTABLES:
+    return iptables_remove(rules);
+  default:
+    return WTERM_ERROR_NETWORK;
+  }
+}
+
+wterm_result_t nat_engine_apply(const nat_rules_t *rules) {
+  return nat_engine_apply_backend(nat_engine_backend(), rules);
+}
+
+wterm_result_t nat_engine_remove(const nat_rules_t *rules) {
+  return nat_engine_remove_backend(nat_engine_backend(), rules);
+}
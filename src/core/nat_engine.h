@@ -0,0 +1,137 @@
+#pragma once
+
+/**
+ * @file nat_engine.h
+ * @brief Internet sharing rules for a hotspot, applied as one transaction
+ *
+ * With nft installed, the rules for a hotspot live in a table of their
+ * own, `ip wterm-<iface>`, loaded by one `nft -f` batch and removed by
+ * deleting the table. Otherwise they live in two chains of their own,
+ * WTERM-FWD-<iface> (filter) and WTERM-NAT-<iface> (nat), reached from
+ * FORWARD and POSTROUTING by one jump each and loaded with
+ * `iptables-restore --noflush`. Either way starting or stopping a hotspot
+ * costs the same few processes however large the host's ruleset is, and
+ * other rules are left untouched.
+ *
+ * Note that an nftables accept only ends evaluation of its own table: a
+ * forward chain elsewhere that drops the hotspot's traffic still wins.
+ *
+ * With rules.flowtable set, the nftables table also gets a flowtable over
+ * the hotspot and uplink interfaces. Once a TCP or UDP connection is
+ * established, its packets are forwarded and NATed from the ingress hook
+ * and skip the forward and postrouting chains, including the host's own.
+ * The iptables backend has no flowtables and ignores the flag.
+ */
+
+#include "../../include/wterm/common.h"
+#include <stddef.h>
+
+#define NAT_SUBNET_MAX 32
+#define NAT_CHAIN_PREFIX_FORWARD "WTERM-FWD-"
+#define NAT_CHAIN_PREFIX_POSTROUTING "WTERM-NAT-"
+#define NAT_TABLE_PREFIX "wterm-"
+
+/**
+ * @brief Tool used to install the rules
+ */
+typedef enum {
+  NAT_BACKEND_NONE = 0,  // Neither tool is installed
+  NAT_BACKEND_NFTABLES,  // nft, one table per hotspot
+  NAT_BACKEND_IPTABLES   // iptables-restore, two chains per hotspot
+} nat_backend_t;
+
+/**
+ * @brief Rule set for one hotspot
+ */
+typedef struct {
+  char hotspot_iface[MAX_STR_INTERFACE];
+  char uplink_iface[MAX_STR_INTERFACE]; // Empty when only removing
+  char subnet[NAT_SUBNET_MAX];          // Hotspot network, e.g. "10.42.0.0/24"
+  bool flowtable; // Offload established flows (nftables only)
+} nat_rules_t;
+
+/**
+ * @brief Describe the rules for a hotspot
+ *
+ * @param rules Output
+ * @param hotspot_iface Hotspot interface
+ * @param uplink_iface Interface with the default route, or NULL when the
+ *        rules are only going to be removed
+ * @param gateway_ip Hotspot address; the shared network is its /24
+ * @return WTERM_SUCCESS or WTERM_ERROR_INVALID_INPUT
+ */
+wterm_result_t nat_rules_init(nat_rules_t *rules, const char *hotspot_iface,
+                              const char *uplink_iface, const char *gateway_ip);
+
+/**
+ * @brief Write the iptables-restore script that installs the rules
+ *
+ * Declaring the hotspot's chains empties them if they already exist, so
+ * the script can be reloaded after nat_render_remove() without leaving
+ * duplicates.
+ *
+ * @return Script length, or 0 if it does not fit or the uplink is unset
+ */
+size_t nat_render_apply(const nat_rules_t *rules, char *buffer, size_t size);
+
+/**
+ * @brief Write the iptables-restore script that removes the rules of one table
+ * @param table "filter" or "nat"
+ * @return Script length, or 0 if it does not fit or the table is unknown
+ */
+size_t nat_render_remove(const nat_rules_t *rules, const char *table,
+                         char *buffer, size_t size);
+
+/**
+ * @brief Write the `nft -f` batch that installs the rules
+ *
+ * The batch creates and deletes the hotspot's table before defining it,
+ * so it also replaces a table left from an earlier start, atomically.
+ * Both interfaces must exist when a batch with a flowtable is loaded.
+ *
+ * @return Batch length, or 0 if it does not fit or the uplink is unset
+ */
+size_t nat_render_nft(const nat_rules_t *rules, char *buffer, size_t size);
+
+/**
+ * @brief Backend nat_engine_apply() and nat_engine_remove() use
+ *
+ * nftables when nft is installed, else iptables-restore.
+ */
+nat_backend_t nat_engine_backend(void);
+
+/**
+ * @brief Install the rules, replacing any left from an earlier start
+ *
+ * With nftables this is one batch. With iptables the removal runs for
+ * each table first, then the new rule set loads in a single transaction.
+ * Either way all rules are in place afterwards or none of the new ones are.
+ *
+ * @return WTERM_SUCCESS, WTERM_ERROR_INVALID_INPUT, or WTERM_ERROR_NETWORK
+ *         if no backend is installed or it rejected the rules
+ */
+wterm_result_t nat_engine_apply(const nat_rules_t *rules);
+
+/**
+ * @brief Remove the rules (only hotspot_iface needs to be set)
+ *
+ * With nftables this deletes the hotspot's table. With iptables each
+ * table is its own transaction, so a table whose rules are already gone
+ * does not keep the other from being cleaned up.
+ *
+ * @return WTERM_SUCCESS if everything was removed, otherwise
+ *         WTERM_ERROR_NETWORK (e.g. nothing was installed)
+ */
+wterm_result_t nat_engine_remove(const nat_rules_t *rules);
+
+/**
+ * @brief nat_engine_apply() with an explicit backend
+ */
+wterm_result_t nat_engine_apply_backend(nat_backend_t backend,
+                                        const nat_rules_t *rules);
+
+/**
+ * @brief nat_engine_remove() with an explicit backend
+ */
+wterm_result_t nat_engine_remove_backend(nat_backend_t backend,
+                                         const nat_rules_t *rules);
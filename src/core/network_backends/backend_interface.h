@@ -4,15 +4,19 @@
  * @file backend_interface.h
  * @brief Network manager backend interface for wterm
  *
- * This header defines the interface for NetworkManager (nmcli) backend.
+ * This header defines the interface for NetworkManager (nmcli) backend, the
+ * NetworkManager D-Bus backend and the native nl80211 scan backend.
  */
 
 #include "../../../include/wterm/common.h"
+#include "../context.h"
 
 // Network manager backend types
 typedef enum {
   NETMGR_UNKNOWN = 0,
-  NETMGR_NMCLI // NetworkManager (nmcli)
+  NETMGR_NMCLI,   // NetworkManager (nmcli)
+  NETMGR_NL80211, // Kernel nl80211 via generic netlink (scan only)
+  NETMGR_NM_DBUS  // NetworkManager over D-Bus (optional, needs libdbus)
 } network_manager_type_t;
 
 // Connection result for backend operations
@@ -22,7 +26,7 @@ typedef struct {
 } backend_result_t;
 
 // Network backend interface
-typedef struct {
+typedef struct network_backend {
   // Backend identification
   network_manager_type_t type;
   const char *name;
@@ -30,18 +34,32 @@ typedef struct {
 
   // Core operations
   wterm_result_t (*scan_networks)(network_list_t *networks);
-  backend_result_t (*connect_open_network)(const char *ssid);
+  // Connect and wait for the activation; a readable cancel_fd (<0 for
+  // none) aborts the attempt with WTERM_ERROR_CANCELLED
+  backend_result_t (*connect_open_network)(const char *ssid, int cancel_fd);
   backend_result_t (*connect_secured_network)(const char *ssid,
-                                              const char *password);
+                                              const char *password,
+                                              int cancel_fd);
+  // Activate a saved profile by its UUID, the same way
+  backend_result_t (*connect_saved_network)(const char *uuid, int cancel_fd);
   backend_result_t (*disconnect_network)(void);
   wterm_result_t (*rescan_networks)(void);
 
+  // Rescan and return results once the scan has completed. If the scan is
+  // refused or misses the deadline, the cached results are returned with
+  // is_stale set.
+  wterm_result_t (*scan_networks_fresh)(network_list_t *networks,
+                                        int timeout_ms);
+
   // Availability check
   bool (*is_available)(void);
 
   // Status operations
   bool (*is_connected)(char *connected_ssid, size_t buffer_size);
   bool (*get_ip_address)(char *ip_buffer, size_t buffer_size);
+  // Active WiFi connection with its profile, device and address in one
+  // query; is_connected is false when there is none
+  wterm_result_t (*get_connection_status)(connection_status_t *status);
 
   // Hotspot operations
   backend_result_t (*create_hotspot)(const hotspot_config_t *config);
@@ -68,15 +86,21 @@ typedef struct {
 
 /**
  * @brief Initialize the network backend system
+ *
+ * The backend is chosen once per process; each context records it on its
+ * first use. The plain variant initializes the default context.
+ *
  * @return WTERM_SUCCESS if a backend was found and initialized
  */
 wterm_result_t init_network_backend(void);
+wterm_result_t init_network_backend_ctx(wterm_ctx_t *ctx);
 
 /**
  * @brief Get the currently active network backend
  * @return Pointer to active backend, or NULL if none initialized
  */
 const network_backend_t *get_current_backend(void);
+const network_backend_t *get_current_backend_ctx(wterm_ctx_t *ctx);
 
 /**
  * @brief Get the type of the currently active backend
@@ -97,5 +121,9 @@ bool command_exists(const char *command);
  */
 network_manager_type_t detect_network_manager(void);
 
-// Backend implementation
+// Backend implementations
 extern const network_backend_t nmcli_backend;
+extern const network_backend_t nl80211_backend;
+#ifdef WTERM_HAVE_DBUS
+extern const network_backend_t nm_dbus_backend;
+#endif
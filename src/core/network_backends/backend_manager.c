@@ -1,15 +1,91 @@
 /**
  * @file backend_manager.c
  * @brief NetworkManager (nmcli) backend management
+ *
+ * Native backends are layered over nmcli: the NetworkManager D-Bus backend
+ * (when built with libdbus) replaces the nmcli operations it implements, and
+ * when the kernel exposes nl80211 with a station interface, scans are served
+ * natively. Anything a native backend does not implement falls through to
+ * nmcli. Set WTERM_BACKEND=nmcli, dbus or nl80211 to force a backend.
  */
 
+#define _POSIX_C_SOURCE 200809L
 #include "../../utils/safe_exec.h"
+#include "../context.h"
 #include "backend_interface.h"
+#include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
 
-// Global backend state
-static const network_backend_t *current_backend = NULL;
-static bool backend_initialized = false;
+// The backend selection is the same for every context: it is made once,
+// under the lock, and retried only while no backend was found
+static pthread_mutex_t selection_lock = PTHREAD_MUTEX_INITIALIZER;
+static const network_backend_t *selected_backend = NULL;
+
+// Layered backend and the backend used when nl80211 may not trigger scans
+static network_backend_t composite_backend;
+static const network_backend_t *rescan_fallback = NULL;
+
+#define OVERLAY_OP(dst, src, op)                                               \
+  if ((src)->op)                                                               \
+  (dst)->op = (src)->op
+
+static void overlay_backend(network_backend_t *dst,
+                            const network_backend_t *src) {
+  dst->type = src->type;
+  dst->name = src->name;
+  OVERLAY_OP(dst, src, scan_networks);
+  OVERLAY_OP(dst, src, connect_open_network);
+  OVERLAY_OP(dst, src, connect_secured_network);
+  OVERLAY_OP(dst, src, connect_saved_network);
+  OVERLAY_OP(dst, src, disconnect_network);
+  OVERLAY_OP(dst, src, rescan_networks);
+  OVERLAY_OP(dst, src, scan_networks_fresh);
+  OVERLAY_OP(dst, src, is_available);
+  OVERLAY_OP(dst, src, is_connected);
+  OVERLAY_OP(dst, src, get_ip_address);
+  OVERLAY_OP(dst, src, get_connection_status);
+  OVERLAY_OP(dst, src, create_hotspot);
+  OVERLAY_OP(dst, src, start_hotspot);
+  OVERLAY_OP(dst, src, stop_hotspot);
+  OVERLAY_OP(dst, src, delete_hotspot);
+  OVERLAY_OP(dst, src, get_hotspot_status);
+  OVERLAY_OP(dst, src, list_active_hotspots);
+  OVERLAY_OP(dst, src, get_hotspot_clients);
+  OVERLAY_OP(dst, src, check_interface_ap_support);
+  OVERLAY_OP(dst, src, get_available_wifi_interfaces);
+}
+
+static wterm_result_t composite_rescan_networks(void) {
+  wterm_result_t result = nl80211_backend.rescan_networks();
+
+  // Triggering a scan needs CAP_NET_ADMIN; NetworkManager can do it for us
+  if (result == WTERM_ERROR_PERMISSION && rescan_fallback) {
+    return rescan_fallback->rescan_networks();
+  }
+  return result;
+}
+
+static wterm_result_t composite_scan_networks_fresh(network_list_t *networks,
+                                                    int timeout_ms) {
+  wterm_result_t result =
+      nl80211_backend.scan_networks_fresh(networks, timeout_ms);
+
+  // NetworkManager's scan refreshes the same kernel BSS cache
+  if (result == WTERM_ERROR_PERMISSION && rescan_fallback &&
+      rescan_fallback->scan_networks_fresh) {
+    return rescan_fallback->scan_networks_fresh(networks, timeout_ms);
+  }
+  if (result == WTERM_ERROR_PERMISSION) {
+    result = nl80211_backend.scan_networks(networks);
+    networks->is_stale = true;
+  }
+  return result;
+}
+
+static bool backend_allowed(const char *forced, const char *name) {
+  return !forced || strcmp(forced, name) == 0;
+}
 
 bool command_exists(const char *command) {
   if (!command)
@@ -19,6 +95,16 @@ bool command_exists(const char *command) {
 }
 
 network_manager_type_t detect_network_manager(void) {
+  if (nl80211_backend.is_available()) {
+    return NETMGR_NL80211;
+  }
+
+#ifdef WTERM_HAVE_DBUS
+  if (nm_dbus_backend.is_available()) {
+    return NETMGR_NM_DBUS;
+  }
+#endif
+
   if (command_exists("nmcli")) {
     // Check if nmcli can actually work
     char *const args[] = {"nmcli", "device", "status", NULL};
@@ -29,27 +115,75 @@ network_manager_type_t detect_network_manager(void) {
   return NETMGR_UNKNOWN;
 }
 
+static const network_backend_t *select_backend(void) {
+  const char *forced = getenv("WTERM_BACKEND");
+  bool have_nmcli = nmcli_backend.is_available();
+  bool layered = false;
+
+  composite_backend = nmcli_backend;
+  rescan_fallback = have_nmcli ? &nmcli_backend : NULL;
+
+#ifdef WTERM_HAVE_DBUS
+  if (backend_allowed(forced, "dbus") && nm_dbus_backend.is_available()) {
+    overlay_backend(&composite_backend, &nm_dbus_backend);
+    rescan_fallback = &nm_dbus_backend;
+    layered = true;
+  }
+#endif
+
+  if (backend_allowed(forced, "nl80211") && nl80211_backend.is_available()) {
+    overlay_backend(&composite_backend, &nl80211_backend);
+    composite_backend.rescan_networks = composite_rescan_networks;
+    composite_backend.scan_networks_fresh = composite_scan_networks_fresh;
+    layered = true;
+  }
+
+  if (layered) {
+    return &composite_backend;
+  }
+
+  if (backend_allowed(forced, "nmcli") && have_nmcli) {
+    return &nmcli_backend;
+  }
+
+  return NULL;
+}
+
 wterm_result_t init_network_backend(void) {
-  if (backend_initialized && current_backend) {
+  return init_network_backend_ctx(wterm_ctx_default());
+}
+
+wterm_result_t init_network_backend_ctx(wterm_ctx_t *ctx) {
+  if (!ctx) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+  if (__atomic_load_n(&ctx->backend, __ATOMIC_ACQUIRE)) {
     return WTERM_SUCCESS; // Already initialized
   }
 
-  if (nmcli_backend.is_available()) {
-    current_backend = &nmcli_backend;
-    backend_initialized = true;
-    return WTERM_SUCCESS;
+  pthread_mutex_lock(&selection_lock);
+  if (!selected_backend) {
+    selected_backend = select_backend();
   }
+  const network_backend_t *backend = selected_backend;
+  pthread_mutex_unlock(&selection_lock);
 
-  current_backend = NULL;
-  backend_initialized = false;
-  return WTERM_ERROR_NETWORK;
+  __atomic_store_n(&ctx->backend, backend, __ATOMIC_RELEASE);
+  return backend ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
 }
 
 const network_backend_t *get_current_backend(void) {
-  if (!backend_initialized) {
-    init_network_backend();
+  return get_current_backend_ctx(wterm_ctx_default());
+}
+
+const network_backend_t *get_current_backend_ctx(wterm_ctx_t *ctx) {
+  if (!ctx) {
+    return NULL;
+  }
+  if (!__atomic_load_n(&ctx->backend, __ATOMIC_ACQUIRE)) {
+    init_network_backend_ctx(ctx);
   }
-  return current_backend;
+  return __atomic_load_n(&ctx->backend, __ATOMIC_ACQUIRE);
 }
 
 network_manager_type_t get_backend_type(void) {
@@ -0,0 +1,181 @@
+/**
+ * @file nl80211_backend.c
+ * @brief Native nl80211 (generic netlink) scan backend
+ *
+ * Scans are served in-process from the kernel's BSS cache, avoiding the
+ * /bin/sh + nmcli round trip. Only scan operations are implemented here;
+ * the backend manager fills the remaining operations from nmcli.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../../utils/network_list.h"
+#include "../../utils/nl80211_helper.h"
+#include "../../utils/string_utils.h"
+#include "backend_interface.h"
+#include <linux/nl80211.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Upper bound for a triggered scan; dual-band scans take ~3-5 seconds
+#define NL80211_SCAN_TIMEOUT_MS 10000
+
+// Forward declarations
+static wterm_result_t nl80211_scan_networks(network_list_t *networks);
+static wterm_result_t nl80211_rescan_networks(void);
+static wterm_result_t nl80211_scan_networks_fresh(network_list_t *networks,
+                                                  int timeout_ms);
+static bool nl80211_backend_is_available(void);
+
+// Backend definition
+const network_backend_t nl80211_backend = {
+    .type = NETMGR_NL80211,
+    .name = "nl80211",
+    .command = NULL,
+    .scan_networks = nl80211_scan_networks,
+    .rescan_networks = nl80211_rescan_networks,
+    .scan_networks_fresh = nl80211_scan_networks_fresh,
+    .is_available = nl80211_backend_is_available};
+
+static long long monotonic_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int get_station_interfaces(nl80211_iface_t *ifaces, int max_ifaces) {
+  int count = 0;
+  if (nl80211_get_interfaces(ifaces, max_ifaces, &count) != WTERM_SUCCESS) {
+    return 0;
+  }
+
+  // Keep only managed (station) interfaces; AP/monitor ones cannot scan
+  int stations = 0;
+  for (int i = 0; i < count; i++) {
+    if (ifaces[i].iftype == NL80211_IFTYPE_STATION) {
+      ifaces[stations++] = ifaces[i];
+    }
+  }
+  return stations;
+}
+
+static bool nl80211_backend_is_available(void) {
+  if (!nl80211_is_available()) {
+    return false;
+  }
+
+  nl80211_iface_t ifaces[NL80211_MAX_INTERFACES];
+  return get_station_interfaces(ifaces, NL80211_MAX_INTERFACES) > 0;
+}
+
+static bool collect_bss(const nl80211_bss_t *bss, void *user_data) {
+  network_list_t *networks = user_data;
+
+  if (bss->ssid[0] == '\0') {
+    // Hidden SSIDs are skipped on purpose: the UI dedups networks by SSID,
+    // so every hidden BSS would collapse into one unusable entry
+    return true;
+  }
+
+  network_info_t *network = network_list_append(networks);
+  if (!network) {
+    return false;
+  }
+
+  safe_string_copy(network->ssid, bss->ssid, MAX_STR_SSID);
+  nl80211_bss_security_string(bss, network->security, MAX_STR_SECURITY);
+  snprintf(network->signal, MAX_STR_SIGNAL, "%d", bss->quality);
+
+  scan_record_t record = {
+      .frequency = (uint16_t)bss->frequency,
+      .channel = network_frequency_to_channel(bss->frequency),
+      .signal_dbm = (int16_t)(bss->signal_mbm / 100),
+      .quality = (uint8_t)bss->quality,
+      .security_flags = network_security_flags(network->security),
+      .max_rate = bss->max_rate};
+  memcpy(record.bssid, bss->bssid, sizeof(record.bssid));
+  network_list_set_record(networks, networks->count - 1, &record);
+  return true;
+}
+
+static wterm_result_t nl80211_scan_networks(network_list_t *networks) {
+  if (!networks) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  network_list_clear(networks);
+
+  nl80211_iface_t ifaces[NL80211_MAX_INTERFACES];
+  int iface_count = get_station_interfaces(ifaces, NL80211_MAX_INTERFACES);
+  if (iface_count == 0) {
+    return WTERM_ERROR_INTERFACE;
+  }
+
+  for (int i = 0; i < iface_count; i++) {
+    wterm_result_t result =
+        nl80211_dump_scan(ifaces[i].ifindex, collect_bss, networks);
+    if (result != WTERM_SUCCESS) {
+      return result;
+    }
+  }
+
+  return WTERM_SUCCESS;
+}
+
+static wterm_result_t nl80211_rescan_networks(void) {
+  nl80211_iface_t ifaces[NL80211_MAX_INTERFACES];
+  int iface_count = get_station_interfaces(ifaces, NL80211_MAX_INTERFACES);
+  if (iface_count == 0) {
+    return WTERM_ERROR_INTERFACE;
+  }
+
+  wterm_result_t result = WTERM_ERROR_NETWORK;
+  for (int i = 0; i < iface_count; i++) {
+    wterm_result_t iface_result =
+        nl80211_trigger_scan(ifaces[i].ifindex, NL80211_SCAN_TIMEOUT_MS);
+    if (iface_result == WTERM_SUCCESS) {
+      result = WTERM_SUCCESS;
+    } else if (result != WTERM_SUCCESS) {
+      result = iface_result;
+    }
+  }
+
+  return result;
+}
+
+static wterm_result_t nl80211_scan_networks_fresh(network_list_t *networks,
+                                                  int timeout_ms) {
+  if (!networks || timeout_ms <= 0) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  nl80211_iface_t ifaces[NL80211_MAX_INTERFACES];
+  int iface_count = get_station_interfaces(ifaces, NL80211_MAX_INTERFACES);
+  if (iface_count == 0) {
+    return WTERM_ERROR_INTERFACE;
+  }
+
+  // Interfaces scan in turn, each within what is left of the deadline
+  long long deadline = monotonic_ms() + timeout_ms;
+  bool fresh = true;
+  for (int i = 0; i < iface_count; i++) {
+    long long remaining = deadline - monotonic_ms();
+    if (remaining <= 0) {
+      fresh = false;
+      break;
+    }
+
+    wterm_result_t result =
+        nl80211_trigger_scan(ifaces[i].ifindex, (int)remaining);
+    if (result == WTERM_ERROR_PERMISSION) {
+      return result; // Caller may ask NetworkManager to scan instead
+    }
+    if (result != WTERM_SUCCESS) {
+      fresh = false; // Timed out or aborted; the cache is still served
+    }
+  }
+
+  wterm_result_t result = nl80211_scan_networks(networks);
+  networks->is_stale = !fresh;
+  return result;
+}
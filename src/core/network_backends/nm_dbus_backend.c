@@ -0,0 +1,1790 @@
+/**
+ * @file nm_dbus_backend.c
+ * @brief NetworkManager backend over a persistent D-Bus connection
+ *
+ * Every operation is a handful of method calls on org.freedesktop.NetworkManager
+ * instead of a fork+exec of /bin/sh and nmcli. Activations wait for the
+ * active connection's StateChanged signal rather than polling.
+ *
+ * Set WTERM_NM_BUS=session to talk to a NetworkManager (or a mock) on the
+ * session bus instead of the system bus.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../../utils/input_sanitizer.h"
+#include "../../utils/network_list.h"
+#include "../../utils/string_utils.h"
+#include "backend_interface.h"
+#include <dbus/dbus.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// D-Bus names
+#define NM_DBUS_SERVICE "org.freedesktop.NetworkManager"
+#define NM_DBUS_PATH "/org/freedesktop/NetworkManager"
+#define NM_DBUS_PATH_SETTINGS "/org/freedesktop/NetworkManager/Settings"
+#define NM_DBUS_IFACE NM_DBUS_SERVICE
+#define NM_DBUS_IFACE_DEVICE NM_DBUS_SERVICE ".Device"
+#define NM_DBUS_IFACE_WIRELESS NM_DBUS_SERVICE ".Device.Wireless"
+#define NM_DBUS_IFACE_AP NM_DBUS_SERVICE ".AccessPoint"
+#define NM_DBUS_IFACE_ACTIVE NM_DBUS_SERVICE ".Connection.Active"
+#define NM_DBUS_IFACE_IP4CONFIG NM_DBUS_SERVICE ".IP4Config"
+#define NM_DBUS_IFACE_SETTINGS NM_DBUS_SERVICE ".Settings"
+#define NM_DBUS_IFACE_CONNECTION NM_DBUS_SERVICE ".Settings.Connection"
+#define DBUS_IFACE_PROPERTIES "org.freedesktop.DBus.Properties"
+
+// NetworkManager constants (from NetworkManager.h)
+#define NM_DEVICE_TYPE_WIFI 2
+#define NM_WIFI_DEVICE_CAP_AP 0x00000040
+#define NM_802_11_AP_FLAGS_PRIVACY 0x00000001
+#define NM_802_11_AP_SEC_KEY_MGMT_PSK 0x00000100
+#define NM_802_11_AP_SEC_KEY_MGMT_802_1X 0x00000200
+#define NM_802_11_AP_SEC_KEY_MGMT_SAE 0x00000400
+#define NM_802_11_AP_SEC_KEY_MGMT_OWE 0x00000800
+#define NM_ACTIVE_CONNECTION_STATE_ACTIVATING 1
+#define NM_ACTIVE_CONNECTION_STATE_ACTIVATED 2
+#define NM_ACTIVE_CONNECTION_STATE_DEACTIVATING 3
+#define NM_ACTIVE_CONNECTION_STATE_DEACTIVATED 4
+
+// Limits and timeouts
+#define NM_MAX_PATH 128
+#define NM_CALL_TIMEOUT_MS 25000
+#define NM_ACTIVATION_TIMEOUT_MS 90000 // Same default as nmcli --wait
+#define NM_SCAN_POLL_MS 100
+
+// Persistent connection for method calls. Activations wait for their
+// signals on a connection of their own, without holding the lock.
+static DBusConnection *nm_bus = NULL;
+static pthread_mutex_t nm_bus_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Forward declarations
+static wterm_result_t nm_dbus_scan_networks(network_list_t *networks);
+static backend_result_t nm_dbus_connect_open_network(const char *ssid,
+                                                     int cancel_fd);
+static backend_result_t nm_dbus_connect_secured_network(const char *ssid,
+                                                        const char *password,
+                                                        int cancel_fd);
+static backend_result_t nm_dbus_connect_saved_network(const char *uuid,
+                                                      int cancel_fd);
+static backend_result_t nm_dbus_disconnect_network(void);
+static wterm_result_t nm_dbus_rescan_networks(void);
+static wterm_result_t nm_dbus_scan_networks_fresh(network_list_t *networks,
+                                                  int timeout_ms);
+static bool nm_dbus_is_available(void);
+static bool nm_dbus_is_connected(char *connected_ssid, size_t buffer_size);
+static bool nm_dbus_get_ip_address(char *ip_buffer, size_t buffer_size);
+static wterm_result_t nm_dbus_get_connection_status(connection_status_t *status);
+static backend_result_t nm_dbus_start_hotspot(const char *hotspot_name);
+static backend_result_t nm_dbus_stop_hotspot(const char *hotspot_name);
+static backend_result_t nm_dbus_delete_hotspot(const char *hotspot_name);
+static wterm_result_t nm_dbus_get_hotspot_status(const char *hotspot_name,
+                                                 hotspot_status_t *status);
+static wterm_result_t
+nm_dbus_list_active_hotspots(char active_hotspots[][MAX_STR_SSID],
+                             int max_count, int *count);
+static wterm_result_t nm_dbus_check_interface_ap_support(const char *interface,
+                                                         bool *supports_ap);
+static wterm_result_t
+nm_dbus_get_available_wifi_interfaces(char interfaces[][MAX_STR_INTERFACE],
+                                      int max_interfaces, int *interface_count);
+
+// Backend definition. Hotspot creation and client listing are left to nmcli:
+// the former needs nmcli's profile defaults, NM does not track the latter.
+const network_backend_t nm_dbus_backend = {
+    .type = NETMGR_NM_DBUS,
+    .name = "NetworkManager (D-Bus)",
+    .command = NULL,
+    .scan_networks = nm_dbus_scan_networks,
+    .connect_open_network = nm_dbus_connect_open_network,
+    .connect_secured_network = nm_dbus_connect_secured_network,
+    .connect_saved_network = nm_dbus_connect_saved_network,
+    .disconnect_network = nm_dbus_disconnect_network,
+    .rescan_networks = nm_dbus_rescan_networks,
+    .scan_networks_fresh = nm_dbus_scan_networks_fresh,
+    .is_available = nm_dbus_is_available,
+    .is_connected = nm_dbus_is_connected,
+    .get_ip_address = nm_dbus_get_ip_address,
+    .get_connection_status = nm_dbus_get_connection_status,
+    .start_hotspot = nm_dbus_start_hotspot,
+    .stop_hotspot = nm_dbus_stop_hotspot,
+    .delete_hotspot = nm_dbus_delete_hotspot,
+    .get_hotspot_status = nm_dbus_get_hotspot_status,
+    .list_active_hotspots = nm_dbus_list_active_hotspots,
+    .check_interface_ap_support = nm_dbus_check_interface_ap_support,
+    .get_available_wifi_interfaces = nm_dbus_get_available_wifi_interfaces};
+
+// ============================================================================
+// Connection and message helpers (call with nm_bus_lock held)
+// ============================================================================
+
+static DBusConnection *nm_open_bus(void) {
+  const char *bus_name = getenv("WTERM_NM_BUS");
+  DBusBusType bus_type = (bus_name && strcmp(bus_name, "session") == 0)
+                             ? DBUS_BUS_SESSION
+                             : DBUS_BUS_SYSTEM;
+
+  DBusError error;
+  dbus_error_init(&error);
+  DBusConnection *bus = dbus_bus_get_private(bus_type, &error);
+  dbus_error_free(&error);
+
+  if (bus) {
+    dbus_connection_set_exit_on_disconnect(bus, FALSE);
+  }
+  return bus;
+}
+
+static void nm_close_bus(DBusConnection *bus) {
+  dbus_connection_close(bus);
+  dbus_connection_unref(bus);
+}
+
+static DBusConnection *nm_get_bus(void) {
+  if (nm_bus && dbus_connection_get_is_connected(nm_bus)) {
+    return nm_bus;
+  }
+
+  if (nm_bus) {
+    nm_close_bus(nm_bus);
+  }
+  nm_bus = nm_open_bus();
+  return nm_bus;
+}
+
+static DBusMessage *nm_send(DBusMessage *message, char *error_message,
+                            size_t error_size) {
+  DBusConnection *bus = nm_get_bus();
+  if (!bus || !message) {
+    if (message) {
+      dbus_message_unref(message);
+    }
+    if (error_message) {
+      safe_string_copy(error_message, "Cannot connect to NetworkManager",
+                       error_size);
+    }
+    return NULL;
+  }
+
+  DBusError error;
+  dbus_error_init(&error);
+  DBusMessage *reply = dbus_connection_send_with_reply_and_block(
+      bus, message, NM_CALL_TIMEOUT_MS, &error);
+  dbus_message_unref(message);
+
+  if (dbus_error_is_set(&error)) {
+    if (error_message) {
+      safe_string_copy(error_message, error.message, error_size);
+    }
+    dbus_error_free(&error);
+  }
+  return reply;
+}
+
+/**
+ * @brief Call a method with simple arguments (dbus_message_append_args style)
+ */
+static DBusMessage *nm_call(const char *path, const char *iface,
+                            const char *method, int first_arg_type, ...) {
+  DBusMessage *message =
+      dbus_message_new_method_call(NM_DBUS_SERVICE, path, iface, method);
+  if (!message) {
+    return NULL;
+  }
+
+  va_list args;
+  va_start(args, first_arg_type);
+  dbus_bool_t appended =
+      dbus_message_append_args_valist(message, first_arg_type, args);
+  va_end(args);
+
+  if (!appended) {
+    dbus_message_unref(message);
+    return NULL;
+  }
+
+  return nm_send(message, NULL, 0);
+}
+
+/**
+ * @brief Read a property; on success value points into the returned reply
+ */
+static DBusMessage *nm_get_property(const char *path, const char *iface,
+                                    const char *property,
+                                    DBusMessageIter *value) {
+  DBusMessage *reply =
+      nm_call(path, DBUS_IFACE_PROPERTIES, "Get", DBUS_TYPE_STRING, &iface,
+              DBUS_TYPE_STRING, &property, DBUS_TYPE_INVALID);
+  if (!reply) {
+    return NULL;
+  }
+
+  DBusMessageIter iter;
+  if (!dbus_message_iter_init(reply, &iter) ||
+      dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_VARIANT) {
+    dbus_message_unref(reply);
+    return NULL;
+  }
+
+  dbus_message_iter_recurse(&iter, value);
+  return reply;
+}
+
+static bool iter_get_string(DBusMessageIter *iter, char *buffer, size_t size) {
+  int type = dbus_message_iter_get_arg_type(iter);
+  if (type != DBUS_TYPE_STRING && type != DBUS_TYPE_OBJECT_PATH) {
+    return false;
+  }
+
+  const char *value = NULL;
+  dbus_message_iter_get_basic(iter, &value);
+  safe_string_copy(buffer, value ? value : "", size);
+  return true;
+}
+
+static bool iter_get_u32(DBusMessageIter *iter, uint32_t *out) {
+  if (dbus_message_iter_get_arg_type(iter) != DBUS_TYPE_UINT32) {
+    return false;
+  }
+
+  dbus_uint32_t value = 0;
+  dbus_message_iter_get_basic(iter, &value);
+  *out = value;
+  return true;
+}
+
+static bool iter_get_ssid(DBusMessageIter *iter, char *buffer, size_t size) {
+  if (dbus_message_iter_get_arg_type(iter) != DBUS_TYPE_ARRAY ||
+      dbus_message_iter_get_element_type(iter) != DBUS_TYPE_BYTE) {
+    return false;
+  }
+
+  DBusMessageIter bytes;
+  const char *data = NULL;
+  int len = 0;
+  dbus_message_iter_recurse(iter, &bytes);
+  dbus_message_iter_get_fixed_array(&bytes, &data, &len);
+
+  if ((size_t)len >= size) {
+    len = (int)size - 1;
+  }
+  if (len > 0) {
+    memcpy(buffer, data, (size_t)len);
+  }
+  buffer[len < 0 ? 0 : len] = '\0';
+  return true;
+}
+
+static bool nm_get_string_property(const char *path, const char *iface,
+                                   const char *property, char *buffer,
+                                   size_t size) {
+  DBusMessageIter value;
+  DBusMessage *reply = nm_get_property(path, iface, property, &value);
+  if (!reply) {
+    return false;
+  }
+
+  bool ok = iter_get_string(&value, buffer, size);
+  dbus_message_unref(reply);
+  return ok;
+}
+
+static bool nm_get_u32_property(const char *path, const char *iface,
+                                const char *property, uint32_t *out) {
+  DBusMessageIter value;
+  DBusMessage *reply = nm_get_property(path, iface, property, &value);
+  if (!reply) {
+    return false;
+  }
+
+  bool ok = iter_get_u32(&value, out);
+  dbus_message_unref(reply);
+  return ok;
+}
+
+/**
+ * @brief Object paths copied out of an "ao" value, sized to the reply
+ */
+typedef struct {
+  char (*paths)[NM_MAX_PATH];
+  int count;
+} nm_path_list_t;
+
+static void nm_path_list_free(nm_path_list_t *list) {
+  free(list->paths);
+  list->paths = NULL;
+  list->count = 0;
+}
+
+static bool iter_get_paths(DBusMessageIter *iter, nm_path_list_t *list) {
+  list->paths = NULL;
+  list->count = 0;
+  if (dbus_message_iter_get_arg_type(iter) != DBUS_TYPE_ARRAY) {
+    return true;
+  }
+
+  int capacity = 0;
+  DBusMessageIter element;
+  dbus_message_iter_recurse(iter, &element);
+  while (dbus_message_iter_get_arg_type(&element) == DBUS_TYPE_OBJECT_PATH) {
+    if (list->count == capacity) {
+      int grown = capacity ? capacity * 2 : 16;
+      char(*paths)[NM_MAX_PATH] =
+          realloc(list->paths, (size_t)grown * sizeof(*paths));
+      if (!paths) {
+        nm_path_list_free(list);
+        return false;
+      }
+      list->paths = paths;
+      capacity = grown;
+    }
+    iter_get_string(&element, list->paths[list->count], NM_MAX_PATH);
+    list->count++;
+    dbus_message_iter_next(&element);
+  }
+  return true;
+}
+
+/**
+ * @brief Call a method returning "ao" and copy the paths out
+ * @return false if the call failed; release the list with nm_path_list_free()
+ */
+static bool nm_call_get_paths(const char *path, const char *iface,
+                              const char *method, nm_path_list_t *list) {
+  list->paths = NULL;
+  list->count = 0;
+  DBusMessage *reply = nm_call(path, iface, method, DBUS_TYPE_INVALID);
+  if (!reply) {
+    return false;
+  }
+
+  DBusMessageIter iter;
+  bool ok = !dbus_message_iter_init(reply, &iter) ||
+            iter_get_paths(&iter, list);
+  dbus_message_unref(reply);
+  return ok;
+}
+
+/**
+ * @brief Read an "ao" property into a path list
+ */
+static bool nm_get_paths_property(const char *path, const char *iface,
+                                  const char *property, nm_path_list_t *list) {
+  list->paths = NULL;
+  list->count = 0;
+  DBusMessageIter value;
+  DBusMessage *reply = nm_get_property(path, iface, property, &value);
+  if (!reply) {
+    return false;
+  }
+
+  bool ok = iter_get_paths(&value, list);
+  dbus_message_unref(reply);
+  return ok;
+}
+
+static bool is_null_path(const char *path) {
+  return path[0] == '\0' || strcmp(path, "/") == 0;
+}
+
+// ============================================================================
+// Settings dictionaries (a{sa{sv}})
+// ============================================================================
+
+static void dict_append_entry(DBusMessageIter *dict, const char *key, int type,
+                              const char *signature, const void *value) {
+  DBusMessageIter entry, variant;
+  dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+  dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, signature,
+                                   &variant);
+  dbus_message_iter_append_basic(&variant, type, value);
+  dbus_message_iter_close_container(&entry, &variant);
+  dbus_message_iter_close_container(dict, &entry);
+}
+
+static void dict_append_string(DBusMessageIter *dict, const char *key,
+                               const char *value) {
+  dict_append_entry(dict, key, DBUS_TYPE_STRING, DBUS_TYPE_STRING_AS_STRING,
+                    &value);
+}
+
+static void dict_append_bytes(DBusMessageIter *dict, const char *key,
+                              const char *data, int len) {
+  DBusMessageIter entry, variant, array;
+  dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+  dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, "ay", &variant);
+  dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY,
+                                   DBUS_TYPE_BYTE_AS_STRING, &array);
+  dbus_message_iter_append_fixed_array(&array, DBUS_TYPE_BYTE, &data, len);
+  dbus_message_iter_close_container(&variant, &array);
+  dbus_message_iter_close_container(&entry, &variant);
+  dbus_message_iter_close_container(dict, &entry);
+}
+
+static void settings_open_group(DBusMessageIter *settings, const char *group,
+                                DBusMessageIter *entry,
+                                DBusMessageIter *dict) {
+  dbus_message_iter_open_container(settings, DBUS_TYPE_DICT_ENTRY, NULL, entry);
+  dbus_message_iter_append_basic(entry, DBUS_TYPE_STRING, &group);
+  dbus_message_iter_open_container(entry, DBUS_TYPE_ARRAY, "{sv}", dict);
+}
+
+static void settings_close_group(DBusMessageIter *settings,
+                                 DBusMessageIter *entry,
+                                 DBusMessageIter *dict) {
+  dbus_message_iter_close_container(entry, dict);
+  dbus_message_iter_close_container(settings, entry);
+}
+
+/**
+ * @brief Find a setting value in a GetSettings reply
+ * @return true with value positioned at the variant contents
+ */
+static bool settings_lookup(DBusMessage *reply, const char *group,
+                            const char *key, DBusMessageIter *value) {
+  DBusMessageIter iter, groups;
+  if (!dbus_message_iter_init(reply, &iter) ||
+      dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_ARRAY) {
+    return false;
+  }
+
+  dbus_message_iter_recurse(&iter, &groups);
+  while (dbus_message_iter_get_arg_type(&groups) == DBUS_TYPE_DICT_ENTRY) {
+    DBusMessageIter group_entry, entries;
+    const char *group_name = NULL;
+    dbus_message_iter_recurse(&groups, &group_entry);
+    dbus_message_iter_get_basic(&group_entry, &group_name);
+
+    if (group_name && strcmp(group_name, group) == 0 &&
+        dbus_message_iter_next(&group_entry)) {
+      dbus_message_iter_recurse(&group_entry, &entries);
+      while (dbus_message_iter_get_arg_type(&entries) == DBUS_TYPE_DICT_ENTRY) {
+        DBusMessageIter entry;
+        const char *entry_key = NULL;
+        dbus_message_iter_recurse(&entries, &entry);
+        dbus_message_iter_get_basic(&entry, &entry_key);
+        if (entry_key && strcmp(entry_key, key) == 0 &&
+            dbus_message_iter_next(&entry)) {
+          dbus_message_iter_recurse(&entry, value);
+          return true;
+        }
+        dbus_message_iter_next(&entries);
+      }
+      return false;
+    }
+    dbus_message_iter_next(&groups);
+  }
+  return false;
+}
+
+static bool connection_get_setting(const char *connection_path,
+                                   const char *group, const char *key,
+                                   char *buffer, size_t size) {
+  DBusMessage *reply = nm_call(connection_path, NM_DBUS_IFACE_CONNECTION,
+                               "GetSettings", DBUS_TYPE_INVALID);
+  if (!reply) {
+    return false;
+  }
+
+  DBusMessageIter value;
+  bool found = settings_lookup(reply, group, key, &value) &&
+               iter_get_string(&value, buffer, size);
+  dbus_message_unref(reply);
+  return found;
+}
+
+/**
+ * @brief Find a saved profile by its connection.id
+ *
+ * Every GetSettings call is queued before the first reply is read, so the
+ * lookup costs one round trip however many profiles are saved.
+ */
+static bool find_connection_by_id(const char *id, char *path, size_t size) {
+  nm_path_list_t connections;
+  if (!nm_call_get_paths(NM_DBUS_PATH_SETTINGS, NM_DBUS_IFACE_SETTINGS,
+                         "ListConnections", &connections) ||
+      connections.count == 0) {
+    nm_path_list_free(&connections);
+    return false;
+  }
+
+  DBusConnection *bus = nm_get_bus();
+  DBusPendingCall **pending =
+      bus ? calloc((size_t)connections.count, sizeof(*pending)) : NULL;
+  if (!pending) {
+    nm_path_list_free(&connections);
+    return false;
+  }
+
+  for (int i = 0; i < connections.count; i++) {
+    DBusMessage *message = dbus_message_new_method_call(
+        NM_DBUS_SERVICE, connections.paths[i], NM_DBUS_IFACE_CONNECTION,
+        "GetSettings");
+    if (message) {
+      dbus_connection_send_with_reply(bus, message, &pending[i],
+                                      NM_CALL_TIMEOUT_MS);
+      dbus_message_unref(message);
+    }
+  }
+  dbus_connection_flush(bus);
+
+  bool found = false;
+  for (int i = 0; i < connections.count; i++) {
+    if (!pending[i]) {
+      continue;
+    }
+    if (found) {
+      dbus_pending_call_cancel(pending[i]);
+      dbus_pending_call_unref(pending[i]);
+      continue;
+    }
+
+    dbus_pending_call_block(pending[i]);
+    DBusMessage *reply = dbus_pending_call_steal_reply(pending[i]);
+    dbus_pending_call_unref(pending[i]);
+    if (!reply) {
+      continue;
+    }
+
+    DBusMessageIter value;
+    char connection_id[256];
+    if (dbus_message_get_type(reply) == DBUS_MESSAGE_TYPE_METHOD_RETURN &&
+        settings_lookup(reply, "connection", "id", &value) &&
+        iter_get_string(&value, connection_id, sizeof(connection_id)) &&
+        strcmp(connection_id, id) == 0) {
+      safe_string_copy(path, connections.paths[i], size);
+      found = true;
+    }
+    dbus_message_unref(reply);
+  }
+
+  free(pending);
+  nm_path_list_free(&connections);
+  return found;
+}
+
+static bool find_active_connection_by_id(const char *id, char *path,
+                                         size_t size) {
+  nm_path_list_t active;
+  if (!nm_get_paths_property(NM_DBUS_PATH, NM_DBUS_IFACE, "ActiveConnections",
+                             &active)) {
+    return false;
+  }
+
+  bool found = false;
+  for (int i = 0; i < active.count && !found; i++) {
+    char active_id[256];
+    if (nm_get_string_property(active.paths[i], NM_DBUS_IFACE_ACTIVE, "Id",
+                               active_id, sizeof(active_id)) &&
+        strcmp(active_id, id) == 0) {
+      safe_string_copy(path, active.paths[i], size);
+      found = true;
+    }
+  }
+  nm_path_list_free(&active);
+  return found;
+}
+
+// ============================================================================
+// Devices and access points
+// ============================================================================
+
+static bool find_wifi_device(char *path, size_t size) {
+  nm_path_list_t devices;
+  nm_call_get_paths(NM_DBUS_PATH, NM_DBUS_IFACE, "GetDevices", &devices);
+
+  bool found = false;
+  for (int i = 0; i < devices.count && !found; i++) {
+    uint32_t type = 0;
+    if (nm_get_u32_property(devices.paths[i], NM_DBUS_IFACE_DEVICE,
+                            "DeviceType", &type) &&
+        type == NM_DEVICE_TYPE_WIFI) {
+      safe_string_copy(path, devices.paths[i], size);
+      found = true;
+    }
+  }
+  nm_path_list_free(&devices);
+  return found;
+}
+
+typedef struct {
+  char ssid[MAX_STR_SSID];
+  uint8_t strength;
+  uint32_t flags;
+  uint32_t wpa_flags;
+  uint32_t rsn_flags;
+  char hw_address[MAX_STR_MAC_ADDR];
+  uint32_t frequency;   // MHz
+  uint32_t max_bitrate; // kbit/s
+} nm_ap_info_t;
+
+static void parse_access_point(DBusMessage *reply, nm_ap_info_t *ap) {
+  memset(ap, 0, sizeof(*ap));
+
+  DBusMessageIter iter, props;
+  if (dbus_message_iter_init(reply, &iter) &&
+      dbus_message_iter_get_arg_type(&iter) == DBUS_TYPE_ARRAY) {
+    dbus_message_iter_recurse(&iter, &props);
+    while (dbus_message_iter_get_arg_type(&props) == DBUS_TYPE_DICT_ENTRY) {
+      DBusMessageIter entry, value;
+      const char *key = NULL;
+      dbus_message_iter_recurse(&props, &entry);
+      dbus_message_iter_get_basic(&entry, &key);
+      dbus_message_iter_next(&entry);
+      dbus_message_iter_recurse(&entry, &value);
+
+      if (strcmp(key, "Ssid") == 0) {
+        iter_get_ssid(&value, ap->ssid, sizeof(ap->ssid));
+      } else if (strcmp(key, "Strength") == 0 &&
+                 dbus_message_iter_get_arg_type(&value) == DBUS_TYPE_BYTE) {
+        dbus_message_iter_get_basic(&value, &ap->strength);
+      } else if (strcmp(key, "Flags") == 0) {
+        iter_get_u32(&value, &ap->flags);
+      } else if (strcmp(key, "WpaFlags") == 0) {
+        iter_get_u32(&value, &ap->wpa_flags);
+      } else if (strcmp(key, "RsnFlags") == 0) {
+        iter_get_u32(&value, &ap->rsn_flags);
+      } else if (strcmp(key, "HwAddress") == 0) {
+        iter_get_string(&value, ap->hw_address, sizeof(ap->hw_address));
+      } else if (strcmp(key, "Frequency") == 0) {
+        iter_get_u32(&value, &ap->frequency);
+      } else if (strcmp(key, "MaxBitrate") == 0) {
+        iter_get_u32(&value, &ap->max_bitrate);
+      }
+      dbus_message_iter_next(&props);
+    }
+  }
+}
+
+/**
+ * @brief Read the properties of every access point in a list
+ *
+ * Every GetAll call is queued before the first reply is read, as in
+ * find_connection_by_id, so a scan costs one round trip however many
+ * BSSIDs are in range.
+ *
+ * @return aps->count entries, or NULL; an access point whose call failed
+ *         is left zeroed (empty SSID)
+ */
+static nm_ap_info_t *get_access_points(const nm_path_list_t *aps) {
+  DBusConnection *bus = nm_get_bus();
+  nm_ap_info_t *infos =
+      bus ? calloc((size_t)aps->count + 1, sizeof(*infos)) : NULL;
+  DBusPendingCall **pending =
+      infos ? calloc((size_t)aps->count + 1, sizeof(*pending)) : NULL;
+  if (!pending) {
+    free(infos);
+    return NULL;
+  }
+
+  const char *iface = NM_DBUS_IFACE_AP;
+  for (int i = 0; i < aps->count; i++) {
+    DBusMessage *message = dbus_message_new_method_call(
+        NM_DBUS_SERVICE, aps->paths[i], DBUS_IFACE_PROPERTIES, "GetAll");
+    if (message) {
+      if (dbus_message_append_args(message, DBUS_TYPE_STRING, &iface,
+                                   DBUS_TYPE_INVALID)) {
+        dbus_connection_send_with_reply(bus, message, &pending[i],
+                                        NM_CALL_TIMEOUT_MS);
+      }
+      dbus_message_unref(message);
+    }
+  }
+  dbus_connection_flush(bus);
+
+  for (int i = 0; i < aps->count; i++) {
+    if (!pending[i]) {
+      continue;
+    }
+
+    dbus_pending_call_block(pending[i]);
+    DBusMessage *reply = dbus_pending_call_steal_reply(pending[i]);
+    dbus_pending_call_unref(pending[i]);
+    if (!reply) {
+      continue;
+    }
+    if (dbus_message_get_type(reply) == DBUS_MESSAGE_TYPE_METHOD_RETURN) {
+      parse_access_point(reply, &infos[i]);
+    }
+    dbus_message_unref(reply);
+  }
+
+  free(pending);
+  return infos;
+}
+
+// Same wording and order as nmcli's SECURITY column
+static void ap_security_string(const nm_ap_info_t *ap, char *buffer,
+                               size_t size) {
+  char parts[64] = {0};
+  size_t used = 0;
+
+  if ((ap->flags & NM_802_11_AP_FLAGS_PRIVACY) && ap->wpa_flags == 0 &&
+      ap->rsn_flags == 0) {
+    used += (size_t)snprintf(parts + used, sizeof(parts) - used, "WEP ");
+  }
+  if (ap->wpa_flags != 0) {
+    used += (size_t)snprintf(parts + used, sizeof(parts) - used, "WPA1 ");
+  }
+  if (ap->rsn_flags &
+      (NM_802_11_AP_SEC_KEY_MGMT_PSK | NM_802_11_AP_SEC_KEY_MGMT_802_1X)) {
+    used += (size_t)snprintf(parts + used, sizeof(parts) - used, "WPA2 ");
+  }
+  if (ap->rsn_flags & NM_802_11_AP_SEC_KEY_MGMT_SAE) {
+    used += (size_t)snprintf(parts + used, sizeof(parts) - used, "WPA3 ");
+  }
+  if (ap->rsn_flags & NM_802_11_AP_SEC_KEY_MGMT_OWE) {
+    used += (size_t)snprintf(parts + used, sizeof(parts) - used, "OWE ");
+  }
+  if ((ap->wpa_flags | ap->rsn_flags) & NM_802_11_AP_SEC_KEY_MGMT_802_1X) {
+    snprintf(parts + used, sizeof(parts) - used, "802.1X ");
+  }
+
+  trim_trailing_whitespace(parts);
+  safe_string_copy(buffer, parts[0] ? parts : "Open", size);
+}
+
+/**
+ * @brief Strongest access point broadcasting an SSID
+ * @param info Optional; receives that access point's properties
+ */
+static bool find_access_point(const char *device_path, const char *ssid,
+                              char *ap_path, size_t size, nm_ap_info_t *info) {
+  nm_path_list_t aps;
+  nm_call_get_paths(device_path, NM_DBUS_IFACE_WIRELESS, "GetAllAccessPoints",
+                    &aps);
+  nm_ap_info_t *infos = get_access_points(&aps);
+
+  int best_strength = -1;
+  for (int i = 0; infos && i < aps.count; i++) {
+    if (infos[i].ssid[0] != '\0' && strcmp(infos[i].ssid, ssid) == 0 &&
+        infos[i].strength > best_strength) {
+      best_strength = infos[i].strength;
+      safe_string_copy(ap_path, aps.paths[i], size);
+      if (info) {
+        *info = infos[i];
+      }
+    }
+  }
+  free(infos);
+  nm_path_list_free(&aps);
+  return best_strength >= 0;
+}
+
+// ============================================================================
+// Activation
+// ============================================================================
+
+#define NM_ACTIVE_STATE_MATCH                                                  \
+  "type='signal',sender='" NM_DBUS_SERVICE "',interface='" NM_DBUS_IFACE_ACTIVE \
+  "',member='StateChanged'"
+
+static const char *activation_reason_string(uint32_t reason) {
+  switch (reason) {
+  case 5:
+    return "IP configuration could not be reserved";
+  case 6:
+    return "The connection attempt timed out";
+  case 9:
+    return "Secrets were required, but not provided";
+  case 10:
+    return "Authentication failed";
+  case 11:
+    return "The connection was removed";
+  case 14:
+    return "The device was removed";
+  default:
+    return "Connection activation failed";
+  }
+}
+
+static long long monotonic_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static backend_result_t deactivate_connection(const char *active_path) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+
+  DBusMessage *reply = nm_call(NM_DBUS_PATH, NM_DBUS_IFACE,
+                               "DeactivateConnection", DBUS_TYPE_OBJECT_PATH,
+                               &active_path, DBUS_TYPE_INVALID);
+  if (reply) {
+    dbus_message_unref(reply);
+  } else {
+    result.result = WTERM_ERROR_NETWORK;
+    safe_string_copy(result.error_message, "Failed to deactivate connection",
+                     sizeof(result.error_message));
+  }
+  return result;
+}
+
+/**
+ * @brief Connection that receives the StateChanged signals of activations
+ *
+ * The match is installed before returning, so no transition after the
+ * activation call can be lost.
+ */
+static DBusConnection *open_signal_bus(void) {
+  DBusConnection *bus = nm_open_bus();
+  if (!bus) {
+    return NULL;
+  }
+
+  DBusError error;
+  dbus_error_init(&error);
+  dbus_bus_add_match(bus, NM_ACTIVE_STATE_MATCH, &error);
+  if (dbus_error_is_set(&error)) {
+    dbus_error_free(&error);
+    nm_close_bus(bus);
+    return NULL;
+  }
+  return bus;
+}
+
+/**
+ * @brief Follow an active connection until it is ACTIVATED or DEACTIVATED
+ *
+ * Runs without nm_bus_lock: only the private signal connection is used.
+ *
+ * @return WTERM_SUCCESS once *state is final, WTERM_ERROR_TIMEOUT,
+ *         WTERM_ERROR_CANCELLED, or WTERM_ERROR_NETWORK if the bus went away
+ */
+static wterm_result_t wait_for_activation(DBusConnection *bus,
+                                          const char *active_path,
+                                          uint32_t *state, uint32_t *reason,
+                                          int timeout_ms, int cancel_fd) {
+  int bus_fd = -1;
+  if (!dbus_connection_get_unix_fd(bus, &bus_fd)) {
+    return WTERM_ERROR_NETWORK;
+  }
+
+  long long deadline = monotonic_ms() + timeout_ms;
+  while (*state != NM_ACTIVE_CONNECTION_STATE_ACTIVATED &&
+         *state != NM_ACTIVE_CONNECTION_STATE_DEACTIVATED) {
+    DBusMessage *message = dbus_connection_pop_message(bus);
+    if (message) {
+      const char *path = dbus_message_get_path(message);
+      dbus_uint32_t new_state = 0, new_reason = 0;
+
+      if (dbus_message_is_signal(message, NM_DBUS_IFACE_ACTIVE,
+                                 "StateChanged") &&
+          path && strcmp(path, active_path) == 0 &&
+          dbus_message_get_args(message, NULL, DBUS_TYPE_UINT32, &new_state,
+                                DBUS_TYPE_UINT32, &new_reason,
+                                DBUS_TYPE_INVALID)) {
+        *state = new_state;
+        *reason = new_reason;
+      }
+      dbus_message_unref(message);
+      continue;
+    }
+
+    long long remaining = deadline - monotonic_ms();
+    if (remaining <= 0) {
+      return WTERM_ERROR_TIMEOUT;
+    }
+
+    struct pollfd pfds[2] = {{.fd = bus_fd, .events = POLLIN},
+                             {.fd = cancel_fd, .events = POLLIN}};
+    int ready = poll(pfds, cancel_fd >= 0 ? 2 : 1, (int)remaining);
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return WTERM_ERROR_NETWORK;
+    }
+    if (cancel_fd >= 0 && (pfds[1].revents & POLLIN)) {
+      return WTERM_ERROR_CANCELLED;
+    }
+    if (ready > 0 && !dbus_connection_read_write(bus, 0)) {
+      return WTERM_ERROR_NETWORK; // Disconnected
+    }
+  }
+  return WTERM_SUCCESS;
+}
+
+/**
+ * @brief Send an activation request and wait for the result
+ *
+ * Call with nm_bus_lock held. The lock is released while waiting for the
+ * activation, which can take up to NM_ACTIVATION_TIMEOUT_MS, and held again
+ * on return. When cancel_fd becomes readable the activation is abandoned.
+ *
+ * @param message AddAndActivateConnection or ActivateConnection call
+ * @param cancel_fd Descriptor that cancels the wait (<0 for none)
+ */
+static backend_result_t activate_and_wait(DBusMessage *message, int cancel_fd) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+
+  DBusConnection *signals = open_signal_bus();
+  if (!signals || !nm_get_bus()) {
+    if (signals) {
+      nm_close_bus(signals);
+    }
+    dbus_message_unref(message);
+    result.result = WTERM_ERROR_NETWORK;
+    safe_string_copy(result.error_message, "Cannot connect to NetworkManager",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  bool add_and_activate =
+      dbus_message_has_member(message, "AddAndActivateConnection");
+  DBusMessage *reply = nm_send(message, result.error_message,
+                               sizeof(result.error_message));
+
+  const char *connection_path = NULL;
+  const char *active_path = NULL;
+  bool parsed = false;
+  if (reply) {
+    parsed = add_and_activate
+                 ? dbus_message_get_args(reply, NULL, DBUS_TYPE_OBJECT_PATH,
+                                         &connection_path,
+                                         DBUS_TYPE_OBJECT_PATH, &active_path,
+                                         DBUS_TYPE_INVALID)
+                 : dbus_message_get_args(reply, NULL, DBUS_TYPE_OBJECT_PATH,
+                                         &active_path, DBUS_TYPE_INVALID);
+  }
+
+  char active[NM_MAX_PATH] = {0};
+  if (parsed) {
+    safe_string_copy(active, active_path, sizeof(active));
+  }
+  if (reply) {
+    dbus_message_unref(reply);
+  }
+  if (!parsed) {
+    nm_close_bus(signals);
+    result.result = WTERM_ERROR_NETWORK;
+    if (result.error_message[0] == '\0') {
+      safe_string_copy(result.error_message, "Connection activation failed",
+                       sizeof(result.error_message));
+    }
+    return result;
+  }
+
+  uint32_t state = 0;
+  uint32_t reason = 0;
+  nm_get_u32_property(active, NM_DBUS_IFACE_ACTIVE, "State", &state);
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  wterm_result_t waited = wait_for_activation(
+      signals, active, &state, &reason, NM_ACTIVATION_TIMEOUT_MS, cancel_fd);
+  pthread_mutex_lock(&nm_bus_lock);
+  nm_close_bus(signals);
+
+  if (waited == WTERM_ERROR_CANCELLED) {
+    deactivate_connection(active); // Ignore errors: it may have just failed
+    result.result = WTERM_ERROR_CANCELLED;
+    safe_string_copy(result.error_message, "Connection cancelled by user",
+                     sizeof(result.error_message));
+  } else if (state != NM_ACTIVE_CONNECTION_STATE_ACTIVATED) {
+    result.result = WTERM_ERROR_NETWORK;
+    safe_string_copy(result.error_message,
+                     state == NM_ACTIVE_CONNECTION_STATE_DEACTIVATED
+                         ? activation_reason_string(reason)
+                         : "Timeout waiting for connection activation",
+                     sizeof(result.error_message));
+  }
+  return result;
+}
+
+static backend_result_t activate_profile(const char *connection_path,
+                                         const char *device_path,
+                                         int cancel_fd) {
+  DBusMessage *message = dbus_message_new_method_call(
+      NM_DBUS_SERVICE, NM_DBUS_PATH, NM_DBUS_IFACE, "ActivateConnection");
+  if (!message) {
+    backend_result_t result = {.result = WTERM_ERROR_MEMORY};
+    safe_string_copy(result.error_message, "Out of memory",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  const char *specific_object = "/";
+  dbus_message_append_args(message, DBUS_TYPE_OBJECT_PATH, &connection_path,
+                           DBUS_TYPE_OBJECT_PATH, &device_path,
+                           DBUS_TYPE_OBJECT_PATH, &specific_object,
+                           DBUS_TYPE_INVALID);
+  return activate_and_wait(message, cancel_fd);
+}
+
+static backend_result_t connect_wifi(const char *ssid, const char *password,
+                                     int cancel_fd) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+
+  char device[NM_MAX_PATH];
+  if (!find_wifi_device(device, sizeof(device))) {
+    result.result = WTERM_ERROR_INTERFACE;
+    safe_string_copy(result.error_message, "No Wi-Fi device found",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  // Reuse a saved profile when no new credentials are supplied
+  char connection[NM_MAX_PATH];
+  if (!password && find_connection_by_id(ssid, connection, sizeof(connection))) {
+    return activate_profile(connection, device, cancel_fd);
+  }
+
+  char ap[NM_MAX_PATH];
+  nm_ap_info_t ap_info;
+  if (!find_access_point(device, ssid, ap, sizeof(ap), &ap_info)) {
+    result.result = WTERM_ERROR_NETWORK;
+    snprintf(result.error_message, sizeof(result.error_message),
+             "No network with SSID '%s' found.", ssid);
+    return result;
+  }
+
+  DBusMessage *message = dbus_message_new_method_call(
+      NM_DBUS_SERVICE, NM_DBUS_PATH, NM_DBUS_IFACE, "AddAndActivateConnection");
+  if (!message) {
+    result.result = WTERM_ERROR_MEMORY;
+    safe_string_copy(result.error_message, "Out of memory",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  DBusMessageIter args, settings, entry, dict;
+  dbus_message_iter_init_append(message, &args);
+  dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sa{sv}}",
+                                   &settings);
+
+  settings_open_group(&settings, "connection", &entry, &dict);
+  dict_append_string(&dict, "id", ssid);
+  dict_append_string(&dict, "type", "802-11-wireless");
+  settings_close_group(&settings, &entry, &dict);
+
+  settings_open_group(&settings, "802-11-wireless", &entry, &dict);
+  dict_append_bytes(&dict, "ssid", ssid, (int)strlen(ssid));
+  settings_close_group(&settings, &entry, &dict);
+
+  if (password) {
+    settings_open_group(&settings, "802-11-wireless-security", &entry, &dict);
+    // WPA3-only networks need SAE; with neither flag NetworkManager infers
+    // the key management from the access point itself
+    if ((ap_info.wpa_flags | ap_info.rsn_flags) &
+        NM_802_11_AP_SEC_KEY_MGMT_PSK) {
+      dict_append_string(&dict, "key-mgmt", "wpa-psk");
+    } else if (ap_info.rsn_flags & NM_802_11_AP_SEC_KEY_MGMT_SAE) {
+      dict_append_string(&dict, "key-mgmt", "sae");
+    }
+    dict_append_string(&dict, "psk", password);
+    settings_close_group(&settings, &entry, &dict);
+  }
+
+  dbus_message_iter_close_container(&args, &settings);
+
+  const char *device_path = device;
+  const char *ap_path = ap;
+  dbus_message_iter_append_basic(&args, DBUS_TYPE_OBJECT_PATH, &device_path);
+  dbus_message_iter_append_basic(&args, DBUS_TYPE_OBJECT_PATH, &ap_path);
+
+  return activate_and_wait(message, cancel_fd);
+}
+
+// ============================================================================
+// Backend operations
+// ============================================================================
+
+static bool nm_dbus_is_available(void) {
+  pthread_mutex_lock(&nm_bus_lock);
+
+  bool available = false;
+  DBusConnection *bus = nm_get_bus();
+  if (bus) {
+    available = dbus_bus_name_has_owner(bus, NM_DBUS_SERVICE, NULL);
+  }
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  return available;
+}
+
+static wterm_result_t nm_dbus_scan_networks(network_list_t *networks) {
+  if (!networks) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  network_list_clear(networks);
+  pthread_mutex_lock(&nm_bus_lock);
+
+  char device[NM_MAX_PATH];
+  if (!find_wifi_device(device, sizeof(device))) {
+    pthread_mutex_unlock(&nm_bus_lock);
+    return WTERM_ERROR_INTERFACE;
+  }
+
+  nm_path_list_t aps;
+  if (!nm_call_get_paths(device, NM_DBUS_IFACE_WIRELESS, "GetAllAccessPoints",
+                         &aps)) {
+    pthread_mutex_unlock(&nm_bus_lock);
+    return WTERM_ERROR_NETWORK;
+  }
+
+  // Dense deployments list hundreds of BSSIDs; fetch them all at once
+  nm_ap_info_t *infos = get_access_points(&aps);
+  wterm_result_t result = infos ? WTERM_SUCCESS : WTERM_ERROR_MEMORY;
+  for (int i = 0; infos && i < aps.count; i++) {
+    const nm_ap_info_t *ap = &infos[i];
+    if (ap->ssid[0] == '\0') {
+      continue; // Hidden, or its properties could not be read
+    }
+
+    network_info_t *network = network_list_append(networks);
+    if (!network) {
+      result = WTERM_ERROR_MEMORY;
+      break;
+    }
+    safe_string_copy(network->ssid, ap->ssid, MAX_STR_SSID);
+    ap_security_string(ap, network->security, MAX_STR_SECURITY);
+    snprintf(network->signal, MAX_STR_SIGNAL, "%u", (unsigned)ap->strength);
+
+    // NetworkManager does not expose dBm for access points
+    scan_record_t record = {
+        .frequency = (uint16_t)ap->frequency,
+        .channel = network_frequency_to_channel(ap->frequency),
+        .quality = ap->strength,
+        .security_flags = network_security_flags(network->security),
+        .max_rate = (uint16_t)(ap->max_bitrate / 1000)};
+    network_parse_bssid(ap->hw_address, record.bssid);
+    network_list_set_record(networks, networks->count - 1, &record);
+  }
+
+  free(infos);
+  nm_path_list_free(&aps);
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+static wterm_result_t request_scan(const char *device) {
+  DBusMessage *message = dbus_message_new_method_call(
+      NM_DBUS_SERVICE, device, NM_DBUS_IFACE_WIRELESS, "RequestScan");
+  if (message) {
+    DBusMessageIter args, options;
+    dbus_message_iter_init_append(message, &args);
+    dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sv}",
+                                     &options);
+    dbus_message_iter_close_container(&args, &options);
+  }
+
+  DBusMessage *reply = nm_send(message, NULL, 0);
+  if (!reply) {
+    return WTERM_ERROR_NETWORK;
+  }
+  dbus_message_unref(reply);
+  return WTERM_SUCCESS;
+}
+
+// LastScan: CLOCK_BOOTTIME ms of the last completed scan (NetworkManager 1.12+)
+static bool get_last_scan(const char *device, int64_t *last_scan) {
+  DBusMessageIter value;
+  DBusMessage *reply =
+      nm_get_property(device, NM_DBUS_IFACE_WIRELESS, "LastScan", &value);
+  if (!reply) {
+    return false;
+  }
+
+  bool ok = dbus_message_iter_get_arg_type(&value) == DBUS_TYPE_INT64;
+  if (ok) {
+    dbus_int64_t scan_time = 0;
+    dbus_message_iter_get_basic(&value, &scan_time);
+    *last_scan = scan_time;
+  }
+  dbus_message_unref(reply);
+  return ok;
+}
+
+static wterm_result_t nm_dbus_rescan_networks(void) {
+  pthread_mutex_lock(&nm_bus_lock);
+
+  wterm_result_t result = WTERM_ERROR_INTERFACE;
+  char device[NM_MAX_PATH];
+  if (find_wifi_device(device, sizeof(device))) {
+    result = request_scan(device);
+  }
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+static wterm_result_t nm_dbus_scan_networks_fresh(network_list_t *networks,
+                                                  int timeout_ms) {
+  if (!networks || timeout_ms <= 0) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+  char device[NM_MAX_PATH];
+  if (!find_wifi_device(device, sizeof(device))) {
+    pthread_mutex_unlock(&nm_bus_lock);
+    return WTERM_ERROR_INTERFACE;
+  }
+
+  // The scan is complete once LastScan moves. NetworkManager refuses
+  // requests right after a previous scan; those results are served stale.
+  int64_t requested_after = 0;
+  bool fresh = false;
+  if (get_last_scan(device, &requested_after) &&
+      request_scan(device) == WTERM_SUCCESS) {
+    long long deadline = monotonic_ms() + timeout_ms;
+    while (!fresh) {
+      long long remaining = deadline - monotonic_ms();
+      if (remaining <= 0) {
+        break;
+      }
+
+      // Poll with the bus unlocked so other callers are not held up
+      pthread_mutex_unlock(&nm_bus_lock);
+      long long delay_ms = remaining < NM_SCAN_POLL_MS ? remaining : NM_SCAN_POLL_MS;
+      struct timespec delay = {0, (long)delay_ms * 1000000L};
+      nanosleep(&delay, NULL);
+      pthread_mutex_lock(&nm_bus_lock);
+
+      int64_t last_scan = 0;
+      fresh = get_last_scan(device, &last_scan) && last_scan != requested_after;
+    }
+  }
+  pthread_mutex_unlock(&nm_bus_lock);
+
+  wterm_result_t result = nm_dbus_scan_networks(networks);
+  networks->is_stale = !fresh;
+  return result;
+}
+
+static backend_result_t nm_dbus_connect_open_network(const char *ssid,
+                                                     int cancel_fd) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+
+  if (!ssid) {
+    result.result = WTERM_ERROR_INVALID_INPUT;
+    safe_string_copy(result.error_message, "Invalid SSID",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  if (!validate_ssid(ssid)) {
+    result.result = WTERM_ERROR_INVALID_INPUT;
+    safe_string_copy(result.error_message,
+                     "SSID contains invalid characters or length",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+  result = connect_wifi(ssid, NULL, cancel_fd);
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+static backend_result_t nm_dbus_connect_secured_network(const char *ssid,
+                                                        const char *password,
+                                                        int cancel_fd) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+
+  if (!ssid || !password) {
+    result.result = WTERM_ERROR_INVALID_INPUT;
+    safe_string_copy(result.error_message, "Invalid SSID or password",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  if (!validate_ssid(ssid)) {
+    result.result = WTERM_ERROR_INVALID_INPUT;
+    safe_string_copy(result.error_message,
+                     "SSID contains invalid characters or length",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+  result = connect_wifi(ssid, password, cancel_fd);
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+static backend_result_t nm_dbus_connect_saved_network(const char *uuid,
+                                                      int cancel_fd) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+
+  if (!uuid || uuid[0] == '\0') {
+    result.result = WTERM_ERROR_INVALID_INPUT;
+    safe_string_copy(result.error_message, "Invalid connection UUID",
+                     sizeof(result.error_message));
+    return result;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+
+  char device[NM_MAX_PATH];
+  const char *connection = NULL;
+  DBusMessage *reply = NULL;
+  if (!find_wifi_device(device, sizeof(device))) {
+    result.result = WTERM_ERROR_INTERFACE;
+    safe_string_copy(result.error_message, "No Wi-Fi device found",
+                     sizeof(result.error_message));
+  } else {
+    DBusMessage *message = dbus_message_new_method_call(
+        NM_DBUS_SERVICE, NM_DBUS_PATH_SETTINGS, NM_DBUS_IFACE_SETTINGS,
+        "GetConnectionByUuid");
+    if (message) {
+      dbus_message_append_args(message, DBUS_TYPE_STRING, &uuid,
+                               DBUS_TYPE_INVALID);
+    }
+    reply = nm_send(message, result.error_message,
+                    sizeof(result.error_message));
+    if (!reply ||
+        !dbus_message_get_args(reply, NULL, DBUS_TYPE_OBJECT_PATH, &connection,
+                               DBUS_TYPE_INVALID)) {
+      result.result = WTERM_ERROR_NETWORK;
+      if (result.error_message[0] == '\0') {
+        safe_string_copy(result.error_message, "Connection profile not found",
+                         sizeof(result.error_message));
+      }
+    } else {
+      char path[NM_MAX_PATH];
+      safe_string_copy(path, connection, sizeof(path));
+      dbus_message_unref(reply);
+      reply = NULL;
+      result = activate_profile(path, device, cancel_fd);
+    }
+  }
+
+  if (reply) {
+    dbus_message_unref(reply);
+  }
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+static backend_result_t nm_dbus_disconnect_network(void) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+  pthread_mutex_lock(&nm_bus_lock);
+
+  char device[NM_MAX_PATH];
+  if (!find_wifi_device(device, sizeof(device))) {
+    result.result = WTERM_ERROR_INTERFACE;
+    safe_string_copy(result.error_message, "No Wi-Fi device found",
+                     sizeof(result.error_message));
+  } else {
+    DBusMessage *message = dbus_message_new_method_call(
+        NM_DBUS_SERVICE, device, NM_DBUS_IFACE_DEVICE, "Disconnect");
+    DBusMessage *reply = nm_send(message, result.error_message,
+                                 sizeof(result.error_message));
+    if (reply) {
+      dbus_message_unref(reply);
+    } else {
+      result.result = WTERM_ERROR_NETWORK;
+    }
+  }
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+// SSID of the access point a WiFi device is associated with
+static bool device_get_ssid(const char *device, char *ssid, size_t size) {
+  char ap[NM_MAX_PATH];
+  if (!nm_get_string_property(device, NM_DBUS_IFACE_WIRELESS,
+                              "ActiveAccessPoint", ap, sizeof(ap)) ||
+      is_null_path(ap)) {
+    return false;
+  }
+
+  DBusMessageIter value;
+  DBusMessage *reply = nm_get_property(ap, NM_DBUS_IFACE_AP, "Ssid", &value);
+  if (!reply) {
+    return false;
+  }
+
+  bool ok = iter_get_ssid(&value, ssid, size);
+  dbus_message_unref(reply);
+  return ok;
+}
+
+// First IPv4 address of a device
+static bool device_get_ip_address(const char *device, char *ip_buffer,
+                                  size_t buffer_size) {
+  bool found_ip = false;
+  char ip4_config[NM_MAX_PATH];
+  if (nm_get_string_property(device, NM_DBUS_IFACE_DEVICE, "Ip4Config",
+                             ip4_config, sizeof(ip4_config)) &&
+      !is_null_path(ip4_config)) {
+    // AddressData is aa{sv}; take the "address" of the first entry
+    DBusMessageIter value;
+    DBusMessage *reply = nm_get_property(ip4_config, NM_DBUS_IFACE_IP4CONFIG,
+                                         "AddressData", &value);
+    if (reply) {
+      DBusMessageIter addresses, entries;
+      if (dbus_message_iter_get_arg_type(&value) == DBUS_TYPE_ARRAY) {
+        dbus_message_iter_recurse(&value, &addresses);
+        if (dbus_message_iter_get_arg_type(&addresses) == DBUS_TYPE_ARRAY) {
+          dbus_message_iter_recurse(&addresses, &entries);
+          while (!found_ip && dbus_message_iter_get_arg_type(&entries) ==
+                                  DBUS_TYPE_DICT_ENTRY) {
+            DBusMessageIter entry, address;
+            const char *key = NULL;
+            dbus_message_iter_recurse(&entries, &entry);
+            dbus_message_iter_get_basic(&entry, &key);
+            if (strcmp(key, "address") == 0 && dbus_message_iter_next(&entry)) {
+              dbus_message_iter_recurse(&entry, &address);
+              found_ip = iter_get_string(&address, ip_buffer, buffer_size) &&
+                         ip_buffer[0] != '\0';
+            }
+            dbus_message_iter_next(&entries);
+          }
+        }
+      }
+      dbus_message_unref(reply);
+    }
+  }
+  return found_ip;
+}
+
+static bool nm_dbus_is_connected(char *connected_ssid, size_t buffer_size) {
+  if (!connected_ssid || buffer_size == 0) {
+    return false;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+  char device[NM_MAX_PATH];
+  bool connected = find_wifi_device(device, sizeof(device)) &&
+                   device_get_ssid(device, connected_ssid, buffer_size);
+  pthread_mutex_unlock(&nm_bus_lock);
+  return connected;
+}
+
+static bool nm_dbus_get_ip_address(char *ip_buffer, size_t buffer_size) {
+  if (!ip_buffer || buffer_size == 0) {
+    return false;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+  char device[NM_MAX_PATH];
+  bool found_ip = find_wifi_device(device, sizeof(device)) &&
+                  device_get_ip_address(device, ip_buffer, buffer_size);
+  pthread_mutex_unlock(&nm_bus_lock);
+  return found_ip;
+}
+
+static wterm_result_t nm_dbus_get_connection_status(connection_status_t *status) {
+  if (!status) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+  memset(status, 0, sizeof(*status));
+
+  pthread_mutex_lock(&nm_bus_lock);
+  if (!nm_get_bus()) {
+    pthread_mutex_unlock(&nm_bus_lock);
+    return WTERM_ERROR_NETWORK;
+  }
+
+  char device[NM_MAX_PATH];
+  char active[NM_MAX_PATH];
+  if (find_wifi_device(device, sizeof(device)) &&
+      device_get_ssid(device, status->connected_ssid,
+                      sizeof(status->connected_ssid)) &&
+      nm_get_string_property(device, NM_DBUS_IFACE_DEVICE, "ActiveConnection",
+                             active, sizeof(active)) &&
+      !is_null_path(active)) {
+    status->is_connected = true;
+    nm_get_string_property(device, NM_DBUS_IFACE_DEVICE, "Interface",
+                           status->device, sizeof(status->device));
+    nm_get_string_property(active, NM_DBUS_IFACE_ACTIVE, "Id",
+                           status->connection_name,
+                           sizeof(status->connection_name));
+    nm_get_string_property(active, NM_DBUS_IFACE_ACTIVE, "Uuid",
+                           status->connection_uuid,
+                           sizeof(status->connection_uuid));
+    device_get_ip_address(device, status->ip_address,
+                          sizeof(status->ip_address));
+  }
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  return WTERM_SUCCESS;
+}
+
+// ============================================================================
+// Hotspot operations
+// ============================================================================
+
+static bool validate_hotspot_argument(const char *hotspot_name,
+                                      backend_result_t *result) {
+  if (!hotspot_name) {
+    result->result = WTERM_ERROR_INVALID_INPUT;
+    safe_string_copy(result->error_message, "Invalid hotspot name",
+                     sizeof(result->error_message));
+    return false;
+  }
+
+  if (!validate_hotspot_name(hotspot_name)) {
+    result->result = WTERM_ERROR_INVALID_INPUT;
+    safe_string_copy(result->error_message,
+                     "Hotspot name contains invalid characters",
+                     sizeof(result->error_message));
+    return false;
+  }
+  return true;
+}
+
+static backend_result_t nm_dbus_start_hotspot(const char *hotspot_name) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+  if (!validate_hotspot_argument(hotspot_name, &result)) {
+    return result;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+
+  char connection[NM_MAX_PATH];
+  if (!find_connection_by_id(hotspot_name, connection, sizeof(connection))) {
+    result.result = WTERM_ERROR_HOTSPOT;
+    snprintf(result.error_message, sizeof(result.error_message),
+             "unknown connection '%s'.", hotspot_name);
+  } else {
+    const char *connection_path = connection;
+    const char *any = "/";
+    DBusMessage *message = dbus_message_new_method_call(
+        NM_DBUS_SERVICE, NM_DBUS_PATH, NM_DBUS_IFACE, "ActivateConnection");
+    if (message) {
+      dbus_message_append_args(message, DBUS_TYPE_OBJECT_PATH,
+                               &connection_path, DBUS_TYPE_OBJECT_PATH, &any,
+                               DBUS_TYPE_OBJECT_PATH, &any, DBUS_TYPE_INVALID);
+      result = activate_and_wait(message, -1);
+    } else {
+      result.result = WTERM_ERROR_MEMORY;
+    }
+  }
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+static backend_result_t nm_dbus_stop_hotspot(const char *hotspot_name) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+  if (!validate_hotspot_argument(hotspot_name, &result)) {
+    return result;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+
+  char active[NM_MAX_PATH];
+  if (find_active_connection_by_id(hotspot_name, active, sizeof(active))) {
+    result = deactivate_connection(active);
+  } else {
+    result.result = WTERM_ERROR_HOTSPOT;
+    snprintf(result.error_message, sizeof(result.error_message),
+             "'%s' is not an active connection.", hotspot_name);
+  }
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+static backend_result_t nm_dbus_delete_hotspot(const char *hotspot_name) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
+  if (!validate_hotspot_argument(hotspot_name, &result)) {
+    return result;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+
+  // Stop first; ignore errors if it is not running
+  char active[NM_MAX_PATH];
+  if (find_active_connection_by_id(hotspot_name, active, sizeof(active))) {
+    deactivate_connection(active);
+  }
+
+  char connection[NM_MAX_PATH];
+  if (!find_connection_by_id(hotspot_name, connection, sizeof(connection))) {
+    result.result = WTERM_ERROR_HOTSPOT;
+    snprintf(result.error_message, sizeof(result.error_message),
+             "unknown connection '%s'.", hotspot_name);
+  } else {
+    DBusMessage *message = dbus_message_new_method_call(
+        NM_DBUS_SERVICE, connection, NM_DBUS_IFACE_CONNECTION, "Delete");
+    DBusMessage *reply = nm_send(message, result.error_message,
+                                 sizeof(result.error_message));
+    if (reply) {
+      dbus_message_unref(reply);
+    } else {
+      result.result = WTERM_ERROR_HOTSPOT;
+    }
+  }
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+static wterm_result_t nm_dbus_get_hotspot_status(const char *hotspot_name,
+                                                 hotspot_status_t *status) {
+  if (!hotspot_name || !status) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  if (!validate_hotspot_name(hotspot_name)) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  pthread_mutex_lock(&nm_bus_lock);
+
+  char active[NM_MAX_PATH];
+  uint32_t state = NM_ACTIVE_CONNECTION_STATE_DEACTIVATED;
+  char connection[NM_MAX_PATH];
+
+  if (find_active_connection_by_id(hotspot_name, active, sizeof(active))) {
+    nm_get_u32_property(active, NM_DBUS_IFACE_ACTIVE, "State", &state);
+  }
+
+  switch (state) {
+  case NM_ACTIVE_CONNECTION_STATE_ACTIVATED:
+    status->state = HOTSPOT_STATE_ACTIVE;
+    safe_string_copy(status->status_message, "Hotspot is active",
+                     sizeof(status->status_message));
+    break;
+  case NM_ACTIVE_CONNECTION_STATE_ACTIVATING:
+    status->state = HOTSPOT_STATE_STARTING;
+    safe_string_copy(status->status_message, "Hotspot is starting",
+                     sizeof(status->status_message));
+    break;
+  case NM_ACTIVE_CONNECTION_STATE_DEACTIVATING:
+    status->state = HOTSPOT_STATE_STOPPING;
+    safe_string_copy(status->status_message, "Hotspot is stopping",
+                     sizeof(status->status_message));
+    break;
+  default:
+    status->state = HOTSPOT_STATE_STOPPED;
+    safe_string_copy(status->status_message,
+                     find_connection_by_id(hotspot_name, connection,
+                                           sizeof(connection))
+                         ? "Hotspot is stopped"
+                         : "Hotspot configuration not found",
+                     sizeof(status->status_message));
+    break;
+  }
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  return WTERM_SUCCESS;
+}
+
+static wterm_result_t
+nm_dbus_list_active_hotspots(char active_hotspots[][MAX_STR_SSID],
+                             int max_count, int *count) {
+  if (!active_hotspots || !count) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  *count = 0;
+  pthread_mutex_lock(&nm_bus_lock);
+
+  nm_path_list_t active;
+  if (!nm_get_paths_property(NM_DBUS_PATH, NM_DBUS_IFACE, "ActiveConnections",
+                             &active)) {
+    pthread_mutex_unlock(&nm_bus_lock);
+    return WTERM_ERROR_NETWORK;
+  }
+
+  for (int i = 0; i < active.count && *count < max_count; i++) {
+    uint32_t state = 0;
+    char connection[NM_MAX_PATH];
+    char mode[32];
+
+    if (!nm_get_u32_property(active.paths[i], NM_DBUS_IFACE_ACTIVE, "State",
+                             &state) ||
+        state != NM_ACTIVE_CONNECTION_STATE_ACTIVATED ||
+        !nm_get_string_property(active.paths[i], NM_DBUS_IFACE_ACTIVE,
+                                "Connection", connection,
+                                sizeof(connection)) ||
+        !connection_get_setting(connection, "802-11-wireless", "mode", mode,
+                                sizeof(mode)) ||
+        strcmp(mode, "ap") != 0) {
+      continue;
+    }
+
+    if (nm_get_string_property(active.paths[i], NM_DBUS_IFACE_ACTIVE, "Id",
+                               active_hotspots[*count], MAX_STR_SSID)) {
+      (*count)++;
+    }
+  }
+
+  nm_path_list_free(&active);
+  pthread_mutex_unlock(&nm_bus_lock);
+  return WTERM_SUCCESS;
+}
+
+static wterm_result_t nm_dbus_check_interface_ap_support(const char *interface,
+                                                         bool *supports_ap) {
+  if (!interface || !supports_ap) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  *supports_ap = false;
+  pthread_mutex_lock(&nm_bus_lock);
+
+  wterm_result_t result = WTERM_ERROR_GENERAL; // Not a WiFi interface
+  DBusMessage *reply =
+      nm_call(NM_DBUS_PATH, NM_DBUS_IFACE, "GetDeviceByIpIface",
+              DBUS_TYPE_STRING, &interface, DBUS_TYPE_INVALID);
+
+  const char *device = NULL;
+  uint32_t type = 0;
+  uint32_t capabilities = 0;
+  if (reply &&
+      dbus_message_get_args(reply, NULL, DBUS_TYPE_OBJECT_PATH, &device,
+                            DBUS_TYPE_INVALID) &&
+      nm_get_u32_property(device, NM_DBUS_IFACE_DEVICE, "DeviceType", &type) &&
+      type == NM_DEVICE_TYPE_WIFI &&
+      nm_get_u32_property(device, NM_DBUS_IFACE_WIRELESS,
+                          "WirelessCapabilities", &capabilities)) {
+    *supports_ap = (capabilities & NM_WIFI_DEVICE_CAP_AP) != 0;
+    result = WTERM_SUCCESS;
+  }
+
+  if (reply) {
+    dbus_message_unref(reply);
+  }
+
+  pthread_mutex_unlock(&nm_bus_lock);
+  return result;
+}
+
+static wterm_result_t
+nm_dbus_get_available_wifi_interfaces(char interfaces[][MAX_STR_INTERFACE],
+                                      int max_interfaces,
+                                      int *interface_count) {
+  if (!interfaces || !interface_count) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  *interface_count = 0;
+  pthread_mutex_lock(&nm_bus_lock);
+
+  nm_path_list_t devices;
+  bool listed =
+      nm_call_get_paths(NM_DBUS_PATH, NM_DBUS_IFACE, "GetDevices", &devices);
+
+  for (int i = 0; i < devices.count && *interface_count < max_interfaces;
+       i++) {
+    uint32_t type = 0;
+    if (nm_get_u32_property(devices.paths[i], NM_DBUS_IFACE_DEVICE,
+                            "DeviceType", &type) &&
+        type == NM_DEVICE_TYPE_WIFI &&
+        nm_get_string_property(devices.paths[i], NM_DBUS_IFACE_DEVICE,
+                               "Interface", interfaces[*interface_count],
+                               MAX_STR_INTERFACE)) {
+      (*interface_count)++;
+    }
+  }
+
+  nm_path_list_free(&devices);
+  pthread_mutex_unlock(&nm_bus_lock);
+  return listed ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
+}
@@ -4,32 +4,42 @@
  */
 
 #define _POSIX_C_SOURCE 200809L
+#include "../../utils/capability.h"
 #include "../../utils/input_sanitizer.h"
 #include "../../utils/safe_exec.h"
 #include "../../utils/string_utils.h"
 #include "../../utils/iw_helper.h"
+#include "../../utils/network_list.h"
+#include "../../utils/nl80211_helper.h"
+#include "../../utils/query_cache.h"
 #include "../network_scanner.h"
 #include "backend_interface.h"
+#include <linux/nl80211.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
-// nmcli command definitions
-#define NMCLI_WIFI_LIST "nmcli -t -f SSID,SECURITY,SIGNAL device wifi list"
-#define NMCLI_WIFI_SCAN "nmcli device wifi rescan"
-#define NMCLI_WIFI_CONNECT "nmcli device wifi connect"
+// nmcli waits up to 90 seconds for an activation, give it a little more
+#define NMCLI_CONNECT_TIMEOUT_MS 95000
 
 // Forward declarations
 static wterm_result_t nmcli_scan_networks(network_list_t *networks);
-static backend_result_t nmcli_connect_open_network(const char *ssid);
+static backend_result_t nmcli_connect_open_network(const char *ssid,
+                                                   int cancel_fd);
 static backend_result_t nmcli_connect_secured_network(const char *ssid,
-                                                      const char *password);
+                                                      const char *password,
+                                                      int cancel_fd);
+static backend_result_t nmcli_connect_saved_network(const char *uuid,
+                                                    int cancel_fd);
 static backend_result_t nmcli_disconnect_network(void);
 static wterm_result_t nmcli_rescan_networks(void);
+static wterm_result_t nmcli_scan_networks_fresh(network_list_t *networks,
+                                                int timeout_ms);
 static bool nmcli_is_available(void);
 static bool nmcli_is_connected(char *connected_ssid, size_t buffer_size);
 static bool nmcli_get_ip_address(char *ip_buffer, size_t buffer_size);
+static wterm_result_t nmcli_get_connection_status(connection_status_t *status);
 
 // Hotspot operation declarations
 static backend_result_t nmcli_create_hotspot(const hotspot_config_t *config);
@@ -59,11 +69,14 @@ const network_backend_t nmcli_backend = {
     .scan_networks = nmcli_scan_networks,
     .connect_open_network = nmcli_connect_open_network,
     .connect_secured_network = nmcli_connect_secured_network,
+    .connect_saved_network = nmcli_connect_saved_network,
     .disconnect_network = nmcli_disconnect_network,
     .rescan_networks = nmcli_rescan_networks,
+    .scan_networks_fresh = nmcli_scan_networks_fresh,
     .is_available = nmcli_is_available,
     .is_connected = nmcli_is_connected,
     .get_ip_address = nmcli_get_ip_address,
+    .get_connection_status = nmcli_get_connection_status,
     .create_hotspot = nmcli_create_hotspot,
     .start_hotspot = nmcli_start_hotspot,
     .stop_hotspot = nmcli_stop_hotspot,
@@ -74,66 +87,136 @@ const network_backend_t nmcli_backend = {
     .check_interface_ap_support = nmcli_check_interface_ap_support,
     .get_available_wifi_interfaces = nmcli_get_available_wifi_interfaces};
 
-static bool nmcli_is_available(void) { return safe_command_exists("nmcli"); }
+static bool nmcli_is_available(void) {
+  return capability_available(CAPABILITY_NMCLI);
+}
 
 // Use the shared parsing function from network_scanner.h
 
-static wterm_result_t nmcli_scan_networks(network_list_t *networks) {
-  if (!networks) {
-    return WTERM_ERROR_INVALID_INPUT;
+/**
+ * @brief Run `nmcli device wifi list` and parse its records
+ * @param networks List to fill
+ * @param args nmcli arguments
+ * @param options Execution limits, or NULL for the defaults
+ */
+static wterm_result_t run_wifi_list(network_list_t *networks, char *const args[],
+                                    const safe_exec_options_t *options) {
+  network_list_clear(networks);
+
+  safe_exec_output_t output;
+  wterm_result_t exec_result =
+      safe_exec_capture_ex("nmcli", args, options, &output);
+  if (exec_result != WTERM_SUCCESS) {
+    return exec_result == WTERM_ERROR_TIMEOUT ? exec_result
+                                              : WTERM_ERROR_NETWORK;
+  }
+
+  char *cursor = output.out;
+  char *line;
+  while ((line = safe_exec_next_line(&cursor))) {
+    if (strlen(line) == 0)
+      continue; // Skip empty lines
+
+    network_info_t parsed;
+    scan_record_t record;
+    if (parse_network_record(line, &parsed, &record) != WTERM_SUCCESS) {
+      continue;
+    }
+
+    network_info_t *network = network_list_append(networks);
+    if (!network) {
+      safe_exec_output_free(&output);
+      return WTERM_ERROR_MEMORY;
+    }
+    *network = parsed;
+    network_list_set_record(networks, networks->count - 1, &record);
   }
 
-  networks->count = 0;
+  int exit_code = output.exit_code;
+  safe_exec_output_free(&output);
 
-  FILE *fp = popen(NMCLI_WIFI_LIST, "r");
-  if (!fp) {
+  if (exit_code != 0) {
     return WTERM_ERROR_NETWORK;
   }
 
-  char buffer[512];
-  while (fgets(buffer, sizeof(buffer), fp) && networks->count < MAX_NETWORKS) {
-    // Remove trailing newline
-    buffer[strcspn(buffer, "\n")] = '\0';
-
-    if (strlen(buffer) == 0)
-      continue; // Skip empty lines
+  return WTERM_SUCCESS;
+}
 
-    network_info_t *network = &networks->networks[networks->count];
-    if (parse_network_line(buffer, network) == WTERM_SUCCESS) {
-      networks->count++;
-    }
+static wterm_result_t nmcli_scan_networks(network_list_t *networks) {
+  if (!networks) {
+    return WTERM_ERROR_INVALID_INPUT;
   }
 
-  int exit_code = pclose(fp);
-  if (exit_code != 0) {
-    return WTERM_ERROR_NETWORK;
+  char *const args[] = {"nmcli", "-t", "-f", NMCLI_SCAN_FIELDS, "device",
+                        "wifi", "list", NULL};
+  return run_wifi_list(networks, args, NULL);
+}
+
+static wterm_result_t nmcli_scan_networks_fresh(network_list_t *networks,
+                                                int timeout_ms) {
+  if (!networks || timeout_ms <= 0) {
+    return WTERM_ERROR_INVALID_INPUT;
   }
 
-  return WTERM_SUCCESS;
+  // `--rescan yes` makes nmcli wait for NetworkManager's scan-done signal;
+  // --wait bounds that wait and the exec deadline bounds nmcli itself
+  char wait_seconds[16];
+  snprintf(wait_seconds, sizeof(wait_seconds), "%d",
+           timeout_ms >= 2000 ? timeout_ms / 1000 : 1);
+  char *const args[] = {"nmcli", "--wait", wait_seconds, "-t", "-f",
+                        NMCLI_SCAN_FIELDS, "device", "wifi", "list",
+                        "--rescan", "yes", NULL};
+  safe_exec_options_t options = {.timeout_ms = timeout_ms};
+
+  wterm_result_t result = run_wifi_list(networks, args, &options);
+  if (result != WTERM_SUCCESS && result != WTERM_ERROR_MEMORY) {
+    // Scan refused or not finished in time: serve what NetworkManager has
+    result = nmcli_scan_networks(networks);
+    networks->is_stale = true;
+  }
+  return result;
 }
 
-// Helper function to execute nmcli connection and handle errors
-static backend_result_t execute_nmcli_command(const char *command) {
+// Helper function to execute nmcli and report its first line of error output
+static backend_result_t run_nmcli_command(char *const args[],
+                                          const safe_exec_options_t *options) {
   backend_result_t result = {.result = WTERM_SUCCESS};
 
-  FILE *fp = popen(command, "r");
-  if (!fp) {
+  // Every command run through here changes NetworkManager state
+  safe_exec_output_t output;
+  wterm_result_t exec_result =
+      safe_exec_capture_ex("nmcli", args, options, &output);
+  query_cache_invalidate();
+  if (exec_result == WTERM_ERROR_CANCELLED) {
+    result.result = WTERM_ERROR_CANCELLED;
+    safe_string_copy(result.error_message, "Connection cancelled by user",
+                     sizeof(result.error_message));
+    return result;
+  }
+  if (exec_result == WTERM_ERROR_TIMEOUT) {
+    result.result = WTERM_ERROR_TIMEOUT;
+    safe_string_copy(result.error_message, "nmcli did not respond",
+                     sizeof(result.error_message));
+    return result;
+  }
+  if (exec_result != WTERM_SUCCESS) {
     result.result = WTERM_ERROR_NETWORK;
     safe_string_copy(result.error_message, "Failed to execute nmcli command",
                      sizeof(result.error_message));
     return result;
   }
 
-  char error_output[256] = {0};
-  if (fgets(error_output, sizeof(error_output), fp)) {
-    trim_trailing_whitespace(error_output);
-  }
-
-  int exit_code = pclose(fp);
-  if (exit_code != 0) {
+  if (output.exit_code != 0) {
     result.result = WTERM_ERROR_NETWORK;
-    if (strlen(error_output) > 0) {
-      safe_string_copy(result.error_message, error_output,
+
+    char *cursor = output.err[0] != '\0' ? output.err : output.out;
+    char *first_line = safe_exec_next_line(&cursor);
+    if (first_line) {
+      trim_trailing_whitespace(first_line);
+    }
+
+    if (first_line && strlen(first_line) > 0) {
+      safe_string_copy(result.error_message, first_line,
                        sizeof(result.error_message));
     } else {
       safe_string_copy(result.error_message, "Command failed",
@@ -141,10 +224,25 @@ static backend_result_t execute_nmcli_command(const char *command) {
     }
   }
 
+  safe_exec_output_free(&output);
   return result;
 }
 
-static backend_result_t nmcli_connect_open_network(const char *ssid) {
+static backend_result_t execute_nmcli_command(char *const args[]) {
+  return run_nmcli_command(args, NULL);
+}
+
+// Activations may run long, so they get their own deadline and can be
+// aborted through cancel_fd
+static backend_result_t execute_nmcli_connect(char *const args[],
+                                              int cancel_fd) {
+  safe_exec_options_t options = {.timeout_ms = NMCLI_CONNECT_TIMEOUT_MS,
+                                 .cancel_fd = cancel_fd};
+  return run_nmcli_command(args, &options);
+}
+
+static backend_result_t nmcli_connect_open_network(const char *ssid,
+                                                   int cancel_fd) {
   backend_result_t result = {.result = WTERM_SUCCESS};
 
   if (!ssid) {
@@ -163,24 +261,15 @@ static backend_result_t nmcli_connect_open_network(const char *ssid) {
     return result;
   }
 
-  // Escape SSID for shell safety
-  char escaped_ssid[256];
-  if (!shell_escape(ssid, escaped_ssid, sizeof(escaped_ssid))) {
-    result.result = WTERM_ERROR_INVALID_INPUT;
-    safe_string_copy(result.error_message, "SSID too long for shell escaping",
-                     sizeof(result.error_message));
-    return result;
-  }
-
-  char command[512];
-  snprintf(command, sizeof(command), "%s %s 2>&1", NMCLI_WIFI_CONNECT,
-           escaped_ssid);
-
-  return execute_nmcli_command(command);
+  // SSID is passed verbatim in argv, no shell involved
+  char *const args[] = {"nmcli", "device", "wifi", "connect", (char *)ssid,
+                        NULL};
+  return execute_nmcli_connect(args, cancel_fd);
 }
 
 static backend_result_t nmcli_connect_secured_network(const char *ssid,
-                                                      const char *password) {
+                                                      const char *password,
+                                                      int cancel_fd) {
   backend_result_t result = {.result = WTERM_SUCCESS};
 
   if (!ssid || !password) {
@@ -199,39 +288,50 @@ static backend_result_t nmcli_connect_secured_network(const char *ssid,
     return result;
   }
 
-  // Escape both SSID and password for shell safety
-  char escaped_ssid[256];
-  char escaped_password[512];
+  char *const args[] = {"nmcli",       "device", "wifi", "connect", (char *)ssid,
+                        "password", (char *)password, NULL};
+  return execute_nmcli_connect(args, cancel_fd);
+}
 
-  if (!shell_escape(ssid, escaped_ssid, sizeof(escaped_ssid))) {
-    result.result = WTERM_ERROR_INVALID_INPUT;
-    safe_string_copy(result.error_message, "SSID too long for shell escaping",
-                     sizeof(result.error_message));
-    return result;
-  }
+static backend_result_t nmcli_connect_saved_network(const char *uuid,
+                                                    int cancel_fd) {
+  backend_result_t result = {.result = WTERM_SUCCESS};
 
-  if (!shell_escape(password, escaped_password, sizeof(escaped_password))) {
+  if (!uuid || is_string_empty(uuid)) {
     result.result = WTERM_ERROR_INVALID_INPUT;
-    safe_string_copy(result.error_message,
-                     "Password too long for shell escaping",
+    safe_string_copy(result.error_message, "Invalid connection UUID",
                      sizeof(result.error_message));
     return result;
   }
 
-  char command[1024];
-  snprintf(command, sizeof(command), "%s %s password %s 2>&1",
-           NMCLI_WIFI_CONNECT, escaped_ssid, escaped_password);
-
-  return execute_nmcli_command(command);
+  char *const args[] = {"nmcli", "connection", "up", "uuid", (char *)uuid,
+                        NULL};
+  return execute_nmcli_connect(args, cancel_fd);
 }
 
 static backend_result_t nmcli_disconnect_network(void) {
-  return execute_nmcli_command("nmcli device wifi disconnect 2>&1");
+  backend_result_t result = {.result = WTERM_SUCCESS};
+
+  connection_status_t status;
+  if (nmcli_get_connection_status(&status) != WTERM_SUCCESS) {
+    result.result = WTERM_ERROR_NETWORK;
+    safe_string_copy(result.error_message, "Failed to execute nmcli command",
+                     sizeof(result.error_message));
+    return result;
+  }
+  if (!status.is_connected || status.connection_uuid[0] == '\0') {
+    return result; // Nothing to disconnect
+  }
+
+  char *const args[] = {"nmcli", "connection", "down", "uuid",
+                        status.connection_uuid, NULL};
+  return execute_nmcli_command(args);
 }
 
 static wterm_result_t nmcli_rescan_networks(void) {
   char *const args[] = {"nmcli", "device", "wifi", "rescan", NULL};
   bool result = safe_exec_check("nmcli", args);
+  query_cache_invalidate();
   return result ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
 }
 
@@ -240,26 +340,27 @@ static bool nmcli_is_connected(char *connected_ssid, size_t buffer_size) {
     return false;
   }
 
-  FILE *fp = popen("nmcli -t -f ACTIVE,SSID device wifi list", "r");
-  if (!fp) {
+  char *const args[] = {"nmcli", "-t", "-f", "ACTIVE,SSID", "device", "wifi",
+                        "list", NULL};
+  safe_exec_output_t output;
+  if (!query_cache_capture("nmcli", args, QUERY_CACHE_SHORT_TTL_MS, &output)) {
     return false;
   }
 
-  char buffer[256];
   bool found_connection = false;
+  char *cursor = output.out;
+  char *line;
 
-  while (fgets(buffer, sizeof(buffer), fp)) {
-    buffer[strcspn(buffer, "\n")] = '\0';
-
-    if (strncmp(buffer, "yes:", 4) == 0) {
-      const char *ssid = buffer + 4; // Skip "yes:"
+  while ((line = safe_exec_next_line(&cursor))) {
+    if (strncmp(line, "yes:", 4) == 0) {
+      const char *ssid = line + 4; // Skip "yes:"
       safe_string_copy(connected_ssid, ssid, buffer_size);
       found_connection = true;
       break;
     }
   }
 
-  pclose(fp);
+  safe_exec_output_free(&output);
   return found_connection;
 }
 
@@ -268,34 +369,200 @@ static bool nmcli_get_ip_address(char *ip_buffer, size_t buffer_size) {
     return false;
   }
 
-  FILE *fp = popen(
-      "nmcli -t -f IP4.ADDRESS connection show --active 2>/dev/null | head -1",
-      "r");
-  if (!fp) {
+  char *const args[] = {"nmcli", "-t", "-f", "IP4.ADDRESS", "connection",
+                        "show", "--active", NULL};
+  safe_exec_output_t output;
+  if (!query_cache_capture("nmcli", args, QUERY_CACHE_SHORT_TTL_MS, &output)) {
     return false;
   }
 
-  char buffer[64];
   bool found_ip = false;
+  char *cursor = output.out;
+  char *line = safe_exec_next_line(&cursor); // First line only
 
-  if (fgets(buffer, sizeof(buffer), fp)) {
-    buffer[strcspn(buffer, "\n")] = '\0';
-
+  if (line) {
     // Remove "/XX" subnet notation if present
-    char *slash = strchr(buffer, '/');
+    char *slash = strchr(line, '/');
     if (slash)
       *slash = '\0';
 
-    if (strlen(buffer) > 0) {
-      safe_string_copy(ip_buffer, buffer, buffer_size);
+    if (strlen(line) > 0) {
+      safe_string_copy(ip_buffer, line, buffer_size);
       found_ip = true;
     }
   }
 
-  pclose(fp);
+  safe_exec_output_free(&output);
   return found_ip;
 }
 
+// Undo nmcli terse escaping ("\:" and "\\") in place
+static void unescape_terse_value(char *value) {
+  char *out = value;
+  for (const char *in = value; *in; in++) {
+    if (*in == '\\' && in[1] != '\0') {
+      in++;
+    }
+    *out++ = *in;
+  }
+  *out = '\0';
+}
+
+// Fields of one device block from `nmcli -t device show`
+typedef struct {
+  char device[MAX_STR_INTERFACE];
+  bool is_wifi;
+  bool is_connected;
+  char connection[MAX_STR_SSID];
+  char uuid[64];
+  char ip_address[16];
+  char ssid[MAX_STR_SSID];
+  bool ap_in_use; // Current AP[n] entry is the associated one
+} device_block_t;
+
+static void apply_device_field(device_block_t *block, const char *key,
+                               const char *value) {
+  if (strcmp(key, "GENERAL.TYPE") == 0) {
+    block->is_wifi = strcmp(value, "wifi") == 0;
+  } else if (strcmp(key, "GENERAL.STATE") == 0) {
+    // "100 (connected)"
+    block->is_connected = atoi(value) == 100;
+  } else if (strcmp(key, "GENERAL.CONNECTION") == 0) {
+    safe_string_copy(block->connection, value, sizeof(block->connection));
+  } else if (strcmp(key, "GENERAL.CON-UUID") == 0) {
+    safe_string_copy(block->uuid, value, sizeof(block->uuid));
+  } else if (strncmp(key, "IP4.ADDRESS", 11) == 0 &&
+             block->ip_address[0] == '\0') {
+    // First address only, without the "/prefix" suffix
+    safe_string_copy(block->ip_address, value, sizeof(block->ip_address));
+    char *slash = strchr(block->ip_address, '/');
+    if (slash) {
+      *slash = '\0';
+    }
+  } else if (strncmp(key, "AP[", 3) == 0) {
+    const char *field = strchr(key, '.');
+    if (field && strcmp(field, ".IN-USE") == 0) {
+      block->ap_in_use = strcmp(value, "*") == 0;
+    } else if (field && strcmp(field, ".SSID") == 0 && block->ap_in_use &&
+               block->ssid[0] == '\0') {
+      safe_string_copy(block->ssid, value, sizeof(block->ssid));
+    }
+  }
+}
+
+// Associated station interface and SSID straight from nl80211, if any
+static bool find_associated_station(nl80211_iface_t *station) {
+  nl80211_iface_t ifaces[NL80211_MAX_INTERFACES];
+  int count = 0;
+  if (nl80211_get_interfaces(ifaces, NL80211_MAX_INTERFACES, &count) !=
+      WTERM_SUCCESS) {
+    return false;
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (ifaces[i].iftype == NL80211_IFTYPE_STATION && ifaces[i].ssid[0]) {
+      *station = ifaces[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+// One nmcli process, plus an in-process nl80211 query
+static wterm_result_t nmcli_get_connection_status(connection_status_t *status) {
+  if (!status) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+  memset(status, 0, sizeof(*status));
+
+  // With nl80211 the device and SSID are known up front, so the nmcli query
+  // can be scoped to that device and skip the access point list
+  nl80211_iface_t station;
+  bool have_station = find_associated_station(&station);
+
+  char *args[12];
+  int argc = 0;
+  args[argc++] = "nmcli";
+  args[argc++] = "-t";
+  args[argc++] = "-f";
+  args[argc++] = have_station
+                     ? "GENERAL.DEVICE,GENERAL.TYPE,GENERAL.STATE,"
+                       "GENERAL.CONNECTION,GENERAL.CON-UUID,IP4.ADDRESS"
+                     : "GENERAL.DEVICE,GENERAL.TYPE,GENERAL.STATE,"
+                       "GENERAL.CONNECTION,GENERAL.CON-UUID,IP4.ADDRESS,AP";
+  args[argc++] = "device";
+  args[argc++] = "show";
+  if (have_station) {
+    args[argc++] = station.name;
+  }
+  args[argc] = NULL;
+
+  safe_exec_output_t output;
+  if (!safe_exec_capture("nmcli", args, &output)) {
+    return WTERM_ERROR_NETWORK;
+  }
+  if (output.exit_code != 0) {
+    safe_exec_output_free(&output);
+    return WTERM_ERROR_NETWORK;
+  }
+
+  device_block_t block = {0};
+  bool have_block = false;
+  char *cursor = output.out;
+
+  for (;;) {
+    char *line = safe_exec_next_line(&cursor);
+
+    // A new GENERAL.DEVICE line (or the end) closes the previous block
+    bool block_done = !line || strncmp(line, "GENERAL.DEVICE:", 15) == 0;
+    if (block_done && have_block && block.is_wifi && block.is_connected) {
+      status->is_connected = true;
+      safe_string_copy(status->device, block.device, sizeof(status->device));
+      safe_string_copy(status->connection_name, block.connection,
+                       sizeof(status->connection_name));
+      safe_string_copy(status->connection_uuid, block.uuid,
+                       sizeof(status->connection_uuid));
+      safe_string_copy(status->ip_address, block.ip_address,
+                       sizeof(status->ip_address));
+      // Without an in-use AP entry the profile name is the best guess
+      safe_string_copy(status->connected_ssid,
+                       block.ssid[0] ? block.ssid : block.connection,
+                       sizeof(status->connected_ssid));
+      break;
+    }
+    if (!line) {
+      break;
+    }
+
+    char *colon = strchr(line, ':');
+    if (!colon) {
+      continue;
+    }
+    *colon = '\0';
+    char *value = colon + 1;
+    unescape_terse_value(value);
+
+    if (strcmp(line, "GENERAL.DEVICE") == 0) {
+      memset(&block, 0, sizeof(block));
+      safe_string_copy(block.device, value, sizeof(block.device));
+      have_block = true;
+    } else if (have_block) {
+      apply_device_field(&block, line, value);
+    }
+  }
+
+  safe_exec_output_free(&output);
+
+  // nl80211 reports the SSID bytes the radio is actually associated with
+  if (status->is_connected && have_station &&
+      strcmp(status->device, station.name) == 0) {
+    safe_string_copy(status->connected_ssid, station.ssid,
+                     sizeof(status->connected_ssid));
+  }
+
+  return WTERM_SUCCESS;
+}
+
 // Hotspot operation implementations
 static backend_result_t nmcli_create_hotspot(const hotspot_config_t *config) {
   backend_result_t result = {.result = WTERM_SUCCESS};
@@ -329,111 +596,53 @@ static backend_result_t nmcli_create_hotspot(const hotspot_config_t *config) {
     return result;
   }
 
-  // Escape all user-controlled parameters
-  char escaped_ssid[256];
-
-  if (!shell_escape(config->ssid, escaped_ssid, sizeof(escaped_ssid))) {
-    result.result = WTERM_ERROR_INVALID_INPUT;
-    safe_string_copy(result.error_message, "SSID too long for shell escaping",
-                     sizeof(result.error_message));
-    return result;
-  }
-
-  // Build complete nmcli command for creating WiFi AP connection
-  char command[2048];
-  int written;
+  // Build nmcli argv for creating a WiFi AP connection. Values are passed
+  // verbatim, so no shell escaping is needed.
+  char *args[32];
+  int argc = 0;
+  char channel[16];
+
+  args[argc++] = "nmcli";
+  args[argc++] = "connection";
+  args[argc++] = "add";
+  args[argc++] = "type";
+  args[argc++] = "wifi";
+  args[argc++] = "ifname";
+  args[argc++] = (char *)config->wifi_interface;
+  args[argc++] = "con-name";
+  args[argc++] = (char *)config->name;
+  args[argc++] = "ssid";
+  args[argc++] = (char *)config->ssid;
+  args[argc++] = "802-11-wireless.mode";
+  args[argc++] = "ap";
 
   if (config->password[0] != '\0' &&
       config->security_type != WIFI_SECURITY_NONE) {
     // Secured hotspot with password
-    char escaped_password[512];
-    if (!shell_escape(config->password, escaped_password,
-                      sizeof(escaped_password))) {
-      result.result = WTERM_ERROR_INVALID_INPUT;
-      safe_string_copy(result.error_message,
-                       "Password too long for shell escaping",
-                       sizeof(result.error_message));
-      return result;
-    }
-
-    written = snprintf(
-        command, sizeof(command),
-        "nmcli connection add type wifi ifname %s con-name %s ssid %s "
-        "802-11-wireless.mode ap "
-        "802-11-wireless-security.key-mgmt wpa-psk "
-        "802-11-wireless-security.psk %s "
-        "ipv4.method shared "
-        "ipv4.addresses 192.168.12.1/24",
-        config->wifi_interface, config->name, escaped_ssid, escaped_password);
-  } else {
-    // Open hotspot without password
-    written =
-        snprintf(command, sizeof(command),
-                 "nmcli connection add type wifi ifname %s con-name %s ssid %s "
-                 "802-11-wireless.mode ap "
-                 "ipv4.method shared "
-                 "ipv4.addresses 192.168.12.1/24",
-                 config->wifi_interface, config->name, escaped_ssid);
-  }
-
-  if (written >= (int)sizeof(command)) {
-    result.result = WTERM_ERROR_GENERAL;
-    safe_string_copy(result.error_message, "Command too long",
-                     sizeof(result.error_message));
-    return result;
+    args[argc++] = "802-11-wireless-security.key-mgmt";
+    args[argc++] = "wpa-psk";
+    args[argc++] = "802-11-wireless-security.psk";
+    args[argc++] = (char *)config->password;
   }
 
+  args[argc++] = "ipv4.method";
+  args[argc++] = "shared";
+  args[argc++] = "ipv4.addresses";
+  args[argc++] = "192.168.12.1/24";
+
   // Add optional channel configuration
   if (config->channel > 0) {
-    char temp[2048];
-    written = snprintf(temp, sizeof(temp), "%s 802-11-wireless.channel %d",
-                       command, config->channel);
-    if (written >= (int)sizeof(temp)) {
-      result.result = WTERM_ERROR_GENERAL;
-      safe_string_copy(result.error_message, "Command with channel too long",
-                       sizeof(result.error_message));
-      return result;
-    }
-    safe_string_copy(command, temp, sizeof(command));
+    snprintf(channel, sizeof(channel), "%d", config->channel);
+    args[argc++] = "802-11-wireless.channel";
+    args[argc++] = channel;
   }
 
-  // Add optional band configuration (2.4GHz or 5GHz)
-  if (config->is_5ghz) {
-    char temp[2048];
-    written =
-        snprintf(temp, sizeof(temp), "%s 802-11-wireless.band a", command);
-    if (written >= (int)sizeof(temp)) {
-      result.result = WTERM_ERROR_GENERAL;
-      safe_string_copy(result.error_message, "Command with band too long",
-                       sizeof(result.error_message));
-      return result;
-    }
-    safe_string_copy(command, temp, sizeof(command));
-  } else {
-    char temp[2048];
-    written =
-        snprintf(temp, sizeof(temp), "%s 802-11-wireless.band bg", command);
-    if (written >= (int)sizeof(temp)) {
-      result.result = WTERM_ERROR_GENERAL;
-      safe_string_copy(result.error_message, "Command with band too long",
-                       sizeof(result.error_message));
-      return result;
-    }
-    safe_string_copy(command, temp, sizeof(command));
-  }
+  // Add band configuration (2.4GHz or 5GHz)
+  args[argc++] = "802-11-wireless.band";
+  args[argc++] = config->is_5ghz ? "a" : "bg";
+  args[argc] = NULL;
 
-  // Execute command
-  char command_with_stderr[2056]; // Increased buffer size
-  written = snprintf(command_with_stderr, sizeof(command_with_stderr),
-                     "%s 2>&1", command);
-  if (written >= (int)sizeof(command_with_stderr)) {
-    result.result = WTERM_ERROR_GENERAL;
-    safe_string_copy(result.error_message, "Final command too long",
-                     sizeof(result.error_message));
-    return result;
-  }
-
-  return execute_nmcli_command(command_with_stderr);
+  return execute_nmcli_command(args);
 }
 
 static backend_result_t nmcli_start_hotspot(const char *hotspot_name) {
@@ -455,12 +664,9 @@ static backend_result_t nmcli_start_hotspot(const char *hotspot_name) {
     return result;
   }
 
-  char command[256];
-  // hotspot_name is already validated, safe to use directly
-  snprintf(command, sizeof(command), "nmcli connection up %s 2>&1",
-           hotspot_name);
-
-  return execute_nmcli_command(command);
+  char *const args[] = {"nmcli", "connection", "up", (char *)hotspot_name,
+                        NULL};
+  return execute_nmcli_command(args);
 }
 
 static backend_result_t nmcli_stop_hotspot(const char *hotspot_name) {
@@ -482,11 +688,9 @@ static backend_result_t nmcli_stop_hotspot(const char *hotspot_name) {
     return result;
   }
 
-  char command[256];
-  snprintf(command, sizeof(command), "nmcli connection down %s 2>&1",
-           hotspot_name);
-
-  return execute_nmcli_command(command);
+  char *const args[] = {"nmcli", "connection", "down", (char *)hotspot_name,
+                        NULL};
+  return execute_nmcli_command(args);
 }
 
 static backend_result_t nmcli_delete_hotspot(const char *hotspot_name) {
@@ -509,20 +713,14 @@ static backend_result_t nmcli_delete_hotspot(const char *hotspot_name) {
   }
 
   // First stop the hotspot if it's running (silently ignore errors if already stopped)
-  char stop_command[256];
-  snprintf(stop_command, sizeof(stop_command),
-           "nmcli connection down %s 2>/dev/null", hotspot_name);
-  FILE *fp = popen(stop_command, "r");
-  if (fp) {
-    pclose(fp); // Ignore return value - hotspot might already be stopped
-  }
+  char *const stop_args[] = {"nmcli", "connection", "down",
+                             (char *)hotspot_name, NULL};
+  safe_exec_check_silent("nmcli", stop_args);
 
   // Then delete the connection
-  char command[256];
-  snprintf(command, sizeof(command), "nmcli connection delete %s 2>&1",
-           hotspot_name);
-
-  return execute_nmcli_command(command);
+  char *const args[] = {"nmcli", "connection", "delete", (char *)hotspot_name,
+                        NULL};
+  return execute_nmcli_command(args);
 }
 
 static wterm_result_t nmcli_get_hotspot_status(const char *hotspot_name,
@@ -536,54 +734,66 @@ static wterm_result_t nmcli_get_hotspot_status(const char *hotspot_name,
     return WTERM_ERROR_INVALID_INPUT;
   }
 
-  // Check if hotspot connection exists and get its state
-  char command[256];
-  snprintf(command, sizeof(command),
-           "nmcli -t -f NAME,TYPE,STATE connection show %s 2>/dev/null",
-           hotspot_name);
-
-  FILE *fp = popen(command, "r");
-  if (!fp) {
-    return WTERM_ERROR_NETWORK;
+  // Mode and state of the profile; GENERAL.STATE is only reported while
+  // the profile is active
+  char *const args[] = {"nmcli",
+                        "-t",
+                        "-f",
+                        "802-11-wireless.mode,GENERAL.STATE",
+                        "connection",
+                        "show",
+                        (char *)hotspot_name,
+                        NULL};
+  safe_exec_output_t output;
+  if (!query_cache_capture("nmcli", args, QUERY_CACHE_SHORT_TTL_MS, &output)) {
+    // Unknown profile
+    status->state = HOTSPOT_STATE_STOPPED;
+    safe_string_copy(status->status_message, "Hotspot configuration not found",
+                     sizeof(status->status_message));
+    return WTERM_SUCCESS;
   }
 
-  char buffer[256];
   bool hotspot_found = false;
+  const char *state_field = "";
+  char *cursor = output.out;
+  char *line;
+
+  while ((line = safe_exec_next_line(&cursor))) {
+    // Parse: FIELD:VALUE
+    char *fields[2];
+    if (split_terse_fields(line, fields, 2) != 2) {
+      continue;
+    }
 
-  if (fgets(buffer, sizeof(buffer), fp)) {
-    buffer[strcspn(buffer, "\n")] = '\0';
-
-    // Parse nmcli output: NAME:TYPE:STATE
-    const char *name_field = strtok(buffer, ":");
-    const char *type_field = strtok(NULL, ":");
-    const char *state_field = strtok(NULL, ":");
-
-    if (name_field && type_field && state_field &&
-        strcmp(type_field, "wifi-hotspot") == 0) {
-      hotspot_found = true;
-
-      // Convert nmcli state to wterm hotspot state
-      if (strcmp(state_field, "activated") == 0) {
-        status->state = HOTSPOT_STATE_ACTIVE;
-        safe_string_copy(status->status_message, "Hotspot is active",
-                         sizeof(status->status_message));
-      } else if (strcmp(state_field, "activating") == 0) {
-        status->state = HOTSPOT_STATE_STARTING;
-        safe_string_copy(status->status_message, "Hotspot is starting",
-                         sizeof(status->status_message));
-      } else if (strcmp(state_field, "deactivating") == 0) {
-        status->state = HOTSPOT_STATE_STOPPING;
-        safe_string_copy(status->status_message, "Hotspot is stopping",
-                         sizeof(status->status_message));
-      } else {
-        status->state = HOTSPOT_STATE_STOPPED;
-        safe_string_copy(status->status_message, "Hotspot is stopped",
-                         sizeof(status->status_message));
-      }
+    if (strcmp(fields[0], "802-11-wireless.mode") == 0) {
+      hotspot_found = strcmp(fields[1], "ap") == 0;
+    } else if (strcmp(fields[0], "GENERAL.STATE") == 0) {
+      state_field = fields[1];
     }
   }
 
-  pclose(fp);
+  if (hotspot_found) {
+    // Convert nmcli state to wterm hotspot state
+    if (strcmp(state_field, "activated") == 0) {
+      status->state = HOTSPOT_STATE_ACTIVE;
+      safe_string_copy(status->status_message, "Hotspot is active",
+                       sizeof(status->status_message));
+    } else if (strcmp(state_field, "activating") == 0) {
+      status->state = HOTSPOT_STATE_STARTING;
+      safe_string_copy(status->status_message, "Hotspot is starting",
+                       sizeof(status->status_message));
+    } else if (strcmp(state_field, "deactivating") == 0) {
+      status->state = HOTSPOT_STATE_STOPPING;
+      safe_string_copy(status->status_message, "Hotspot is stopping",
+                       sizeof(status->status_message));
+    } else {
+      status->state = HOTSPOT_STATE_STOPPED;
+      safe_string_copy(status->status_message, "Hotspot is stopped",
+                       sizeof(status->status_message));
+    }
+  }
+
+  safe_exec_output_free(&output);
 
   if (!hotspot_found) {
     status->state = HOTSPOT_STATE_STOPPED;
@@ -594,6 +804,27 @@ static wterm_result_t nmcli_get_hotspot_status(const char *hotspot_name,
   return WTERM_SUCCESS;
 }
 
+// Whether a WiFi profile is in AP (hotspot) mode
+static bool connection_is_ap(const char *name) {
+  char *const args[] = {"nmcli", "-t", "-f", "802-11-wireless.mode",
+                        "connection", "show", (char *)name, NULL};
+  safe_exec_output_t output;
+  if (!query_cache_capture("nmcli", args, QUERY_CACHE_SHORT_TTL_MS, &output)) {
+    return false;
+  }
+
+  bool is_ap = false;
+  char *cursor = output.out;
+  char *line = safe_exec_next_line(&cursor);
+  if (line) {
+    const char *value = strchr(line, ':');
+    is_ap = value && strcmp(value + 1, "ap") == 0;
+  }
+
+  safe_exec_output_free(&output);
+  return is_ap;
+}
+
 static wterm_result_t
 nmcli_list_active_hotspots(char active_hotspots[][MAX_STR_SSID], int max_count,
                            int *count) {
@@ -603,30 +834,29 @@ nmcli_list_active_hotspots(char active_hotspots[][MAX_STR_SSID], int max_count,
 
   *count = 0;
 
-  FILE *fp = popen(
-      "nmcli -t -f NAME,TYPE,STATE connection show --active 2>/dev/null", "r");
-  if (!fp) {
+  // nmcli reports hotspots as 802-11-wireless profiles in AP mode
+  char *const args[] = {"nmcli",      "-t",   "-f",       "NAME,TYPE,STATE",
+                        "connection", "show", "--active", NULL};
+  safe_exec_output_t output;
+  if (!query_cache_capture("nmcli", args, QUERY_CACHE_SHORT_TTL_MS, &output)) {
     return WTERM_ERROR_NETWORK;
   }
 
-  char buffer[256];
-  while (fgets(buffer, sizeof(buffer), fp) && *count < max_count) {
-    buffer[strcspn(buffer, "\n")] = '\0';
-
+  char *cursor = output.out;
+  char *line;
+  while ((line = safe_exec_next_line(&cursor)) && *count < max_count) {
     // Parse: NAME:TYPE:STATE
-    const char *name_field = strtok(buffer, ":");
-    const char *type_field = strtok(NULL, ":");
-    const char *state_field = strtok(NULL, ":");
-
-    if (name_field && type_field && state_field &&
-        strcmp(type_field, "wifi-hotspot") == 0 &&
-        strcmp(state_field, "activated") == 0) {
-      safe_string_copy(active_hotspots[*count], name_field, MAX_STR_SSID);
+    char *fields[3];
+    int field_count = split_terse_fields(line, fields, 3);
+
+    if (field_count == 3 && strcmp(fields[1], "802-11-wireless") == 0 &&
+        strcmp(fields[2], "activated") == 0 && connection_is_ap(fields[0])) {
+      safe_string_copy(active_hotspots[*count], fields[0], MAX_STR_SSID);
       (*count)++;
     }
   }
 
-  pclose(fp);
+  safe_exec_output_free(&output);
   return WTERM_SUCCESS;
 }
 
@@ -641,43 +871,45 @@ static wterm_result_t nmcli_get_hotspot_clients(const char *hotspot_name,
   *client_count = 0;
 
   // Get the interface associated with the hotspot
-  char command[256];
-  snprintf(
-      command, sizeof(command),
-      "nmcli -t -f connection.interface-name connection show %s 2>/dev/null",
-      hotspot_name);
-
-  FILE *fp = popen(command, "r");
-  if (!fp) {
+  char *const iface_args[] = {"nmcli",
+                              "-t",
+                              "-f",
+                              "connection.interface-name",
+                              "connection",
+                              "show",
+                              (char *)hotspot_name,
+                              NULL};
+  safe_exec_output_t output;
+  if (!safe_exec_capture("nmcli", iface_args, &output)) {
     return WTERM_ERROR_NETWORK;
   }
 
   char interface[MAX_STR_INTERFACE] = {0};
-  if (fgets(interface, sizeof(interface), fp)) {
-    interface[strcspn(interface, "\n")] = '\0';
+  char *cursor = output.out;
+  char *line = safe_exec_next_line(&cursor);
+  if (line) {
+    // Terse output is "connection.interface-name:wlan0"
+    const char *value = strchr(line, ':');
+    safe_string_copy(interface, value ? value + 1 : line, sizeof(interface));
   }
-  pclose(fp);
+  safe_exec_output_free(&output);
 
   if (strlen(interface) == 0) {
     return WTERM_ERROR_GENERAL; // Could not find interface
   }
 
   // Use iw to get station information (requires root privileges)
-  snprintf(command, sizeof(command), "iw dev %s station dump 2>/dev/null",
-           interface);
-
-  fp = popen(command, "r");
-  if (!fp) {
+  char *const iw_args[] = {"iw", "dev", interface, "station", "dump", NULL};
+  if (!safe_exec_capture("iw", iw_args, &output)) {
     return WTERM_ERROR_NETWORK;
   }
 
-  char buffer[256];
-  while (fgets(buffer, sizeof(buffer), fp) && *client_count < max_clients) {
-    buffer[strcspn(buffer, "\n")] = '\0';
-
+  cursor = output.out;
+  while ((line = safe_exec_next_line(&cursor)) &&
+         *client_count < max_clients) {
     // Look for "Station" lines that contain MAC addresses
-    if (strncmp(buffer, "Station ", 8) == 0) {
-      char *mac_start = buffer + 8;
+    if (strncmp(line, "Station ", 8) == 0) {
+      char *mac_start = line + 8;
       char *space_pos = strchr(mac_start, ' ');
       if (space_pos) {
         *space_pos = '\0';
@@ -696,10 +928,17 @@ static wterm_result_t nmcli_get_hotspot_clients(const char *hotspot_name,
     }
   }
 
-  pclose(fp);
+  safe_exec_output_free(&output);
   return WTERM_SUCCESS;
 }
 
+// List "DEVICE:TYPE" pairs from nmcli device status
+static bool nmcli_device_types(safe_exec_output_t *output) {
+  char *const args[] = {"nmcli", "-t", "-f", "DEVICE,TYPE", "device", "status",
+                        NULL};
+  return safe_exec_capture("nmcli", args, output);
+}
+
 static wterm_result_t nmcli_check_interface_ap_support(const char *interface,
                                                        bool *supports_ap) {
   if (!interface || !supports_ap) {
@@ -709,26 +948,23 @@ static wterm_result_t nmcli_check_interface_ap_support(const char *interface,
   *supports_ap = false;
 
   // First verify this is a WiFi interface via nmcli
-  FILE *fp = popen("nmcli -t -f DEVICE,TYPE device status", "r");
-  if (!fp) {
+  safe_exec_output_t output;
+  if (!nmcli_device_types(&output)) {
     return WTERM_ERROR_NETWORK;
   }
 
   bool is_wifi = false;
-  char buffer[256];
-  while (fgets(buffer, sizeof(buffer), fp)) {
-    buffer[strcspn(buffer, "\n")] = '\0';
-
-    const char *device_field = strtok(buffer, ":");
-    const char *type_field = strtok(NULL, ":");
-
-    if (device_field && type_field && strcmp(device_field, interface) == 0 &&
-        strcmp(type_field, "wifi") == 0) {
+  char *cursor = output.out;
+  char *line;
+  while ((line = safe_exec_next_line(&cursor))) {
+    char *fields[2];
+    if (split_terse_fields(line, fields, 2) == 2 &&
+        strcmp(fields[0], interface) == 0 && strcmp(fields[1], "wifi") == 0) {
       is_wifi = true;
       break;
     }
   }
-  pclose(fp);
+  safe_exec_output_free(&output);
 
   if (!is_wifi) {
     return WTERM_ERROR_GENERAL; // Not a WiFi interface
@@ -753,27 +989,25 @@ nmcli_get_available_wifi_interfaces(char interfaces[][MAX_STR_INTERFACE],
 
   *interface_count = 0;
 
-  FILE *fp = popen("nmcli -t -f DEVICE,TYPE device status 2>/dev/null", "r");
-  if (!fp) {
+  safe_exec_output_t output;
+  if (!nmcli_device_types(&output)) {
     return WTERM_ERROR_NETWORK;
   }
 
-  char buffer[128];
-  while (fgets(buffer, sizeof(buffer), fp) &&
+  char *cursor = output.out;
+  char *line;
+  while ((line = safe_exec_next_line(&cursor)) &&
          *interface_count < max_interfaces) {
-    buffer[strcspn(buffer, "\n")] = '\0';
-
     // Parse: DEVICE:TYPE
-    const char *device_field = strtok(buffer, ":");
-    const char *type_field = strtok(NULL, ":");
-
-    if (device_field && type_field && strcmp(type_field, "wifi") == 0) {
-      safe_string_copy(interfaces[*interface_count], device_field,
+    char *fields[2];
+    if (split_terse_fields(line, fields, 2) == 2 &&
+        strcmp(fields[1], "wifi") == 0) {
+      safe_string_copy(interfaces[*interface_count], fields[0],
                        MAX_STR_INTERFACE);
       (*interface_count)++;
     }
   }
 
-  pclose(fp);
+  safe_exec_output_free(&output);
   return WTERM_SUCCESS;
 }
@@ -6,6 +6,8 @@
 #define _POSIX_C_SOURCE 200809L
 #include "network_scanner.h"
 #include "network_backends/backend_interface.h"
+#include "scan_pipeline.h"
+#include "../utils/network_list.h"
 #include "../utils/string_utils.h"
 #include "error_queue.h"
 #include <stdio.h>
@@ -62,42 +64,163 @@ wterm_result_t parse_network_line(const char *buffer, network_info_t *network) {
   return WTERM_SUCCESS;
 }
 
-wterm_result_t scan_wifi_networks(network_list_t *network_list) {
-  if (!network_list) {
+wterm_result_t parse_network_record(const char *buffer, network_info_t *network,
+                                    scan_record_t *record) {
+  if (!buffer || !network || !record) {
     return WTERM_ERROR_INVALID_INPUT;
   }
 
-  // Initialize network list
-  network_list->count = 0;
-  memset(network_list->networks, 0, sizeof(network_list->networks));
+  char line[512];
+  if (!safe_string_copy(line, buffer, sizeof(line))) {
+    return WTERM_ERROR_PARSE;
+  }
+
+  // BSSID:SSID:SECURITY:SIGNAL:FREQ:CHAN:RATE
+  char *fields[7];
+  if (split_terse_fields(line, fields, 7) != 7) {
+    return WTERM_ERROR_PARSE;
+  }
+
+  memset(network, 0, sizeof(network_info_t));
+  memset(record, 0, sizeof(scan_record_t));
+
+  safe_string_copy(network->ssid, fields[1], MAX_STR_SSID);
+  trim_trailing_whitespace(network->ssid);
+  trim_trailing_whitespace(fields[2]);
+  safe_string_copy(network->security, fields[2][0] ? fields[2] : "Open",
+                   MAX_STR_SECURITY);
+  safe_string_copy(network->signal, fields[3], MAX_STR_SIGNAL);
+  trim_trailing_whitespace(network->signal);
+
+  // Units ("MHz", "Mbit/s") are dropped by atoi
+  int quality = atoi(fields[3]);
+  network_parse_bssid(fields[0], record->bssid);
+  record->quality = (uint8_t)(quality < 0 ? 0 : quality > 100 ? 100 : quality);
+  record->frequency = (uint16_t)atoi(fields[4]);
+  record->channel = (uint16_t)atoi(fields[5]);
+  record->max_rate = (uint16_t)atoi(fields[6]);
+  record->security_flags = network_security_flags(network->security);
+
+  return WTERM_SUCCESS;
+}
+
+// Errors go to stderr and the error queue, or only to the queue when
+// quiet (background threads must not write over the TUI)
+#define SCAN_REPORT(quiet, format, ...) \
+  do { \
+    if (quiet) { \
+      error_queue_push_formatted(true, format, __VA_ARGS__); \
+    } else { \
+      REPORT_ERROR(true, format, __VA_ARGS__); \
+    } \
+  } while (0)
+
+static wterm_result_t scan_cached(wterm_ctx_t *ctx, network_list_t *network_list,
+                                  bool quiet) {
+  if (!ctx || !network_list) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  // Drop previous results; the list's memory is reused for this scan
+  network_list_clear(network_list);
 
   // Get the current backend
-  const network_backend_t* backend = get_current_backend();
+  const network_backend_t* backend = get_current_backend_ctx(ctx);
   if (!backend) {
-    REPORT_ERROR(true, "No supported network manager found. Please install NetworkManager (nmcli) or iwd (iwctl).%s", "");
+    SCAN_REPORT(quiet, "No supported network manager found. Please install NetworkManager (nmcli) or iwd (iwctl).%s", "");
     return WTERM_ERROR_NETWORK;
   }
 
   // Use backend to scan networks
   wterm_result_t result = backend->scan_networks(network_list);
   if (result != WTERM_SUCCESS) {
-    REPORT_ERROR(true, "Failed to scan networks using %s", backend->name);
+    SCAN_REPORT(quiet, "Failed to scan networks using %s", backend->name);
     return result;
   }
 
   return WTERM_SUCCESS;
 }
 
+static wterm_result_t scan_fresh(wterm_ctx_t *ctx, network_list_t *network_list,
+                                 int timeout_ms, bool quiet) {
+  if (!ctx || !network_list) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+  if (timeout_ms <= 0) {
+    timeout_ms = SCAN_FRESH_DEFAULT_TIMEOUT_MS;
+  }
+
+  network_list_clear(network_list);
+
+  const network_backend_t* backend = get_current_backend_ctx(ctx);
+  if (!backend) {
+    SCAN_REPORT(quiet, "No supported network manager found. Please install NetworkManager (nmcli) or iwd (iwctl).%s", "");
+    return WTERM_ERROR_NETWORK;
+  }
+
+  wterm_result_t result;
+  if (backend->scan_networks_fresh) {
+    result = backend->scan_networks_fresh(network_list, timeout_ms);
+  } else {
+    // No completion signal: trigger, then read whatever is cached
+    backend->rescan_networks();
+    result = backend->scan_networks(network_list);
+    network_list->is_stale = true;
+  }
+
+  if (result != WTERM_SUCCESS) {
+    SCAN_REPORT(quiet, "Failed to scan networks using %s", backend->name);
+  }
+  return result;
+}
+
+wterm_result_t scan_wifi_networks(network_list_t *network_list) {
+  return scan_wifi_networks_ctx(wterm_ctx_default(), network_list);
+}
+
+wterm_result_t scan_wifi_networks_ctx(wterm_ctx_t *ctx,
+                                      network_list_t *network_list) {
+  return scan_cached(ctx, network_list, false);
+}
+
+wterm_result_t scan_wifi_networks_fresh(network_list_t *network_list,
+                                        int timeout_ms) {
+  return scan_wifi_networks_fresh_ctx(wterm_ctx_default(), network_list,
+                                      timeout_ms);
+}
+
+wterm_result_t scan_wifi_networks_fresh_ctx(wterm_ctx_t *ctx,
+                                            network_list_t *network_list,
+                                            int timeout_ms) {
+  return scan_fresh(ctx, network_list, timeout_ms, false);
+}
+
+wterm_result_t scan_wifi_networks_quiet(network_list_t *network_list,
+                                        bool fresh) {
+  wterm_ctx_t *ctx = wterm_ctx_default();
+  return fresh ? scan_fresh(ctx, network_list, SCAN_FRESH_DEFAULT_TIMEOUT_MS, true)
+               : scan_cached(ctx, network_list, true);
+}
+
 void display_networks(const network_list_t *network_list) {
   if (!network_list) {
     printf("No network list provided\n");
     return;
   }
 
-  printf("Found %d Wi-Fi networks:\n\n", network_list->count);
+  // One line per SSID (its strongest BSSID), strongest first
+  scan_view_t view = {0};
+  if (scan_view_build(&view, network_list, NULL) != WTERM_SUCCESS) {
+    scan_view_free(&view);
+    printf("Failed to process network list\n");
+    return;
+  }
+
+  printf("Found %d Wi-Fi networks:\n\n", view.count);
 
-  if (network_list->count == 0) {
+  if (view.count == 0) {
     printf("No networks found. Try running a rescan.\n");
+    scan_view_free(&view);
     return;
   }
 
@@ -107,11 +230,13 @@ void display_networks(const network_list_t *network_list) {
          "----------------------------------------------------------------");
 
   // Print each network
-  for (int i = 0; i < network_list->count; i++) {
-    const network_info_t *network = &network_list->networks[i];
+  for (int i = 0; i < view.count; i++) {
+    const network_info_t *network = &network_list->networks[view.order[i]];
     printf("%-32s | %-16s | %s\n", network->ssid, network->security,
            network->signal);
   }
+
+  scan_view_free(&view);
 }
 
 wterm_result_t rescan_wifi_networks(void) {
@@ -6,13 +6,59 @@
  */
 
 #include "../../include/wterm/common.h"
+#include "../utils/network_list.h"
+#include "context.h"
 
 /**
  * @brief Scan for available WiFi networks
+ *
+ * The list must be zero-initialized (or passed through network_list_init())
+ * before the first scan. It can be reused across scans and is released with
+ * network_list_free().
+ *
+ * The _ctx variant uses the context's backend; the plain one uses the
+ * default context.
+ *
  * @param network_list Pointer to network_list_t structure to populate
  * @return wterm_result_t Result code
  */
 wterm_result_t scan_wifi_networks(network_list_t *network_list);
+wterm_result_t scan_wifi_networks_ctx(wterm_ctx_t *ctx, network_list_t *network_list);
+
+// Default deadline for scan_wifi_networks_fresh(); dual-band scans take 3-5s
+#define SCAN_FRESH_DEFAULT_TIMEOUT_MS 10000
+
+/**
+ * @brief Trigger a scan and return its results once it has completed
+ *
+ * Completion is detected per backend: the nl80211 scan-done event,
+ * NetworkManager's LastScan property, or `nmcli device wifi list --rescan
+ * yes`. If the scan is refused or does not finish before the deadline, the
+ * backend's cached results are returned with network_list->is_stale set.
+ *
+ * @param network_list List to populate (see scan_wifi_networks())
+ * @param timeout_ms Deadline, or 0 for SCAN_FRESH_DEFAULT_TIMEOUT_MS
+ * @return wterm_result_t Result code
+ */
+wterm_result_t scan_wifi_networks_fresh(network_list_t *network_list,
+                                        int timeout_ms);
+wterm_result_t scan_wifi_networks_fresh_ctx(wterm_ctx_t *ctx,
+                                            network_list_t *network_list,
+                                            int timeout_ms);
+
+/**
+ * @brief Scan from a background thread
+ *
+ * Same as scan_wifi_networks() or, with fresh, scan_wifi_networks_fresh()
+ * with the default deadline, except that failures only go to the error
+ * queue. Nothing is written to stderr, which the TUI may own.
+ *
+ * @param network_list List to populate (see scan_wifi_networks())
+ * @param fresh Trigger a scan and wait for it
+ * @return wterm_result_t Result code
+ */
+wterm_result_t scan_wifi_networks_quiet(network_list_t *network_list,
+                                        bool fresh);
 
 /**
  * @brief Parse a single line of nmcli output
@@ -22,6 +68,23 @@ wterm_result_t scan_wifi_networks(network_list_t *network_list);
  */
 wterm_result_t parse_network_line(const char *buffer, network_info_t *network);
 
+// nmcli fields requested for BSSID-level scan records, in parse order
+#define NMCLI_SCAN_FIELDS "BSSID,SSID,SECURITY,SIGNAL,FREQ,CHAN,RATE"
+
+/**
+ * @brief Parse one line of `nmcli -t -f NMCLI_SCAN_FIELDS device wifi list`
+ *
+ * Handles nmcli's terse escaping, so SSIDs and BSSIDs containing ':' are
+ * split correctly.
+ *
+ * @param buffer Input line from nmcli
+ * @param network String view to populate (SSID, security, signal)
+ * @param record Numeric scan record to populate
+ * @return wterm_result_t Result code
+ */
+wterm_result_t parse_network_record(const char *buffer, network_info_t *network,
+                                    scan_record_t *record);
+
 /**
  * @brief Display network list in formatted output
  * @param network_list Pointer to network_list_t structure to display
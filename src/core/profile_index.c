@@ -0,0 +1,290 @@
+/**
+ * @file profile_index.c
+ * @brief In-memory index of saved NetworkManager connection profiles
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "profile_index.h"
+#include "../utils/safe_exec.h"
+#include "../utils/string_utils.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WIRELESS_TYPE "802-11-wireless"
+
+static uint32_t fnv1a(const char *text) {
+  uint32_t hash = 2166136261u;
+  for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+    hash ^= *p;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static bool is_wireless(const saved_profile_t *profile) {
+  return strcmp(profile->type, WIRELESS_TYPE) == 0;
+}
+
+static void index_clear(profile_index_t *index) {
+  index->count = 0;
+  if (index->ssid_slots) {
+    memset(index->ssid_slots, 0xFF, (size_t)index->slot_count * sizeof(int));
+    memset(index->name_slots, 0xFF, (size_t)index->slot_count * sizeof(int));
+  }
+}
+
+static saved_profile_t *append_profile(profile_index_t *index) {
+  if (index->count == index->capacity) {
+    int capacity = index->capacity ? index->capacity * 2 : 32;
+    saved_profile_t *profiles =
+        realloc(index->profiles, (size_t)capacity * sizeof(*profiles));
+    if (!profiles) {
+      return NULL;
+    }
+    index->profiles = profiles;
+    index->capacity = capacity;
+  }
+
+  saved_profile_t *profile = &index->profiles[index->count++];
+  memset(profile, 0, sizeof(*profile));
+  return profile;
+}
+
+// One "NAME:UUID:TYPE:AUTOCONNECT-PRIORITY" line per profile
+static bool parse_list(profile_index_t *index, char *output) {
+  char *cursor = output;
+  char *line;
+  while ((line = safe_exec_next_line(&cursor))) {
+    char *fields[4] = {NULL};
+    int field_count = split_terse_fields(line, fields, 4);
+    if (field_count < 3 || fields[0][0] == '\0') {
+      continue;
+    }
+
+    saved_profile_t *profile = append_profile(index);
+    if (!profile) {
+      return false;
+    }
+    safe_string_copy(profile->name, fields[0], sizeof(profile->name));
+    safe_string_copy(profile->uuid, fields[1], sizeof(profile->uuid));
+    safe_string_copy(profile->type, fields[2], sizeof(profile->type));
+    profile->autoconnect_priority = field_count > 3 ? atoi(fields[3]) : 0;
+
+    // Profiles are usually named after their SSID; details refine this
+    if (is_wireless(profile)) {
+      safe_string_copy(profile->ssid, profile->name, sizeof(profile->ssid));
+    }
+  }
+  return true;
+}
+
+// "connection.uuid:<uuid>" then "802-11-wireless.ssid:<ssid>" per profile,
+// in the order the UUIDs were requested
+static void apply_details(profile_index_t *index, char *output) {
+  saved_profile_t *current = NULL;
+  int next = 0;
+
+  char *cursor = output;
+  char *line;
+  while ((line = safe_exec_next_line(&cursor))) {
+    char *fields[2] = {NULL};
+    if (split_terse_fields(line, fields, 2) != 2) {
+      continue;
+    }
+
+    if (strcmp(fields[0], "connection.uuid") == 0) {
+      current = NULL;
+      for (int n = 0; n < index->count && !current; n++) {
+        int i = (next + n) % index->count;
+        if (strcmp(index->profiles[i].uuid, fields[1]) == 0) {
+          current = &index->profiles[i];
+          next = i + 1;
+        }
+      }
+    } else if (current && strcmp(fields[0], "802-11-wireless.ssid") == 0 &&
+               fields[1][0] != '\0') {
+      safe_string_copy(current->ssid, fields[1], sizeof(current->ssid));
+    }
+  }
+}
+
+static uint32_t find_slot(const profile_index_t *index, const int *slots,
+                          const char *key, bool by_ssid) {
+  uint32_t mask = (uint32_t)index->slot_count - 1;
+  uint32_t slot = fnv1a(key) & mask;
+  while (slots[slot] >= 0) {
+    const saved_profile_t *profile = &index->profiles[slots[slot]];
+    if (strcmp(by_ssid ? profile->ssid : profile->name, key) == 0) {
+      break;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+static bool build_tables(profile_index_t *index) {
+  int slots = 16;
+  while (slots < index->count * 2) {
+    slots *= 2;
+  }
+  if (slots > index->slot_count) {
+    int *ssid_slots = realloc(index->ssid_slots, (size_t)slots * sizeof(int));
+    if (ssid_slots) {
+      index->ssid_slots = ssid_slots;
+    }
+    int *name_slots = realloc(index->name_slots, (size_t)slots * sizeof(int));
+    if (name_slots) {
+      index->name_slots = name_slots;
+    }
+    if (!ssid_slots || !name_slots) {
+      return false;
+    }
+    index->slot_count = slots;
+  }
+
+  memset(index->ssid_slots, 0xFF, (size_t)index->slot_count * sizeof(int));
+  memset(index->name_slots, 0xFF, (size_t)index->slot_count * sizeof(int));
+  for (int i = 0; i < index->count; i++) {
+    const saved_profile_t *profile = &index->profiles[i];
+
+    uint32_t slot = find_slot(index, index->name_slots, profile->name, false);
+    if (index->name_slots[slot] < 0) {
+      index->name_slots[slot] = i;
+    }
+
+    if (!is_wireless(profile) || profile->ssid[0] == '\0') {
+      continue;
+    }
+    slot = find_slot(index, index->ssid_slots, profile->ssid, true);
+    int existing = index->ssid_slots[slot];
+    if (existing < 0 || profile->autoconnect_priority >
+                            index->profiles[existing].autoconnect_priority) {
+      index->ssid_slots[slot] = i;
+    }
+  }
+  return true;
+}
+
+wterm_result_t profile_index_parse(profile_index_t *index, char *list_output,
+                                   char *detail_output) {
+  if (!index || !list_output) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  index_clear(index);
+  if (!parse_list(index, list_output)) {
+    index_clear(index);
+    return WTERM_ERROR_MEMORY;
+  }
+  if (detail_output) {
+    apply_details(index, detail_output);
+  }
+  if (!build_tables(index)) {
+    index_clear(index);
+    return WTERM_ERROR_MEMORY;
+  }
+  return WTERM_SUCCESS;
+}
+
+// SSIDs of all wireless profiles in one nmcli call
+static void load_details(profile_index_t *index) {
+  int wireless = 0;
+  for (int i = 0; i < index->count; i++) {
+    if (is_wireless(&index->profiles[i]) && index->profiles[i].uuid[0]) {
+      wireless++;
+    }
+  }
+  if (wireless == 0) {
+    return;
+  }
+
+  char **args = malloc((size_t)(wireless + 7) * sizeof(char *));
+  if (!args) {
+    return;
+  }
+
+  int argc = 0;
+  args[argc++] = "nmcli";
+  args[argc++] = "-t";
+  args[argc++] = "-f";
+  args[argc++] = "connection.uuid,802-11-wireless.ssid";
+  args[argc++] = "connection";
+  args[argc++] = "show";
+  for (int i = 0; i < index->count; i++) {
+    if (is_wireless(&index->profiles[i]) && index->profiles[i].uuid[0]) {
+      args[argc++] = index->profiles[i].uuid;
+    }
+  }
+  args[argc] = NULL;
+
+  safe_exec_output_t output;
+  if (safe_exec_capture("nmcli", args, &output)) {
+    if (output.exit_code == 0) {
+      apply_details(index, output.out);
+    }
+    safe_exec_output_free(&output);
+  }
+  free(args);
+}
+
+wterm_result_t profile_index_load(profile_index_t *index) {
+  if (!index) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  index_clear(index);
+
+  char *const args[] = {"nmcli", "-t", "-f", "NAME,UUID,TYPE,AUTOCONNECT-PRIORITY",
+                        "connection", "show", NULL};
+  safe_exec_output_t output;
+  if (!safe_exec_capture("nmcli", args, &output)) {
+    return WTERM_ERROR_NETWORK;
+  }
+  if (output.exit_code != 0) {
+    safe_exec_output_free(&output);
+    return WTERM_ERROR_NETWORK;
+  }
+
+  bool parsed = parse_list(index, output.out);
+  safe_exec_output_free(&output);
+  if (parsed) {
+    load_details(index);
+  }
+  if (!parsed || !build_tables(index)) {
+    index_clear(index);
+    return WTERM_ERROR_MEMORY;
+  }
+  return WTERM_SUCCESS;
+}
+
+const saved_profile_t *profile_index_find_ssid(const profile_index_t *index,
+                                               const char *ssid) {
+  if (!index || !ssid || index->slot_count == 0) {
+    return NULL;
+  }
+
+  int found = index->ssid_slots[find_slot(index, index->ssid_slots, ssid, true)];
+  return found >= 0 ? &index->profiles[found] : NULL;
+}
+
+const saved_profile_t *profile_index_find_name(const profile_index_t *index,
+                                               const char *name) {
+  if (!index || !name || index->slot_count == 0) {
+    return NULL;
+  }
+
+  int found = index->name_slots[find_slot(index, index->name_slots, name, false)];
+  return found >= 0 ? &index->profiles[found] : NULL;
+}
+
+void profile_index_free(profile_index_t *index) {
+  if (!index) {
+    return;
+  }
+
+  free(index->profiles);
+  free(index->ssid_slots);
+  free(index->name_slots);
+  memset(index, 0, sizeof(*index));
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+ * @file profile_index.h
+ * @brief In-memory index of saved NetworkManager connection profiles
+ *
+ * Built from two nmcli queries (the profile list, then the SSIDs of all
+ * wireless profiles in one call) and hashed by SSID and by profile name,
+ * so "is this network saved?" is a table lookup instead of a process
+ * spawn and a linear scan.
+ */
+
+#include "../../include/wterm/common.h"
+
+#define PROFILE_NAME_MAX 128
+#define PROFILE_UUID_MAX 40
+#define PROFILE_TYPE_MAX 32
+
+/**
+ * @brief One saved connection profile
+ */
+typedef struct {
+  char name[PROFILE_NAME_MAX];
+  char uuid[PROFILE_UUID_MAX];
+  char type[PROFILE_TYPE_MAX];   // e.g. "802-11-wireless"
+  char ssid[MAX_STR_SSID];       // Empty for non-wireless profiles
+  int autoconnect_priority;
+} saved_profile_t;
+
+/**
+ * @brief Hashed profile set. A zero-initialized index is a valid empty index.
+ */
+typedef struct {
+  saved_profile_t *profiles;
+  int count;
+  int capacity;
+
+  // Open-addressing tables of profile indices, -1 for empty slots
+  int *ssid_slots;
+  int *name_slots;
+  int slot_count;
+} profile_index_t;
+
+/**
+ * @brief Rebuild the index from NetworkManager
+ * @return WTERM_SUCCESS, WTERM_ERROR_NETWORK if nmcli could not list
+ *         profiles, or WTERM_ERROR_MEMORY. The index is left empty on error.
+ */
+wterm_result_t profile_index_load(profile_index_t *index);
+
+/**
+ * @brief Rebuild the index from captured nmcli output
+ *
+ * @param index Index to fill (previous contents are dropped)
+ * @param list_output Output of
+ *        `nmcli -t -f NAME,UUID,TYPE,AUTOCONNECT-PRIORITY connection show`
+ *        (modified in place)
+ * @param detail_output Output of
+ *        `nmcli -t -f connection.uuid,802-11-wireless.ssid connection show
+ *        <uuid>...` for the wireless profiles (modified in place), or NULL
+ *        to use profile names as SSIDs
+ * @return WTERM_SUCCESS or WTERM_ERROR_MEMORY
+ */
+wterm_result_t profile_index_parse(profile_index_t *index, char *list_output,
+                                   char *detail_output);
+
+/**
+ * @brief Find the wireless profile for an SSID
+ *
+ * If several profiles share the SSID, the one with the highest
+ * autoconnect priority is returned.
+ */
+const saved_profile_t *profile_index_find_ssid(const profile_index_t *index,
+                                               const char *ssid);
+
+/**
+ * @brief Find a profile by connection name
+ */
+const saved_profile_t *profile_index_find_name(const profile_index_t *index,
+                                               const char *name);
+
+/**
+ * @brief Release the index's memory and reset it to empty
+ */
+void profile_index_free(profile_index_t *index);
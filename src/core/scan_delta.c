@@ -0,0 +1,258 @@
+/**
+ * @file scan_delta.c
+ * @brief Incremental diffing of consecutive scans
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "scan_delta.h"
+#include "../utils/network_list.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t fnv1a(const void *data, size_t len) {
+  uint32_t hash = 2166136261u;
+  const unsigned char *p = data;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= p[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static bool has_bssid(const network_list_t *list, int index) {
+  static const uint8_t zero[6] = {0};
+  return memcmp(list->bssid[index], zero, sizeof(zero)) != 0;
+}
+
+// Entries without a BSSID (legacy parsers) fall back to their SSID
+static uint32_t key_hash(const scan_delta_t *delta, const network_list_t *list,
+                         int index) {
+  if (delta->key == SCAN_DELTA_KEY_BSSID && has_bssid(list, index)) {
+    return fnv1a(list->bssid[index], sizeof(list->bssid[index]));
+  }
+  const char *ssid = list->networks[index].ssid;
+  return fnv1a(ssid, strlen(ssid));
+}
+
+static bool same_key(const scan_delta_t *delta, const network_list_t *a,
+                     int a_index, const network_list_t *b, int b_index) {
+  if (delta->key == SCAN_DELTA_KEY_BSSID) {
+    bool a_has = has_bssid(a, a_index);
+    if (a_has != has_bssid(b, b_index)) {
+      return false;
+    }
+    if (a_has) {
+      return memcmp(a->bssid[a_index], b->bssid[b_index],
+                    sizeof(a->bssid[a_index])) == 0;
+    }
+  }
+  return strcmp(a->networks[a_index].ssid, b->networks[b_index].ssid) == 0;
+}
+
+// Make room for `entries` keys and a hash table with >= 2x as many slots
+static bool delta_reserve(scan_delta_t *delta, int entries) {
+  if (entries > delta->entry_capacity) {
+    int *indices = realloc(delta->entries, (size_t)entries * sizeof(int));
+    if (indices) {
+      delta->entries = indices;
+    }
+    bool *matched = realloc(delta->matched, (size_t)entries * sizeof(bool));
+    if (matched) {
+      delta->matched = matched;
+    }
+    if (!indices || !matched) {
+      return false;
+    }
+    delta->entry_capacity = entries;
+  }
+
+  int slots = 16;
+  while (slots < entries * 2) {
+    slots *= 2;
+  }
+  if (slots > delta->slot_count) {
+    int *table = realloc(delta->slots, (size_t)slots * sizeof(int));
+    if (!table) {
+      return false;
+    }
+    delta->slots = table;
+    delta->slot_count = slots;
+  }
+  return true;
+}
+
+static bool append_change(scan_delta_t *delta, uint8_t flags, int index,
+                          int previous_quality) {
+  if (delta->change_count == delta->change_capacity) {
+    int capacity = delta->change_capacity ? delta->change_capacity * 2 : 32;
+    scan_change_t *changes =
+        realloc(delta->changes, (size_t)capacity * sizeof(*changes));
+    if (!changes) {
+      return false;
+    }
+    delta->changes = changes;
+    delta->change_capacity = capacity;
+  }
+
+  scan_change_t *change = &delta->changes[delta->change_count++];
+  change->flags = flags;
+  change->index = index;
+  change->previous_quality = previous_quality;
+  return true;
+}
+
+// Slot holding `index` of `list`'s key, or the empty slot where it belongs.
+// `keys` maps occupied slots to indices in `table_list`.
+static uint32_t find_slot(const scan_delta_t *delta, const int *keys,
+                          const network_list_t *table_list,
+                          const network_list_t *list, int index) {
+  uint32_t mask = (uint32_t)delta->slot_count - 1;
+  uint32_t slot = key_hash(delta, list, index) & mask;
+  while (delta->slots[slot] >= 0) {
+    int candidate = keys ? keys[delta->slots[slot]] : delta->slots[slot];
+    if (same_key(delta, table_list, candidate, list, index)) {
+      break;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void scan_delta_init(scan_delta_t *delta, scan_delta_key_t key, int signal_threshold) {
+  if (!delta) {
+    return;
+  }
+
+  memset(delta, 0, sizeof(*delta));
+  delta->key = key;
+  delta->signal_threshold = signal_threshold > 0 ? signal_threshold : 0;
+}
+
+wterm_result_t scan_delta_update(scan_delta_t *delta, const network_list_t *scan) {
+  if (!delta || !scan) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  delta->change_count = 0;
+  network_list_clear(&delta->next);
+  network_list_clear(&delta->removed);
+
+  int previous_count = delta->snapshot.count;
+  if (!delta_reserve(delta, scan->count > previous_count ? scan->count
+                                                         : previous_count)) {
+    return WTERM_ERROR_MEMORY;
+  }
+
+  // Deduplicate the scan by key; per SSID, the strongest BSSID wins
+  int entry_count = 0;
+  memset(delta->slots, 0xFF, (size_t)delta->slot_count * sizeof(int));
+  for (int i = 0; i < scan->count; i++) {
+    if (delta->key == SCAN_DELTA_KEY_SSID && scan->networks[i].ssid[0] == '\0') {
+      continue; // Hidden network
+    }
+
+    uint32_t slot = find_slot(delta, delta->entries, scan, scan, i);
+    int entry = delta->slots[slot];
+    if (entry < 0) {
+      delta->slots[slot] = entry_count;
+      delta->entries[entry_count++] = i;
+    } else if (scan->quality[i] > scan->quality[delta->entries[entry]]) {
+      delta->entries[entry] = i;
+    }
+  }
+
+  // Index the last reported state
+  memset(delta->slots, 0xFF, (size_t)delta->slot_count * sizeof(int));
+  for (int s = 0; s < previous_count; s++) {
+    uint32_t slot = find_slot(delta, NULL, &delta->snapshot, &delta->snapshot, s);
+    delta->slots[slot] = s;
+    delta->matched[s] = false;
+  }
+
+  for (int e = 0; e < entry_count; e++) {
+    int index = delta->entries[e];
+    int next_index = network_list_copy_entry(&delta->next, -1, scan, index);
+    if (next_index < 0) {
+      goto fail;
+    }
+
+    int previous = delta->slots[find_slot(delta, NULL, &delta->snapshot, scan, index)];
+    if (previous < 0) {
+      if (!append_change(delta, SCAN_CHANGE_ADDED, index, 0)) {
+        goto fail;
+      }
+      continue;
+    }
+    delta->matched[previous] = true;
+
+    uint8_t flags = 0;
+    int previous_quality = delta->snapshot.quality[previous];
+    int moved = abs((int)scan->quality[index] - previous_quality);
+    if (moved > delta->signal_threshold) {
+      flags |= SCAN_CHANGE_SIGNAL;
+    } else {
+      // Keep measuring from the last reported value
+      delta->next.quality[next_index] = (uint8_t)previous_quality;
+    }
+    if (scan->security_flags[index] != delta->snapshot.security_flags[previous]) {
+      flags |= SCAN_CHANGE_SECURITY;
+    }
+
+    if (flags && !append_change(delta, flags, index, previous_quality)) {
+      goto fail;
+    }
+  }
+
+  for (int s = 0; s < previous_count; s++) {
+    if (delta->matched[s]) {
+      continue;
+    }
+    int removed_index = network_list_copy_entry(&delta->removed, -1, &delta->snapshot, s);
+    if (removed_index < 0 ||
+        !append_change(delta, SCAN_CHANGE_REMOVED, removed_index,
+                       delta->snapshot.quality[s])) {
+      goto fail;
+    }
+  }
+
+  network_list_t reported = delta->snapshot;
+  delta->snapshot = delta->next;
+  delta->next = reported;
+  delta->primed = true;
+  return WTERM_SUCCESS;
+
+fail:
+  delta->change_count = 0;
+  network_list_clear(&delta->removed);
+  return WTERM_ERROR_MEMORY;
+}
+
+void scan_delta_reset(scan_delta_t *delta) {
+  if (!delta) {
+    return;
+  }
+
+  network_list_clear(&delta->snapshot);
+  network_list_clear(&delta->next);
+  network_list_clear(&delta->removed);
+  delta->change_count = 0;
+  delta->primed = false;
+}
+
+void scan_delta_free(scan_delta_t *delta) {
+  if (!delta) {
+    return;
+  }
+
+  network_list_free(&delta->snapshot);
+  network_list_free(&delta->next);
+  network_list_free(&delta->removed);
+  free(delta->changes);
+  free(delta->slots);
+  free(delta->entries);
+  free(delta->matched);
+
+  scan_delta_key_t key = delta->key;
+  int signal_threshold = delta->signal_threshold;
+  scan_delta_init(delta, key, signal_threshold);
+}
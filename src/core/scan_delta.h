@@ -0,0 +1,99 @@
+#pragma once
+
+/**
+ * @file scan_delta.h
+ * @brief Incremental diffing of consecutive scans
+ *
+ * A scan_delta_t remembers the last reported state of every network and,
+ * given a new scan, reports only what changed: networks that appeared or
+ * disappeared, and networks whose signal moved by more than a threshold or
+ * whose security changed. Consumers update the affected rows instead of
+ * rebuilding everything on each rescan.
+ */
+
+#include "../../include/wterm/common.h"
+
+#define SCAN_DELTA_DEFAULT_THRESHOLD 10
+
+// Change flags (scan_change_t.flags)
+#define SCAN_CHANGE_ADDED 0x01
+#define SCAN_CHANGE_REMOVED 0x02
+#define SCAN_CHANGE_SIGNAL 0x04
+#define SCAN_CHANGE_SECURITY 0x08
+
+/**
+ * @brief What identifies "the same network" across scans
+ */
+typedef enum {
+  SCAN_DELTA_KEY_BSSID = 0, // Each access point separately
+  SCAN_DELTA_KEY_SSID       // One entry per SSID (its strongest BSSID)
+} scan_delta_key_t;
+
+/**
+ * @brief One changed network
+ *
+ * For added and changed networks, index refers to the scan passed to
+ * scan_delta_update(). For removed networks it refers to the delta's
+ * `removed` list, which holds their last reported state.
+ */
+typedef struct {
+  uint8_t flags;        // SCAN_CHANGE_* bits
+  int index;
+  int previous_quality; // Last reported quality (SCAN_CHANGE_SIGNAL)
+} scan_change_t;
+
+/**
+ * @brief Diff state carried between scans
+ */
+typedef struct {
+  scan_delta_key_t key;
+  int signal_threshold;     // Quality points a signal must move to be reported
+  bool primed;              // False until the first update
+
+  network_list_t snapshot;  // Last reported state per key
+  network_list_t next;      // Snapshot under construction
+  network_list_t removed;   // Networks gone in the last update
+
+  scan_change_t *changes;   // Changes from the last update
+  int change_count;
+  int change_capacity;
+
+  int *slots;               // Hash table workspace, reused across updates
+  int slot_count;
+  int *entries;             // Deduplicated scan entries
+  bool *matched;            // Snapshot entries seen in the new scan
+  int entry_capacity;
+} scan_delta_t;
+
+/**
+ * @brief Initialize an empty delta
+ * @param delta Delta to initialize
+ * @param key Matching key
+ * @param signal_threshold Minimum quality change to report (>= 0)
+ */
+void scan_delta_init(scan_delta_t *delta, scan_delta_key_t key, int signal_threshold);
+
+/**
+ * @brief Diff a new scan against the last reported state
+ *
+ * On the first update every network is reported as added. A signal change
+ * is measured from the quality last reported for that network, so slow
+ * drift is reported once it accumulates past the threshold. Hidden
+ * networks are ignored when keying by SSID.
+ *
+ * @param delta Delta state
+ * @param scan New scan results
+ * @return WTERM_SUCCESS, or WTERM_ERROR_MEMORY (no changes are reported and
+ *         the last reported state is kept)
+ */
+wterm_result_t scan_delta_update(scan_delta_t *delta, const network_list_t *scan);
+
+/**
+ * @brief Forget all state; the next update reports everything as added
+ */
+void scan_delta_reset(scan_delta_t *delta);
+
+/**
+ * @brief Release the delta's memory
+ */
+void scan_delta_free(scan_delta_t *delta);
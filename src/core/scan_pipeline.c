@@ -0,0 +1,219 @@
+/**
+ * @file scan_pipeline.c
+ * @brief Post-processing of scan results into a ranked, deduplicated view
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "scan_pipeline.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t fnv1a(const char *text) {
+  uint32_t hash = 2166136261u;
+  for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+    hash ^= *p;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+int scan_security_rank(uint8_t security_flags) {
+  if (security_flags & NETWORK_SECURITY_WPA3) {
+    return 5;
+  }
+  if (security_flags & NETWORK_SECURITY_WPA2) {
+    return 4;
+  }
+  if (security_flags & NETWORK_SECURITY_OWE) {
+    return 3;
+  }
+  if (security_flags & NETWORK_SECURITY_WPA1) {
+    return 2;
+  }
+  if (security_flags & NETWORK_SECURITY_WEP) {
+    return 1;
+  }
+  return 0;
+}
+
+// Make room for `entries` groups and a hash table with >= 2x as many slots
+static bool view_reserve(scan_view_t *view, int entries) {
+  if (entries > view->capacity) {
+    int *order = realloc(view->order, (size_t)entries * sizeof(int));
+    if (order) {
+      view->order = order;
+    }
+    int *group_size = realloc(view->group_size, (size_t)entries * sizeof(int));
+    if (group_size) {
+      view->group_size = group_size;
+    }
+    bool *known = realloc(view->known, (size_t)entries * sizeof(bool));
+    if (known) {
+      view->known = known;
+    }
+    int *scratch = realloc(view->scratch, (size_t)entries * 2 * sizeof(int));
+    if (scratch) {
+      view->scratch = scratch;
+    }
+    if (!order || !group_size || !known || !scratch) {
+      return false;
+    }
+    view->capacity = entries;
+  }
+
+  int slots = 16;
+  while (slots < entries * 2) {
+    slots *= 2;
+  }
+  if (slots > view->slot_count) {
+    int *table = realloc(view->slots, (size_t)slots * sizeof(int));
+    if (!table) {
+      return false;
+    }
+    view->slots = table;
+    view->slot_count = slots;
+  }
+  return true;
+}
+
+// True if entry a should rank before entry b
+static bool ranks_before(const scan_view_t *view, const network_list_t *list,
+                         int a, int b) {
+  if (view->known[a] != view->known[b]) {
+    return view->known[a];
+  }
+
+  int quality_a = list->quality[view->order[a]];
+  int quality_b = list->quality[view->order[b]];
+  if (quality_a != quality_b) {
+    return quality_a > quality_b;
+  }
+
+  return scan_security_rank(list->security_flags[view->order[a]]) >
+         scan_security_rank(list->security_flags[view->order[b]]);
+}
+
+// Stable merge sort of group positions; ties keep scan order
+static void merge_sort(const scan_view_t *view, const network_list_t *list,
+                       int *items, int *scratch, int count) {
+  if (count < 2) {
+    return;
+  }
+
+  int half = count / 2;
+  merge_sort(view, list, items, scratch, half);
+  merge_sort(view, list, items + half, scratch, count - half);
+
+  int left = 0;
+  int right = half;
+  int out = 0;
+  while (left < half && right < count) {
+    // Take from the right only when strictly better, for stability
+    if (ranks_before(view, list, items[right], items[left])) {
+      scratch[out++] = items[right++];
+    } else {
+      scratch[out++] = items[left++];
+    }
+  }
+  while (left < half) {
+    scratch[out++] = items[left++];
+  }
+  while (right < count) {
+    scratch[out++] = items[right++];
+  }
+  memcpy(items, scratch, (size_t)count * sizeof(int));
+}
+
+wterm_result_t scan_view_build(scan_view_t *view, const network_list_t *list,
+                               const scan_pipeline_options_t *options) {
+  if (!view || !list) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  view->count = 0;
+  if (list->count == 0) {
+    return WTERM_SUCCESS;
+  }
+  if (!view_reserve(view, list->count)) {
+    return WTERM_ERROR_MEMORY;
+  }
+
+  // Group BSSIDs by SSID, keeping the strongest one per group
+  int mask = view->slot_count - 1;
+  memset(view->slots, 0xFF, (size_t)view->slot_count * sizeof(int));
+
+  for (int i = 0; i < list->count; i++) {
+    const char *ssid = list->networks[i].ssid;
+    if (ssid[0] == '\0') {
+      continue; // Hidden network
+    }
+
+    uint32_t slot = fnv1a(ssid) & (uint32_t)mask;
+    while (view->slots[slot] >= 0 &&
+           strcmp(list->networks[view->order[view->slots[slot]]].ssid, ssid) !=
+               0) {
+      slot = (slot + 1) & (uint32_t)mask;
+    }
+
+    int group = view->slots[slot];
+    if (group < 0) {
+      group = view->count++;
+      view->slots[slot] = group;
+      view->order[group] = i;
+      view->group_size[group] = 1;
+      continue;
+    }
+
+    view->group_size[group]++;
+    if (list->quality[i] > list->quality[view->order[group]]) {
+      view->order[group] = i;
+    }
+  }
+
+  for (int g = 0; g < view->count; g++) {
+    view->known[g] =
+        options && options->is_known &&
+        options->is_known(list->networks[view->order[g]].ssid,
+                          options->user_data);
+  }
+
+  // Sort group positions, then permute the per-group columns to match
+  int *positions = view->scratch;
+  int *temp = view->scratch + view->count;
+  for (int g = 0; g < view->count; g++) {
+    positions[g] = g;
+  }
+  merge_sort(view, list, positions, temp, view->count);
+
+  for (int i = 0; i < view->count; i++) {
+    temp[i] = view->order[positions[i]];
+  }
+  memcpy(view->order, temp, (size_t)view->count * sizeof(int));
+
+  for (int i = 0; i < view->count; i++) {
+    temp[i] = view->group_size[positions[i]];
+  }
+  memcpy(view->group_size, temp, (size_t)view->count * sizeof(int));
+
+  for (int i = 0; i < view->count; i++) {
+    temp[i] = view->known[positions[i]];
+  }
+  for (int i = 0; i < view->count; i++) {
+    view->known[i] = temp[i] != 0;
+  }
+
+  return WTERM_SUCCESS;
+}
+
+void scan_view_free(scan_view_t *view) {
+  if (!view) {
+    return;
+  }
+
+  free(view->order);
+  free(view->group_size);
+  free(view->known);
+  free(view->scratch);
+  free(view->slots);
+  memset(view, 0, sizeof(*view));
+}
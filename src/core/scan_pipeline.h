@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file scan_pipeline.h
+ * @brief Post-processing of scan results into a ranked, deduplicated view
+ *
+ * BSSIDs are grouped by SSID through a hash table, the strongest BSSID of
+ * each group represents it, and the groups are stably sorted by known
+ * status, signal quality and security. The result is an index view into
+ * the scanned network_list_t, so no entries are copied.
+ */
+
+#include "../../include/wterm/common.h"
+
+/**
+ * @brief Reports whether an SSID has a saved profile
+ */
+typedef bool (*scan_known_fn)(const char *ssid, void *user_data);
+
+/**
+ * @brief Ranking options
+ */
+typedef struct {
+  scan_known_fn is_known; // Optional; called once per SSID group
+  void *user_data;
+} scan_pipeline_options_t;
+
+/**
+ * @brief Ranked index view over a network_list_t
+ *
+ * order[i] is the index in the source list of the best BSSID for the i-th
+ * ranked SSID. The view is invalidated when the source list changes.
+ */
+typedef struct {
+  int *order;      // Representative entry per SSID, ranked
+  int *group_size; // BSSIDs sharing that SSID
+  bool *known;     // Known status per ranked SSID
+  int count;
+  int capacity;
+  int *scratch;    // Sort workspace (2 * capacity), reused across builds
+  int *slots;      // Hash table of group indices, reused across builds
+  int slot_count;
+} scan_view_t;
+
+/**
+ * @brief Group, select and rank a scan into a view
+ *
+ * Entries with an empty SSID (hidden networks) are skipped. The view's
+ * memory is reused across builds and released with scan_view_free().
+ *
+ * @param view View to (re)build; zero-initialize before first use
+ * @param list Scan results
+ * @param options Ranking options, or NULL for signal/security ranking only
+ * @return WTERM_SUCCESS, or WTERM_ERROR_MEMORY
+ */
+wterm_result_t scan_view_build(scan_view_t *view, const network_list_t *list,
+                               const scan_pipeline_options_t *options);
+
+/**
+ * @brief Release a view's memory
+ */
+void scan_view_free(scan_view_t *view);
+
+/**
+ * @brief Rank of a security flag set (higher is stronger, 0 for open)
+ */
+int scan_security_rank(uint8_t security_flags);
@@ -0,0 +1,216 @@
+/**
+ * @file scan_worker.c
+ * @brief Background WiFi scanning thread
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "scan_worker.h"
+#include "network_scanner.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct scan_worker {
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  scan_worker_options_t options;
+
+  // Guarded by lock
+  bool stop;
+  bool requested;
+  bool refresh_requested;
+  bool scanning;
+  bool fresh;                     // published holds results not yet taken
+  unsigned long generation;       // Completed scans
+  unsigned long taken_generation; // Last generation seen by take
+  wterm_result_t result;          // Result of the last completed scan
+  network_list_t published;
+
+  network_list_t scan_buffer;     // Owned by the thread while scanning
+};
+
+static wterm_result_t backend_scan(network_list_t *list, bool rescan,
+                                   void *user_data) {
+  (void)user_data;
+  // Errors are queued for the TUI; stderr belongs to termbox here
+  return scan_wifi_networks_quiet(list, rescan);
+}
+
+static bool has_work(const scan_worker_t *worker) {
+  return worker->stop || worker->requested || worker->refresh_requested;
+}
+
+// Sleep until a request, stop, or the refresh interval elapses
+static void wait_for_work(scan_worker_t *worker) {
+  if (worker->options.interval_ms <= 0) {
+    while (!has_work(worker)) {
+      pthread_cond_wait(&worker->wake, &worker->lock);
+    }
+    return;
+  }
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += worker->options.interval_ms / 1000;
+  deadline.tv_nsec += (long)(worker->options.interval_ms % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  while (!has_work(worker)) {
+    if (pthread_cond_timedwait(&worker->wake, &worker->lock, &deadline) ==
+        ETIMEDOUT) {
+      return;
+    }
+  }
+}
+
+static void *worker_main(void *arg) {
+  scan_worker_t *worker = arg;
+
+  pthread_mutex_lock(&worker->lock);
+  while (true) {
+    wait_for_work(worker);
+    if (worker->stop) {
+      break;
+    }
+
+    bool rescan = worker->requested;
+    worker->requested = false;
+    worker->refresh_requested = false;
+    worker->scanning = true;
+    pthread_mutex_unlock(&worker->lock);
+
+    wterm_result_t result =
+        worker->options.scan(&worker->scan_buffer, rescan, worker->options.user_data);
+
+    pthread_mutex_lock(&worker->lock);
+    if (result == WTERM_SUCCESS) {
+      network_list_t completed = worker->scan_buffer;
+      worker->scan_buffer = worker->published;
+      worker->published = completed;
+      worker->fresh = true;
+    } else {
+      // A failure supersedes an earlier scan that was not taken yet
+      worker->fresh = false;
+    }
+    worker->result = result;
+    worker->generation++;
+    worker->scanning = false;
+  }
+  pthread_mutex_unlock(&worker->lock);
+
+  return NULL;
+}
+
+scan_worker_t *scan_worker_start(const scan_worker_options_t *options) {
+  scan_worker_t *worker = calloc(1, sizeof(*worker));
+  if (!worker) {
+    return NULL;
+  }
+
+  if (options) {
+    worker->options = *options;
+  } else {
+    worker->options.interval_ms = SCAN_WORKER_DEFAULT_INTERVAL_MS;
+  }
+  if (!worker->options.scan) {
+    worker->options.scan = backend_scan;
+  }
+
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_mutex_init(&worker->lock, NULL);
+  pthread_cond_init(&worker->wake, &attr);
+  pthread_condattr_destroy(&attr);
+
+  if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+    pthread_cond_destroy(&worker->wake);
+    pthread_mutex_destroy(&worker->lock);
+    free(worker);
+    return NULL;
+  }
+
+  return worker;
+}
+
+void scan_worker_request(scan_worker_t *worker) {
+  if (!worker) {
+    return;
+  }
+
+  pthread_mutex_lock(&worker->lock);
+  worker->requested = true;
+  pthread_cond_signal(&worker->wake);
+  pthread_mutex_unlock(&worker->lock);
+}
+
+void scan_worker_refresh(scan_worker_t *worker) {
+  if (!worker) {
+    return;
+  }
+
+  pthread_mutex_lock(&worker->lock);
+  worker->refresh_requested = true;
+  pthread_cond_signal(&worker->wake);
+  pthread_mutex_unlock(&worker->lock);
+}
+
+bool scan_worker_is_scanning(scan_worker_t *worker) {
+  if (!worker) {
+    return false;
+  }
+
+  pthread_mutex_lock(&worker->lock);
+  bool scanning =
+      worker->scanning || worker->requested || worker->refresh_requested;
+  pthread_mutex_unlock(&worker->lock);
+  return scanning;
+}
+
+bool scan_worker_take(scan_worker_t *worker, network_list_t *list,
+                      wterm_result_t *result) {
+  if (!worker || !list) {
+    return false;
+  }
+
+  pthread_mutex_lock(&worker->lock);
+  bool completed = worker->generation != worker->taken_generation;
+  if (completed) {
+    worker->taken_generation = worker->generation;
+    if (result) {
+      *result = worker->result;
+    }
+    if (worker->fresh) {
+      network_list_t taken = worker->published;
+      worker->published = *list;
+      *list = taken;
+      worker->fresh = false;
+    }
+  }
+  pthread_mutex_unlock(&worker->lock);
+
+  return completed;
+}
+
+void scan_worker_stop(scan_worker_t *worker) {
+  if (!worker) {
+    return;
+  }
+
+  pthread_mutex_lock(&worker->lock);
+  worker->stop = true;
+  pthread_cond_signal(&worker->wake);
+  pthread_mutex_unlock(&worker->lock);
+  pthread_join(worker->thread, NULL);
+
+  network_list_free(&worker->published);
+  network_list_free(&worker->scan_buffer);
+  pthread_cond_destroy(&worker->wake);
+  pthread_mutex_destroy(&worker->lock);
+  free(worker);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * @file scan_worker.h
+ * @brief Background WiFi scanning thread
+ *
+ * The worker rescans on demand and re-reads scan results periodically,
+ * publishing each completed scan for the UI to pick up between key
+ * presses. Results are handed over by swapping lists, so publishing a
+ * scan never copies entries.
+ */
+
+#include "../../include/wterm/common.h"
+
+#define SCAN_WORKER_DEFAULT_INTERVAL_MS 30000
+
+typedef struct scan_worker scan_worker_t;
+
+/**
+ * @brief Scan function run on the worker thread
+ * @param list List to fill (cleared by the callee)
+ * @param rescan true if a fresh radio scan was requested, false for a
+ *        periodic refresh of the backend's current results
+ * @param user_data Options user data
+ */
+typedef wterm_result_t (*scan_worker_scan_fn)(network_list_t *list, bool rescan,
+                                              void *user_data);
+
+/**
+ * @brief Worker options
+ */
+typedef struct {
+  int interval_ms;          // Periodic refresh interval, 0 for on demand only
+  scan_worker_scan_fn scan; // NULL for the active backend
+  void *user_data;
+} scan_worker_options_t;
+
+/**
+ * @brief Start a worker thread
+ * @param options Options, or NULL for SCAN_WORKER_DEFAULT_INTERVAL_MS and
+ *        the active backend
+ * @return Worker, or NULL if the thread could not be started
+ */
+scan_worker_t *scan_worker_start(const scan_worker_options_t *options);
+
+/**
+ * @brief Ask for a fresh scan
+ *
+ * Returns immediately. Requests made while a scan is running are merged
+ * into one follow-up scan.
+ */
+void scan_worker_request(scan_worker_t *worker);
+
+/**
+ * @brief Re-read the backend's current results without a radio scan
+ *
+ * Returns immediately. Cheaper than scan_worker_request(); used to replace
+ * a stale startup snapshot as soon as possible. A pending fresh scan
+ * takes precedence.
+ */
+void scan_worker_refresh(scan_worker_t *worker);
+
+/**
+ * @brief Whether a scan is running or queued
+ */
+bool scan_worker_is_scanning(scan_worker_t *worker);
+
+/**
+ * @brief Take the latest completed scan, if there is one not yet taken
+ *
+ * On success the caller's list is swapped with the published one; the
+ * caller's previous entries are recycled by the worker.
+ *
+ * @param worker Worker
+ * @param list Caller's list, replaced with the new results
+ * @param result Optional; receives the scan's result code. On failure the
+ *        list is left untouched.
+ * @return true if a new scan completed since the last call
+ */
+bool scan_worker_take(scan_worker_t *worker, network_list_t *list,
+                      wterm_result_t *result);
+
+/**
+ * @brief Stop the thread (waiting for a running scan) and free the worker
+ */
+void scan_worker_stop(scan_worker_t *worker);
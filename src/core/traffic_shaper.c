@@ -0,0 +1,385 @@
+/**
+ * @file traffic_shaper.c
+ * @brief Per-hotspot and per-client rate limits on the access point
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "traffic_shaper.h"
+#include "../utils/capability.h"
+#include "../utils/input_sanitizer.h"
+#include "../utils/safe_exec.h"
+#include "../utils/string_utils.h"
+#include <arpa/inet.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SHAPER_SCRIPT_MAX 16384
+#define SHAPER_DEFAULT_CLASS 0x2
+#define SHAPER_CLIENT_CLASS 0x100 // Class of station slot 0
+#define SHAPER_FIFO_MIN_PACKETS 4
+#define SHAPER_FIFO_MAX_PACKETS 1000
+
+static const char *const leaf_kinds[SHAPER_LEAF_COUNT] = {
+    [SHAPER_LEAF_FQ_CODEL] = "fq_codel",
+    [SHAPER_LEAF_CAKE] = "cake",
+    [SHAPER_LEAF_FIFO] = "pfifo",
+};
+
+wterm_result_t shaper_plan_init(shaper_plan_t *plan, const char *iface,
+                                unsigned int rate_kbit,
+                                unsigned int client_rate_kbit) {
+  if (!plan || !validate_interface_name(iface)) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  memset(plan, 0, sizeof(*plan));
+  safe_string_copy(plan->iface, iface, sizeof(plan->iface));
+  plan->rate_kbit = rate_kbit;
+  plan->client_rate_kbit = client_rate_kbit;
+  return WTERM_SUCCESS;
+}
+
+bool shaper_plan_active(const shaper_plan_t *plan) {
+  return plan && (plan->rate_kbit > 0 || plan->client_rate_kbit > 0);
+}
+
+// Normalise a MAC to lowercase "aa:bb:cc:dd:ee:ff"
+static bool normalize_mac(const char *text, char *mac, size_t size) {
+  unsigned int b[6];
+  int consumed = 0;
+  if (strlen(text) != 17 ||
+      sscanf(text, "%2x:%2x:%2x:%2x:%2x:%2x%n", &b[0], &b[1], &b[2], &b[3],
+             &b[4], &b[5], &consumed) != 6 ||
+      consumed != 17) {
+    return false;
+  }
+  snprintf(mac, size, "%02x:%02x:%02x:%02x:%02x:%02x", b[0], b[1], b[2], b[3],
+           b[4], b[5]);
+  return true;
+}
+
+wterm_result_t shaper_plan_add_client(shaper_plan_t *plan, const char *key,
+                                      unsigned int rate_kbit) {
+  if (!plan || !key) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  shaper_client_t client = {.rate_kbit = rate_kbit};
+  struct in_addr address;
+  if (normalize_mac(key, client.key, sizeof(client.key))) {
+    client.is_mac = true;
+  } else if (inet_pton(AF_INET, key, &address) == 1) {
+    inet_ntop(AF_INET, &address, client.key, sizeof(client.key));
+  } else {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  if (plan->client_count >= SHAPER_MAX_CLIENTS) {
+    return WTERM_ERROR_GENERAL;
+  }
+  plan->clients[plan->client_count++] = client;
+  return WTERM_SUCCESS;
+}
+
+void shaper_plan_add_stations(shaper_plan_t *plan,
+                              const hotspot_client_t *stations, int count) {
+  if (!plan || !stations) {
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    // Unknown fields hold "Unknown", which neither key accepts
+    if (shaper_plan_add_client(plan, stations[i].mac_address, 0) ==
+        WTERM_ERROR_INVALID_INPUT) {
+      shaper_plan_add_client(plan, stations[i].ip_address, 0);
+    }
+  }
+}
+
+// Append formatted text; *used passes size once anything is truncated
+static void append(char *buffer, size_t size, size_t *used, const char *format,
+                   ...) __attribute__((format(printf, 4, 5)));
+
+static void append(char *buffer, size_t size, size_t *used, const char *format,
+                   ...) {
+  if (*used >= size) {
+    return;
+  }
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buffer + *used, size - *used, format, args);
+  va_end(args);
+  *used += len > 0 ? (size_t)len : size;
+}
+
+static unsigned int total_rate(const shaper_plan_t *plan) {
+  return plan->rate_kbit > 0 ? plan->rate_kbit : SHAPER_LINE_RATE_KBIT;
+}
+
+// Ceiling of a client class: its own limit, never above the hotspot's
+static unsigned int client_ceil(const shaper_plan_t *plan,
+                                unsigned int rate_kbit) {
+  unsigned int total = total_rate(plan);
+  if (rate_kbit == 0) {
+    rate_kbit = plan->client_rate_kbit;
+  }
+  return rate_kbit > 0 && rate_kbit < total ? rate_kbit : total;
+}
+
+// Guaranteed rate: an equal share of the hotspot for every class
+static unsigned int client_share(const shaper_plan_t *plan,
+                                 unsigned int ceil_kbit) {
+  unsigned int share = total_rate(plan) / (unsigned int)(plan->client_count + 1);
+  if (share < SHAPER_MIN_RATE_KBIT) {
+    share = SHAPER_MIN_RATE_KBIT;
+  }
+  return share < ceil_kbit ? share : ceil_kbit;
+}
+
+// A client class with its leaf queue, replacing any earlier one
+static void append_class(char *buffer, size_t size, size_t *used,
+                         const shaper_plan_t *plan, unsigned int classid,
+                         unsigned int ceil_kbit, shaper_leaf_t leaf) {
+  const char *dev = plan->iface;
+  append(buffer, size, used,
+         "class replace dev %s parent 1:1 classid 1:%x htb rate %ukbit ceil %ukbit\n",
+         dev, classid, client_share(plan, ceil_kbit), ceil_kbit);
+  append(buffer, size, used, "qdisc replace dev %s parent 1:%x handle %x: ", dev,
+         classid, classid);
+
+  switch (leaf) {
+  case SHAPER_LEAF_FQ_CODEL:
+    append(buffer, size, used, "fq_codel\n");
+    break;
+  case SHAPER_LEAF_CAKE:
+    append(buffer, size, used, "cake unlimited besteffort\n");
+    break;
+  default: {
+    // About SHAPER_FIFO_MS of full-size frames at the ceiling
+    unsigned long packets =
+        (unsigned long)ceil_kbit * 125 * SHAPER_FIFO_MS / 1000 / 1514;
+    if (packets < SHAPER_FIFO_MIN_PACKETS) {
+      packets = SHAPER_FIFO_MIN_PACKETS;
+    } else if (packets > SHAPER_FIFO_MAX_PACKETS) {
+      packets = SHAPER_FIFO_MAX_PACKETS;
+    }
+    append(buffer, size, used, "pfifo limit %lu\n", packets);
+    break;
+  }
+  }
+}
+
+size_t shaper_render(const shaper_plan_t *plan, shaper_leaf_t leaf,
+                     bool create, char *buffer, size_t size) {
+  if (!plan || !buffer || plan->iface[0] == '\0' ||
+      (int)leaf < 0 || leaf >= SHAPER_LEAF_COUNT) {
+    return 0;
+  }
+
+  const char *dev = plan->iface;
+  size_t used = 0;
+  if (create) {
+    unsigned int total = total_rate(plan);
+    append(buffer, size, &used,
+           "qdisc add dev %s root handle 1: htb default %x\n"
+           "class add dev %s parent 1: classid 1:1 htb rate %ukbit ceil %ukbit\n",
+           dev, SHAPER_DEFAULT_CLASS, dev, total, total);
+  }
+  // Unclassified traffic is not one client's: it may use the whole hotspot
+  append_class(buffer, size, &used, plan, SHAPER_DEFAULT_CLASS,
+               total_rate(plan), leaf);
+
+  for (int i = 0; i < plan->client_count; i++) {
+    const shaper_client_t *client = &plan->clients[i];
+    unsigned int classid = SHAPER_CLIENT_CLASS + (unsigned int)i;
+    append_class(buffer, size, &used, plan, classid,
+                 client_ceil(plan, client->rate_kbit), leaf);
+    // Filter handles follow the slots, so a slot's filter is replaced in
+    // place when another station takes it over
+    append(buffer, size, &used,
+           "filter replace dev %s parent 1: protocol all prio 1 handle 800::%x u32 ",
+           dev, i + 1);
+    if (client->is_mac) {
+      append(buffer, size, &used, "match ether dst %s", client->key);
+    } else {
+      append(buffer, size, &used,
+             "match u16 0x0800 0xffff at -2 match ip dst %s/32", client->key);
+    }
+    append(buffer, size, &used, " flowid 1:%x\n", classid);
+  }
+  return used < size ? used : 0;
+}
+
+size_t shaper_render_prune(const char *iface, const int *slots, int count,
+                           char *buffer, size_t size) {
+  if (!iface || (!slots && count > 0) || !buffer) {
+    return 0;
+  }
+
+  // A class can only go once no filter points at it
+  size_t used = 0;
+  for (int i = 0; i < count; i++) {
+    append(buffer, size, &used,
+           "filter del dev %s parent 1: protocol all prio 1 handle 800::%x u32\n"
+           "class del dev %s classid 1:%x\n",
+           iface, slots[i] + 1, iface, SHAPER_CLIENT_CLASS + (unsigned int)slots[i]);
+  }
+  return used < size ? used : 0;
+}
+
+// Run tc, feeding it a batch on stdin when one is given
+static bool tc_run(char *const args[], const char *script, size_t len,
+                   safe_exec_output_t *result) {
+  if (!capability_available(CAPABILITY_TC)) {
+    return false;
+  }
+
+  safe_exec_options_t options = {.input = script, .input_len = len};
+  safe_exec_output_t output;
+  if (safe_exec_capture_ex("tc", args, &options, &output) != WTERM_SUCCESS) {
+    return false;
+  }
+  bool ok = output.exit_code == 0;
+  if (ok && result) {
+    *result = output;
+  } else {
+    safe_exec_output_free(&output);
+  }
+  return ok;
+}
+
+static bool tc_batch(const char *script, size_t len, bool force) {
+  char *const args[] = {"tc", "-batch", "-", NULL};
+  char *const force_args[] = {"tc", "-force", "-batch", "-", NULL};
+  return tc_run(force ? force_args : args, script, len, NULL);
+}
+
+static void delete_root(const char *iface) {
+  char *const args[] = {"tc", "qdisc", "del", "dev", (char *)iface, "root", NULL};
+  tc_run(args, NULL, 0, NULL); // Fails when only the default qdisc is there
+}
+
+// Find the leaf discipline of an applied tree from `tc qdisc show`
+static bool applied_leaf(const char *iface, shaper_leaf_t *leaf) {
+  char *const args[] = {"tc", "qdisc", "show", "dev", (char *)iface, NULL};
+  safe_exec_output_t output;
+  if (!tc_run(args, NULL, 0, &output)) {
+    return false;
+  }
+
+  // The default class's leaf: "qdisc fq_codel 2: parent 1:2 limit ..."
+  char needle[32];
+  snprintf(needle, sizeof(needle), " %x: parent 1:%x ", SHAPER_DEFAULT_CLASS,
+           SHAPER_DEFAULT_CLASS);
+  bool found = false;
+  char *cursor = output.out;
+  char *line;
+  while (!found && (line = safe_exec_next_line(&cursor))) {
+    char *tail = strstr(line, needle);
+    if (strncmp(line, "qdisc ", 6) != 0 || !tail) {
+      continue;
+    }
+    *tail = '\0';
+    for (int i = 0; i < SHAPER_LEAF_COUNT; i++) {
+      if (strcmp(line + 6, leaf_kinds[i]) == 0) {
+        *leaf = (shaper_leaf_t)i;
+        found = true;
+      }
+    }
+  }
+  safe_exec_output_free(&output);
+  return found;
+}
+
+// Slots at or past keep that still have a class
+static int stale_slots(const char *iface, int keep, int *slots, int max) {
+  char *const args[] = {"tc", "class", "show", "dev", (char *)iface, NULL};
+  safe_exec_output_t output;
+  if (!tc_run(args, NULL, 0, &output)) {
+    return 0;
+  }
+
+  int count = 0;
+  char *cursor = output.out;
+  char *line;
+  while ((line = safe_exec_next_line(&cursor)) && count < max) {
+    unsigned int classid;
+    if (sscanf(line, "class htb 1:%x ", &classid) == 1 &&
+        classid >= SHAPER_CLIENT_CLASS + (unsigned int)keep &&
+        classid < SHAPER_CLIENT_CLASS + SHAPER_MAX_CLIENTS) {
+      slots[count++] = (int)(classid - SHAPER_CLIENT_CLASS);
+    }
+  }
+  safe_exec_output_free(&output);
+  return count;
+}
+
+wterm_result_t traffic_shaper_apply(const shaper_plan_t *plan) {
+  if (!plan || plan->iface[0] == '\0') {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+  if (!capability_available(CAPABILITY_TC)) {
+    return WTERM_ERROR_NETWORK;
+  }
+
+  // Kernels without fq_codel or CAKE reject the batch; fall back in order
+  char script[SHAPER_SCRIPT_MAX];
+  for (int leaf = 0; leaf < SHAPER_LEAF_COUNT; leaf++) {
+    size_t len = shaper_render(plan, (shaper_leaf_t)leaf, true, script,
+                               sizeof(script));
+    if (len == 0) {
+      return WTERM_ERROR_INVALID_INPUT;
+    }
+    delete_root(plan->iface);
+    if (tc_batch(script, len, false)) {
+      return WTERM_SUCCESS;
+    }
+  }
+  delete_root(plan->iface);
+  return WTERM_ERROR_NETWORK;
+}
+
+wterm_result_t traffic_shaper_sync(const shaper_plan_t *plan) {
+  if (!plan || plan->iface[0] == '\0') {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  shaper_leaf_t leaf;
+  if (!applied_leaf(plan->iface, &leaf)) {
+    return WTERM_ERROR_GENERAL;
+  }
+
+  char script[SHAPER_SCRIPT_MAX];
+  size_t len = shaper_render(plan, leaf, false, script, sizeof(script));
+  if (len == 0) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+  if (!tc_batch(script, len, false)) {
+    return WTERM_ERROR_NETWORK;
+  }
+
+  int slots[SHAPER_MAX_CLIENTS];
+  int count = stale_slots(plan->iface, plan->client_count, slots, SHAPER_MAX_CLIENTS);
+  if (count > 0) {
+    // Best effort: a slot whose filter is already gone still loses its class
+    len = shaper_render_prune(plan->iface, slots, count, script, sizeof(script));
+    if (len > 0) {
+      tc_batch(script, len, true);
+    }
+  }
+  return WTERM_SUCCESS;
+}
+
+wterm_result_t traffic_shaper_remove(const char *iface) {
+  if (!validate_interface_name(iface)) {
+    return WTERM_ERROR_INVALID_INPUT;
+  }
+
+  // Leave a root qdisc alone unless it is a tree wterm built
+  shaper_leaf_t leaf;
+  if (applied_leaf(iface, &leaf)) {
+    delete_root(iface);
+  }
+  return WTERM_SUCCESS;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+/**
+ * @file traffic_shaper.h
+ * @brief Per-hotspot and per-client rate limits on the access point
+ *
+ * Traffic towards the clients is shaped on the egress of the AP interface
+ * with an HTB tree, sent to the kernel as one `tc -batch`:
+ *
+ *   1:    htb root, unclassified traffic goes to 1:2
+ *   1:1   whole hotspot, at the hotspot rate (or line rate when unset)
+ *   1:2   clients not known yet, up to the hotspot rate
+ *   1:1xx one class per station, matched by MAC or IPv4 address
+ *
+ * Every client class is guaranteed an equal share of the hotspot rate and
+ * may borrow unused bandwidth up to its own limit, so one heavy client
+ * cannot starve the others. Each class queues into fq_codel, or CAKE or a
+ * short FIFO when the kernel has neither, to keep latency low under load.
+ *
+ * Upload (client to AP) traffic is not shaped.
+ */
+
+#include "../../include/wterm/common.h"
+#include <stddef.h>
+
+#define SHAPER_MAX_CLIENTS MAX_HOTSPOT_CLIENTS
+#define SHAPER_LINE_RATE_KBIT 10000000u // Hotspot ceiling when unlimited
+#define SHAPER_MIN_RATE_KBIT 8u         // Smallest guaranteed class rate
+#define SHAPER_FIFO_MS 20               // Queue depth of the FIFO fallback
+
+/**
+ * @brief Queue discipline for each class, in order of preference
+ */
+typedef enum {
+  SHAPER_LEAF_FQ_CODEL = 0,
+  SHAPER_LEAF_CAKE,
+  SHAPER_LEAF_FIFO,
+  SHAPER_LEAF_COUNT
+} shaper_leaf_t;
+
+/**
+ * @brief One station with its own class
+ */
+typedef struct {
+  char key[MAX_STR_MAC_ADDR]; // "aa:bb:cc:dd:ee:ff" or "a.b.c.d"
+  bool is_mac;
+  unsigned int rate_kbit; // 0 for the plan's client rate
+} shaper_client_t;
+
+/**
+ * @brief Limits for one AP interface
+ */
+typedef struct {
+  char iface[MAX_STR_INTERFACE];
+  unsigned int rate_kbit;        // Whole hotspot, 0 for unlimited
+  unsigned int client_rate_kbit; // Each client, 0 for unlimited
+  shaper_client_t clients[SHAPER_MAX_CLIENTS];
+  int client_count;
+} shaper_plan_t;
+
+/**
+ * @brief Start a plan without stations
+ * @return WTERM_SUCCESS, or WTERM_ERROR_INVALID_INPUT for a bad interface
+ */
+wterm_result_t shaper_plan_init(shaper_plan_t *plan, const char *iface,
+                                unsigned int rate_kbit,
+                                unsigned int client_rate_kbit);
+
+/**
+ * @brief Whether the plan limits anything at all
+ */
+bool shaper_plan_active(const shaper_plan_t *plan);
+
+/**
+ * @brief Give a station its own class
+ * @param key MAC or IPv4 address
+ * @param rate_kbit Limit for this station, 0 for the plan's client rate
+ * @return WTERM_SUCCESS, WTERM_ERROR_INVALID_INPUT for a malformed key, or
+ *         WTERM_ERROR_GENERAL if the plan is full
+ */
+wterm_result_t shaper_plan_add_client(shaper_plan_t *plan, const char *key,
+                                      unsigned int rate_kbit);
+
+/**
+ * @brief Give every station of a station list its own class
+ *
+ * Stations are keyed by MAC address, or by IP address when the MAC is
+ * not known. Stations without either are left in the default class.
+ */
+void shaper_plan_add_stations(shaper_plan_t *plan,
+                              const hotspot_client_t *stations, int count);
+
+/**
+ * @brief Write the `tc -batch` script for a plan
+ *
+ * With create set, the script builds the whole tree on an interface that
+ * has no root qdisc. Without it, only the station classes and filters are
+ * written, as replace commands that update a tree built earlier in place.
+ *
+ * @return Script length, or 0 if it does not fit
+ */
+size_t shaper_render(const shaper_plan_t *plan, shaper_leaf_t leaf,
+                     bool create, char *buffer, size_t size);
+
+/**
+ * @brief Write the `tc -batch` script that drops station classes
+ * @param slots Station slots (index into a plan's clients) to drop
+ * @return Script length, or 0 if it does not fit
+ */
+size_t shaper_render_prune(const char *iface, const int *slots, int count,
+                           char *buffer, size_t size);
+
+/**
+ * @brief Replace the AP's root qdisc with the plan's tree
+ * @return WTERM_SUCCESS, WTERM_ERROR_INVALID_INPUT, or WTERM_ERROR_NETWORK
+ *         if tc is missing or the kernel rejected every leaf discipline
+ */
+wterm_result_t traffic_shaper_apply(const shaper_plan_t *plan);
+
+/**
+ * @brief Bring the station classes of an applied tree up to date
+ *
+ * Classes of stations still present are updated in place, so their queues
+ * survive; classes of stations that left are dropped.
+ *
+ * @return WTERM_SUCCESS, WTERM_ERROR_GENERAL if no tree is applied on the
+ *         interface, or WTERM_ERROR_NETWORK
+ */
+wterm_result_t traffic_shaper_sync(const shaper_plan_t *plan);
+
+/**
+ * @brief Remove the shaping tree from an interface
+ */
+wterm_result_t traffic_shaper_remove(const char *iface);
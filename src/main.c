@@ -8,9 +8,14 @@
 #include "core/hotspot_manager.h"
 #include "core/hotspot_ui.h"
 #include "core/network_scanner.h"
+#include "core/scan_worker.h"
 #include "core/error_queue.h"
+#include "utils/query_cache.h"
+#include "utils/safe_exec.h"
+#include "utils/scan_cache.h"
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -23,6 +28,7 @@ static void print_usage(const char *program_name) {
   printf("  -h, --help       Show this help message\n");
   printf("  -v, --version    Show version information\n\n");
   printf("Commands:\n");
+  printf("  list           Print available networks and exit\n");
   printf("  hotspot        Manage WiFi hotspots\n");
   printf("  [no command]   Show network selection interface (default)\n\n");
   printf("Hotspot Commands:\n");
@@ -30,6 +36,7 @@ static void print_usage(const char *program_name) {
   printf("  hotspot create          Create new hotspot interactively\n");
   printf("  hotspot start <name>    Start hotspot by name\n");
   printf("  hotspot stop <name>     Stop running hotspot\n");
+  printf("  hotspot watch <name>    Keep per-client rate limits current\n");
   printf("  hotspot list            List all hotspot configurations\n");
   printf("  hotspot status [name]   Show hotspot status\n");
   printf("  hotspot delete <name>   Delete hotspot configuration\n");
@@ -50,16 +57,45 @@ static void print_usage(const char *program_name) {
   printf("  %s hotspot list              # List all hotspots\n", program_name);
 }
 
+// Enabled by WTERM_EXEC_STATS=1, used by the startup benchmark
+static void print_exec_stats(void) {
+  query_cache_stats_t cache;
+  query_cache_get_stats(&cache);
+  fprintf(stderr, "wterm: %lu child processes spawned\n",
+          safe_exec_spawn_count());
+  fprintf(stderr, "wterm: query cache %lu hits, %lu misses, %lu invalidations\n",
+          cache.hits, cache.misses, cache.invalidations);
+}
+
+// Remember a completed scan so the next start can paint immediately
+static void save_scan_snapshot(const network_list_t *network_list) {
+  char path[4096];
+  if (network_list->count > 0 && !network_list->is_stale &&
+      scan_cache_default_path(path, sizeof(path))) {
+    scan_cache_save(path, network_list);
+  }
+}
+
+static bool load_scan_snapshot(network_list_t *network_list) {
+  char path[4096];
+  return scan_cache_default_path(path, sizeof(path)) &&
+         scan_cache_load(path, network_list, NULL) == WTERM_SUCCESS &&
+         network_list->count > 0;
+}
+
 static wterm_result_t handle_list_networks(void) {
-  network_list_t network_list;
+  network_list_t network_list = {0};
   wterm_result_t result = scan_wifi_networks(&network_list);
 
   if (result != WTERM_SUCCESS) {
     REPORT_ERROR(true, "Failed to scan WiFi networks%s", "");
+    network_list_free(&network_list);
     return result;
   }
 
   display_networks(&network_list);
+  save_scan_snapshot(&network_list);
+  network_list_free(&network_list);
   return WTERM_SUCCESS;
 }
 
@@ -71,19 +107,15 @@ static wterm_result_t scan_networks_with_loading(network_list_t *network_list,
   printf("%s\n", message);
   fflush(stdout);
 
-  wterm_result_t result;
-  if (is_rescan) {
-    // Use silent rescan to avoid verbose output
-    result = rescan_wifi_networks_silent(true);
-    if (result == WTERM_SUCCESS) {
-      result = scan_wifi_networks(network_list);
-    }
-  } else {
-    result = scan_wifi_networks(network_list);
-  }
+  // A rescan waits for the scan to finish, so its results are current
+  wterm_result_t result =
+      is_rescan ? scan_wifi_networks_fresh(network_list, SCAN_FRESH_DEFAULT_TIMEOUT_MS)
+                : scan_wifi_networks(network_list);
 
   if (result != WTERM_SUCCESS) {
     REPORT_ERROR(true, "Failed to scan WiFi networks%s", "");
+  } else if (network_list->is_stale) {
+    printf("Scan did not complete in time; showing cached results\n");
   }
 
   return result;
@@ -97,32 +129,48 @@ static wterm_result_t handle_tui_mode(void) {
     return handle_list_networks();
   }
 
-  // Do initial scan BEFORE initializing TUI (so loading messages show)
-  network_list_t network_list;
-  wterm_result_t result = scan_networks_with_loading(&network_list, false);
-  if (result != WTERM_SUCCESS) {
-    return result;
+  // Later rescans run in the background while the TUI stays up
+  network_list_t network_list = {0};
+  wterm_result_t result;
+  scan_worker_t *worker = scan_worker_start(NULL);
+
+  // Paint the last session's networks (marked stale) right away and let
+  // the worker replace them; without a snapshot, scan BEFORE initializing
+  // the TUI so loading messages show
+  if (worker && load_scan_snapshot(&network_list)) {
+    scan_worker_refresh(worker);
+  } else {
+    result = scan_networks_with_loading(&network_list, false);
+    if (result != WTERM_SUCCESS) {
+      scan_worker_stop(worker);
+      network_list_free(&network_list);
+      return result;
+    }
   }
 
-  // Initialize TUI after scan completes
   if (tui_init() != WTERM_SUCCESS) {
     REPORT_ERROR(true, "TUI initialization failed%s", "");
+    scan_worker_stop(worker);
+    network_list_free(&network_list);
     return WTERM_ERROR_GENERAL;
   }
 
   while (true) {
     // Show network selection (TUI handles connections internally)
     char selected_ssid[MAX_STR_SSID];
-    bool selection_made =
-        tui_select_network(&network_list, selected_ssid, sizeof(selected_ssid));
+    bool selection_made = tui_select_network(&network_list, worker,
+                                             selected_ssid, sizeof(selected_ssid));
 
     if (!selection_made) {
       // User quit
       tui_shutdown();
+      scan_worker_stop(worker);
+      save_scan_snapshot(&network_list);
+      network_list_free(&network_list);
       return WTERM_SUCCESS;
     }
 
-    // Check if user selected rescan
+    // Rescan requested and no worker thread could be started
     if (strcmp(selected_ssid, "RESCAN") == 0) {
       // Clean up TUI before rescanning
       tui_shutdown();
@@ -130,12 +178,14 @@ static wterm_result_t handle_tui_mode(void) {
       // Rescan (loading message will show because TUI is shut down)
       result = scan_networks_with_loading(&network_list, true);
       if (result != WTERM_SUCCESS) {
+        network_list_free(&network_list);
         return result;
       }
 
       // Reinitialize TUI after scan completes
       if (tui_init() != WTERM_SUCCESS) {
         REPORT_ERROR(true, "Failed to reinitialize TUI%s", "");
+        network_list_free(&network_list);
         return WTERM_ERROR_GENERAL;
       }
       continue; // Show selection again with new networks
@@ -153,6 +203,8 @@ static wterm_result_t handle_tui_mode(void) {
       // Reinitialize TUI for next selection
       if (tui_init() != WTERM_SUCCESS) {
         REPORT_ERROR(true, "Failed to reinitialize TUI%s", "");
+        scan_worker_stop(worker);
+        network_list_free(&network_list);
         return WTERM_ERROR_GENERAL;
       }
       continue; // Return to network selection after hotspot menu
@@ -252,6 +304,29 @@ static wterm_result_t handle_hotspot_stop(const char *hotspot_name) {
   return result;
 }
 
+static wterm_result_t handle_hotspot_watch(const char *hotspot_name) {
+  wterm_result_t result = hotspot_manager_init();
+  if (result != WTERM_SUCCESS) {
+    REPORT_ERROR(true, "Failed to initialize hotspot manager%s", "");
+    return result;
+  }
+
+  // Runs until the hotspot stops or the process is interrupted
+  printf("Watching clients of hotspot '%s'\n", hotspot_name);
+  result = hotspot_watch_clients(hotspot_name, -1);
+
+  if (result == WTERM_ERROR_PERMISSION) {
+    REPORT_ERROR(true, "✗ Rate limits need root privileges%s", "");
+  } else if (result == WTERM_ERROR_GENERAL) {
+    REPORT_ERROR(true, "✗ Hotspot '%s' is not saved or not running", hotspot_name);
+  } else if (result != WTERM_SUCCESS) {
+    REPORT_ERROR(true, "✗ Failed to watch hotspot '%s'", hotspot_name);
+  }
+
+  hotspot_manager_cleanup();
+  return result;
+}
+
 static wterm_result_t handle_hotspot_status(const char *hotspot_name) {
   wterm_result_t result = hotspot_manager_init();
   if (result != WTERM_SUCCESS) {
@@ -385,6 +460,12 @@ static wterm_result_t handle_hotspot_commands(int argc, char *argv[]) {
       return WTERM_ERROR_INVALID_INPUT;
     }
     return handle_hotspot_stop(argv[3]);
+  } else if (strcmp(subcommand, "watch") == 0) {
+    if (argc < 4) {
+      REPORT_ERROR(true, "Hotspot name required for watch command%s", "");
+      return WTERM_ERROR_INVALID_INPUT;
+    }
+    return handle_hotspot_watch(argv[3]);
   } else if (strcmp(subcommand, "status") == 0) {
     const char *name = (argc >= 4) ? argv[3] : NULL;
     return handle_hotspot_status(name);
@@ -406,6 +487,11 @@ static wterm_result_t handle_hotspot_commands(int argc, char *argv[]) {
 }
 
 int main(int argc, char *argv[]) {
+  const char *exec_stats = getenv("WTERM_EXEC_STATS");
+  if (exec_stats && strcmp(exec_stats, "1") == 0) {
+    atexit(print_exec_stats);
+  }
+
   // Handle command line arguments
   if (argc > 1) {
     if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
@@ -415,6 +501,8 @@ int main(int argc, char *argv[]) {
                strcmp(argv[1], "--version") == 0) {
       print_version();
       return WTERM_SUCCESS;
+    } else if (strcmp(argv[1], "list") == 0) {
+      return handle_list_networks();
     } else if (strcmp(argv[1], "hotspot") == 0) {
       // Handle hotspot commands
       return handle_hotspot_commands(argc, argv);
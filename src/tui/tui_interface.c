@@ -11,11 +11,15 @@
 #include "../core/connection.h"
 #include "../core/hotspot_manager.h"
 #include "../core/error_queue.h"
+#include "../core/scan_delta.h"
+#include "../core/scan_pipeline.h"
+#include "../core/scan_worker.h"
 #include "../utils/string_utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <time.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <errno.h>
@@ -66,6 +70,15 @@ static bool tui_initialized = false;
 static connection_status_t current_connection_status = {0};
 static hotspot_list_t current_hotspots = {0};
 
+// Scan-to-scan state: new networks are marked and the selection follows its SSID
+static scan_delta_t network_delta = {.key = SCAN_DELTA_KEY_SSID,
+                                     .signal_threshold = SCAN_DELTA_DEFAULT_THRESHOLD};
+static char last_selected_ssid[MAX_STR_SSID] = "";
+
+// Event wait while a scan worker is attached, so new results and the
+// scanning indicator are drawn without a key press
+#define TUI_SCAN_POLL_MS 100
+
 // ============================================================================
 // Helper Functions
 // ============================================================================
@@ -156,10 +169,10 @@ static void render_saved_networks_list(tui_panel_t *panel, const network_list_t
     int end = start + visible_lines;
 
     // Build list of saved networks (only show networks that are actually saved)
-    int saved_indices[MAX_NETWORKS];
+    int saved_indices[networks->count > 0 ? networks->count : 1];
     int saved_count = 0;
 
-    for (int i = 0; i < networks->count && saved_count < MAX_NETWORKS; i++) {
+    for (int i = 0; i < networks->count; i++) {
         if (is_saved_connection(networks->networks[i].ssid)) {
             saved_indices[saved_count++] = i;
         }
@@ -204,13 +217,22 @@ static void render_saved_networks_list(tui_panel_t *panel, const network_list_t
 }
 #endif  // End of unused render_saved_networks_list
 
-static void render_available_networks(tui_panel_t *panel, const network_list_t *networks) {
+// The connected network ranks first in the list
+static bool is_current_network(const char *ssid, void *user_data) {
+    (void)user_data;
+    return current_connection_status.is_connected &&
+           strcmp(current_connection_status.connected_ssid, ssid) == 0;
+}
+
+static void render_available_networks(tui_panel_t *panel, const network_list_t *networks,
+                                      const scan_view_t *view, const bool *is_new) {
     int visible_lines = panel->height - 2;
     int start = panel->scroll_offset;
     int end = start + visible_lines;
-    if (end > networks->count) end = networks->count;
+    if (end > view->count) end = view->count;
 
     for (int i = start; i < end; i++) {
+        const network_info_t *network = &networks->networks[view->order[i]];
         int y = panel->y + 1 + (i - start);
         int x = panel->x + 2;
 
@@ -224,15 +246,18 @@ static void render_available_networks(tui_panel_t *panel, const network_list_t *
 
         // Check connection status
         bool is_connected = current_connection_status.is_connected &&
-                           strcmp(current_connection_status.connected_ssid, networks->networks[i].ssid) == 0;
+                           strcmp(current_connection_status.connected_ssid, network->ssid) == 0;
 
-        // Show ✓ only if connected (no saved indicator)
+        // Show ✓ if connected, + if new since the previous scan
         const char *indicator = " ";
         uintptr_t indicator_fg = fg;
 
         if (is_connected) {
             indicator = "✓";  // Connected (U+2713)
             indicator_fg = (i == panel->selected && panel->is_active) ? fg : TB_GREEN | TB_BOLD;
+        } else if (is_new && is_new[view->order[i]]) {
+            indicator = "+";
+            indicator_fg = (i == panel->selected && panel->is_active) ? fg : TB_CYAN | TB_BOLD;
         }
 
         // Selection arrow (only when active panel and selected)
@@ -244,23 +269,23 @@ static void render_available_networks(tui_panel_t *panel, const network_list_t *
 
         // SSID (left-aligned, 20 chars)
         char ssid_buf[40];  // Larger buffer to avoid truncation warnings
-        snprintf(ssid_buf, sizeof(ssid_buf), "%-18s", networks->networks[i].ssid);
+        snprintf(ssid_buf, sizeof(ssid_buf), "%-18s", network->ssid);
         tb_printf(x + 4, y, fg, bg, "%s", ssid_buf);
 
-        // Signal bar (parse signal string to int)
-        int signal_strength = atoi(networks->networks[i].signal);
+        // Signal bar from the numeric quality column
+        int signal_strength = networks->quality[view->order[i]];
         render_signal_bar(x + 23, y, signal_strength, fg, bg);
 
         // Signal percentage and security
         tb_printf(x + 30, y, fg, bg, " %3d%%  %-8s",
                   signal_strength,
-                  networks->networks[i].security);
+                  network->security);
     }
 
     // Scroll indicator
-    if (networks->count > visible_lines && networks->count > 1) {
+    if (view->count > visible_lines && view->count > 1) {
         int indicator_y = panel->y + 1;
-        int progress = (panel->selected * (visible_lines - 1)) / (networks->count - 1);
+        int progress = (panel->selected * (visible_lines - 1)) / (view->count - 1);
         tb_set_cell(panel->x + panel->width - 2, indicator_y + progress, 0x2588, TB_CYAN, TB_DEFAULT);
     }
 }
@@ -1241,53 +1266,78 @@ void tui_shutdown(void) {
     }
 }
 
-bool tui_select_network(const network_list_t *networks,
-                        char *selected_ssid,
-                        size_t buffer_size) {
-    if (!networks || !selected_ssid || buffer_size == 0) {
+// Rank a new scan, mark networks that appeared since the previous one and
+// keep the previously selected SSID selected
+static bool refresh_network_view(const network_list_t *networks, scan_view_t *view,
+                                 bool **is_new, tui_panel_t *panel) {
+    scan_pipeline_options_t options = {.is_known = is_current_network, .user_data = NULL};
+    if (scan_view_build(view, networks, &options) != WTERM_SUCCESS) {
         return false;
     }
 
-    if (!tui_initialized) {
-        if (tui_init() != WTERM_SUCCESS) {
-            return false;
+    // On the first scan nothing is "new"
+    free(*is_new);
+    *is_new = NULL;
+    bool had_previous_scan = network_delta.primed;
+    if (scan_delta_update(&network_delta, networks) == WTERM_SUCCESS &&
+        had_previous_scan && networks->count > 0) {
+        *is_new = calloc((size_t)networks->count, sizeof(bool));
+        for (int i = 0; *is_new && i < network_delta.change_count; i++) {
+            if (network_delta.changes[i].flags & SCAN_CHANGE_ADDED) {
+                (*is_new)[network_delta.changes[i].index] = true;
+            }
         }
     }
 
-    // Filter and deduplicate networks
-    network_list_t filtered_networks = {0};
-
-    for (int i = 0; i < networks->count; i++) {
-        // Skip empty SSIDs
-        if (networks->networks[i].ssid[0] == '\0' ||
-            strlen(networks->networks[i].ssid) == 0) {
-            continue;
+    int visible = panel->height - 2;
+    panel->item_count = view->count;
+    for (int i = 0; last_selected_ssid[0] != '\0' && i < view->count; i++) {
+        if (strcmp(networks->networks[view->order[i]].ssid, last_selected_ssid) == 0) {
+            panel->selected = i;
+            panel->scroll_offset = i >= visible ? i - visible + 1 : 0;
+            return true;
         }
+    }
 
-        // Check if this SSID already exists in filtered list
-        bool duplicate = false;
-        int existing_idx = -1;
-        for (int j = 0; j < filtered_networks.count; j++) {
-            if (strcmp(filtered_networks.networks[j].ssid, networks->networks[i].ssid) == 0) {
-                duplicate = true;
-                existing_idx = j;
-                break;
-            }
-        }
+    // Selected network is gone: stay at the same row
+    if (panel->selected >= view->count) {
+        panel->selected = view->count > 0 ? view->count - 1 : 0;
+    }
+    if (panel->scroll_offset > panel->selected) {
+        panel->scroll_offset = panel->selected;
+    }
+    return true;
+}
 
-        if (duplicate) {
-            // Keep the one with stronger signal
-            int current_signal = atoi(networks->networks[i].signal);
-            int existing_signal = atoi(filtered_networks.networks[existing_idx].signal);
-            if (current_signal > existing_signal) {
-                // Replace with stronger signal
-                filtered_networks.networks[existing_idx] = networks->networks[i];
-            }
-        } else {
-            // Add new network
-            if (filtered_networks.count < MAX_NETWORKS) {
-                filtered_networks.networks[filtered_networks.count++] = networks->networks[i];
-            }
+static void remember_selection(const network_list_t *networks, const scan_view_t *view,
+                               const tui_panel_t *panel) {
+    if (view->count > 0 && panel->selected < view->count) {
+        safe_string_copy(last_selected_ssid, networks->networks[view->order[panel->selected]].ssid,
+                         sizeof(last_selected_ssid));
+    }
+}
+
+static void draw_scanning_indicator(const tui_panel_t *panel) {
+    static const char *frames[] = {"⠋", "⠙", "⠹", "⠸", "⠼", "⠴", "⠦", "⠧", "⠇", "⠏"};
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int frame = (int)((now.tv_sec * 10 + now.tv_nsec / 100000000) % 10);
+
+    tb_printf(panel->x + panel->width - 16, panel->y, TB_YELLOW, TB_DEFAULT,
+              " %s scanning ", frames[frame]);
+}
+
+bool tui_select_network(network_list_t *networks,
+                        struct scan_worker *worker,
+                        char *selected_ssid,
+                        size_t buffer_size) {
+    if (!networks || !selected_ssid || buffer_size == 0) {
+        return false;
+    }
+
+    if (!tui_initialized) {
+        if (tui_init() != WTERM_SUCCESS) {
+            return false;
         }
     }
 
@@ -1303,17 +1353,35 @@ bool tui_select_network(const network_list_t *networks,
     if (panel2_height < 8) panel2_height = 8;
 
     tui_panel_t panels[3] = {
-        {0, 0, width, panel1_height, "Available Networks", true, 0, 0, filtered_networks.count},
+        {0, 0, width, panel1_height, "Available Networks", true, 0, 0, 0},
         {0, panel1_height, width, panel2_height, "Hotspots", false, 0, 0, current_hotspots.count},
         {0, panel1_height + panel2_height, width, keybindings_height, "Keybindings", false, 0, 0, 0}
     };
 
+    // Deduplicate and rank networks (index view, no copies)
+    scan_view_t view = {0};
+    bool *is_new = NULL;
+    if (!refresh_network_view(networks, &view, &is_new, &panels[0])) {
+        scan_view_free(&view);
+        return false;
+    }
+
     bool running = true;
     int active_panel = 0;  // 0=networks, 1=hotspots
     bool show_help = false;
     bool network_selected = false;
 
     while (running) {
+        // Merge results published by the scan worker in place
+        wterm_result_t scan_result;
+        if (worker && scan_worker_take(worker, networks, &scan_result) &&
+            scan_result == WTERM_SUCCESS) {
+            remember_selection(networks, &view, &panels[0]);
+            if (!refresh_network_view(networks, &view, &is_new, &panels[0])) {
+                break;
+            }
+        }
+
         tb_clear();
 
         panels[0].is_active = (active_panel == 0);
@@ -1326,8 +1394,14 @@ bool tui_select_network(const network_list_t *networks,
             clear_panel_content(&panels[i]);
         }
 
-        // Render available networks (using filtered list)
-        render_available_networks(&panels[0], &filtered_networks);
+        // Render available networks (ranked view)
+        render_available_networks(&panels[0], networks, &view, is_new);
+        if (scan_worker_is_scanning(worker)) {
+            draw_scanning_indicator(&panels[0]);
+        } else if (networks->is_stale) {
+            tb_printf(panels[0].x + panels[0].width - 18, panels[0].y, TB_YELLOW, TB_DEFAULT,
+                      " cached results ");
+        }
 
         // Render hotspot list
         render_hotspot_list(&panels[1], &current_hotspots);
@@ -1344,8 +1418,8 @@ bool tui_select_network(const network_list_t *networks,
         // Status line (dynamic based on active panel)
         if (active_panel == 0) {
             const char *selected_network = "";
-            if (filtered_networks.count > 0 && panels[0].selected < filtered_networks.count) {
-                selected_network = filtered_networks.networks[panels[0].selected].ssid;
+            if (view.count > 0 && panels[0].selected < view.count) {
+                selected_network = networks->networks[view.order[panels[0].selected]].ssid;
             }
             tb_printf(0, height - 1, TB_GREEN, TB_DEFAULT,
                       " wterm TUI | Panel 1/2 | Network: %s [%d/%d]",
@@ -1382,7 +1456,13 @@ bool tui_select_network(const network_list_t *networks,
         }
 
         struct tb_event ev;
-        tb_poll_event(&ev);
+        if (worker) {
+            if (tb_peek_event(&ev, TUI_SCAN_POLL_MS) != TB_OK) {
+                continue;  // Timeout: redraw with any new scan results
+            }
+        } else {
+            tb_poll_event(&ev);
+        }
 
         if (show_help) {
             show_help = false;
@@ -1404,8 +1484,8 @@ bool tui_select_network(const network_list_t *networks,
                     // Panel-specific Enter action
                     if (active_panel == 0) {
                         // Network panel: Connect to network
-                        if (filtered_networks.count > 0 && panels[0].selected < filtered_networks.count) {
-                            network_info_t *selected_net = (network_info_t*)&filtered_networks.networks[panels[0].selected];
+                        if (view.count > 0 && panels[0].selected < view.count) {
+                            network_info_t *selected_net = (network_info_t*)&networks->networks[view.order[panels[0].selected]];
                             handle_connect_action(selected_net);
                         }
                     } else if (active_panel == 1) {
@@ -1431,8 +1511,8 @@ bool tui_select_network(const network_list_t *networks,
                         active_panel = (active_panel + 1) % 2;
                     } else if (ev.ch == 'c' && active_panel == 0) {
                         // Connect to selected network (network panel only)
-                        if (filtered_networks.count > 0 && panels[0].selected < filtered_networks.count) {
-                            network_info_t *selected_net = (network_info_t*)&filtered_networks.networks[panels[0].selected];
+                        if (view.count > 0 && panels[0].selected < view.count) {
+                            network_info_t *selected_net = (network_info_t*)&networks->networks[view.order[panels[0].selected]];
                             handle_connect_action(selected_net);
                         }
                     } else if (ev.ch == 'd') {
@@ -1459,7 +1539,10 @@ bool tui_select_network(const network_list_t *networks,
                         panels[1].item_count = current_hotspots.count;
                     } else if (ev.ch == 'r') {
                         // Panel-specific refresh
-                        if (active_panel == 0) {
+                        if (active_panel == 0 && worker) {
+                            // Network panel: Rescan in the background
+                            scan_worker_request(worker);
+                        } else if (active_panel == 0) {
                             // Network panel: Rescan
                             snprintf(selected_ssid, buffer_size, "RESCAN");
                             network_selected = true;
@@ -1489,6 +1572,15 @@ bool tui_select_network(const network_list_t *networks,
         }
     }
 
+    remember_selection(networks, &view, &panels[0]);
+    if (!network_selected) {
+        // Quitting: the next session starts from a fresh scan
+        scan_delta_free(&network_delta);
+        last_selected_ssid[0] = '\0';
+    }
+
+    free(is_new);
+    scan_view_free(&view);
     return network_selected;
 }
 
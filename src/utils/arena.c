@@ -0,0 +1,139 @@
+/**
+ * @file arena.c
+ * @brief Bump allocator for short-lived, bulk-freed data
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Strictest fundamental alignment (C99 has no max_align_t)
+typedef union {
+    long double ld;
+    long long ll;
+    void *ptr;
+    void (*fn)(void);
+} arena_align_t;
+
+#define ARENA_ALIGN sizeof(arena_align_t)
+#define ARENA_ROUND_UP(n) (((n) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+typedef struct arena_block {
+    struct arena_block *next;   // Older block
+    size_t size;
+    size_t used;
+    size_t last;                // Offset of the most recent allocation
+    arena_align_t data[];
+} arena_block_t;
+
+struct arena {
+    arena_block_t *head;        // Block currently allocated from
+    arena_block_t *first;       // Lives inside the arena's own allocation
+    size_t block_size;
+};
+
+static void block_init(arena_block_t *block, size_t size, arena_block_t *next) {
+    block->next = next;
+    block->size = size;
+    block->used = 0;
+    block->last = SIZE_MAX;
+}
+
+arena_t *arena_create(size_t block_size) {
+    block_size = ARENA_ROUND_UP(block_size > 0 ? block_size : ARENA_ALIGN);
+
+    size_t header = ARENA_ROUND_UP(sizeof(arena_t));
+    char *memory = malloc(header + sizeof(arena_block_t) + block_size);
+    if (!memory) {
+        return NULL;
+    }
+
+    arena_t *arena = (arena_t *)memory;
+    arena->first = (arena_block_t *)(memory + header);
+    block_init(arena->first, block_size, NULL);
+    arena->head = arena->first;
+    arena->block_size = block_size;
+    return arena;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+    if (!arena) {
+        return NULL;
+    }
+
+    size = ARENA_ROUND_UP(size > 0 ? size : 1);
+    arena_block_t *block = arena->head;
+
+    if (block->size - block->used < size) {
+        size_t capacity = size > arena->block_size ? size : arena->block_size;
+        block = malloc(sizeof(arena_block_t) + capacity);
+        if (!block) {
+            return NULL;
+        }
+        block_init(block, capacity, arena->head);
+        arena->head = block;
+    }
+
+    void *ptr = (char *)block->data + block->used;
+    block->last = block->used;
+    block->used += size;
+    return ptr;
+}
+
+void *arena_resize(arena_t *arena, void *ptr, size_t old_size, size_t new_size) {
+    if (!arena) {
+        return NULL;
+    }
+    if (!ptr) {
+        return arena_alloc(arena, new_size);
+    }
+
+    // The most recent allocation in the current block can simply grow
+    arena_block_t *block = arena->head;
+    if (block->last != SIZE_MAX && (char *)block->data + block->last == ptr) {
+        size_t rounded = ARENA_ROUND_UP(new_size > 0 ? new_size : 1);
+        if (block->size - block->last >= rounded) {
+            block->used = block->last + rounded;
+            return ptr;
+        }
+    }
+
+    void *moved = arena_alloc(arena, new_size);
+    if (moved) {
+        memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return moved;
+}
+
+void arena_reset(arena_t *arena) {
+    if (!arena) {
+        return;
+    }
+
+    while (arena->head != arena->first) {
+        arena_block_t *older = arena->head->next;
+        free(arena->head);
+        arena->head = older;
+    }
+    block_init(arena->first, arena->first->size, NULL);
+}
+
+void arena_destroy(arena_t *arena) {
+    if (!arena) {
+        return;
+    }
+
+    arena_reset(arena);
+    free(arena);
+}
+
+size_t arena_block_count(const arena_t *arena) {
+    size_t count = 0;
+    for (const arena_block_t *block = arena ? arena->head : NULL; block;
+         block = block->next) {
+        count++;
+    }
+    return count;
+}
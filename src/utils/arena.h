@@ -0,0 +1,57 @@
+/**
+ * @file arena.h
+ * @brief Bump allocator for short-lived, bulk-freed data
+ *
+ * An arena hands out memory from large blocks and releases everything at
+ * once. The header and first block share a single malloc(), so data that
+ * fits the first block (e.g. one scan's results) costs one allocation and
+ * one free.
+ */
+
+#ifndef WTERM_ARENA_H
+#define WTERM_ARENA_H
+
+#include <stddef.h>
+
+typedef struct arena arena_t;
+
+/**
+ * @brief Create an arena
+ * @param block_size Capacity of the first block and minimum size of later ones
+ * @return New arena, or NULL on allocation failure
+ */
+arena_t *arena_create(size_t block_size);
+
+/**
+ * @brief Allocate suitably aligned, uninitialized memory
+ * @return Pointer valid until the next arena_reset() or arena_destroy(),
+ *         or NULL on allocation failure
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * @brief Resize an allocation, in place when it is the most recent one
+ *
+ * Otherwise a new region is allocated and the old contents copied; the old
+ * region is only reclaimed when the arena is reset.
+ *
+ * @return Resized allocation, or NULL on failure (the original is untouched)
+ */
+void *arena_resize(arena_t *arena, void *ptr, size_t old_size, size_t new_size);
+
+/**
+ * @brief Release every allocation, keeping the first block for reuse
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * @brief Free the arena and all of its blocks
+ */
+void arena_destroy(arena_t *arena);
+
+/**
+ * @brief Number of malloc()ed blocks currently backing the arena
+ */
+size_t arena_block_count(const arena_t *arena);
+
+#endif // WTERM_ARENA_H
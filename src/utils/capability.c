@@ -0,0 +1,165 @@
+/**
+ * @file capability.c
+ * @brief Process-wide registry of external tools wterm can use
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "capability.h"
+#include "string_utils.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef enum {
+    CAPABILITY_UNKNOWN = 0,
+    CAPABILITY_MISSING,
+    CAPABILITY_FOUND
+} capability_state_t;
+
+typedef struct {
+    const char *name;
+    capability_state_t state;
+    char path[CAPABILITY_PATH_MAX];
+} capability_entry_t;
+
+static capability_entry_t registry[CAPABILITY_COUNT] = {
+    [CAPABILITY_NMCLI] = {.name = "nmcli"},
+    [CAPABILITY_IW] = {.name = "iw"},
+    [CAPABILITY_IP] = {.name = "ip"},
+    [CAPABILITY_IPTABLES] = {.name = "iptables"},
+    [CAPABILITY_IPTABLES_RESTORE] = {.name = "iptables-restore"},
+    [CAPABILITY_NFT] = {.name = "nft"},
+    [CAPABILITY_TC] = {.name = "tc"},
+};
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool is_executable_file(const char *path) {
+    struct stat st;
+    return access(path, X_OK) == 0 && stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+bool capability_resolve(const char *program, char *path, size_t size) {
+    if (!program || program[0] == '\0') {
+        return false;
+    }
+
+    if (strchr(program, '/')) {
+        if (!is_executable_file(program)) {
+            return false;
+        }
+        if (path && size > 0) {
+            safe_string_copy(path, program, size);
+        }
+        return true;
+    }
+
+    char default_path[256];
+    const char *search = getenv("PATH");
+    if (!search) {
+        size_t len = confstr(_CS_PATH, default_path, sizeof(default_path));
+        search = (len > 0 && len <= sizeof(default_path)) ? default_path : "/usr/bin:/bin";
+    }
+
+    size_t program_len = strlen(program);
+    const char *dir = search;
+    for (;;) {
+        const char *end = strchr(dir, ':');
+        size_t dir_len = end ? (size_t)(end - dir) : strlen(dir);
+
+        char candidate[CAPABILITY_PATH_MAX];
+        // An empty PATH element means the current directory
+        if (dir_len == 0) {
+            candidate[0] = '.';
+            dir_len = 1;
+        } else if (dir_len < sizeof(candidate)) {
+            memcpy(candidate, dir, dir_len);
+        }
+
+        if (dir_len + 1 + program_len < sizeof(candidate)) {
+            candidate[dir_len] = '/';
+            memcpy(candidate + dir_len + 1, program, program_len + 1);
+
+            if (is_executable_file(candidate)) {
+                if (path && size > 0) {
+                    safe_string_copy(path, candidate, size);
+                }
+                return true;
+            }
+        }
+
+        if (!end) {
+            return false;
+        }
+        dir = end + 1;
+    }
+}
+
+// Resolve an entry on first use; caller holds registry_lock
+static capability_entry_t *lookup_locked(capability_t capability) {
+    capability_entry_t *entry = &registry[capability];
+    if (entry->state == CAPABILITY_UNKNOWN) {
+        entry->state = capability_resolve(entry->name, entry->path, sizeof(entry->path))
+                           ? CAPABILITY_FOUND
+                           : CAPABILITY_MISSING;
+    }
+    return entry;
+}
+
+bool capability_available(capability_t capability) {
+    return capability_path(capability, NULL, 0);
+}
+
+bool capability_path(capability_t capability, char *path, size_t size) {
+    if ((int)capability < 0 || capability >= CAPABILITY_COUNT) {
+        return false;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+    const capability_entry_t *entry = lookup_locked(capability);
+    bool found = entry->state == CAPABILITY_FOUND;
+    if (found && path) {
+        found = strlen(entry->path) < size;
+        if (found) {
+            safe_string_copy(path, entry->path, size);
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+
+    return found;
+}
+
+const char *capability_name(capability_t capability) {
+    if ((int)capability < 0 || capability >= CAPABILITY_COUNT) {
+        return NULL;
+    }
+    return registry[capability].name;
+}
+
+bool capability_from_name(const char *program, capability_t *capability) {
+    if (!program) {
+        return false;
+    }
+
+    for (int i = 0; i < CAPABILITY_COUNT; i++) {
+        if (strcmp(registry[i].name, program) == 0) {
+            if (capability) {
+                *capability = (capability_t)i;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void capability_reset(void) {
+    pthread_mutex_lock(&registry_lock);
+    for (int i = 0; i < CAPABILITY_COUNT; i++) {
+        registry[i].state = CAPABILITY_UNKNOWN;
+        registry[i].path[0] = '\0';
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
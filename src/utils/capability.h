@@ -0,0 +1,86 @@
+/**
+ * @file capability.h
+ * @brief Process-wide registry of external tools wterm can use
+ *
+ * Binaries are resolved by walking PATH with access(X_OK) in-process, the
+ * first time each one is asked for, and the result is cached for the
+ * lifetime of the process. This replaces forking `which` for every
+ * availability check.
+ */
+
+#ifndef WTERM_CAPABILITY_H
+#define WTERM_CAPABILITY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CAPABILITY_PATH_MAX 4096
+
+/**
+ * @brief External tools known to the registry
+ */
+typedef enum {
+    CAPABILITY_NMCLI = 0,
+    CAPABILITY_IW,
+    CAPABILITY_IP,
+    CAPABILITY_IPTABLES,
+    CAPABILITY_IPTABLES_RESTORE,
+    CAPABILITY_NFT,
+    CAPABILITY_TC,
+    CAPABILITY_COUNT
+} capability_t;
+
+/**
+ * @brief Check whether a tool is installed (cached)
+ * @param capability Tool to check
+ * @return true if an executable was found in PATH
+ */
+bool capability_available(capability_t capability);
+
+/**
+ * @brief Get the resolved absolute path of a tool (cached)
+ *
+ * The path is copied under the registry lock, so a concurrent
+ * capability_reset() cannot change it underneath the caller.
+ *
+ * @param capability Tool to look up
+ * @param path Output buffer for the absolute path (may be NULL)
+ * @param size Size of path buffer; CAPABILITY_PATH_MAX always fits
+ * @return true if the tool is installed and its path fits
+ */
+bool capability_path(capability_t capability, char *path, size_t size);
+
+/**
+ * @brief Get the program name of a tool ("nmcli", "iw", ...)
+ * @param capability Tool
+ * @return Program name, or NULL for an invalid capability
+ */
+const char *capability_name(capability_t capability);
+
+/**
+ * @brief Find the registry entry for a program name
+ * @param program Program name as passed to exec (e.g. "nmcli")
+ * @param capability Output: matching capability
+ * @return true if the program is a known capability
+ */
+bool capability_from_name(const char *program, capability_t *capability);
+
+/**
+ * @brief Resolve a program in PATH without consulting the cache
+ *
+ * Names containing '/' are checked as-is. An unset PATH falls back to
+ * the confstr(_CS_PATH) default, like execvp().
+ *
+ * @param program Program name
+ * @param path Output buffer for the resolved path (may be NULL)
+ * @param size Size of path buffer
+ * @return true if an executable was found
+ */
+bool capability_resolve(const char *program, char *path, size_t size);
+
+/**
+ * @brief Forget all cached lookups (e.g. after PATH changes)
+ */
+void capability_reset(void);
+
+#endif // WTERM_CAPABILITY_H
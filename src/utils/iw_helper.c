@@ -5,6 +5,7 @@
 
 #define _POSIX_C_SOURCE 200809L
 #include "iw_helper.h"
+#include "capability.h"
 #include "string_utils.h"
 #include "safe_exec.h"
 #include <stdio.h>
@@ -13,7 +14,7 @@
 #include <ctype.h>
 
 bool iw_is_available(void) {
-    return safe_command_exists("iw");
+    return capability_available(CAPABILITY_IW);
 }
 
 wterm_result_t iw_get_phy_index(const char *interface, int *phy_index) {
@@ -25,29 +26,29 @@ wterm_result_t iw_get_phy_index(const char *interface, int *phy_index) {
         return WTERM_ERROR_GENERAL;
     }
 
-    // Execute: iw dev <interface> info | grep wiphy | awk '{print $2}'
-    char command[256];
-    snprintf(command, sizeof(command), "iw dev %s info 2>/dev/null | grep wiphy", interface);
-
-    FILE *fp = popen(command, "r");
-    if (!fp) {
+    // Execute: iw dev <interface> info, then find the "wiphy N" line
+    char *const args[] = {"iw", "dev", (char *)interface, "info", NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("iw", args, &output)) {
         return WTERM_ERROR_NETWORK;
     }
 
-    char buffer[128];
     bool found = false;
+    char *cursor = output.out;
+    char *line;
 
-    if (fgets(buffer, sizeof(buffer), fp)) {
+    while (output.exit_code == 0 && (line = safe_exec_next_line(&cursor))) {
         // Parse line like: "    wiphy 0"
-        char *wiphy_start = strstr(buffer, "wiphy ");
+        const char *wiphy_start = strstr(line, "wiphy ");
         if (wiphy_start) {
             wiphy_start += strlen("wiphy ");
             *phy_index = atoi(wiphy_start);
             found = true;
+            break;
         }
     }
 
-    pclose(fp);
+    safe_exec_output_free(&output);
     return found ? WTERM_SUCCESS : WTERM_ERROR_GENERAL;
 }
 
@@ -69,27 +70,41 @@ wterm_result_t iw_check_ap_mode_support(const char *interface, bool *supports_ap
         return result;
     }
 
-    // Execute: iw phy phy<N> info | grep -A 10 "Supported interface modes"
-    char command[256];
-    snprintf(command, sizeof(command),
-             "iw phy phy%d info 2>/dev/null | grep -A 10 'Supported interface modes'",
-             phy_index);
+    // Execute: iw phy phy<N> info and look for "* AP" in the
+    // "Supported interface modes" list
+    char phy_name[32];
+    snprintf(phy_name, sizeof(phy_name), "phy%d", phy_index);
+    char *const args[] = {"iw", "phy", phy_name, "info", NULL};
 
-    FILE *fp = popen(command, "r");
-    if (!fp) {
+    safe_exec_output_t output;
+    if (!safe_exec_capture("iw", args, &output)) {
         return WTERM_ERROR_NETWORK;
     }
 
-    char buffer[256];
-    while (fgets(buffer, sizeof(buffer), fp)) {
-        // Look for "* AP" in the output
-        if (strstr(buffer, "* AP")) {
-            *supports_ap = true;
-            break;
+    bool in_modes = false;
+    char *cursor = output.out;
+    char *line;
+
+    while ((line = safe_exec_next_line(&cursor))) {
+        if (strstr(line, "Supported interface modes")) {
+            in_modes = true;
+            continue;
+        }
+
+        if (in_modes) {
+            const char *item = trim_leading_whitespace(line);
+            if (strncmp(item, "* ", 2) != 0) {
+                break; // End of the mode list
+            }
+            trim_trailing_whitespace(line);
+            if (strcmp(item, "* AP") == 0) {
+                *supports_ap = true;
+                break;
+            }
         }
     }
 
-    pclose(fp);
+    safe_exec_output_free(&output);
     return WTERM_SUCCESS;
 }
 
@@ -111,26 +126,19 @@ wterm_result_t iw_check_5ghz_support(const char *interface, bool *supports_5ghz)
         return result;
     }
 
-    // Execute: iw phy phy<N> info | grep "Band 2:"
+    // Execute: iw phy phy<N> info and look for "Band 2:"
     // Band 1 is 2.4GHz, Band 2 is 5GHz
-    char command[256];
-    snprintf(command, sizeof(command),
-             "iw phy phy%d info 2>/dev/null | grep 'Band 2:'",
-             phy_index);
+    char phy_name[32];
+    snprintf(phy_name, sizeof(phy_name), "phy%d", phy_index);
+    char *const args[] = {"iw", "phy", phy_name, "info", NULL};
 
-    FILE *fp = popen(command, "r");
-    if (!fp) {
+    safe_exec_output_t output;
+    if (!safe_exec_capture("iw", args, &output)) {
         return WTERM_ERROR_NETWORK;
     }
 
-    char buffer[256];
-    if (fgets(buffer, sizeof(buffer), fp)) {
-        // If we find "Band 2:" line, 5GHz is supported
-        if (strstr(buffer, "Band 2:")) {
-            *supports_5ghz = true;
-        }
-    }
+    *supports_5ghz = strstr(output.out, "Band 2:") != NULL;
 
-    pclose(fp);
+    safe_exec_output_free(&output);
     return WTERM_SUCCESS;
 }
@@ -0,0 +1,343 @@
+/**
+ * @file link_watcher.c
+ * @brief rtnetlink watcher for interface link and IPv4 address state
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "link_watcher.h"
+#include "string_utils.h"
+#include <errno.h>
+#include <linux/if.h>
+#include <linux/neighbour.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RTNL_RECV_BUFFER_SIZE 32768
+#define RTNL_REPLY_TIMEOUT_MS 5000
+
+// Dump request: header plus the family-specific message
+typedef struct {
+    struct nlmsghdr hdr;
+    union {
+        struct ifinfomsg link;
+        struct ifaddrmsg addr;
+    } body;
+} rtnl_dump_request_t;
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// ============================================================================
+// Message handling
+// ============================================================================
+
+static void handle_link(link_watcher_t *watcher, struct nlmsghdr *nlh) {
+    struct ifinfomsg *ifi = NLMSG_DATA(nlh);
+    int len = (int)nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifi));
+    if (len < 0) {
+        return;
+    }
+
+    const char *name = NULL;
+    int operstate = IF_OPER_UNKNOWN;
+    for (struct rtattr *rta = IFLA_RTA(ifi); RTA_OK(rta, len);
+         rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFLA_IFNAME) {
+            name = RTA_DATA(rta);
+        } else if (rta->rta_type == IFLA_OPERSTATE &&
+                   RTA_PAYLOAD(rta) >= sizeof(uint8_t)) {
+            operstate = *(uint8_t *)RTA_DATA(rta);
+        }
+    }
+
+    // The index is learned from the initial dump by name
+    if (watcher->ifindex == 0 && name && strcmp(name, watcher->ifname) == 0) {
+        watcher->ifindex = ifi->ifi_index;
+    }
+    if (ifi->ifi_index != watcher->ifindex) {
+        return;
+    }
+
+    if (nlh->nlmsg_type == RTM_DELLINK) {
+        watcher->link_up = false;
+        watcher->address_count = 0;
+        return;
+    }
+
+    // Drivers without operstate support report UNKNOWN; fall back to carrier.
+    // WiFi stays DORMANT until the supplicant finishes authentication.
+    watcher->link_up =
+        operstate == IF_OPER_UP ||
+        (operstate == IF_OPER_UNKNOWN && (ifi->ifi_flags & IFF_LOWER_UP));
+}
+
+static void handle_neighbour(link_watcher_t *watcher, struct nlmsghdr *nlh) {
+    struct ndmsg *ndm = NLMSG_DATA(nlh);
+    if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*ndm)) || ndm->ndm_family != AF_INET ||
+        ndm->ndm_ifindex != watcher->ifindex) {
+        return;
+    }
+    watcher->neighbour_changes++;
+}
+
+static void handle_address(link_watcher_t *watcher, struct nlmsghdr *nlh) {
+    struct ifaddrmsg *ifa = NLMSG_DATA(nlh);
+    int len = (int)nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifa));
+    if (len < 0 || ifa->ifa_family != AF_INET ||
+        (int)ifa->ifa_index != watcher->ifindex) {
+        return;
+    }
+
+    uint32_t address = 0;
+    bool found = false;
+    for (struct rtattr *rta = IFA_RTA(ifa); RTA_OK(rta, len);
+         rta = RTA_NEXT(rta, len)) {
+        // IFA_LOCAL is the interface's own address on point-to-point links
+        if ((rta->rta_type == IFA_LOCAL || (rta->rta_type == IFA_ADDRESS && !found)) &&
+            RTA_PAYLOAD(rta) >= sizeof(address)) {
+            memcpy(&address, RTA_DATA(rta), sizeof(address));
+            found = true;
+        }
+    }
+    if (!found) {
+        return;
+    }
+
+    int index = -1;
+    for (int i = 0; i < watcher->address_count; i++) {
+        if (watcher->addresses[i] == address) {
+            index = i;
+            break;
+        }
+    }
+
+    if (nlh->nlmsg_type == RTM_DELADDR) {
+        if (index >= 0) {
+            watcher->addresses[index] = watcher->addresses[--watcher->address_count];
+        }
+    } else if (index < 0 && watcher->address_count < LINK_WATCHER_MAX_ADDRESSES) {
+        // RTM_NEWADDR also fires for lifetime updates on known addresses
+        watcher->addresses[watcher->address_count++] = address;
+    }
+}
+
+/**
+ * @brief Apply every message in a receive buffer
+ *
+ * Returns true once NLMSG_DONE (or an error) for dump sequence `seq` is seen.
+ */
+static bool handle_messages(link_watcher_t *watcher, char *buffer, ssize_t len,
+                            uint32_t seq) {
+    bool done = false;
+    struct nlmsghdr *nlh = (struct nlmsghdr *)buffer;
+    for (; NLMSG_OK(nlh, (uint32_t)len); nlh = NLMSG_NEXT(nlh, len)) {
+        switch (nlh->nlmsg_type) {
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+            handle_link(watcher, nlh);
+            break;
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+            handle_address(watcher, nlh);
+            break;
+        case RTM_NEWNEIGH:
+        case RTM_DELNEIGH:
+            handle_neighbour(watcher, nlh);
+            break;
+        case NLMSG_DONE:
+        case NLMSG_ERROR:
+            if (seq != 0 && nlh->nlmsg_seq == seq) {
+                done = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return done;
+}
+
+static bool dump(link_watcher_t *watcher, uint16_t type, uint32_t seq) {
+    rtnl_dump_request_t req;
+    memset(&req, 0, sizeof(req));
+    req.hdr.nlmsg_type = type;
+    req.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.hdr.nlmsg_seq = seq;
+    if (type == RTM_GETLINK) {
+        req.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+        req.body.link.ifi_family = AF_UNSPEC;
+    } else {
+        req.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+        req.body.addr.ifa_family = AF_INET;
+    }
+
+    if (send(watcher->fd, &req, req.hdr.nlmsg_len, 0) != (ssize_t)req.hdr.nlmsg_len) {
+        return false;
+    }
+
+    static __thread char buffer[RTNL_RECV_BUFFER_SIZE]
+        __attribute__((aligned(NLMSG_ALIGNTO)));
+
+    // Events may interleave with the dump; they are applied the same way
+    while (true) {
+        struct pollfd pfd = {.fd = watcher->fd, .events = POLLIN};
+        if (poll(&pfd, 1, RTNL_REPLY_TIMEOUT_MS) <= 0) {
+            return false;
+        }
+
+        ssize_t len = recv(watcher->fd, buffer, sizeof(buffer), 0);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (handle_messages(watcher, buffer, len, seq)) {
+            return true;
+        }
+    }
+}
+
+// Reload the full state, e.g. after the socket overflowed and dropped events.
+// Neighbour events are not dumped; a lost one counts as a change.
+static bool resync(link_watcher_t *watcher) {
+    watcher->neighbour_changes++;
+    watcher->link_up = false;
+    watcher->address_count = 0;
+    return dump(watcher, RTM_GETLINK, 1) && dump(watcher, RTM_GETADDR, 2);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+wterm_result_t link_watcher_open(link_watcher_t *watcher, const char *ifname) {
+    if (!watcher || !ifname || ifname[0] == '\0') {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    memset(watcher, 0, sizeof(*watcher));
+    safe_string_copy(watcher->ifname, ifname, sizeof(watcher->ifname));
+
+    watcher->fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (watcher->fd < 0) {
+        return WTERM_ERROR_NETWORK;
+    }
+
+    // Subscribe before dumping so no change between the two is missed
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_NEIGH;
+    if (bind(watcher->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        !resync(watcher)) {
+        link_watcher_close(watcher);
+        return WTERM_ERROR_NETWORK;
+    }
+
+    if (watcher->ifindex == 0) {
+        link_watcher_close(watcher);
+        return WTERM_ERROR_INTERFACE;
+    }
+
+    return WTERM_SUCCESS;
+}
+
+// Apply events until the phase (or with neighbours, the neighbour table)
+// of the watched interface changes
+static wterm_result_t wait_for_change(link_watcher_t *watcher, int timeout_ms,
+                                      int cancel_fd, bool neighbours) {
+    if (!watcher || watcher->fd < 0) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    static __thread char buffer[RTNL_RECV_BUFFER_SIZE]
+        __attribute__((aligned(NLMSG_ALIGNTO)));
+
+    link_phase_t start_phase = link_watcher_phase(watcher);
+    unsigned long start_changes = watcher->neighbour_changes;
+    long long deadline = monotonic_ms() + (timeout_ms > 0 ? timeout_ms : 0);
+
+    while (true) {
+        long long remaining = deadline - monotonic_ms();
+        if (remaining < 0) {
+            remaining = 0;
+        }
+
+        struct pollfd pfds[2] = {{.fd = watcher->fd, .events = POLLIN},
+                                 {.fd = cancel_fd, .events = POLLIN}};
+        int ready = poll(pfds, cancel_fd >= 0 ? 2 : 1, (int)remaining);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return WTERM_ERROR_NETWORK;
+        }
+        if (cancel_fd >= 0 && (pfds[1].revents & POLLIN)) {
+            return WTERM_ERROR_CANCELLED;
+        }
+        if (ready == 0) {
+            return WTERM_ERROR_TIMEOUT;
+        }
+
+        ssize_t len = recv(watcher->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (len < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            if (errno != ENOBUFS || !resync(watcher)) {
+                return WTERM_ERROR_NETWORK;
+            }
+        } else {
+            handle_messages(watcher, buffer, len, 0);
+        }
+
+        if (neighbours ? watcher->neighbour_changes != start_changes
+                       : link_watcher_phase(watcher) != start_phase) {
+            return WTERM_SUCCESS;
+        }
+    }
+}
+
+wterm_result_t link_watcher_wait(link_watcher_t *watcher, int timeout_ms, int cancel_fd) {
+    return wait_for_change(watcher, timeout_ms, cancel_fd, false);
+}
+
+wterm_result_t link_watcher_wait_neighbours(link_watcher_t *watcher, int timeout_ms,
+                                            int cancel_fd) {
+    return wait_for_change(watcher, timeout_ms, cancel_fd, true);
+}
+
+link_phase_t link_watcher_phase(const link_watcher_t *watcher) {
+    if (!watcher || !watcher->link_up) {
+        return LINK_PHASE_DOWN;
+    }
+    return watcher->address_count > 0 ? LINK_PHASE_CONFIGURED : LINK_PHASE_ASSOCIATED;
+}
+
+const char *link_phase_name(link_phase_t phase) {
+    switch (phase) {
+    case LINK_PHASE_ASSOCIATED:
+        return "associated, waiting for an IPv4 address";
+    case LINK_PHASE_CONFIGURED:
+        return "IPv4 address assigned";
+    case LINK_PHASE_DOWN:
+    default:
+        return "not associated";
+    }
+}
+
+void link_watcher_close(link_watcher_t *watcher) {
+    if (watcher && watcher->fd >= 0) {
+        close(watcher->fd);
+        watcher->fd = -1;
+    }
+}
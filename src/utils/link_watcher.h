@@ -0,0 +1,90 @@
+/**
+ * @file link_watcher.h
+ * @brief rtnetlink watcher for interface link and IPv4 address state
+ *
+ * Subscribes to the kernel's link and IPv4 address multicast groups on a
+ * NETLINK_ROUTE socket, so connection progress (association, then DHCP)
+ * is observed the moment it happens instead of by polling nmcli. IPv4
+ * neighbour events are counted too, which tells an access point when
+ * its stations come and go.
+ */
+
+#ifndef LINK_WATCHER_H
+#define LINK_WATCHER_H
+
+#include "../../include/wterm/common.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LINK_WATCHER_MAX_ADDRESSES 8
+
+/**
+ * @brief Connection phase of the watched interface
+ */
+typedef enum {
+    LINK_PHASE_DOWN = 0,        // Interface down or not associated
+    LINK_PHASE_ASSOCIATED,      // Carrier up, no IPv4 address yet
+    LINK_PHASE_CONFIGURED       // Carrier up with an IPv4 address
+} link_phase_t;
+
+/**
+ * @brief Watcher state for one interface
+ */
+typedef struct {
+    int fd;
+    int ifindex;
+    char ifname[MAX_STR_INTERFACE];
+    bool link_up;
+    uint32_t addresses[LINK_WATCHER_MAX_ADDRESSES];  // IPv4, network order
+    int address_count;
+    unsigned long neighbour_changes;  // IPv4 neighbour events seen so far
+} link_watcher_t;
+
+/**
+ * @brief Subscribe to link and address events and load the current state
+ * @param watcher Watcher to initialize
+ * @param ifname Interface to watch
+ * @return WTERM_SUCCESS, WTERM_ERROR_INTERFACE if the interface does not
+ *         exist, or WTERM_ERROR_NETWORK if rtnetlink is unavailable
+ */
+wterm_result_t link_watcher_open(link_watcher_t *watcher, const char *ifname);
+
+/**
+ * @brief Wait until the watched interface changes phase
+ * @param watcher Open watcher
+ * @param timeout_ms Maximum time to wait
+ * @param cancel_fd Descriptor that aborts the wait when readable (<0 for none)
+ * @return WTERM_SUCCESS on a phase change, WTERM_ERROR_TIMEOUT,
+ *         WTERM_ERROR_CANCELLED, or WTERM_ERROR_NETWORK on socket failure
+ */
+wterm_result_t link_watcher_wait(link_watcher_t *watcher, int timeout_ms, int cancel_fd);
+
+/**
+ * @brief Wait until an IPv4 neighbour of the watched interface changes
+ *
+ * Every added, updated or removed neighbour entry counts, including state
+ * changes of entries already known. Callers compare what they derive from
+ * the neighbour table themselves.
+ *
+ * @return WTERM_SUCCESS on a change, WTERM_ERROR_TIMEOUT,
+ *         WTERM_ERROR_CANCELLED, or WTERM_ERROR_NETWORK on socket failure
+ */
+wterm_result_t link_watcher_wait_neighbours(link_watcher_t *watcher, int timeout_ms,
+                                            int cancel_fd);
+
+/**
+ * @brief Current phase of the watched interface
+ */
+link_phase_t link_watcher_phase(const link_watcher_t *watcher);
+
+/**
+ * @brief Human-readable description of a phase
+ */
+const char *link_phase_name(link_phase_t phase);
+
+/**
+ * @brief Close the watcher socket
+ */
+void link_watcher_close(link_watcher_t *watcher);
+
+#endif // LINK_WATCHER_H
@@ -0,0 +1,272 @@
+/**
+ * @file network_list.c
+ * @brief Growable, column-wise scan result container backed by an arena
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "network_list.h"
+#include "arena.h"
+#include <string.h>
+
+// Columns in layout order; the string views come first so the block base
+// is always list->networks
+enum {
+    COLUMN_NETWORKS,
+    COLUMN_BSSID,
+    COLUMN_FREQUENCY,
+    COLUMN_CHANNEL,
+    COLUMN_SIGNAL_DBM,
+    COLUMN_QUALITY,
+    COLUMN_SECURITY_FLAGS,
+    COLUMN_MAX_RATE,
+    COLUMN_COUNT
+};
+
+static const size_t column_sizes[COLUMN_COUNT] = {
+    sizeof(network_info_t),
+    sizeof(uint8_t[6]),
+    sizeof(uint16_t),
+    sizeof(uint16_t),
+    sizeof(int16_t),
+    sizeof(uint8_t),
+    sizeof(uint8_t),
+    sizeof(uint16_t),
+};
+
+#define COLUMN_ALIGN 8
+
+// Compute column offsets for a capacity; returns the total block size
+static size_t column_layout(int capacity, size_t offsets[COLUMN_COUNT]) {
+    size_t offset = 0;
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        offsets[i] = offset;
+        offset += (size_t)capacity * column_sizes[i];
+        offset = (offset + COLUMN_ALIGN - 1) & ~(size_t)(COLUMN_ALIGN - 1);
+    }
+    return offset;
+}
+
+static void assign_columns(network_list_t *list, char *base, const size_t offsets[COLUMN_COUNT]) {
+    list->networks = (network_info_t *)(void *)(base + offsets[COLUMN_NETWORKS]);
+    list->bssid = (uint8_t(*)[6])(void *)(base + offsets[COLUMN_BSSID]);
+    list->frequency = (uint16_t *)(void *)(base + offsets[COLUMN_FREQUENCY]);
+    list->channel = (uint16_t *)(void *)(base + offsets[COLUMN_CHANNEL]);
+    list->signal_dbm = (int16_t *)(void *)(base + offsets[COLUMN_SIGNAL_DBM]);
+    list->quality = (uint8_t *)(void *)(base + offsets[COLUMN_QUALITY]);
+    list->security_flags = (uint8_t *)(void *)(base + offsets[COLUMN_SECURITY_FLAGS]);
+    list->max_rate = (uint16_t *)(void *)(base + offsets[COLUMN_MAX_RATE]);
+}
+
+static bool grow(network_list_t *list) {
+    int capacity = list->capacity > 0 ? list->capacity * 2 : NETWORK_LIST_INITIAL_CAPACITY;
+
+    size_t old_offsets[COLUMN_COUNT];
+    size_t new_offsets[COLUMN_COUNT];
+    size_t old_size = column_layout(list->capacity, old_offsets);
+    size_t new_size = column_layout(capacity, new_offsets);
+
+    // All columns share one allocation, the arena's most recent, so it grows
+    // in place until the first block is full
+    char *base = arena_resize(list->arena, list->networks, old_size, new_size);
+    if (!base) {
+        return false;
+    }
+
+    // Spread the columns out to their new offsets, last first so nothing
+    // is overwritten before it has moved
+    for (int i = COLUMN_COUNT - 1; i >= 0; i--) {
+        if (list->count > 0 && new_offsets[i] != old_offsets[i]) {
+            memmove(base + new_offsets[i], base + old_offsets[i],
+                    (size_t)list->count * column_sizes[i]);
+        }
+    }
+
+    assign_columns(list, base, new_offsets);
+    list->capacity = capacity;
+    return true;
+}
+
+void network_list_init(network_list_t *list) {
+    if (list) {
+        memset(list, 0, sizeof(*list));
+    }
+}
+
+network_info_t *network_list_append(network_list_t *list) {
+    if (!list) {
+        return NULL;
+    }
+
+    if (!list->arena) {
+        list->arena = arena_create(NETWORK_LIST_ARENA_SIZE);
+        if (!list->arena) {
+            return NULL;
+        }
+    }
+
+    if (list->count == list->capacity && !grow(list)) {
+        return NULL;
+    }
+
+    int index = list->count++;
+    static const scan_record_t empty_record = {{0}, 0, 0, 0, 0, 0, 0};
+    network_list_set_record(list, index, &empty_record);
+
+    network_info_t *network = &list->networks[index];
+    memset(network, 0, sizeof(*network));
+    return network;
+}
+
+void network_list_set_record(network_list_t *list, int index, const scan_record_t *record) {
+    if (!list || !record || index < 0 || index >= list->count) {
+        return;
+    }
+
+    memcpy(list->bssid[index], record->bssid, sizeof(record->bssid));
+    list->frequency[index] = record->frequency;
+    list->channel[index] = record->channel;
+    list->signal_dbm[index] = record->signal_dbm;
+    list->quality[index] = record->quality;
+    list->security_flags[index] = record->security_flags;
+    list->max_rate[index] = record->max_rate;
+}
+
+void network_list_get_record(const network_list_t *list, int index, scan_record_t *record) {
+    if (!record) {
+        return;
+    }
+    memset(record, 0, sizeof(*record));
+    if (!list || index < 0 || index >= list->count) {
+        return;
+    }
+
+    memcpy(record->bssid, list->bssid[index], sizeof(record->bssid));
+    record->frequency = list->frequency[index];
+    record->channel = list->channel[index];
+    record->signal_dbm = list->signal_dbm[index];
+    record->quality = list->quality[index];
+    record->security_flags = list->security_flags[index];
+    record->max_rate = list->max_rate[index];
+}
+
+int network_list_copy_entry(network_list_t *dst, int dst_index,
+                            const network_list_t *src, int src_index) {
+    if (!dst || !src || src_index < 0 || src_index >= src->count ||
+        dst_index >= dst->count) {
+        return -1;
+    }
+
+    if (dst_index < 0) {
+        if (!network_list_append(dst)) {
+            return -1;
+        }
+        dst_index = dst->count - 1;
+    }
+
+    scan_record_t record;
+    network_list_get_record(src, src_index, &record);
+    network_list_set_record(dst, dst_index, &record);
+    dst->networks[dst_index] = src->networks[src_index];
+    return dst_index;
+}
+
+void network_list_clear(network_list_t *list) {
+    if (!list) {
+        return;
+    }
+
+    arena_reset(list->arena);
+    struct arena *arena = list->arena;
+    memset(list, 0, sizeof(*list));
+    list->arena = arena;
+}
+
+void network_list_free(network_list_t *list) {
+    if (!list) {
+        return;
+    }
+
+    arena_destroy(list->arena);
+    memset(list, 0, sizeof(*list));
+}
+
+uint16_t network_frequency_to_channel(uint32_t frequency) {
+    if (frequency == 2484) {
+        return 14;
+    }
+    if (frequency >= 2412 && frequency < 2484) {
+        return (uint16_t)((frequency - 2407) / 5);
+    }
+    if (frequency >= 5955 && frequency <= 7115) {
+        return (uint16_t)((frequency - 5950) / 5); // 6 GHz
+    }
+    if (frequency >= 5000 && frequency <= 5925) {
+        return (uint16_t)((frequency - 5000) / 5);
+    }
+    if (frequency >= 4910 && frequency <= 4980) {
+        return (uint16_t)((frequency - 4000) / 5);
+    }
+    return 0;
+}
+
+uint8_t network_security_flags(const char *security) {
+    if (!security) {
+        return 0;
+    }
+
+    uint8_t flags = 0;
+    if (strstr(security, "WEP")) {
+        flags |= NETWORK_SECURITY_WEP;
+    }
+    if (strstr(security, "WPA1")) {
+        flags |= NETWORK_SECURITY_WPA1;
+    }
+    if (strstr(security, "WPA2")) {
+        flags |= NETWORK_SECURITY_WPA2;
+    }
+    if (strstr(security, "WPA3")) {
+        flags |= NETWORK_SECURITY_WPA3;
+    }
+    if (strstr(security, "OWE")) {
+        flags |= NETWORK_SECURITY_OWE;
+    }
+    if (strstr(security, "802.1X")) {
+        flags |= NETWORK_SECURITY_8021X;
+    }
+    return flags;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool network_parse_bssid(const char *text, uint8_t bssid[6]) {
+    memset(bssid, 0, 6);
+    if (!text) {
+        return false;
+    }
+
+    uint8_t parsed[6];
+    for (int i = 0; i < 6; i++) {
+        // Each character is read only after the one before it was not NUL
+        const char *octet = text + i * 3;
+        int high = hex_value(octet[0]);
+        int low = high >= 0 ? hex_value(octet[1]) : -1;
+        if (low < 0 || octet[2] != (i < 5 ? ':' : '\0')) {
+            return false;
+        }
+        parsed[i] = (uint8_t)(high << 4 | low);
+    }
+
+    memcpy(bssid, parsed, sizeof(parsed));
+    return true;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file network_list.h
+ * @brief Growable, column-wise scan result container backed by an arena
+ *
+ * A scan's entries are stored in one arena: the whole list is a single
+ * allocation for typical scans (a few hundred BSSIDs) and is released with
+ * one free. Clearing the list keeps that allocation for the next rescan.
+ *
+ * Each field lives in its own column (see network_list_t), so passes over
+ * one attribute, such as sorting by quality, read only that column.
+ */
+
+#ifndef WTERM_NETWORK_LIST_H
+#define WTERM_NETWORK_LIST_H
+
+#include "../../include/wterm/common.h"
+
+// Arena block size; fits ~1000 entries (all columns) in the first block
+#define NETWORK_LIST_ARENA_SIZE (128 * 1024)
+#define NETWORK_LIST_INITIAL_CAPACITY 64
+
+/**
+ * @brief Initialize an empty list (equivalent to zero-initialization)
+ */
+void network_list_init(network_list_t *list);
+
+/**
+ * @brief Append an entry with zeroed strings and columns
+ * @return The new entry's string view, or NULL on allocation failure
+ */
+network_info_t *network_list_append(network_list_t *list);
+
+/**
+ * @brief Store a scan record in the numeric columns of an entry
+ */
+void network_list_set_record(network_list_t *list, int index, const scan_record_t *record);
+
+/**
+ * @brief Read the numeric columns of an entry into a scan record
+ */
+void network_list_get_record(const network_list_t *list, int index, scan_record_t *record);
+
+/**
+ * @brief Copy an entry (string view and columns) between lists
+ *
+ * @param dst Destination list
+ * @param dst_index Entry to overwrite, or -1 to append
+ * @param src Source list
+ * @param src_index Entry to copy
+ * @return Index of the written entry, or -1 on failure
+ */
+int network_list_copy_entry(network_list_t *dst, int dst_index,
+                            const network_list_t *src, int src_index);
+
+/**
+ * @brief Remove all entries, keeping the backing memory for reuse
+ */
+void network_list_clear(network_list_t *list);
+
+/**
+ * @brief Release the list's memory and reset it to empty
+ */
+void network_list_free(network_list_t *list);
+
+/**
+ * @brief Map a center frequency to its 802.11 channel number
+ * @param frequency Frequency in MHz
+ * @return Channel number, or 0 if the frequency is not a WiFi channel
+ */
+uint16_t network_frequency_to_channel(uint32_t frequency);
+
+/**
+ * @brief Derive NETWORK_SECURITY_* flags from an nmcli-style security string
+ * @param security e.g. "WPA1 WPA2 802.1X", "WEP" or "Open"
+ * @return Security flags
+ */
+uint8_t network_security_flags(const char *security);
+
+/**
+ * @brief Parse a BSSID in "aa:bb:cc:dd:ee:ff" form
+ * @param text BSSID text (case-insensitive)
+ * @param bssid Output bytes, zeroed if text is not a valid BSSID
+ * @return true if text was a valid BSSID
+ */
+bool network_parse_bssid(const char *text, uint8_t bssid[6]);
+
+#endif // WTERM_NETWORK_LIST_H
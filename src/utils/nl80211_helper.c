@@ -0,0 +1,812 @@
+/**
+ * @file nl80211_helper.c
+ * @brief Minimal generic netlink client for nl80211
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "nl80211_helper.h"
+#include "string_utils.h"
+#include <errno.h>
+#include <linux/genetlink.h>
+#include <linux/netlink.h>
+#include <linux/nl80211.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NL_RECV_BUFFER_SIZE 32768
+#define NL_REQUEST_SIZE 512
+#define NL_REPLY_TIMEOUT_MS 5000
+
+// Attribute access helpers (the uapi headers only provide the raw layout)
+#define NLA_DATA(nla) ((void *)((char *)(nla) + NLA_HDRLEN))
+#define NLA_PAYLOAD(nla) ((int)(nla)->nla_len - NLA_HDRLEN)
+#define NLA_TYPE(nla) ((nla)->nla_type & NLA_TYPE_MASK)
+
+// Request buffer, aligned for struct nlmsghdr
+typedef union {
+    struct nlmsghdr hdr;
+    char buf[NL_REQUEST_SIZE];
+} nl_request_t;
+
+// Per-message handler for nl_transact()
+typedef void (*nl_msg_handler)(struct nlmsghdr *nlh, void *user_data);
+
+// Resolved family information (looked up once per process)
+static int nl80211_family_id = -1;
+static int nl80211_scan_group = -1;
+
+// ============================================================================
+// Netlink plumbing
+// ============================================================================
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int nl_open(void) {
+    int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static bool nla_ok(const struct nlattr *nla, int remaining) {
+    return remaining >= (int)sizeof(*nla) &&
+           nla->nla_len >= sizeof(*nla) &&
+           (int)nla->nla_len <= remaining;
+}
+
+static struct nlattr *nla_next(const struct nlattr *nla, int *remaining) {
+    int len = NLA_ALIGN(nla->nla_len);
+    *remaining -= len;
+    return (struct nlattr *)((char *)nla + len);
+}
+
+static void nla_parse(struct nlattr **table, int max_type, void *data, int len) {
+    memset(table, 0, sizeof(struct nlattr *) * (max_type + 1));
+
+    struct nlattr *nla = data;
+    int remaining = len;
+    while (nla_ok(nla, remaining)) {
+        int type = NLA_TYPE(nla);
+        if (type <= max_type) {
+            table[type] = nla;
+        }
+        nla = nla_next(nla, &remaining);
+    }
+}
+
+static uint32_t nla_get_u32(const struct nlattr *nla) {
+    uint32_t value = 0;
+    if (NLA_PAYLOAD(nla) >= (int)sizeof(value)) {
+        memcpy(&value, NLA_DATA(nla), sizeof(value));
+    }
+    return value;
+}
+
+static uint16_t nla_get_u16(const struct nlattr *nla) {
+    uint16_t value = 0;
+    if (NLA_PAYLOAD(nla) >= (int)sizeof(value)) {
+        memcpy(&value, NLA_DATA(nla), sizeof(value));
+    }
+    return value;
+}
+
+static void nl_request_init(nl_request_t *req, uint16_t family, uint8_t cmd,
+                            uint16_t flags) {
+    memset(req, 0, sizeof(*req));
+    req->hdr.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN);
+    req->hdr.nlmsg_type = family;
+    req->hdr.nlmsg_flags = NLM_F_REQUEST | flags;
+
+    struct genlmsghdr *genl = NLMSG_DATA(&req->hdr);
+    genl->cmd = cmd;
+    genl->version = 1;
+}
+
+static bool nl_request_put(nl_request_t *req, uint16_t type, const void *data,
+                           size_t len) {
+    size_t offset = NLMSG_ALIGN(req->hdr.nlmsg_len);
+    size_t attr_len = NLA_HDRLEN + len;
+    if (offset + NLA_ALIGN(attr_len) > sizeof(req->buf)) {
+        return false;
+    }
+
+    struct nlattr *nla = (struct nlattr *)(req->buf + offset);
+    nla->nla_type = type;
+    nla->nla_len = (uint16_t)attr_len;
+    if (len > 0) {
+        memcpy(NLA_DATA(nla), data, len);
+    }
+    req->hdr.nlmsg_len = (uint32_t)(offset + NLA_ALIGN(attr_len));
+    return true;
+}
+
+static bool nl_request_put_u32(nl_request_t *req, uint16_t type, uint32_t value) {
+    return nl_request_put(req, type, &value, sizeof(value));
+}
+
+static struct nlattr *nl_request_nest_start(nl_request_t *req, uint16_t type) {
+    size_t offset = NLMSG_ALIGN(req->hdr.nlmsg_len);
+    if (!nl_request_put(req, type | NLA_F_NESTED, NULL, 0)) {
+        return NULL;
+    }
+    return (struct nlattr *)(req->buf + offset);
+}
+
+static void nl_request_nest_end(nl_request_t *req, struct nlattr *nest) {
+    nest->nla_len = (uint16_t)((req->buf + req->hdr.nlmsg_len) - (char *)nest);
+}
+
+static bool nl_send(int fd, nl_request_t *req, uint32_t seq) {
+    req->hdr.nlmsg_seq = seq;
+    ssize_t sent = send(fd, req, req->hdr.nlmsg_len, 0);
+    return sent == (ssize_t)req->hdr.nlmsg_len;
+}
+
+/**
+ * @brief Send a request and feed every reply message to handler
+ *
+ * Returns 0 on success or a negative errno from the kernel's error/ack.
+ */
+static int nl_transact(int fd, nl_request_t *req, nl_msg_handler handler,
+                       void *user_data) {
+    static uint32_t seq_counter = 0;
+    uint32_t seq = __atomic_add_fetch(&seq_counter, 1, __ATOMIC_RELAXED);
+    bool is_dump = (req->hdr.nlmsg_flags & NLM_F_DUMP) == NLM_F_DUMP;
+
+    if (!is_dump) {
+        req->hdr.nlmsg_flags |= NLM_F_ACK;
+    }
+    if (!nl_send(fd, req, seq)) {
+        return -errno;
+    }
+
+    static __thread char buffer[NL_RECV_BUFFER_SIZE]
+        __attribute__((aligned(NLMSG_ALIGNTO)));
+
+    while (true) {
+        struct pollfd pfd = {.fd = fd, .events = POLLIN};
+        int ready = poll(&pfd, 1, NL_REPLY_TIMEOUT_MS);
+        if (ready <= 0) {
+            return ready == 0 ? -ETIMEDOUT : -errno;
+        }
+
+        ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+
+        struct nlmsghdr *nlh = (struct nlmsghdr *)buffer;
+        for (; NLMSG_OK(nlh, (uint32_t)len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_seq != seq) {
+                continue; // Stale reply or multicast event
+            }
+
+            // A dump ends with NLMSG_DONE; any other request with its ACK,
+            // which is an NLMSG_ERROR carrying 0
+            if (nlh->nlmsg_type == NLMSG_DONE) {
+                return 0;
+            }
+
+            if (nlh->nlmsg_type == NLMSG_ERROR) {
+                const struct nlmsgerr *err = NLMSG_DATA(nlh);
+                return err->error; // 0 is the ACK
+            }
+
+            if (handler) {
+                handler(nlh, user_data);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Family resolution
+// ============================================================================
+
+static void handle_family_reply(struct nlmsghdr *nlh, void *user_data) {
+    (void)user_data;
+
+    struct genlmsghdr *genl = NLMSG_DATA(nlh);
+    struct nlattr *tb[CTRL_ATTR_MAX + 1];
+    nla_parse(tb, CTRL_ATTR_MAX, (char *)genl + GENL_HDRLEN,
+              (int)nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN));
+
+    if (!tb[CTRL_ATTR_FAMILY_ID]) {
+        return;
+    }
+
+    int scan_group = -1;
+    if (tb[CTRL_ATTR_MCAST_GROUPS]) {
+        struct nlattr *group = NLA_DATA(tb[CTRL_ATTR_MCAST_GROUPS]);
+        int remaining = NLA_PAYLOAD(tb[CTRL_ATTR_MCAST_GROUPS]);
+        while (nla_ok(group, remaining)) {
+            struct nlattr *gb[CTRL_ATTR_MCAST_GRP_MAX + 1];
+            nla_parse(gb, CTRL_ATTR_MCAST_GRP_MAX, NLA_DATA(group),
+                      NLA_PAYLOAD(group));
+            if (gb[CTRL_ATTR_MCAST_GRP_NAME] && gb[CTRL_ATTR_MCAST_GRP_ID] &&
+                strncmp(NLA_DATA(gb[CTRL_ATTR_MCAST_GRP_NAME]),
+                        NL80211_MULTICAST_GROUP_SCAN,
+                        NLA_PAYLOAD(gb[CTRL_ATTR_MCAST_GRP_NAME])) == 0) {
+                scan_group = (int)nla_get_u32(gb[CTRL_ATTR_MCAST_GRP_ID]);
+            }
+            group = nla_next(group, &remaining);
+        }
+    }
+
+    __atomic_store_n(&nl80211_scan_group, scan_group, __ATOMIC_RELEASE);
+    __atomic_store_n(&nl80211_family_id,
+                     (int)nla_get_u16(tb[CTRL_ATTR_FAMILY_ID]),
+                     __ATOMIC_RELEASE);
+}
+
+static int resolve_family(int fd) {
+    int family = __atomic_load_n(&nl80211_family_id, __ATOMIC_ACQUIRE);
+    if (family > 0) {
+        return family;
+    }
+
+    nl_request_t req;
+    nl_request_init(&req, GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 0);
+    if (!nl_request_put(&req, CTRL_ATTR_FAMILY_NAME, NL80211_GENL_NAME,
+                        strlen(NL80211_GENL_NAME) + 1)) {
+        return -1;
+    }
+
+    if (nl_transact(fd, &req, handle_family_reply, NULL) != 0) {
+        return -1;
+    }
+
+    family = __atomic_load_n(&nl80211_family_id, __ATOMIC_ACQUIRE);
+    return family > 0 ? family : -1;
+}
+
+bool nl80211_is_available(void) {
+    int fd = nl_open();
+    if (fd < 0) {
+        return false;
+    }
+
+    bool available = resolve_family(fd) > 0;
+    close(fd);
+    return available;
+}
+
+// ============================================================================
+// Interfaces
+// ============================================================================
+
+typedef struct {
+    nl80211_iface_t *ifaces;
+    int max_ifaces;
+    int count;
+} iface_dump_ctx_t;
+
+static void handle_interface(struct nlmsghdr *nlh, void *user_data) {
+    iface_dump_ctx_t *ctx = user_data;
+    if (ctx->count >= ctx->max_ifaces) {
+        return;
+    }
+
+    struct genlmsghdr *genl = NLMSG_DATA(nlh);
+    struct nlattr *tb[NL80211_ATTR_MAX + 1];
+    nla_parse(tb, NL80211_ATTR_MAX, (char *)genl + GENL_HDRLEN,
+              (int)nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN));
+
+    if (!tb[NL80211_ATTR_IFINDEX] || !tb[NL80211_ATTR_IFNAME]) {
+        return; // P2P device or similar without a netdev
+    }
+
+    nl80211_iface_t *iface = &ctx->ifaces[ctx->count];
+    memset(iface, 0, sizeof(*iface));
+
+    iface->ifindex = (int)nla_get_u32(tb[NL80211_ATTR_IFINDEX]);
+    safe_string_copy(iface->name, NLA_DATA(tb[NL80211_ATTR_IFNAME]),
+                     sizeof(iface->name));
+    iface->wiphy = tb[NL80211_ATTR_WIPHY] ? (int)nla_get_u32(tb[NL80211_ATTR_WIPHY]) : -1;
+    iface->iftype = tb[NL80211_ATTR_IFTYPE] ? (int)nla_get_u32(tb[NL80211_ATTR_IFTYPE])
+                                            : NL80211_IFTYPE_UNSPECIFIED;
+
+    if (tb[NL80211_ATTR_SSID]) {
+        int ssid_len = NLA_PAYLOAD(tb[NL80211_ATTR_SSID]);
+        if (ssid_len >= MAX_STR_SSID) {
+            ssid_len = MAX_STR_SSID - 1;
+        }
+        memcpy(iface->ssid, NLA_DATA(tb[NL80211_ATTR_SSID]), (size_t)ssid_len);
+        iface->ssid[ssid_len] = '\0';
+    }
+
+    ctx->count++;
+}
+
+wterm_result_t nl80211_get_interfaces(nl80211_iface_t *ifaces, int max_ifaces,
+                                      int *count) {
+    if (!ifaces || !count || max_ifaces <= 0) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    *count = 0;
+
+    int fd = nl_open();
+    if (fd < 0) {
+        return WTERM_ERROR_NETWORK;
+    }
+
+    int family = resolve_family(fd);
+    if (family < 0) {
+        close(fd);
+        return WTERM_ERROR_NETWORK;
+    }
+
+    nl_request_t req;
+    nl_request_init(&req, (uint16_t)family, NL80211_CMD_GET_INTERFACE, NLM_F_DUMP);
+
+    iface_dump_ctx_t ctx = {.ifaces = ifaces, .max_ifaces = max_ifaces, .count = 0};
+    int err = nl_transact(fd, &req, handle_interface, &ctx);
+    close(fd);
+
+    if (err != 0) {
+        return WTERM_ERROR_NETWORK;
+    }
+
+    *count = ctx.count;
+    return WTERM_SUCCESS;
+}
+
+// ============================================================================
+// Information elements
+// ============================================================================
+
+static void parse_akm_suites(const uint8_t *data, size_t len,
+                             const uint8_t oui[3], nl80211_bss_t *bss) {
+    // version(2) group cipher(4) pairwise count(2) pairwise(4*n) akm count(2) akm(4*n)
+    size_t pos = 2 + 4;
+    if (len < pos + 2) {
+        return;
+    }
+
+    size_t pairwise_count = (size_t)data[pos] | ((size_t)data[pos + 1] << 8);
+    pos += 2 + pairwise_count * 4;
+    if (len < pos + 2) {
+        return;
+    }
+
+    size_t akm_count = (size_t)data[pos] | ((size_t)data[pos + 1] << 8);
+    pos += 2;
+
+    for (size_t i = 0; i < akm_count && pos + 4 <= len; i++, pos += 4) {
+        if (memcmp(data + pos, oui, 3) != 0) {
+            continue;
+        }
+
+        switch (data[pos + 3]) {
+        case 1:  // 802.1X
+        case 3:  // FT over 802.1X
+        case 5:  // 802.1X SHA-256
+        case 11: // Suite B
+        case 12: // Suite B 192
+        case 13: // FT 802.1X SHA-384
+            bss->akm_eap = true;
+            break;
+        case 2: // PSK
+        case 4: // FT PSK
+        case 6: // PSK SHA-256
+            bss->akm_psk = true;
+            break;
+        case 8:  // SAE
+        case 9:  // FT SAE
+        case 24: // SAE (extended key)
+        case 25: // FT SAE (extended key)
+            bss->akm_sae = true;
+            break;
+        case 18: // OWE
+            bss->akm_owe = true;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Legacy rates are in 500 kbit/s units; bit 7 marks a basic rate
+static uint16_t legacy_max_rate(const uint8_t *data, size_t len) {
+    uint16_t max_rate = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint16_t rate = (uint16_t)((data[i] & 0x7F) / 2);
+        if ((data[i] & 0x7F) != 127 && rate > max_rate) { // 127: BSS membership selector
+            max_rate = rate;
+        }
+    }
+    return max_rate;
+}
+
+// Spatial streams enabled in the HT RX MCS bitmask (one byte per stream)
+static uint16_t ht_max_rate(const uint8_t *data, size_t len) {
+    if (len < 7) {
+        return 0;
+    }
+
+    int streams = 0;
+    for (int i = 0; i < 4; i++) {
+        if (data[3 + i] != 0) {
+            streams = i + 1;
+        }
+    }
+
+    // Per-stream MCS 7 rate: 65 (20 MHz) or 135 (40 MHz), more with short GI
+    uint16_t cap_info = (uint16_t)(data[0] | (data[1] << 8));
+    bool wide = (cap_info & 0x0002) != 0;
+    bool short_gi = (cap_info & (wide ? 0x0040 : 0x0020)) != 0;
+    int per_stream = wide ? (short_gi ? 150 : 135) : (short_gi ? 72 : 65);
+    return (uint16_t)(streams * per_stream);
+}
+
+// Spatial streams from the VHT RX MCS map (2 bits per stream, 3 = none)
+static uint16_t vht_max_rate(const uint8_t *data, size_t len) {
+    if (len < 12) {
+        return 0;
+    }
+
+    uint16_t mcs_map = (uint16_t)(data[4] | (data[5] << 8));
+    int streams = 0;
+    for (int i = 0; i < 8; i++) {
+        if (((mcs_map >> (i * 2)) & 0x3) != 0x3) {
+            streams = i + 1;
+        }
+    }
+
+    // Per-stream MCS 9 rate with short GI: 433 (80 MHz) or 867 (160 MHz)
+    uint32_t cap_info = (uint32_t)data[0] | ((uint32_t)data[1] << 8);
+    bool wide = ((cap_info >> 2) & 0x3) != 0;
+    return (uint16_t)(streams * (wide ? 867 : 433));
+}
+
+void nl80211_parse_ies(const uint8_t *ies, size_t len, nl80211_bss_t *bss) {
+    static const uint8_t rsn_oui[3] = {0x00, 0x0F, 0xAC};
+    static const uint8_t wpa_oui[3] = {0x00, 0x50, 0xF2};
+
+    if (!ies || !bss) {
+        return;
+    }
+
+    size_t pos = 0;
+    while (pos + 2 <= len) {
+        uint8_t id = ies[pos];
+        size_t elen = ies[pos + 1];
+        const uint8_t *data = ies + pos + 2;
+
+        if (pos + 2 + elen > len) {
+            break; // Truncated element
+        }
+
+        if (id == 0) {
+            // SSID; an all-zero SSID is a hidden network
+            size_t ssid_len = elen < MAX_STR_SSID ? elen : MAX_STR_SSID - 1;
+            bool hidden = true;
+            for (size_t i = 0; i < ssid_len; i++) {
+                if (data[i] != 0) {
+                    hidden = false;
+                    break;
+                }
+            }
+            if (hidden) {
+                ssid_len = 0;
+            }
+            memcpy(bss->ssid, data, ssid_len);
+            bss->ssid[ssid_len] = '\0';
+        } else if (id == 1 || id == 50) {
+            uint16_t rate = legacy_max_rate(data, elen);
+            if (rate > bss->max_rate) {
+                bss->max_rate = rate;
+            }
+        } else if (id == 45 || id == 191) {
+            uint16_t rate = id == 45 ? ht_max_rate(data, elen) : vht_max_rate(data, elen);
+            if (rate > bss->max_rate) {
+                bss->max_rate = rate;
+            }
+        } else if (id == 48) {
+            bss->rsn = true;
+            parse_akm_suites(data, elen, rsn_oui, bss);
+        } else if (id == 221 && elen >= 4 && memcmp(data, wpa_oui, 3) == 0 &&
+                   data[3] == 1) {
+            bss->wpa = true;
+            parse_akm_suites(data + 4, elen - 4, wpa_oui, bss);
+        }
+
+        pos += 2 + elen;
+    }
+}
+
+void nl80211_bss_security_string(const nl80211_bss_t *bss, char *buffer,
+                                 size_t size) {
+    if (!buffer || size == 0) {
+        return;
+    }
+
+    buffer[0] = '\0';
+    if (!bss) {
+        return;
+    }
+
+    if (!bss->wpa && !bss->rsn) {
+        safe_string_copy(buffer, bss->privacy ? "WEP" : "Open", size);
+        return;
+    }
+
+    char parts[64] = {0};
+    size_t used = 0;
+
+    if (bss->wpa) {
+        used += (size_t)snprintf(parts + used, sizeof(parts) - used, "WPA1 ");
+    }
+    if (bss->rsn && (bss->akm_psk || bss->akm_eap || (!bss->akm_sae && !bss->akm_owe))) {
+        used += (size_t)snprintf(parts + used, sizeof(parts) - used, "WPA2 ");
+    }
+    if (bss->akm_sae) {
+        used += (size_t)snprintf(parts + used, sizeof(parts) - used, "WPA3 ");
+    }
+    if (bss->akm_owe) {
+        used += (size_t)snprintf(parts + used, sizeof(parts) - used, "OWE ");
+    }
+    if (bss->akm_eap) {
+        snprintf(parts + used, sizeof(parts) - used, "802.1X ");
+    }
+
+    trim_trailing_whitespace(parts);
+    safe_string_copy(buffer, parts, size);
+}
+
+int nl80211_dbm_to_quality(int dbm) {
+    if (dbm > -40) {
+        dbm = -40;
+    }
+    if (dbm < -100) {
+        dbm = -100;
+    }
+
+    int distance = -(dbm + 40); // 0 (best) .. 60 (worst)
+    return 100 - (distance * 100) / 60;
+}
+
+// ============================================================================
+// Scanning
+// ============================================================================
+
+typedef struct {
+    nl80211_bss_cb callback;
+    void *user_data;
+    bool stopped;
+} scan_dump_ctx_t;
+
+static void handle_scan_result(struct nlmsghdr *nlh, void *user_data) {
+    scan_dump_ctx_t *ctx = user_data;
+    if (ctx->stopped) {
+        return; // Keep draining the dump but ignore the rest
+    }
+
+    struct genlmsghdr *genl = NLMSG_DATA(nlh);
+    struct nlattr *tb[NL80211_ATTR_MAX + 1];
+    nla_parse(tb, NL80211_ATTR_MAX, (char *)genl + GENL_HDRLEN,
+              (int)nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN));
+
+    if (!tb[NL80211_ATTR_BSS]) {
+        return;
+    }
+
+    struct nlattr *bss_tb[NL80211_BSS_MAX + 1];
+    nla_parse(bss_tb, NL80211_BSS_MAX, NLA_DATA(tb[NL80211_ATTR_BSS]),
+              NLA_PAYLOAD(tb[NL80211_ATTR_BSS]));
+
+    nl80211_bss_t bss;
+    memset(&bss, 0, sizeof(bss));
+
+    if (bss_tb[NL80211_BSS_BSSID] &&
+        NLA_PAYLOAD(bss_tb[NL80211_BSS_BSSID]) >= (int)sizeof(bss.bssid)) {
+        memcpy(bss.bssid, NLA_DATA(bss_tb[NL80211_BSS_BSSID]), sizeof(bss.bssid));
+    }
+
+    if (bss_tb[NL80211_BSS_FREQUENCY]) {
+        bss.frequency = nla_get_u32(bss_tb[NL80211_BSS_FREQUENCY]);
+    }
+
+    if (bss_tb[NL80211_BSS_SIGNAL_MBM]) {
+        bss.signal_mbm = (int)(int32_t)nla_get_u32(bss_tb[NL80211_BSS_SIGNAL_MBM]);
+        bss.quality = nl80211_dbm_to_quality(bss.signal_mbm / 100);
+    } else if (bss_tb[NL80211_BSS_SIGNAL_UNSPEC] &&
+               NLA_PAYLOAD(bss_tb[NL80211_BSS_SIGNAL_UNSPEC]) >= 1) {
+        bss.quality = *(uint8_t *)NLA_DATA(bss_tb[NL80211_BSS_SIGNAL_UNSPEC]);
+    }
+
+    if (bss_tb[NL80211_BSS_CAPABILITY]) {
+        bss.privacy = (nla_get_u16(bss_tb[NL80211_BSS_CAPABILITY]) & 0x0010) != 0;
+    }
+
+    struct nlattr *ies = bss_tb[NL80211_BSS_INFORMATION_ELEMENTS];
+    if (!ies) {
+        ies = bss_tb[NL80211_BSS_BEACON_IES];
+    }
+    if (ies) {
+        nl80211_parse_ies(NLA_DATA(ies), (size_t)NLA_PAYLOAD(ies), &bss);
+    }
+
+    if (!ctx->callback(&bss, ctx->user_data)) {
+        ctx->stopped = true;
+    }
+}
+
+wterm_result_t nl80211_dump_scan(int ifindex, nl80211_bss_cb callback,
+                                 void *user_data) {
+    if (ifindex <= 0 || !callback) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    int fd = nl_open();
+    if (fd < 0) {
+        return WTERM_ERROR_NETWORK;
+    }
+
+    int family = resolve_family(fd);
+    if (family < 0) {
+        close(fd);
+        return WTERM_ERROR_NETWORK;
+    }
+
+    nl_request_t req;
+    nl_request_init(&req, (uint16_t)family, NL80211_CMD_GET_SCAN, NLM_F_DUMP);
+    nl_request_put_u32(&req, NL80211_ATTR_IFINDEX, (uint32_t)ifindex);
+
+    scan_dump_ctx_t ctx = {.callback = callback, .user_data = user_data, .stopped = false};
+    int err = nl_transact(fd, &req, handle_scan_result, &ctx);
+    close(fd);
+
+    return err == 0 ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
+}
+
+/**
+ * @brief Check whether a multicast message is a scan completion for ifindex
+ * @return 1 for new results, -1 for aborted, 0 for anything else
+ */
+static int classify_scan_event(struct nlmsghdr *nlh, int family, int ifindex) {
+    if (nlh->nlmsg_type != family) {
+        return 0;
+    }
+
+    struct genlmsghdr *genl = NLMSG_DATA(nlh);
+    if (genl->cmd != NL80211_CMD_NEW_SCAN_RESULTS &&
+        genl->cmd != NL80211_CMD_SCAN_ABORTED) {
+        return 0;
+    }
+
+    struct nlattr *tb[NL80211_ATTR_MAX + 1];
+    nla_parse(tb, NL80211_ATTR_MAX, (char *)genl + GENL_HDRLEN,
+              (int)nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN));
+
+    if (!tb[NL80211_ATTR_IFINDEX] ||
+        (int)nla_get_u32(tb[NL80211_ATTR_IFINDEX]) != ifindex) {
+        return 0;
+    }
+
+    return genl->cmd == NL80211_CMD_NEW_SCAN_RESULTS ? 1 : -1;
+}
+
+wterm_result_t nl80211_trigger_scan(int ifindex, int timeout_ms) {
+    if (ifindex <= 0 || timeout_ms <= 0) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    int fd = nl_open();
+    if (fd < 0) {
+        return WTERM_ERROR_NETWORK;
+    }
+
+    int family = resolve_family(fd);
+    int group = __atomic_load_n(&nl80211_scan_group, __ATOMIC_ACQUIRE);
+    if (family < 0 || group < 0) {
+        close(fd);
+        return WTERM_ERROR_NETWORK;
+    }
+
+    // Subscribe before triggering so the completion event cannot be missed
+    if (setsockopt(fd, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP, &group,
+                   sizeof(group)) < 0) {
+        close(fd);
+        return WTERM_ERROR_NETWORK;
+    }
+
+    nl_request_t req;
+    nl_request_init(&req, (uint16_t)family, NL80211_CMD_TRIGGER_SCAN, NLM_F_ACK);
+    nl_request_put_u32(&req, NL80211_ATTR_IFINDEX, (uint32_t)ifindex);
+
+    // A single zero-length SSID requests an active wildcard scan
+    struct nlattr *ssids = nl_request_nest_start(&req, NL80211_ATTR_SCAN_SSIDS);
+    if (ssids) {
+        nl_request_put(&req, 1, NULL, 0);
+        nl_request_nest_end(&req, ssids);
+    }
+
+    uint32_t seq = (uint32_t)monotonic_ms();
+    if (!nl_send(fd, &req, seq)) {
+        close(fd);
+        return WTERM_ERROR_NETWORK;
+    }
+
+    static __thread char buffer[NL_RECV_BUFFER_SIZE]
+        __attribute__((aligned(NLMSG_ALIGNTO)));
+
+    long long deadline = monotonic_ms() + timeout_ms;
+    wterm_result_t result = WTERM_ERROR_NETWORK;
+    bool finished = false;
+
+    while (!finished) {
+        long long remaining = deadline - monotonic_ms();
+        if (remaining <= 0) {
+            break; // Timed out
+        }
+
+        struct pollfd pfd = {.fd = fd, .events = POLLIN};
+        int ready = poll(&pfd, 1, (int)remaining);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            break;
+        }
+
+        ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        struct nlmsghdr *nlh = (struct nlmsghdr *)buffer;
+        for (; NLMSG_OK(nlh, (uint32_t)len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_type == NLMSG_ERROR && nlh->nlmsg_seq == seq) {
+                const struct nlmsgerr *err = NLMSG_DATA(nlh);
+                if (err->error == -EPERM || err->error == -EACCES) {
+                    result = WTERM_ERROR_PERMISSION;
+                    finished = true;
+                    break;
+                }
+                // 0 = scan started, -EBUSY = a scan is already running and
+                // its results will be announced the same way
+                if (err->error != 0 && err->error != -EBUSY) {
+                    finished = true;
+                    break;
+                }
+                continue;
+            }
+
+            int event = classify_scan_event(nlh, family, ifindex);
+            if (event != 0) {
+                result = (event > 0) ? WTERM_SUCCESS : WTERM_ERROR_NETWORK;
+                finished = true;
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    return result;
+}
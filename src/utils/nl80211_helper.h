@@ -0,0 +1,131 @@
+/**
+ * @file nl80211_helper.h
+ * @brief Minimal generic netlink client for nl80211
+ *
+ * This module talks to the kernel's nl80211 family directly over a
+ * NETLINK_GENERIC socket, so WiFi interfaces and scan results can be
+ * queried in-process without spawning nmcli or iw.
+ */
+
+#ifndef NL80211_HELPER_H
+#define NL80211_HELPER_H
+
+#include "../../include/wterm/common.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NL80211_MAX_INTERFACES 8
+
+/**
+ * @brief WiFi interface as reported by NL80211_CMD_GET_INTERFACE
+ */
+typedef struct {
+    char name[MAX_STR_INTERFACE];
+    int ifindex;
+    int wiphy;
+    int iftype;                 // enum nl80211_iftype
+    char ssid[MAX_STR_SSID];    // SSID when associated (station mode)
+} nl80211_iface_t;
+
+/**
+ * @brief Single BSS entry from a scan dump
+ */
+typedef struct {
+    uint8_t bssid[6];
+    char ssid[MAX_STR_SSID];
+    uint32_t frequency;         // MHz
+    int signal_mbm;             // mBm (dBm * 100), 0 if not reported
+    int quality;                // 0-100 signal quality
+    bool privacy;               // Capability privacy bit (WEP or better)
+    bool wpa;                   // Vendor WPA1 IE present
+    bool rsn;                   // RSN (WPA2/WPA3) IE present
+    bool akm_psk;               // RSN/WPA AKM: PSK
+    bool akm_sae;               // RSN AKM: SAE (WPA3-Personal)
+    bool akm_eap;               // RSN/WPA AKM: 802.1X
+    bool akm_owe;               // RSN AKM: OWE (Enhanced Open)
+    uint16_t max_rate;          // Highest advertised PHY rate, Mbit/s
+} nl80211_bss_t;
+
+/**
+ * @brief Callback invoked for every BSS in a scan dump
+ * @return false to stop iterating
+ */
+typedef bool (*nl80211_bss_cb)(const nl80211_bss_t *bss, void *user_data);
+
+/**
+ * @brief Check if the nl80211 generic netlink family is available
+ * @return true if the kernel exposes nl80211
+ */
+bool nl80211_is_available(void);
+
+/**
+ * @brief List WiFi interfaces known to nl80211
+ * @param ifaces Output array
+ * @param max_ifaces Size of output array
+ * @param count Output number of interfaces found
+ * @return WTERM_SUCCESS on success, error code otherwise
+ */
+wterm_result_t nl80211_get_interfaces(nl80211_iface_t *ifaces, int max_ifaces,
+                                      int *count);
+
+/**
+ * @brief Trigger a scan and wait for it to complete
+ *
+ * Subscribes to the nl80211 "scan" multicast group, sends
+ * NL80211_CMD_TRIGGER_SCAN and waits for NL80211_CMD_NEW_SCAN_RESULTS (or
+ * NL80211_CMD_SCAN_ABORTED) for the interface. If another scan is already
+ * running (e.g. started by NetworkManager) the wait piggybacks on it.
+ *
+ * @param ifindex Interface index to scan on
+ * @param timeout_ms Maximum time to wait for scan completion
+ * @return WTERM_SUCCESS when fresh results are available,
+ *         WTERM_ERROR_PERMISSION without CAP_NET_ADMIN,
+ *         WTERM_ERROR_NETWORK on timeout or abort
+ */
+wterm_result_t nl80211_trigger_scan(int ifindex, int timeout_ms);
+
+/**
+ * @brief Dump cached scan results for an interface
+ * @param ifindex Interface index
+ * @param callback Called once per BSS
+ * @param user_data Passed through to callback
+ * @return WTERM_SUCCESS on success, error code otherwise
+ */
+wterm_result_t nl80211_dump_scan(int ifindex, nl80211_bss_cb callback,
+                                 void *user_data);
+
+/**
+ * @brief Parse 802.11 information elements into a BSS entry
+ *
+ * Extracts the SSID (element 0), RSN (element 48) and the vendor WPA
+ * element (221, OUI 00:50:F2 type 1) including their AKM suites, and the
+ * maximum rate from the supported rates (1, 50), HT (45) and VHT (191)
+ * capability elements.
+ *
+ * @param ies Raw information elements
+ * @param len Length of ies in bytes
+ * @param bss BSS entry to update
+ */
+void nl80211_parse_ies(const uint8_t *ies, size_t len, nl80211_bss_t *bss);
+
+/**
+ * @brief Describe BSS security like nmcli ("WPA2", "WPA1 WPA2", "Open", ...)
+ * @param bss BSS entry
+ * @param buffer Output buffer
+ * @param size Size of output buffer
+ */
+void nl80211_bss_security_string(const nl80211_bss_t *bss, char *buffer,
+                                 size_t size);
+
+/**
+ * @brief Convert a signal level in dBm to a 0-100 quality percentage
+ *
+ * Uses the same mapping as NetworkManager (-100 dBm = 0, -40 dBm = 100).
+ *
+ * @param dbm Signal level in dBm
+ * @return Quality percentage
+ */
+int nl80211_dbm_to_quality(int dbm);
+
+#endif // NL80211_HELPER_H
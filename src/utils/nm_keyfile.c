@@ -0,0 +1,381 @@
+/**
+ * @file nm_keyfile.c
+ * @brief In-process reader for NetworkManager keyfile connection profiles
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "nm_keyfile.h"
+#include "string_utils.h"
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WATCH_EVENTS (IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | \
+                      IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF)
+
+typedef enum {
+    SECTION_OTHER = 0,
+    SECTION_CONNECTION,
+    SECTION_WIFI
+} keyfile_section_t;
+
+// Keyfiles use short setting names; nmcli reports the long ones
+static const struct {
+    const char *alias;
+    const char *name;
+} type_aliases[] = {
+    {"wifi", "802-11-wireless"},
+    {"ethernet", "802-3-ethernet"},
+    {"wired", "802-3-ethernet"},
+};
+
+const char *nm_keyfile_default_dir(void) {
+    const char *dir = getenv(NM_KEYFILE_DIR_ENV);
+    return (dir && dir[0] != '\0') ? dir : NM_KEYFILE_DIR;
+}
+
+static char *trim(char *start, char *end) {
+    while (start < end && isspace((unsigned char)*start)) {
+        start++;
+    }
+    while (end > start && isspace((unsigned char)end[-1])) {
+        end--;
+    }
+    *end = '\0';
+    return start;
+}
+
+// GKeyFile escapes: \s \n \t \r and \\ (in place)
+static void unescape_value(char *value) {
+    char *out = value;
+    for (const char *in = value; *in; in++) {
+        if (*in == '\\' && in[1] != '\0') {
+            in++;
+            switch (*in) {
+            case 's': *out++ = ' '; break;
+            case 'n': *out++ = '\n'; break;
+            case 't': *out++ = '\t'; break;
+            case 'r': *out++ = '\r'; break;
+            default: *out++ = *in; break;
+            }
+        } else {
+            *out++ = *in;
+        }
+    }
+    *out = '\0';
+}
+
+// SSIDs that are not valid UTF-8 are stored as a byte list ("72;105;")
+static void decode_ssid(const char *value, char *ssid, size_t size) {
+    bool is_list = strchr(value, ';') != NULL;
+    for (const char *p = value; *p && is_list; p++) {
+        is_list = isdigit((unsigned char)*p) || *p == ';';
+    }
+    if (!is_list) {
+        safe_string_copy(ssid, value, size);
+        return;
+    }
+
+    size_t len = 0;
+    const char *p = value;
+    while (*p && len + 1 < size) {
+        char *end;
+        long byte = strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        ssid[len++] = (char)byte;
+        p = (*end == ';') ? end + 1 : end;
+    }
+    ssid[len] = '\0';
+}
+
+static void apply_key(nm_keyfile_profile_t *profile, keyfile_section_t section,
+                      const char *key, char *value) {
+    if (section == SECTION_CONNECTION) {
+        if (strcmp(key, "id") == 0) {
+            safe_string_copy(profile->name, value, sizeof(profile->name));
+        } else if (strcmp(key, "uuid") == 0) {
+            safe_string_copy(profile->uuid, value, sizeof(profile->uuid));
+        } else if (strcmp(key, "type") == 0) {
+            const char *type = value;
+            for (size_t i = 0; i < sizeof(type_aliases) / sizeof(type_aliases[0]); i++) {
+                if (strcmp(value, type_aliases[i].alias) == 0) {
+                    type = type_aliases[i].name;
+                    break;
+                }
+            }
+            safe_string_copy(profile->type, type, sizeof(profile->type));
+        } else if (strcmp(key, "autoconnect-priority") == 0) {
+            profile->autoconnect_priority = atoi(value);
+        }
+    } else if (section == SECTION_WIFI) {
+        if (strcmp(key, "ssid") == 0) {
+            decode_ssid(value, profile->ssid, sizeof(profile->ssid));
+        } else if (strcmp(key, "mode") == 0) {
+            safe_string_copy(profile->mode, value, sizeof(profile->mode));
+        }
+    }
+}
+
+wterm_result_t nm_keyfile_parse(const char *text, size_t len,
+                                nm_keyfile_profile_t *profile) {
+    if (!text || !profile) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    memset(profile, 0, sizeof(*profile));
+    keyfile_section_t section = SECTION_OTHER;
+
+    size_t pos = 0;
+    while (pos < len) {
+        const char *newline = memchr(text + pos, '\n', len - pos);
+        size_t line_len = newline ? (size_t)(newline - (text + pos)) : len - pos;
+
+        char line[1024];
+        if (line_len >= sizeof(line)) {
+            line_len = sizeof(line) - 1; // Long values are truncated anyway
+        }
+        memcpy(line, text + pos, line_len);
+        pos += (newline ? (size_t)(newline - (text + pos)) + 1 : len - pos);
+
+        char *content = trim(line, line + line_len);
+        if (content[0] == '\0' || content[0] == '#' || content[0] == ';') {
+            continue;
+        }
+
+        if (content[0] == '[') {
+            char *close = strchr(content, ']');
+            if (close) {
+                *close = '\0';
+                const char *name = content + 1;
+                if (strcmp(name, "connection") == 0) {
+                    section = SECTION_CONNECTION;
+                } else if (strcmp(name, "wifi") == 0 ||
+                           strcmp(name, "802-11-wireless") == 0) {
+                    section = SECTION_WIFI;
+                } else {
+                    section = SECTION_OTHER;
+                }
+            }
+            continue;
+        }
+
+        char *equals = strchr(content, '=');
+        if (!equals || section == SECTION_OTHER) {
+            continue;
+        }
+        char *key = trim(content, equals);
+        char *value = trim(equals + 1, equals + 1 + strlen(equals + 1));
+        unescape_value(value);
+        apply_key(profile, section, key, value);
+    }
+
+    return profile->type[0] != '\0' ? WTERM_SUCCESS : WTERM_ERROR_PARSE;
+}
+
+void nm_keyfile_store_init(nm_keyfile_store_t *store, const char *dir) {
+    if (!store) {
+        return;
+    }
+
+    memset(store, 0, sizeof(*store));
+    safe_string_copy(store->dir, dir ? dir : nm_keyfile_default_dir(), sizeof(store->dir));
+    store->inotify_fd = -1;
+}
+
+static bool has_keyfile_suffix(const char *name) {
+    size_t len = strlen(name);
+    size_t ext_len = strlen(NM_KEYFILE_EXT);
+    return len > ext_len && strcmp(name + len - ext_len, NM_KEYFILE_EXT) == 0;
+}
+
+static nm_keyfile_profile_t *append_profile(nm_keyfile_store_t *store) {
+    if (store->count == store->capacity) {
+        int capacity = store->capacity ? store->capacity * 2 : 32;
+        nm_keyfile_profile_t *profiles =
+            realloc(store->profiles, (size_t)capacity * sizeof(*profiles));
+        if (!profiles) {
+            return NULL;
+        }
+        store->profiles = profiles;
+        store->capacity = capacity;
+    }
+    return &store->profiles[store->count++];
+}
+
+// Read one keyfile relative to the open directory
+static wterm_result_t load_file(nm_keyfile_store_t *store, int dir_fd, const char *name,
+                                char *buffer) {
+    int fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) {
+        // Vanished since readdir, or a symlink NetworkManager would not use
+        return (errno == EACCES || errno == EPERM) ? WTERM_ERROR_PERMISSION
+                                                    : WTERM_SUCCESS;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > NM_KEYFILE_MAX_SIZE) {
+        close(fd);
+        return WTERM_SUCCESS;
+    }
+
+    size_t len = 0;
+    while (len < NM_KEYFILE_MAX_SIZE) {
+        ssize_t n = read(fd, buffer + len, NM_KEYFILE_MAX_SIZE - len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        len += (size_t)n;
+    }
+    close(fd);
+
+    nm_keyfile_profile_t profile;
+    if (nm_keyfile_parse(buffer, len, &profile) != WTERM_SUCCESS) {
+        return WTERM_SUCCESS; // Not a profile; NetworkManager ignores it too
+    }
+    if (profile.name[0] == '\0') {
+        // NetworkManager names unnamed profiles after their file
+        size_t stem = strlen(name) - strlen(NM_KEYFILE_EXT);
+        if (stem >= sizeof(profile.name)) {
+            stem = sizeof(profile.name) - 1;
+        }
+        memcpy(profile.name, name, stem);
+        profile.name[stem] = '\0';
+    }
+
+    nm_keyfile_profile_t *slot = append_profile(store);
+    if (!slot) {
+        return WTERM_ERROR_MEMORY;
+    }
+    *slot = profile;
+    return WTERM_SUCCESS;
+}
+
+static wterm_result_t load_directory(nm_keyfile_store_t *store) {
+    store->count = 0;
+    store->loaded = false;
+
+    DIR *dir = opendir(store->dir);
+    if (!dir) {
+        return (errno == EACCES || errno == EPERM) ? WTERM_ERROR_PERMISSION
+                                                    : WTERM_ERROR_GENERAL;
+    }
+
+    char *buffer = malloc(NM_KEYFILE_MAX_SIZE);
+    if (!buffer) {
+        closedir(dir);
+        return WTERM_ERROR_MEMORY;
+    }
+
+    wterm_result_t result = WTERM_SUCCESS;
+    struct dirent *entry;
+    while (result == WTERM_SUCCESS && (entry = readdir(dir))) {
+        if (entry->d_name[0] != '.' && has_keyfile_suffix(entry->d_name)) {
+            result = load_file(store, dirfd(dir), entry->d_name, buffer);
+        }
+    }
+
+    free(buffer);
+    closedir(dir);
+
+    if (result != WTERM_SUCCESS) {
+        store->count = 0;
+        return result;
+    }
+    store->loaded = true;
+    return WTERM_SUCCESS;
+}
+
+static void start_watch(nm_keyfile_store_t *store) {
+    store->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (store->inotify_fd >= 0 &&
+        inotify_add_watch(store->inotify_fd, store->dir, WATCH_EVENTS) < 0) {
+        close(store->inotify_fd);
+        store->inotify_fd = -1;
+    }
+}
+
+// Consume pending events; true if the directory may have changed
+static bool drain_events(nm_keyfile_store_t *store) {
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+
+    for (;;) {
+        ssize_t n = read(store->inotify_fd, events, sizeof(events));
+        if (n <= 0) {
+            break;
+        }
+        changed = true;
+
+        for (char *p = events; p < events + n;) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            if (event->mask & IN_IGNORED) {
+                // Directory removed or moved: the watch is gone
+                close(store->inotify_fd);
+                store->inotify_fd = -1;
+                return true;
+            }
+            p += sizeof(*event) + event->len;
+        }
+    }
+    return changed;
+}
+
+wterm_result_t nm_keyfile_store_refresh(nm_keyfile_store_t *store) {
+    if (!store) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    if (store->inotify_fd < 0) {
+        // Watch first, so changes made while reading are not missed
+        start_watch(store);
+    } else if (store->loaded && !drain_events(store)) {
+        return WTERM_SUCCESS;
+    }
+
+    return load_directory(store);
+}
+
+const nm_keyfile_profile_t *nm_keyfile_store_find(const nm_keyfile_store_t *store,
+                                                  const char *name) {
+    if (!store || !name || !store->loaded) {
+        return NULL;
+    }
+
+    for (int i = 0; i < store->count; i++) {
+        if (strcmp(store->profiles[i].name, name) == 0) {
+            return &store->profiles[i];
+        }
+    }
+    return NULL;
+}
+
+bool nm_keyfile_profile_is_ap(const nm_keyfile_profile_t *profile) {
+    return profile && strcmp(profile->type, "802-11-wireless") == 0 &&
+           strcmp(profile->mode, "ap") == 0;
+}
+
+void nm_keyfile_store_free(nm_keyfile_store_t *store) {
+    if (!store) {
+        return;
+    }
+
+    if (store->inotify_fd >= 0) {
+        close(store->inotify_fd);
+    }
+    free(store->profiles);
+
+    char dir[sizeof(store->dir)];
+    memcpy(dir, store->dir, sizeof(dir));
+    nm_keyfile_store_init(store, dir);
+}
@@ -0,0 +1,112 @@
+/**
+ * @file nm_keyfile.h
+ * @brief In-process reader for NetworkManager keyfile connection profiles
+ *
+ * NetworkManager stores profiles as INI-style *.nmconnection files. Reading
+ * them directly turns "which saved connections are hotspots?" into one
+ * directory pass instead of one nmcli process per connection. An inotify
+ * watch on the directory tells the store when to re-read it.
+ *
+ * The files are normally readable by root only; without permission the
+ * store reports WTERM_ERROR_PERMISSION and callers fall back to nmcli.
+ */
+
+#ifndef WTERM_NM_KEYFILE_H
+#define WTERM_NM_KEYFILE_H
+
+#include "../../include/wterm/common.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define NM_KEYFILE_DIR "/etc/NetworkManager/system-connections"
+#define NM_KEYFILE_EXT ".nmconnection"
+
+// Overrides NM_KEYFILE_DIR for nm_keyfile_default_dir()
+#define NM_KEYFILE_DIR_ENV "WTERM_NM_KEYFILE_DIR"
+
+// Larger files are not NetworkManager profiles and are skipped
+#define NM_KEYFILE_MAX_SIZE (64 * 1024)
+
+#define NM_KEYFILE_NAME_MAX 128
+#define NM_KEYFILE_UUID_MAX 40
+#define NM_KEYFILE_TYPE_MAX 32
+#define NM_KEYFILE_MODE_MAX 16
+
+/**
+ * @brief Fields of one profile that wterm uses
+ */
+typedef struct {
+    char name[NM_KEYFILE_NAME_MAX];     // connection.id
+    char uuid[NM_KEYFILE_UUID_MAX];
+    char type[NM_KEYFILE_TYPE_MAX];     // Long form, e.g. "802-11-wireless"
+    char ssid[MAX_STR_SSID];            // wifi.ssid, empty if not WiFi
+    char mode[NM_KEYFILE_MODE_MAX];     // wifi.mode ("ap" for hotspots)
+    int autoconnect_priority;
+} nm_keyfile_profile_t;
+
+/**
+ * @brief Profiles of one keyfile directory
+ *
+ * Initialize with nm_keyfile_store_init().
+ */
+typedef struct {
+    nm_keyfile_profile_t *profiles;
+    int count;
+    int capacity;
+    char dir[512];
+    int inotify_fd;     // -1 if the directory is not watched
+    bool loaded;
+} nm_keyfile_store_t;
+
+/**
+ * @brief Keyfile directory to read: $WTERM_NM_KEYFILE_DIR or NM_KEYFILE_DIR
+ */
+const char *nm_keyfile_default_dir(void);
+
+/**
+ * @brief Parse the contents of one keyfile
+ *
+ * @param text File contents (need not be NUL-terminated)
+ * @param len Length of text
+ * @param profile Receives the profile; connection.id defaults to empty
+ * @return WTERM_SUCCESS, or WTERM_ERROR_PARSE if there is no [connection]
+ *         section with a type
+ */
+wterm_result_t nm_keyfile_parse(const char *text, size_t len,
+                                nm_keyfile_profile_t *profile);
+
+/**
+ * @brief Prepare a store for a directory (nothing is read yet)
+ */
+void nm_keyfile_store_init(nm_keyfile_store_t *store, const char *dir);
+
+/**
+ * @brief Make sure the store reflects the directory
+ *
+ * The first call reads every keyfile and starts watching the directory;
+ * later calls re-read it only if the watch reported a change (or always,
+ * if the watch could not be set up).
+ *
+ * @return WTERM_SUCCESS, WTERM_ERROR_PERMISSION if the directory or a
+ *         keyfile is not readable, WTERM_ERROR_GENERAL if the directory
+ *         does not exist, or WTERM_ERROR_MEMORY
+ */
+wterm_result_t nm_keyfile_store_refresh(nm_keyfile_store_t *store);
+
+/**
+ * @brief Find a profile by connection name
+ */
+const nm_keyfile_profile_t *nm_keyfile_store_find(const nm_keyfile_store_t *store,
+                                                  const char *name);
+
+/**
+ * @brief Whether a profile is a WiFi access point (hotspot)
+ */
+bool nm_keyfile_profile_is_ap(const nm_keyfile_profile_t *profile);
+
+/**
+ * @brief Stop watching and release the store's memory
+ */
+void nm_keyfile_store_free(nm_keyfile_store_t *store);
+
+#endif // WTERM_NM_KEYFILE_H
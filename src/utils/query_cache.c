@@ -0,0 +1,202 @@
+/**
+ * @file query_cache.c
+ * @brief Short-lived cache of read-only command output
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "query_cache.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    char *key;          // program and arguments, each NUL-terminated
+    size_t key_len;
+    long long expires_at;
+    long long stored_at;
+    safe_exec_output_t output;
+} query_entry_t;
+
+static query_entry_t entries[QUERY_CACHE_MAX_ENTRIES];
+static unsigned long generation = 0;
+static query_cache_stats_t stats = {0};
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static char *build_key(const char *program, char *const args[], size_t *key_len) {
+    size_t len = strlen(program) + 1;
+    for (int i = 0; args[i]; i++) {
+        len += strlen(args[i]) + 1;
+    }
+
+    char *key = malloc(len);
+    if (!key) {
+        return NULL;
+    }
+
+    size_t offset = strlen(program) + 1;
+    memcpy(key, program, offset);
+    for (int i = 0; args[i]; i++) {
+        size_t arg_len = strlen(args[i]) + 1;
+        memcpy(key + offset, args[i], arg_len);
+        offset += arg_len;
+    }
+    *key_len = len;
+    return key;
+}
+
+static char *copy_buffer(const char *data, size_t len) {
+    char *copy = malloc(len + 1);
+    if (copy) {
+        memcpy(copy, data ? data : "", len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+static bool copy_output(const safe_exec_output_t *src, safe_exec_output_t *dst) {
+    memset(dst, 0, sizeof(*dst));
+    dst->out = copy_buffer(src->out, src->out_len);
+    dst->err = copy_buffer(src->err, src->err_len);
+    if (!dst->out || !dst->err) {
+        safe_exec_output_free(dst);
+        return false;
+    }
+    dst->out_len = src->out_len;
+    dst->err_len = src->err_len;
+    dst->exit_code = src->exit_code;
+    return true;
+}
+
+static void entry_clear(query_entry_t *entry) {
+    free(entry->key);
+    safe_exec_output_free(&entry->output);
+    memset(entry, 0, sizeof(*entry));
+}
+
+static query_entry_t *find_entry(const char *key, size_t key_len) {
+    for (int i = 0; i < QUERY_CACHE_MAX_ENTRIES; i++) {
+        if (entries[i].key && entries[i].key_len == key_len &&
+            memcmp(entries[i].key, key, key_len) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Entry to overwrite: a free one, else the oldest
+static query_entry_t *victim_entry(void) {
+    query_entry_t *oldest = &entries[0];
+    for (int i = 0; i < QUERY_CACHE_MAX_ENTRIES; i++) {
+        if (!entries[i].key) {
+            return &entries[i];
+        }
+        if (entries[i].stored_at < oldest->stored_at) {
+            oldest = &entries[i];
+        }
+    }
+    return oldest;
+}
+
+bool query_cache_capture(const char *program, char *const args[], int ttl_ms,
+                         safe_exec_output_t *output) {
+    if (!program || !args || !output) {
+        return false;
+    }
+    if (ttl_ms <= 0) {
+        return safe_exec_capture(program, args, output);
+    }
+
+    size_t key_len;
+    char *key = build_key(program, args, &key_len);
+    if (!key) {
+        return safe_exec_capture(program, args, output);
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    query_entry_t *entry = find_entry(key, key_len);
+    if (entry && entry->expires_at > monotonic_ms() &&
+        copy_output(&entry->output, output)) {
+        stats.hits++;
+        pthread_mutex_unlock(&cache_lock);
+        free(key);
+        return true;
+    }
+    stats.misses++;
+    unsigned long started_generation = generation;
+    pthread_mutex_unlock(&cache_lock);
+
+    if (!safe_exec_capture(program, args, output)) {
+        free(key);
+        return false;
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    // A result that raced with an invalidation may already be out of date
+    if (output->exit_code == 0 && generation == started_generation) {
+        entry = find_entry(key, key_len);
+        if (entry) {
+            free(key);
+            key = entry->key;
+            entry->key = NULL;
+            entry_clear(entry);
+        } else {
+            entry = victim_entry();
+            entry_clear(entry);
+        }
+
+        if (copy_output(output, &entry->output)) {
+            long long now = monotonic_ms();
+            entry->key = key;
+            entry->key_len = key_len;
+            entry->stored_at = now;
+            entry->expires_at = now + ttl_ms;
+            key = NULL;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    free(key);
+    return true;
+}
+
+void query_cache_invalidate(void) {
+    pthread_mutex_lock(&cache_lock);
+    for (int i = 0; i < QUERY_CACHE_MAX_ENTRIES; i++) {
+        if (entries[i].key) {
+            entry_clear(&entries[i]);
+        }
+    }
+    generation++;
+    stats.invalidations++;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+unsigned long query_cache_generation(void) {
+    pthread_mutex_lock(&cache_lock);
+    unsigned long current = generation;
+    pthread_mutex_unlock(&cache_lock);
+    return current;
+}
+
+void query_cache_get_stats(query_cache_stats_t *out) {
+    if (!out) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    *out = stats;
+    out->entries = 0;
+    for (int i = 0; i < QUERY_CACHE_MAX_ENTRIES; i++) {
+        if (entries[i].key) {
+            out->entries++;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
@@ -0,0 +1,77 @@
+/**
+ * @file query_cache.h
+ * @brief Short-lived cache of read-only command output
+ *
+ * One user action often asks NetworkManager the same question several
+ * times (e.g. `nmcli connection show` from the connect path and the
+ * hotspot list). Read-only queries go through query_cache_capture(),
+ * which serves a successful result again until its TTL expires or the
+ * cache is invalidated. Every operation that changes NetworkManager state
+ * calls query_cache_invalidate().
+ */
+
+#ifndef WTERM_QUERY_CACHE_H
+#define WTERM_QUERY_CACHE_H
+
+#include "safe_exec.h"
+#include <stdbool.h>
+
+// TTL for queries whose results only change through wterm's own actions
+#define QUERY_CACHE_DEFAULT_TTL_MS 2000
+
+// TTL for state that can change underneath us (link state, scan results)
+#define QUERY_CACHE_SHORT_TTL_MS 500
+
+// Distinct queries kept at once; the oldest entry is evicted first
+#define QUERY_CACHE_MAX_ENTRIES 16
+
+/**
+ * @brief Cache counters
+ */
+typedef struct {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long invalidations;
+    int entries;        // Entries currently held (expired ones included)
+} query_cache_stats_t;
+
+/**
+ * @brief Capture a command's output, reusing a recent identical run
+ *
+ * Same contract as safe_exec_capture(); the output is always a private
+ * copy the caller may modify and must release with safe_exec_output_free().
+ * The key is the program plus every argument. Only runs that exit with
+ * status 0 are cached.
+ *
+ * @param program Program name or path
+ * @param args NULL-terminated array of arguments (including program name)
+ * @param ttl_ms How long the result may be reused; <= 0 bypasses the cache
+ * @param output Receives the captured output
+ * @return true if output was captured (check output->exit_code)
+ */
+bool query_cache_capture(const char *program, char *const args[], int ttl_ms,
+                         safe_exec_output_t *output);
+
+/**
+ * @brief Drop every cached result
+ *
+ * Call after anything that may change the answer to a cached query
+ * (connect, disconnect, profile or hotspot changes, rescans).
+ */
+void query_cache_invalidate(void);
+
+/**
+ * @brief Number of invalidations so far
+ *
+ * Lets longer-lived caches built from the same queries (e.g. the saved
+ * profile index) notice that NetworkManager state changed.
+ */
+unsigned long query_cache_generation(void);
+
+/**
+ * @brief Read the cache counters
+ * @param stats Receives the counters
+ */
+void query_cache_get_stats(query_cache_stats_t *stats);
+
+#endif // WTERM_QUERY_CACHE_H
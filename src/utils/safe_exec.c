@@ -1,94 +1,315 @@
 /**
  * @file safe_exec.c
  * @brief Safe command execution implementation
+ *
+ * All helpers share one launcher built on posix_spawnp(), which glibc
+ * implements with CLONE_VM | CLONE_VFORK: the child never copies the
+ * parent's page tables, so spawn cost stays flat as the TUI grows. Pipes
+ * are created close-on-exec and wired up through spawn file actions, and
+ * children are reaped through a pidfd where the kernel supports it.
+ *
+ * Every command runs against a deadline. A child that outlives it (or whose
+ * caller cancels) is sent SIGTERM, then SIGKILL, so a hung nmcli can never
+ * block the caller indefinitely.
  */
 
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE // pipe2(), P_PIDFD
 #include "safe_exec.h"
+#include "capability.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <spawn.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <string.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
 
-// cppcheck-suppress unusedFunction ; Exported API function
-int safe_exec_command(const char* program, char* const args[]) {
-    if (!program || !args) {
-        return -1;
+extern char **environ;
+
+// Number of processes started by this module (see safe_exec_spawn_count())
+static unsigned long spawn_count = 0;
+
+// Special stdio dispositions for spawn_process()
+#define SPAWN_INHERIT (-1)
+#define SPAWN_DEVNULL (-2)
+
+// Running child process
+typedef struct {
+    pid_t pid;
+    int pidfd;          // -1 when pidfds are unavailable (kernel < 5.3)
+} spawn_handle_t;
+
+// Capture buffer for one stream of a child process
+typedef struct {
+    char *data;
+    size_t len;
+    size_t capacity;
+} capture_buffer_t;
+
+static int open_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    int fd = (int)syscall(SYS_pidfd_open, pid, 0);
+    if (fd >= 0) {
+        // pidfd_open() sets O_CLOEXEC itself since 5.10; be explicit for 5.3+
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
     }
+    return fd;
+#else
+    (void)pid;
+    return -1;
+#endif
+}
 
-    pid_t pid = fork();
+static int add_stdio_action(posix_spawn_file_actions_t *actions, int fd,
+                            int target, int devnull_flags) {
+    if (fd == SPAWN_INHERIT) {
+        return 0;
+    }
+    if (fd == SPAWN_DEVNULL) {
+        return posix_spawn_file_actions_addopen(actions, target, "/dev/null",
+                                                devnull_flags, 0);
+    }
+    return posix_spawn_file_actions_adddup2(actions, fd, target);
+}
 
-    if (pid < 0) {
-        // Fork failed
-        perror("fork");
-        return -1;
+/**
+ * @brief Start a program with the given stdio wiring
+ *
+ * Each of stdin_fd/stdout_fd/stderr_fd is a descriptor to install,
+ * SPAWN_INHERIT, or SPAWN_DEVNULL. Descriptors other than these three are
+ * expected to be close-on-exec, so nothing else leaks into the child.
+ *
+ * @return 0 on success, otherwise an errno value (ENOENT if not found)
+ */
+static int spawn_process(const char *program, char *const args[], int stdin_fd,
+                         int stdout_fd, int stderr_fd, spawn_handle_t *child) {
+    posix_spawn_file_actions_t actions;
+    int error = posix_spawn_file_actions_init(&actions);
+    if (error != 0) {
+        return error;
     }
 
-    if (pid == 0) {
-        // Child process
-        // Redirect stderr to /dev/null if needed
-        execvp(program, args);
+    error = add_stdio_action(&actions, stdin_fd, STDIN_FILENO, O_RDONLY);
+    if (error == 0) {
+        error = add_stdio_action(&actions, stdout_fd, STDOUT_FILENO, O_WRONLY);
+    }
+    if (error == 0) {
+        error = add_stdio_action(&actions, stderr_fd, STDERR_FILENO, O_WRONLY);
+    }
 
-        // execvp only returns on error
-        perror("execvp");
-        _exit(127); // Command not found
+    if (error == 0) {
+        // Known tools use the path cached by the capability registry,
+        // sparing the child a failed execve() per PATH entry
+        capability_t capability;
+        char resolved[CAPABILITY_PATH_MAX];
+        const char *path = NULL;
+        if (capability_from_name(program, &capability)) {
+            if (capability_path(capability, resolved, sizeof(resolved))) {
+                path = resolved;
+            } else {
+                error = ENOENT;
+            }
+        }
+
+        if (error == 0) {
+            error = path ? posix_spawn(&child->pid, path, &actions, NULL, args, environ)
+                         : posix_spawnp(&child->pid, program, &actions, NULL, args, environ);
+        }
+    }
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (error != 0) {
+        return error;
+    }
+
+    __atomic_add_fetch(&spawn_count, 1, __ATOMIC_RELAXED);
+
+    child->pidfd = open_pidfd(child->pid);
+    return 0;
+}
+
+/**
+ * @brief Wait for a spawned child and release its handle
+ * @return Exit status, or -1 if the child was killed or could not be reaped
+ */
+static int reap_process(spawn_handle_t *child) {
+    int exit_code = -1;
+
+    if (child->pidfd >= 0) {
+        siginfo_t info;
+        memset(&info, 0, sizeof(info));
+
+        int rc;
+        do {
+            rc = waitid(P_PIDFD, (id_t)child->pidfd, &info, WEXITED);
+        } while (rc < 0 && errno == EINTR);
+
+        close(child->pidfd);
+        child->pidfd = -1;
+
+        if (rc == 0) {
+            return info.si_code == CLD_EXITED ? info.si_status : -1;
+        }
+        if (errno != EINVAL) {
+            return -1;
+        }
+        // Kernel without P_PIDFD support (< 5.4): fall back to the pid
     }
 
-    // Parent process
     int status;
-    if (waitpid(pid, &status, 0) < 0) {
-        perror("waitpid");
-        return -1;
+    while (waitpid(child->pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
     }
 
     if (WIFEXITED(status)) {
-        return WEXITSTATUS(status);
+        exit_code = WEXITSTATUS(status);
     }
+    return exit_code;
+}
 
-    return -1; // Abnormal termination
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
 
-bool safe_command_exists(const char* command) {
-    if (!command) {
-        return false;
+// Deadline in CLOCK_MONOTONIC milliseconds, -1 for none
+static long long deadline_after(int timeout_ms) {
+    if (timeout_ms == 0) {
+        timeout_ms = SAFE_EXEC_DEFAULT_TIMEOUT_MS;
     }
+    return timeout_ms < 0 ? -1 : monotonic_ms() + timeout_ms;
+}
 
-    // Use 'which' to check if command exists (which is an actual executable)
-    char* const args[] = {
-        "which",
-        (char*)command,
-        NULL
-    };
+// Milliseconds left for poll(), -1 to wait forever
+static int poll_timeout(long long deadline) {
+    if (deadline < 0) {
+        return -1;
+    }
+    long long left = deadline - monotonic_ms();
+    return left > 0 ? (int)left : 0;
+}
 
-    pid_t pid = fork();
+static bool fd_readable(int fd) {
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    return poll(&pfd, 1, 0) > 0;
+}
 
-    if (pid < 0) {
-        return false;
-    }
+// Has the child exited? Leaves it unreaped (WNOWAIT) for reap_process()
+static bool process_exited(const spawn_handle_t *child) {
+    siginfo_t info;
+    memset(&info, 0, sizeof(info));
+    return waitid(P_PID, (id_t)child->pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0 &&
+           info.si_pid != 0;
+}
+
+/**
+ * @brief Wait for a child to exit, bounded by a deadline and a cancel fd
+ *
+ * With a pidfd this is a single poll(); without one the exit status is
+ * polled every 10 ms. The child is not reaped.
+ *
+ * @return WTERM_SUCCESS once exited, WTERM_ERROR_TIMEOUT,
+ *         WTERM_ERROR_CANCELLED or WTERM_ERROR_GENERAL otherwise
+ */
+static wterm_result_t wait_process(const spawn_handle_t *child, long long deadline,
+                                   int cancel_fd) {
+    for (;;) {
+        struct pollfd fds[2];
+        int nfds = 0;
+        int pid_slot = -1;
+        int cancel_slot = -1;
+
+        if (child->pidfd >= 0) {
+            pid_slot = nfds;
+            fds[nfds++] = (struct pollfd){.fd = child->pidfd, .events = POLLIN};
+        }
+        if (cancel_fd >= 0) {
+            cancel_slot = nfds;
+            fds[nfds++] = (struct pollfd){.fd = cancel_fd, .events = POLLIN};
+        }
+
+        int timeout = poll_timeout(deadline);
+        if (pid_slot < 0 && (timeout < 0 || timeout > 10)) {
+            timeout = 10;
+        }
+
+        int rc = poll(fds, (nfds_t)nfds, timeout);
+        if (rc < 0 && errno != EINTR) {
+            return WTERM_ERROR_GENERAL;
+        }
 
-    if (pid == 0) {
-        // Child process - redirect output to /dev/null
-        int devnull = open("/dev/null", O_WRONLY);
-        if (devnull >= 0) {
-            dup2(devnull, STDOUT_FILENO);
-            dup2(devnull, STDERR_FILENO);
-            close(devnull);
+        if (rc > 0 && cancel_slot >= 0 && fds[cancel_slot].revents) {
+            return WTERM_ERROR_CANCELLED;
         }
+        if (pid_slot >= 0 ? (rc > 0 && fds[pid_slot].revents) : process_exited(child)) {
+            return WTERM_SUCCESS;
+        }
+        if (deadline >= 0 && monotonic_ms() >= deadline) {
+            return WTERM_ERROR_TIMEOUT;
+        }
+    }
+}
+
+// SIGTERM, then SIGKILL if the child ignores it for the grace period
+static void terminate_process(const spawn_handle_t *child) {
+    kill(child->pid, SIGTERM);
+    if (wait_process(child, monotonic_ms() + SAFE_EXEC_KILL_GRACE_MS, -1) != WTERM_SUCCESS) {
+        kill(child->pid, SIGKILL);
+    }
+}
 
-        execvp("which", args);
-        _exit(127);
+// Run a program to completion; spawn failures map to 127 like a shell would
+static int run_process(const char *program, char *const args[], int stdout_fd,
+                       int stderr_fd) {
+    spawn_handle_t child;
+    int error = spawn_process(program, args, SPAWN_INHERIT, stdout_fd, stderr_fd,
+                              &child);
+    if (error != 0) {
+        return (error == ENOENT || error == EACCES) ? 127 : -1;
     }
 
-    // Parent process
-    int status;
-    if (waitpid(pid, &status, 0) < 0) {
+    if (wait_process(&child, deadline_after(0), -1) != WTERM_SUCCESS) {
+        terminate_process(&child);
+        reap_process(&child);
+        return -1;
+    }
+    return reap_process(&child);
+}
+
+// cppcheck-suppress unusedFunction ; Exported API function
+int safe_exec_command(const char* program, char* const args[]) {
+    if (!program || !args) {
+        return -1;
+    }
+
+    return run_process(program, args, SPAWN_INHERIT, SPAWN_INHERIT);
+}
+
+bool safe_command_exists(const char* command) {
+    if (!command) {
         return false;
     }
 
-    return (WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    // Known tools are resolved once per process; anything else is a PATH
+    // walk in-process, never a fork
+    capability_t capability;
+    if (capability_from_name(command, &capability)) {
+        return capability_available(capability);
+    }
+    return capability_resolve(command, NULL, 0);
+}
+
+unsigned long safe_exec_spawn_count(void) {
+    return __atomic_load_n(&spawn_count, __ATOMIC_RELAXED);
 }
 
 bool safe_exec_check(const char* program, char* const args[]) {
@@ -102,31 +323,299 @@ bool safe_exec_check_silent(const char* program, char* const args[]) {
         return false;
     }
 
-    pid_t pid = fork();
+    // Redirect stdout and stderr to /dev/null
+    return run_process(program, args, SPAWN_DEVNULL, SPAWN_DEVNULL) == 0;
+}
 
-    if (pid < 0) {
-        // Fork failed
-        return false;
+static bool capture_append(capture_buffer_t *buffer, const char *data, size_t len) {
+    size_t room = SAFE_EXEC_MAX_OUTPUT - buffer->len;
+    if (len > room) {
+        len = room; // Drop the excess
     }
 
-    if (pid == 0) {
-        // Child process - redirect stdout and stderr to /dev/null
-        int devnull = open("/dev/null", O_WRONLY);
-        if (devnull >= 0) {
-            dup2(devnull, STDOUT_FILENO);
-            dup2(devnull, STDERR_FILENO);
-            close(devnull);
+    if (buffer->len + len + 1 > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 1024;
+        while (capacity < buffer->len + len + 1) {
+            capacity *= 2;
         }
 
-        execvp(program, args);
-        _exit(127); // Command not found
+        char *grown = realloc(buffer->data, capacity);
+        if (!grown) {
+            return false;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
     }
 
-    // Parent process
-    int status;
-    if (waitpid(pid, &status, 0) < 0) {
-        return false;
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+    buffer->data[buffer->len] = '\0';
+    return true;
+}
+
+bool safe_exec_capture(const char* program, char* const args[],
+                       safe_exec_output_t* output) {
+    return safe_exec_capture_ex(program, args, NULL, output) == WTERM_SUCCESS;
+}
+
+// Write the next part of a child's stdin; false once there is nothing left
+// to write (all written, or the child closed its end)
+static bool write_input(int fd, const char *input, size_t input_len, size_t *written) {
+    while (*written < input_len) {
+        ssize_t n = write(fd, input + *written, input_len - *written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        if (n <= 0) {
+            return false; // EPIPE: the child does not want the rest
+        }
+        *written += (size_t)n;
+    }
+    return false;
+}
+
+wterm_result_t safe_exec_capture_ex(const char* program, char* const args[],
+                                    const safe_exec_options_t* options,
+                                    safe_exec_output_t* output) {
+    if (!program || !args || !output) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    memset(output, 0, sizeof(*output));
+    output->exit_code = -1;
+
+    long long deadline = deadline_after(options ? options->timeout_ms : 0);
+    int cancel_fd = (options && options->cancel_fd > 0) ? options->cancel_fd : -1;
+
+    if (cancel_fd >= 0 && fd_readable(cancel_fd)) {
+        return WTERM_ERROR_CANCELLED;
+    }
+
+    // Close-on-exec so concurrent spawns never inherit each other's pipes
+    int out_pipe[2];
+    int err_pipe[2];
+    if (pipe2(out_pipe, O_CLOEXEC) < 0) {
+        return WTERM_ERROR_GENERAL;
+    }
+    if (pipe2(err_pipe, O_CLOEXEC) < 0) {
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        return WTERM_ERROR_GENERAL;
+    }
+
+    // Input goes through a non-blocking pipe written from the poll loop, so
+    // a child that produces output before reading all of it cannot deadlock
+    const char *input = options ? options->input : NULL;
+    size_t input_len = input ? options->input_len : 0;
+    size_t input_written = 0;
+    int in_pipe[2] = {-1, -1};
+    if (input && (pipe2(in_pipe, O_CLOEXEC | O_NONBLOCK) < 0 ||
+                  fcntl(in_pipe[0], F_SETFL, 0) < 0)) {
+        for (int i = 0; i < 2; i++) {
+            if (in_pipe[i] >= 0) {
+                close(in_pipe[i]);
+            }
+        }
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        close(err_pipe[0]);
+        close(err_pipe[1]);
+        return WTERM_ERROR_GENERAL;
+    }
+
+    // A child that exits without reading its input must not kill us with
+    // SIGPIPE; block it on this thread and discard it afterwards
+    sigset_t sigpipe_set;
+    sigset_t old_mask;
+    sigemptyset(&sigpipe_set);
+    sigaddset(&sigpipe_set, SIGPIPE);
+    if (input) {
+        pthread_sigmask(SIG_BLOCK, &sigpipe_set, &old_mask);
+    }
+
+    spawn_handle_t child;
+    int error = spawn_process(program, args, input ? in_pipe[0] : SPAWN_DEVNULL,
+                              out_pipe[1], err_pipe[1], &child);
+    close(out_pipe[1]);
+    close(err_pipe[1]);
+    if (input) {
+        close(in_pipe[0]);
+        if (error != 0 || !write_input(in_pipe[1], input, input_len, &input_written)) {
+            close(in_pipe[1]);
+            in_pipe[1] = -1;
+        }
+    }
+
+    if (error != 0) {
+        if (input) {
+            pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+        }
+        close(out_pipe[0]);
+        close(err_pipe[0]);
+        if (error != ENOENT && error != EACCES) {
+            return WTERM_ERROR_GENERAL;
+        }
+
+        // Report a missing program the way a shell would
+        output->out = calloc(1, 1);
+        output->err = calloc(1, 1);
+        if (!output->out || !output->err) {
+            safe_exec_output_free(output);
+            return WTERM_ERROR_MEMORY;
+        }
+        output->exit_code = 127;
+        return WTERM_SUCCESS;
+    }
+
+    // Drain both pipes until the child closes them, watching the child's
+    // pidfd and the cancel descriptor at the same time
+    enum { SLOT_OUT, SLOT_ERR, SLOT_PID, SLOT_CANCEL, SLOT_IN, SLOT_COUNT };
+    capture_buffer_t buffers[2] = {{0}};
+    struct pollfd fds[SLOT_COUNT] = {
+        [SLOT_OUT] = {.fd = out_pipe[0], .events = POLLIN},
+        [SLOT_ERR] = {.fd = err_pipe[0], .events = POLLIN},
+        [SLOT_PID] = {.fd = child.pidfd, .events = POLLIN},
+        [SLOT_CANCEL] = {.fd = cancel_fd, .events = POLLIN},
+        [SLOT_IN] = {.fd = in_pipe[1], .events = POLLOUT},
+    };
+    int open_fds = 2;
+    bool child_exited = false;
+    wterm_result_t result = WTERM_SUCCESS;
+
+    while (open_fds > 0) {
+        // Once the child is gone, only drain what is already buffered: a
+        // grandchild may still hold the pipes open
+        int rc = poll(fds, SLOT_COUNT, child_exited ? 0 : poll_timeout(deadline));
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            result = WTERM_ERROR_GENERAL;
+            break;
+        }
+        if (rc == 0) {
+            if (!child_exited) {
+                result = WTERM_ERROR_TIMEOUT;
+            }
+            break;
+        }
+
+        if (fds[SLOT_CANCEL].fd >= 0 && fds[SLOT_CANCEL].revents) {
+            result = WTERM_ERROR_CANCELLED;
+            break;
+        }
+        if (fds[SLOT_PID].fd >= 0 && fds[SLOT_PID].revents) {
+            child_exited = true;
+            fds[SLOT_PID].fd = -1;
+        }
+        if (fds[SLOT_IN].fd >= 0 && fds[SLOT_IN].revents &&
+            !write_input(fds[SLOT_IN].fd, input, input_len, &input_written)) {
+            close(fds[SLOT_IN].fd);
+            fds[SLOT_IN].fd = -1;
+        }
+
+        for (int i = SLOT_OUT; i <= SLOT_ERR; i++) {
+            if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+
+            char chunk[4096];
+            ssize_t n = read(fds[i].fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                close(fds[i].fd);
+                fds[i].fd = -1;
+                open_fds--;
+                continue;
+            }
+            if (!capture_append(&buffers[i], chunk, (size_t)n)) {
+                result = WTERM_ERROR_MEMORY;
+            }
+        }
+        if (result != WTERM_SUCCESS) {
+            break;
+        }
+
+        // A child flooding its output must not outrun the deadline
+        if (!child_exited && deadline >= 0 && monotonic_ms() >= deadline) {
+            result = WTERM_ERROR_TIMEOUT;
+            break;
+        }
+    }
+
+    for (int i = SLOT_OUT; i <= SLOT_ERR; i++) {
+        if (fds[i].fd >= 0) {
+            close(fds[i].fd);
+        }
+    }
+    if (fds[SLOT_IN].fd >= 0) {
+        close(fds[SLOT_IN].fd);
+    }
+    if (input) {
+        struct timespec no_wait = {0, 0};
+        while (sigtimedwait(&sigpipe_set, NULL, &no_wait) == SIGPIPE) {
+        }
+        pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    }
+
+    if (result == WTERM_SUCCESS && !child_exited) {
+        result = wait_process(&child, deadline, cancel_fd);
+    }
+    // Whatever stopped the capture early, a child still running is no
+    // longer drained or bounded by the deadline, so it must not be waited on
+    if (result != WTERM_SUCCESS) {
+        terminate_process(&child);
+    }
+
+    int exit_code = reap_process(&child);
+
+    // Empty streams still get a valid empty string
+    if (result == WTERM_SUCCESS && (!capture_append(&buffers[0], "", 0) ||
+                                    !capture_append(&buffers[1], "", 0))) {
+        result = WTERM_ERROR_MEMORY;
+    }
+
+    if (result != WTERM_SUCCESS) {
+        free(buffers[0].data);
+        free(buffers[1].data);
+        return result;
+    }
+
+    output->out = buffers[0].data;
+    output->out_len = buffers[0].len;
+    output->err = buffers[1].data;
+    output->err_len = buffers[1].len;
+    output->exit_code = exit_code;
+    return WTERM_SUCCESS;
+}
+
+void safe_exec_output_free(safe_exec_output_t* output) {
+    if (!output) {
+        return;
     }
 
-    return (WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    free(output->out);
+    free(output->err);
+    memset(output, 0, sizeof(*output));
+}
+
+char* safe_exec_next_line(char** cursor) {
+    if (!cursor || !*cursor || **cursor == '\0') {
+        return NULL;
+    }
+
+    char *line = *cursor;
+    char *newline = strchr(line, '\n');
+    if (newline) {
+        *newline = '\0';
+        *cursor = newline + 1;
+    } else {
+        *cursor = line + strlen(line);
+    }
+    return line;
 }
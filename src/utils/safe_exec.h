@@ -2,35 +2,81 @@
  * @file safe_exec.h
  * @brief Safe command execution utilities
  *
- * Provides safer alternatives to system() that use fork/exec pattern
- * to avoid shell injection vulnerabilities.
+ * Provides safer alternatives to system() that spawn programs directly
+ * (posix_spawn, no shell) to avoid shell injection vulnerabilities.
  */
 
 #ifndef WTERM_SAFE_EXEC_H
 #define WTERM_SAFE_EXEC_H
 
+#include "../../include/wterm/common.h"
 #include <stdbool.h>
 #include <stddef.h>
 
+// Upper bound on captured output per stream; excess output is discarded
+#define SAFE_EXEC_MAX_OUTPUT (1024 * 1024)
+
+// Deadline applied when no explicit timeout is given
+#define SAFE_EXEC_DEFAULT_TIMEOUT_MS 30000
+
+// Time a child gets to exit after SIGTERM before it is sent SIGKILL
+#define SAFE_EXEC_KILL_GRACE_MS 500
+
+/**
+ * @brief Per-command execution limits for safe_exec_capture_ex()
+ *
+ * Zero-initialised options select the default deadline, no cancellation
+ * and /dev/null as stdin.
+ */
+typedef struct {
+    int timeout_ms;     // 0 = SAFE_EXEC_DEFAULT_TIMEOUT_MS, negative = none
+    int cancel_fd;      // Aborts the command once readable; <= 0 = none
+    const char *input;  // Written to the child's stdin, then closed; NULL = none
+    size_t input_len;
+} safe_exec_options_t;
+
+/**
+ * @brief Captured result of a command run with safe_exec_capture()
+ */
+typedef struct {
+    char *out;          // stdout, always NUL-terminated after a capture
+    size_t out_len;
+    char *err;          // stderr, always NUL-terminated after a capture
+    size_t err_len;
+    int exit_code;      // Exit status, 127 if exec failed, -1 if killed
+} safe_exec_output_t;
+
 /**
  * @brief Execute a command safely without shell interpretation
  *
- * Uses fork/exec to run a command with arguments, avoiding shell injection.
+ * Uses posix_spawn to run a command with arguments, avoiding shell injection.
+ *
+ * The command is killed if it outlives SAFE_EXEC_DEFAULT_TIMEOUT_MS.
  *
  * @param program Program name or path (argv[0])
  * @param args NULL-terminated array of arguments (including program name)
- * @return Exit code of the command (0 = success, non-zero = failure)
+ * @return Exit code of the command (0 = success, non-zero = failure,
+ *         -1 if it could not be run, was killed or timed out)
  */
 int safe_exec_command(const char* program, char* const args[]);
 
 /**
  * @brief Check if a command exists in PATH
  *
+ * Resolved in-process (no fork); tools known to the capability registry
+ * are cached for the lifetime of the process.
+ *
  * @param command Command name to check
  * @return true if command exists and is executable, false otherwise
  */
 bool safe_command_exists(const char* command);
 
+/**
+ * @brief Number of child processes spawned so far by this process
+ * @return Spawn count
+ */
+unsigned long safe_exec_spawn_count(void);
+
 /**
  * @brief Execute a command and check if it succeeds (returns 0)
  *
@@ -52,4 +98,64 @@ bool safe_exec_check(const char* program, char* const args[]);
  */
 bool safe_exec_check_silent(const char* program, char* const args[]);
 
+/**
+ * @brief Execute a command and capture its stdout, stderr and exit code
+ *
+ * Runs the program directly with posix_spawn (no shell) and reads both
+ * streams through pipes. stdin is connected to /dev/null. Arguments are
+ * passed verbatim, so no shell escaping is needed. The command is killed
+ * if it outlives SAFE_EXEC_DEFAULT_TIMEOUT_MS.
+ *
+ * @param program Program name or path
+ * @param args NULL-terminated array of arguments (including program name)
+ * @param output Receives the captured output; release with
+ *               safe_exec_output_free()
+ * @return true if the command was run and captured (check output->exit_code),
+ *         false if it could not be started or did not finish in time
+ */
+bool safe_exec_capture(const char* program, char* const args[],
+                       safe_exec_output_t* output);
+
+/**
+ * @brief Execute a command with a deadline and optional cancellation
+ *
+ * Like safe_exec_capture(), but waits on the output pipes, a pidfd for the
+ * child and options->cancel_fd together. When the deadline passes or the
+ * cancel descriptor becomes readable, the child gets SIGTERM, then SIGKILL
+ * after SAFE_EXEC_KILL_GRACE_MS, and is reaped before returning. With
+ * options->input set, the child reads that text on stdin (e.g. a rule set
+ * for iptables-restore) instead of /dev/null.
+ *
+ * @param program Program name or path
+ * @param args NULL-terminated array of arguments (including program name)
+ * @param options Limits for this command, or NULL for the defaults
+ * @param output Receives the captured output on WTERM_SUCCESS; left empty
+ *               otherwise
+ * @return WTERM_SUCCESS if the command ran to completion (check
+ *         output->exit_code), WTERM_ERROR_TIMEOUT if the deadline passed,
+ *         WTERM_ERROR_CANCELLED if cancel_fd fired, WTERM_ERROR_GENERAL if
+ *         it could not be started
+ */
+wterm_result_t safe_exec_capture_ex(const char* program, char* const args[],
+                                    const safe_exec_options_t* options,
+                                    safe_exec_output_t* output);
+
+/**
+ * @brief Release buffers held by a safe_exec_output_t
+ *
+ * @param output Output to clear (safe to call on a zeroed struct)
+ */
+void safe_exec_output_free(safe_exec_output_t* output);
+
+/**
+ * @brief Iterate over the lines of a captured buffer
+ *
+ * Splits the buffer in place. Start with *cursor pointing at the buffer;
+ * each call returns the next line without its trailing newline.
+ *
+ * @param cursor In/out position within the buffer
+ * @return Next line, or NULL when the buffer is exhausted
+ */
+char* safe_exec_next_line(char** cursor);
+
 #endif // WTERM_SAFE_EXEC_H
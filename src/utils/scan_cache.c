@@ -0,0 +1,233 @@
+/**
+ * @file scan_cache.c
+ * @brief Persisted snapshot of the last scan for instant startup
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "scan_cache.h"
+#include "network_list.h"
+#include "string_utils.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SCAN_CACHE_MAGIC "WTSC"
+#define SCAN_CACHE_VERSION 1
+
+// File layout: header, then `count` fixed-size entries. Native byte order;
+// the file never leaves the machine that wrote it.
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_size;
+    uint32_t count;
+    int64_t saved_at;           // Seconds since the epoch
+} scan_cache_header_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t quality;
+    uint8_t security_flags;
+    uint16_t frequency;
+    uint16_t channel;
+    int16_t signal_dbm;
+    uint16_t max_rate;
+    char ssid[MAX_STR_SSID];
+    char security[MAX_STR_SECURITY];
+} scan_cache_entry_t;
+
+bool scan_cache_default_path(char *path, size_t size) {
+    if (!path || size == 0) {
+        return false;
+    }
+
+    const char *cache_home = getenv("XDG_CACHE_HOME");
+    int written;
+    if (cache_home && cache_home[0] == '/') {
+        written = snprintf(path, size, "%s/wterm/%s", cache_home, SCAN_CACHE_FILE);
+    } else {
+        const char *home = getenv("HOME");
+        if (!home || home[0] == '\0') {
+            return false;
+        }
+        written = snprintf(path, size, "%s/.cache/wterm/%s", home, SCAN_CACHE_FILE);
+    }
+    return written > 0 && (size_t)written < size;
+}
+
+// mkdir -p for every directory above the file
+static bool create_parent_dirs(const char *path) {
+    char dir[4096];
+    if (!safe_string_copy(dir, path, sizeof(dir))) {
+        return false;
+    }
+
+    for (char *slash = strchr(dir + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+            return false;
+        }
+        *slash = '/';
+    }
+    return true;
+}
+
+static bool write_all(int fd, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0) {
+        ssize_t written = write(fd, p, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+wterm_result_t scan_cache_save(const char *path, const network_list_t *list) {
+    if (!path || !list || list->count < 0) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    size_t size = sizeof(scan_cache_header_t) +
+                  (size_t)list->count * sizeof(scan_cache_entry_t);
+    char *buffer = calloc(1, size);
+    if (!buffer) {
+        return WTERM_ERROR_MEMORY;
+    }
+
+    scan_cache_header_t *header = (scan_cache_header_t *)buffer;
+    memcpy(header->magic, SCAN_CACHE_MAGIC, sizeof(header->magic));
+    header->version = SCAN_CACHE_VERSION;
+    header->entry_size = sizeof(scan_cache_entry_t);
+    header->count = (uint32_t)list->count;
+    header->saved_at = (int64_t)time(NULL);
+
+    scan_cache_entry_t *entries = (scan_cache_entry_t *)(header + 1);
+    for (int i = 0; i < list->count; i++) {
+        scan_record_t record;
+        network_list_get_record(list, i, &record);
+
+        scan_cache_entry_t *entry = &entries[i];
+        memcpy(entry->bssid, record.bssid, sizeof(entry->bssid));
+        entry->quality = record.quality;
+        entry->security_flags = record.security_flags;
+        entry->frequency = record.frequency;
+        entry->channel = record.channel;
+        entry->signal_dbm = record.signal_dbm;
+        entry->max_rate = record.max_rate;
+        safe_string_copy(entry->ssid, list->networks[i].ssid, sizeof(entry->ssid));
+        safe_string_copy(entry->security, list->networks[i].security,
+                         sizeof(entry->security));
+    }
+
+    char temp_path[4096];
+    int written = snprintf(temp_path, sizeof(temp_path), "%s.%ld.tmp", path, (long)getpid());
+    if (written <= 0 || (size_t)written >= sizeof(temp_path) || !create_parent_dirs(path)) {
+        free(buffer);
+        return WTERM_ERROR_GENERAL;
+    }
+
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        free(buffer);
+        return WTERM_ERROR_GENERAL;
+    }
+
+    bool ok = write_all(fd, buffer, size);
+    ok = (close(fd) == 0) && ok;
+    free(buffer);
+
+    if (!ok || rename(temp_path, path) != 0) {
+        unlink(temp_path);
+        return WTERM_ERROR_GENERAL;
+    }
+    return WTERM_SUCCESS;
+}
+
+static void copy_field(char *dst, const char *src, size_t size) {
+    // Fields from the file are not trusted to be terminated
+    memcpy(dst, src, size);
+    dst[size - 1] = '\0';
+}
+
+wterm_result_t scan_cache_load(const char *path, network_list_t *list,
+                               time_t *saved_at) {
+    if (!path || !list) {
+        return WTERM_ERROR_INVALID_INPUT;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return WTERM_ERROR_GENERAL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(scan_cache_header_t)) {
+        close(fd);
+        return WTERM_ERROR_GENERAL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return WTERM_ERROR_GENERAL;
+    }
+
+    const scan_cache_header_t *header = map;
+    uint64_t expected = sizeof(*header) +
+                        (uint64_t)header->count * sizeof(scan_cache_entry_t);
+    if (memcmp(header->magic, SCAN_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != SCAN_CACHE_VERSION ||
+        header->entry_size != sizeof(scan_cache_entry_t) ||
+        header->count > INT32_MAX || expected != size) {
+        munmap(map, size);
+        return WTERM_ERROR_GENERAL;
+    }
+
+    wterm_result_t result = WTERM_SUCCESS;
+    network_list_clear(list);
+
+    const scan_cache_entry_t *entries = (const scan_cache_entry_t *)(header + 1);
+    for (uint32_t i = 0; i < header->count; i++) {
+        const scan_cache_entry_t *entry = &entries[i];
+        network_info_t *network = network_list_append(list);
+        if (!network) {
+            result = WTERM_ERROR_MEMORY;
+            break;
+        }
+
+        copy_field(network->ssid, entry->ssid, sizeof(network->ssid));
+        copy_field(network->security, entry->security, sizeof(network->security));
+        snprintf(network->signal, sizeof(network->signal), "%u", (unsigned)entry->quality);
+
+        scan_record_t record = {
+            .frequency = entry->frequency,
+            .channel = entry->channel,
+            .signal_dbm = entry->signal_dbm,
+            .quality = entry->quality,
+            .security_flags = entry->security_flags,
+            .max_rate = entry->max_rate};
+        memcpy(record.bssid, entry->bssid, sizeof(record.bssid));
+        network_list_set_record(list, list->count - 1, &record);
+    }
+
+    if (saved_at) {
+        *saved_at = (time_t)header->saved_at;
+    }
+    munmap(map, size);
+
+    list->is_stale = true;
+    return result;
+}
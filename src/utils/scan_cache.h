@@ -0,0 +1,59 @@
+/**
+ * @file scan_cache.h
+ * @brief Persisted snapshot of the last scan for instant startup
+ *
+ * The last scan is stored as a small binary file in the user's cache
+ * directory. On startup it is memory-mapped and loaded into a
+ * network_list_t marked stale, so the UI can paint before the first real
+ * scan completes.
+ */
+
+#ifndef WTERM_SCAN_CACHE_H
+#define WTERM_SCAN_CACHE_H
+
+#include "../../include/wterm/common.h"
+#include <stddef.h>
+#include <time.h>
+
+#define SCAN_CACHE_FILE "scan-cache.bin"
+
+/**
+ * @brief Path of the snapshot file
+ *
+ * $XDG_CACHE_HOME/wterm/scan-cache.bin, falling back to
+ * $HOME/.cache/wterm/scan-cache.bin.
+ *
+ * @param path Output buffer
+ * @param size Size of the output buffer
+ * @return false if neither variable is set or the path does not fit
+ */
+bool scan_cache_default_path(char *path, size_t size);
+
+/**
+ * @brief Write a scan to the snapshot file
+ *
+ * The file is written next to its final name and renamed into place, so
+ * readers never see a partial snapshot. Missing parent directories are
+ * created.
+ *
+ * @param path Snapshot path
+ * @param list Scan to store
+ * @return WTERM_SUCCESS, or WTERM_ERROR_GENERAL on I/O failure
+ */
+wterm_result_t scan_cache_save(const char *path, const network_list_t *list);
+
+/**
+ * @brief Load a snapshot into a list
+ *
+ * The list's previous entries are replaced and is_stale is set.
+ *
+ * @param path Snapshot path
+ * @param list List to fill
+ * @param saved_at Optional; receives the time the snapshot was written
+ * @return WTERM_SUCCESS, WTERM_ERROR_GENERAL if the file is missing or
+ *         invalid, or WTERM_ERROR_MEMORY
+ */
+wterm_result_t scan_cache_load(const char *path, network_list_t *list,
+                               time_t *saved_at);
+
+#endif // WTERM_SCAN_CACHE_H
@@ -68,4 +68,28 @@ const char *find_nth_char(const char *str, char ch, int n) {
         str++;
     }
     return NULL;
-}
\ No newline at end of file
+}
+int split_terse_fields(char *line, char *fields[], int max_fields) {
+    if (!line || !fields || max_fields < 1) return 0;
+
+    int count = 0;
+    char *in = line;
+    char *out = line;
+    fields[count++] = out;
+
+    while (*in) {
+        if (*in == '\\' && in[1] != '\0') {
+            // Escaped separator or backslash
+            *out++ = in[1];
+            in += 2;
+        } else if (*in == ':' && count < max_fields) {
+            *out++ = '\0';
+            in++;
+            fields[count++] = out;
+        } else {
+            *out++ = *in++;
+        }
+    }
+    *out = '\0';
+    return count;
+}
@@ -45,3 +45,17 @@ bool is_string_empty(const char *str);
  * @return Pointer to nth occurrence, or NULL if not found
  */
 const char *find_nth_char(const char *str, char ch, int n);
+
+/**
+ * @brief Split a line of nmcli terse (-t) output into fields in place
+ *
+ * Fields are separated by ':'; escaped "\:" and "\\" inside a field are
+ * unescaped. The last field receives the rest of the line if there are
+ * more separators than max_fields.
+ *
+ * @param line Line to split (modified)
+ * @param fields Output field pointers into line
+ * @param max_fields Size of fields
+ * @return Number of fields found
+ */
+int split_terse_fields(char *line, char *fields[], int max_fields);
@@ -0,0 +1,257 @@
+/**
+ * @file test_bridge_engine.c
+ * @brief Tests for bridged hotspot sharing
+ *
+ * Parsing and the rendered `ip -batch` scripts are checked everywhere.
+ * With ip installed, veth pairs in a private network namespace stand in
+ * for the AP and the uplink while bridges are built and dissolved.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "test_utils.h"
+#include "../src/core/bridge_engine.h"
+#include "../src/core/context.h"
+#include "../src/core/hotspot_manager.h"
+#include "../src/utils/capability.h"
+#include "../src/utils/safe_exec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void test_parse(void) {
+    test_section("Parsing ip output");
+
+    bridge_link_t link;
+    TEST_ASSERT(bridge_parse_link("4: eth0@if3: <BROADCAST,MULTICAST,UP> mtu 1500 qdisc noqueue"
+                                  " master br0 state UP mode DEFAULT group default qlen 1000\\"
+                                  "    link/ether 8e:f3:e4:d2:fb:d8 brd ff:ff:ff:ff:ff:ff"
+                                  " promiscuity 1 \\    veth \\    bridge_slave state forwarding",
+                                  &link),
+                "Port line parsed");
+    TEST_ASSERT_EQUAL_STR("br0", link.master, "Master found");
+    TEST_ASSERT_EQUAL_STR("8e:f3:e4:d2:fb:d8", link.mac, "MAC found");
+    TEST_ASSERT(!link.is_bridge, "A bridge port is not a bridge");
+
+    TEST_ASSERT(bridge_parse_link("2: br0: <BROADCAST,MULTICAST,UP> mtu 1500 qdisc noqueue"
+                                  " state UP\\    link/ether 86:ff:f9:a2:18:e3 brd"
+                                  " ff:ff:ff:ff:ff:ff promiscuity 0 \\    bridge forward_delay"
+                                  " 1500 hello_time 200",
+                                  &link),
+                "Bridge line parsed");
+    TEST_ASSERT(link.is_bridge, "Bridge recognised");
+    TEST_ASSERT_EQUAL_STR("", link.master, "Bridge has no master");
+    TEST_ASSERT(!bridge_parse_link("Device \"x\" does not exist.", &link), "Errors rejected");
+
+    char addrs[] = "4: eth0    inet 192.0.2.10/24 brd 192.0.2.255 scope global eth0\\"
+                   "       valid_lft forever preferred_lft forever\n"
+                   "4: eth0    inet 198.51.100.7/25 scope global secondary eth0\\"
+                   "       valid_lft forever preferred_lft forever\n";
+    char routes[] = "default via 192.0.2.1 proto dhcp src 192.0.2.10 metric 100 \n";
+    bridge_l3_t l3;
+    bridge_parse_l3(addrs, routes, &l3);
+    TEST_ASSERT_EQUAL_INT(2, l3.address_count, "Both addresses found");
+    TEST_ASSERT_EQUAL_STR("192.0.2.10/24", l3.addresses[0], "Primary address");
+    TEST_ASSERT_EQUAL_STR("198.51.100.7/25", l3.addresses[1], "Secondary address");
+    TEST_ASSERT_EQUAL_STR("192.0.2.1", l3.gateway, "Gateway found");
+    TEST_ASSERT_EQUAL_INT(100, l3.metric, "Metric found");
+
+    bridge_parse_l3(NULL, NULL, &l3);
+    TEST_ASSERT(l3.address_count == 0 && l3.gateway[0] == '\0' && l3.metric == -1,
+                "Nothing to move");
+
+    char name[MAX_STR_INTERFACE];
+    bridge_name_for_uplink("eth0", name, sizeof(name));
+    TEST_ASSERT_EQUAL_STR("wtbr-eth0", name, "Bridge named after the uplink");
+    bridge_name_for_uplink("enp0s20f0u1u2", name, sizeof(name));
+    TEST_ASSERT_EQUAL_STR("wtbr-enp0s20f0u", name, "Long uplink trimmed to 15 characters");
+}
+
+static void test_render(void) {
+    test_section("Rendered ip batches");
+
+    bridge_l3_t l3 = {.address_count = 1, .addresses = {"192.0.2.10/24"},
+                      .gateway = "192.0.2.1", .metric = 100};
+    char script[1024];
+
+    TEST_ASSERT(bridge_render_create("wtbr-eth0", "eth0", "wlan0", "8e:f3:e4:d2:fb:d8", &l3,
+                                     script, sizeof(script)) > 0,
+                "Create batch rendered");
+    TEST_ASSERT_EQUAL_STR("link add name wtbr-eth0 address 8e:f3:e4:d2:fb:d8 type bridge\n"
+                          "link set eth0 master wtbr-eth0\n"
+                          "link set wlan0 master wtbr-eth0\n"
+                          "addr del 192.0.2.10/24 dev eth0\n"
+                          "link set wtbr-eth0 up\n"
+                          "addr add 192.0.2.10/24 brd + dev wtbr-eth0\n"
+                          "route replace default via 192.0.2.1 dev wtbr-eth0 metric 100\n",
+                          script, "Uplink and its addressing move into the bridge");
+
+    TEST_ASSERT(bridge_render_dissolve("wtbr-eth0", "eth0", &l3, script, sizeof(script)) > 0,
+                "Dissolve batch rendered");
+    TEST_ASSERT_EQUAL_STR("link set eth0 nomaster\n"
+                          "link del wtbr-eth0\n"
+                          "addr add 192.0.2.10/24 brd + dev eth0\n"
+                          "route replace default via 192.0.2.1 dev eth0 metric 100\n",
+                          script, "Addressing moves back to the uplink");
+
+    TEST_ASSERT_EQUAL_INT(0, (int)bridge_render_create("wtbr-eth0", "eth0", "wlan0", NULL, &l3,
+                                                       script, 40),
+                          "Short buffer rejected");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT,
+                          bridge_engine_attach("wlan0", "wlan0", NULL, 0),
+                          "AP cannot be its own uplink");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT,
+                          bridge_engine_attach("wlan0", "eth0 type bridge", NULL, 0),
+                          "Uplink cannot inject batch commands");
+}
+
+static bool ip_run(const char *a, const char *b, const char *c, const char *d, const char *e,
+                   const char *f, const char *g) {
+    char *const args[] = {"ip", (char *)a, (char *)b, (char *)c, (char *)d, (char *)e,
+                          (char *)f, (char *)g, NULL};
+    return safe_exec_command("ip", args) == 0;
+}
+
+// Does the output of `ip <words...>` contain needle?
+static bool ip_shows(const char *needle, const char *a, const char *b, const char *c,
+                     const char *d, const char *e) {
+    char *const args[] = {"ip", (char *)a, (char *)b, (char *)c, (char *)d, (char *)e, NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("ip", args, &output)) {
+        return false;
+    }
+    bool found = strstr(output.out, needle) != NULL;
+    safe_exec_output_free(&output);
+    return found;
+}
+
+// Save a bridged hotspot on wtap0 in a scratch context and delete it
+static void delete_bridged_hotspot(void) {
+    char dir[] = "/tmp/wterm-bridge-XXXXXX";
+    char path[sizeof(dir) + 32];
+    TEST_ASSERT(mkdtemp(dir) != NULL, "Config directory created");
+    snprintf(path, sizeof(path), "%s/bridged.conf", dir);
+
+    FILE *file = fopen(path, "w");
+    if (file) {
+        fprintf(file, "name=bridged\nssid=bridged\nwifi_interface=wtap0\n"
+                      "internet_interface=wtup0\ngateway_ip=10.42.0.1\nshare_method=%d\n",
+                HOTSPOT_SHARE_BRIDGE);
+        fclose(file);
+    }
+
+    wterm_ctx_t *ctx = wterm_ctx_create();
+    TEST_ASSERT_NOT_NULL(ctx, "Context created");
+    if (!ctx) {
+        return;
+    }
+    snprintf(ctx->hotspot_config_dir, sizeof(ctx->hotspot_config_dir), "%s", dir);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, hotspot_manager_init_ctx(ctx), "Context initialized");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, hotspot_delete_config_ctx(ctx, "bridged"),
+                          "Bridged hotspot deleted");
+    TEST_ASSERT(access(path, F_OK) != 0, "Config removed");
+
+    wterm_ctx_destroy(ctx);
+    rmdir(dir);
+}
+
+// Runs in a forked child inside the namespace; nonzero if a check failed
+static int run_netns_checks(void) {
+    bool ok = ip_run("link", "add", "wtap0", "type", "veth", "peer", "wtap0p") &&
+              ip_run("link", "add", "wtap1", "type", "veth", "peer", "wtap1p") &&
+              ip_run("link", "add", "wtup0", "type", "veth", "peer", "wtup0p") &&
+              ip_run("link", "set", "wtup0", "up", NULL, NULL, NULL) &&
+              ip_run("link", "set", "wtup0p", "up", NULL, NULL, NULL) &&
+              ip_run("addr", "add", "192.0.2.10/24", "dev", "wtup0", NULL, NULL) &&
+              ip_run("route", "add", "default", "via", "192.0.2.1", "metric", "50");
+    TEST_ASSERT(ok, "Stand-in interfaces created");
+    if (!ok) {
+        return test_finish();
+    }
+
+    char bridge[MAX_STR_INTERFACE] = {0};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          bridge_engine_attach("wtap0", "wtup0", bridge, sizeof(bridge)),
+                          "AP bridged to the uplink");
+    TEST_ASSERT_EQUAL_STR("wtbr-wtup0", bridge, "Bridge created for the uplink");
+    TEST_ASSERT(ip_shows("master wtbr-wtup0", "-o", "link", "show", "dev", "wtap0"),
+                "AP is a bridge port");
+    TEST_ASSERT(ip_shows("master wtbr-wtup0", "-o", "link", "show", "dev", "wtup0"),
+                "Uplink is a bridge port");
+    TEST_ASSERT(ip_shows("192.0.2.10/24", "-o", "addr", "show", "dev", "wtbr-wtup0"),
+                "Address moved to the bridge");
+    TEST_ASSERT(!ip_shows("inet ", "-o", "-4", "addr", "show", "wtup0"),
+                "Uplink has no address left");
+    TEST_ASSERT(ip_shows("default via 192.0.2.1 dev wtbr-wtup0", "route", "show", "default",
+                         NULL, NULL),
+                "Default route moved to the bridge");
+    TEST_ASSERT(ip_shows("metric 50", "route", "show", "default", NULL, NULL),
+                "Route metric kept");
+
+    // A second AP joins the existing bridge; detaching it leaves the bridge
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          bridge_engine_attach("wtap1", "wtup0", bridge, sizeof(bridge)),
+                          "Second AP bridged");
+    TEST_ASSERT_EQUAL_STR("wtbr-wtup0", bridge, "Existing bridge reused");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, bridge_engine_detach("wtap1"), "Second AP detached");
+    TEST_ASSERT(!ip_shows("master", "-o", "link", "show", "dev", "wtap1"),
+                "Second AP left the bridge");
+    TEST_ASSERT(ip_shows("wtbr-wtup0", "-o", "link", "show", "wtbr-wtup0", NULL),
+                "Bridge kept for the first AP");
+
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, bridge_engine_detach("wtap0"), "Last AP detached");
+    TEST_ASSERT(!ip_shows("wtbr", "-o", "link", "show", NULL, NULL), "Bridge deleted");
+    TEST_ASSERT(ip_shows("192.0.2.10/24", "-o", "addr", "show", "dev", "wtup0"),
+                "Address back on the uplink");
+    TEST_ASSERT(ip_shows("default via 192.0.2.1 dev wtup0 metric 50", "route", "show",
+                         "default", NULL, NULL),
+                "Default route back on the uplink");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, bridge_engine_detach("wtap0"),
+                          "Detaching an unbridged AP is a no-op");
+
+    // An uplink that already is a bridge is used as it is
+    ok = ip_run("link", "add", "br9", "type", "bridge", NULL, NULL);
+    TEST_ASSERT(ok, "Host bridge created");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          bridge_engine_attach("wtap0", "br9", bridge, sizeof(bridge)),
+                          "AP joins the host bridge");
+    TEST_ASSERT_EQUAL_STR("br9", bridge, "Host bridge used");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, bridge_engine_detach("wtap0"), "AP detached");
+    TEST_ASSERT(ip_shows("br9", "-o", "link", "show", "br9", NULL),
+                "Host bridge is not wterm's to delete");
+
+    // Deleting a running bridged hotspot dissolves its bridge first
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          bridge_engine_attach("wtap0", "wtup0", bridge, sizeof(bridge)),
+                          "AP bridged again");
+    delete_bridged_hotspot();
+    TEST_ASSERT(!ip_shows("wtbr", "-o", "link", "show", NULL, NULL),
+                "Deleted hotspot's bridge dissolved");
+    TEST_ASSERT(ip_shows("192.0.2.10/24", "-o", "addr", "show", "dev", "wtup0"),
+                "Address back on the uplink after delete");
+    TEST_ASSERT(ip_shows("default via 192.0.2.1 dev wtup0", "route", "show", "default",
+                         NULL, NULL),
+                "Default route back on the uplink after delete");
+
+    return test_finish();
+}
+
+static void test_netns(void) {
+    test_section("Bridges in a private network namespace");
+
+    if (!capability_available(CAPABILITY_IP)) {
+        printf("SKIP: ip is not installed\n");
+        return;
+    }
+    test_run_in_netns(run_netns_checks);
+}
+
+int main(void) {
+    test_init("Bridge Engine");
+
+    test_parse();
+    test_render();
+    test_netns();
+
+    return test_finish();
+}
@@ -0,0 +1,212 @@
+/**
+ * @file test_context.c
+ * @brief Tests for isolated wterm contexts
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "test_utils.h"
+#include "../src/core/context.h"
+#include "../src/core/connection.h"
+#include "../src/core/hotspot_manager.h"
+#include "../src/core/network_backends/backend_interface.h"
+#include "../src/utils/nm_keyfile.h"
+#include "../src/utils/string_utils.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define WORKERS 4
+#define WORKER_ROUNDS 50
+
+static void write_hotspot(const char *dir, const char *name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.conf", dir, name);
+    FILE *file = fopen(path, "w");
+    if (file) {
+        fprintf(file, "name=%s\nssid=%s-ssid\nwifi_interface=wlan0\ngateway_ip=10.42.0.1\n",
+                name, name);
+        fclose(file);
+    }
+}
+
+static void remove_hotspot_dir(const char *dir, const char *name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.conf", dir, name);
+    unlink(path);
+    rmdir(dir);
+}
+
+static wterm_ctx_t *create_ctx(char *dir, const char *hotspot) {
+    if (!mkdtemp(dir)) {
+        return NULL;
+    }
+    write_hotspot(dir, hotspot);
+
+    wterm_ctx_t *ctx = wterm_ctx_create();
+    if (ctx) {
+        snprintf(ctx->hotspot_config_dir, sizeof(ctx->hotspot_config_dir), "%s", dir);
+    }
+    return ctx;
+}
+
+static void test_isolated_hotspots(void) {
+    test_section("Hotspot state per context");
+
+    char dir_a[] = "/tmp/wterm-ctx-a-XXXXXX";
+    char dir_b[] = "/tmp/wterm-ctx-b-XXXXXX";
+    wterm_ctx_t *a = create_ctx(dir_a, "alpha");
+    wterm_ctx_t *b = create_ctx(dir_b, "beta");
+    TEST_ASSERT(a && b, "Contexts created");
+    if (!a || !b) {
+        return;
+    }
+
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT, hotspot_list_configs_ctx(a, NULL),
+                          "Listing needs an initialized context");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, hotspot_manager_init_ctx(a), "Context A initialized");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, hotspot_manager_init_ctx(b), "Context B initialized");
+
+    hotspot_list_t list;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, hotspot_list_configs_ctx(a, &list), "A listed");
+    TEST_ASSERT(list.count == 1 && strcmp(list.hotspots[0].name, "alpha") == 0,
+                "A sees only its own hotspot");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, hotspot_list_configs_ctx(b, &list), "B listed");
+    TEST_ASSERT(list.count == 1 && strcmp(list.hotspots[0].name, "beta") == 0,
+                "B sees only its own hotspot");
+
+    hotspot_status_t status;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, hotspot_get_status_ctx(a, "alpha", &status),
+                          "Status of a saved hotspot");
+    TEST_ASSERT_EQUAL_STR("alpha-ssid", status.config.ssid, "Status carries the config");
+
+    // A new configuration is written to its context's directory only
+    hotspot_config_t config;
+    hotspot_get_default_config(&config);
+    safe_string_copy(config.name, "gamma", sizeof(config.name));
+    safe_string_copy(config.ssid, "gamma-ssid", sizeof(config.ssid));
+    safe_string_copy(config.password, "password123", sizeof(config.password));
+    safe_string_copy(config.wifi_interface, "wlan0", sizeof(config.wifi_interface));
+    config.is_5ghz = false;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, hotspot_create_config_ctx(a, &config), "Created in A");
+    hotspot_list_configs_ctx(a, &list);
+    TEST_ASSERT_EQUAL_INT(2, list.count, "A lists the new hotspot");
+    hotspot_list_configs_ctx(b, &list);
+    TEST_ASSERT_EQUAL_INT(1, list.count, "B is unaffected");
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/gamma.conf", dir_a);
+    TEST_ASSERT(access(path, F_OK) == 0, "Saved under A's directory");
+    unlink(path);
+
+    wterm_ctx_destroy(a);
+    wterm_ctx_destroy(b);
+    remove_hotspot_dir(dir_a, "alpha");
+    remove_hotspot_dir(dir_b, "beta");
+}
+
+static void test_isolated_cancel(void) {
+    test_section("Connection cancellation per context");
+
+    wterm_ctx_t *a = wterm_ctx_create();
+    wterm_ctx_t *b = wterm_ctx_create();
+    TEST_ASSERT(a && b, "Contexts created");
+    if (!a || !b) {
+        return;
+    }
+
+    init_connection_cancel_ctx(a);
+    init_connection_cancel_ctx(b);
+    init_connection_cancel();
+    request_connection_cancel_ctx(a);
+    TEST_ASSERT(is_connection_cancelled_ctx(a), "A cancelled");
+    TEST_ASSERT(!is_connection_cancelled_ctx(b), "B still running");
+    TEST_ASSERT(!is_connection_cancelled(), "Default context still running");
+
+    init_connection_cancel_ctx(a);
+    TEST_ASSERT(!is_connection_cancelled_ctx(a), "Re-initialized attempt not cancelled");
+
+    TEST_ASSERT(get_current_backend_ctx(a) == get_current_backend(),
+                "Contexts share the backend selection");
+
+    wterm_ctx_destroy(a);
+    wterm_ctx_destroy(b);
+}
+
+typedef struct {
+    wterm_ctx_t *ctx;
+    char name[16];
+    int failures;
+} worker_t;
+
+static void *worker_main(void *arg) {
+    worker_t *worker = arg;
+    for (int i = 0; i < WORKER_ROUNDS; i++) {
+        hotspot_list_t list;
+        hotspot_status_t status;
+        if (hotspot_list_configs_ctx(worker->ctx, &list) != WTERM_SUCCESS ||
+            list.count != 1 || strcmp(list.hotspots[0].name, worker->name) != 0) {
+            worker->failures++;
+        }
+        if (hotspot_get_status_ctx(worker->ctx, worker->name, &status) != WTERM_SUCCESS) {
+            worker->failures++;
+        }
+        request_connection_cancel_ctx(worker->ctx);
+        if (!is_connection_cancelled_ctx(worker->ctx)) {
+            worker->failures++;
+        }
+        init_connection_cancel_ctx(worker->ctx);
+    }
+    return NULL;
+}
+
+static void test_parallel_workers(void) {
+    test_section("Parallel workers with a context each");
+
+    char dirs[WORKERS][32];
+    worker_t workers[WORKERS];
+    pthread_t threads[WORKERS];
+    int started = 0;
+
+    for (int i = 0; i < WORKERS; i++) {
+        snprintf(dirs[i], sizeof(dirs[i]), "/tmp/wterm-ctx-%d-XXXXXX", i);
+        snprintf(workers[i].name, sizeof(workers[i].name), "worker%d", i);
+        workers[i].failures = 0;
+        workers[i].ctx = create_ctx(dirs[i], workers[i].name);
+        if (workers[i].ctx && hotspot_manager_init_ctx(workers[i].ctx) == WTERM_SUCCESS &&
+            pthread_create(&threads[i], NULL, worker_main, &workers[i]) == 0) {
+            started++;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(WORKERS, started, "Workers started");
+
+    int failures = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        failures += workers[i].failures;
+    }
+    TEST_ASSERT_EQUAL_INT(0, failures, "Every worker saw only its own state");
+
+    for (int i = 0; i < WORKERS; i++) {
+        wterm_ctx_destroy(workers[i].ctx);
+        remove_hotspot_dir(dirs[i], workers[i].name);
+    }
+}
+
+int main(void) {
+    test_init("Context");
+
+    // Keep external hotspot discovery away from the system's profiles
+    char keyfiles[] = "/tmp/wterm-ctx-keyfiles-XXXXXX";
+    if (mkdtemp(keyfiles)) {
+        setenv(NM_KEYFILE_DIR_ENV, keyfiles, 1);
+    }
+
+    test_isolated_hotspots();
+    test_isolated_cancel();
+    test_parallel_workers();
+
+    rmdir(keyfiles);
+    return test_finish();
+}
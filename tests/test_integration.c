@@ -66,8 +66,7 @@ static void test_network_list_with_original_data(void) {
     test_section("Testing Network List with Original Data");
 
     // This simulates what would happen if we had the original nmcli output
-    network_list_t network_list;
-    network_list.count = 0;
+    network_list_t network_list = {0};
 
     const char *original_nmcli_output[] = {
         "POCO F4::89",
@@ -77,13 +76,16 @@ static void test_network_list_with_original_data(void) {
     };
 
     // Manually parse each line (simulating what scan_wifi_networks does)
-    for (int i = 0; i < 4 && network_list.count < MAX_NETWORKS; i++) {
+    for (int i = 0; i < 4; i++) {
         network_info_t network;
         wterm_result_t result = parse_network_line(original_nmcli_output[i], &network);
 
         if (result == WTERM_SUCCESS) {
-            network_list.networks[network_list.count] = network;
-            network_list.count++;
+            network_info_t *entry = network_list_append(&network_list);
+            TEST_ASSERT_NOT_NULL(entry, "Append should succeed");
+            if (entry) {
+                *entry = network;
+            }
         }
     }
 
@@ -101,6 +103,8 @@ static void test_network_list_with_original_data(void) {
 
     TEST_ASSERT(poco_f4_found, "POCO F4 network should be found in the list");
     printf("✓ POCO F4 network is now included in network list (bug fixed!)\n");
+
+    network_list_free(&network_list);
 }
 
 static void test_memory_safety_validation(void) {
@@ -0,0 +1,154 @@
+/**
+ * @file test_link_watcher.c
+ * @brief Tests for the rtnetlink link and address watcher
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../src/utils/capability.h"
+#include "../src/utils/link_watcher.h"
+#include "../src/utils/safe_exec.h"
+#include "test_utils.h"
+
+static long elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+static void test_initial_state(void) {
+    test_section("Initial state from the rtnetlink dump");
+
+    link_watcher_t watcher;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, link_watcher_open(&watcher, "lo"),
+                          "Watching lo should succeed");
+    TEST_ASSERT(watcher.ifindex > 0, "Interface index should be resolved");
+
+    // Loopback reports operstate UNKNOWN with carrier, and owns 127.0.0.1
+    TEST_ASSERT_EQUAL_INT(LINK_PHASE_CONFIGURED, link_watcher_phase(&watcher),
+                          "lo should be up with an IPv4 address");
+    link_watcher_close(&watcher);
+    TEST_ASSERT_EQUAL_INT(-1, watcher.fd, "Close should reset the descriptor");
+
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INTERFACE,
+                          link_watcher_open(&watcher, "wterm-no-such0"),
+                          "Missing interface should be reported");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT, link_watcher_open(&watcher, ""),
+                          "Empty name should be rejected");
+}
+
+static void test_wait(void) {
+    test_section("Waiting for changes");
+
+    link_watcher_t watcher;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, link_watcher_open(&watcher, "lo"),
+                          "Watching lo should succeed");
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_TIMEOUT, link_watcher_wait(&watcher, 100, -1),
+                          "Idle interface should time out");
+    TEST_ASSERT(elapsed_ms(&start) >= 90, "Wait returned before the timeout");
+
+    int cancel_pipe[2];
+    TEST_ASSERT(pipe(cancel_pipe) == 0, "pipe() failed");
+    TEST_ASSERT(write(cancel_pipe[1], "x", 1) == 1, "write() failed");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_CANCELLED,
+                          link_watcher_wait(&watcher, 5000, cancel_pipe[0]),
+                          "Cancel descriptor should abort the wait");
+    TEST_ASSERT(elapsed_ms(&start) < 1000, "Cancellation should be immediate");
+    close(cancel_pipe[0]);
+    close(cancel_pipe[1]);
+
+    link_watcher_close(&watcher);
+}
+
+static bool ip_run(const char *a, const char *b, const char *c, const char *d, const char *e,
+                   const char *f, const char *g, const char *h) {
+    char *const args[] = {"ip", (char *)a, (char *)b, (char *)c, (char *)d, (char *)e,
+                          (char *)f, (char *)g, (char *)h, NULL};
+    return safe_exec_command("ip", args) == 0;
+}
+
+// Wait for a neighbour change, then let the rest of its burst pass
+static wterm_result_t wait_neighbour_burst(link_watcher_t *watcher, int timeout_ms) {
+    wterm_result_t result = link_watcher_wait_neighbours(watcher, timeout_ms, -1);
+    while (result == WTERM_SUCCESS &&
+           link_watcher_wait_neighbours(watcher, 100, -1) == WTERM_SUCCESS) {
+    }
+    return result;
+}
+
+// Runs in a forked child inside the namespace; nonzero if a check failed
+static int run_neighbour_checks(void) {
+    bool ok = ip_run("link", "add", "wtnb0", "type", "veth", "peer", "wtnb0p", NULL) &&
+              ip_run("link", "set", "wtnb0", "up", NULL, NULL, NULL, NULL) &&
+              ip_run("link", "set", "wtnb0p", "up", NULL, NULL, NULL, NULL);
+    TEST_ASSERT(ok, "Stand-in interface created");
+    if (!ok) {
+        return test_finish();
+    }
+
+    link_watcher_t watcher;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, link_watcher_open(&watcher, "wtnb0"),
+                          "Watching the stand-in should succeed");
+    wterm_result_t result = wait_neighbour_burst(&watcher, 100);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_TIMEOUT, result, "No neighbours, no change");
+
+    TEST_ASSERT(ip_run("neigh", "replace", "192.0.2.7", "lladdr", "02:00:00:00:00:07",
+                       "dev", "wtnb0", NULL),
+                "Neighbour added");
+    result = wait_neighbour_burst(&watcher, 2000);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result, "New neighbour reported");
+
+    TEST_ASSERT(ip_run("neigh", "del", "192.0.2.7", "dev", "wtnb0", NULL, NULL, NULL),
+                "Neighbour removed");
+    result = wait_neighbour_burst(&watcher, 2000);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result, "Removed neighbour reported");
+
+    // Neighbours of other interfaces do not count
+    TEST_ASSERT(ip_run("neigh", "replace", "192.0.2.8", "lladdr", "02:00:00:00:00:08",
+                       "dev", "wtnb0p", NULL),
+                "Peer neighbour added");
+    result = wait_neighbour_burst(&watcher, 200);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_TIMEOUT, result, "Other interface ignored");
+    link_watcher_close(&watcher);
+
+    return test_finish();
+}
+
+static void test_neighbours(void) {
+    test_section("Neighbour events in a private network namespace");
+
+    if (!capability_available(CAPABILITY_IP)) {
+        printf("SKIP: ip is not installed\n");
+        return;
+    }
+    test_run_in_netns(run_neighbour_checks);
+}
+
+static void test_phase_names(void) {
+    test_section("Phase names");
+
+    TEST_ASSERT_EQUAL_STR("not associated", link_phase_name(LINK_PHASE_DOWN),
+                          "Down phase name wrong");
+    TEST_ASSERT(strstr(link_phase_name(LINK_PHASE_ASSOCIATED), "IPv4") != NULL,
+                "Associated phase should mention the missing address");
+    TEST_ASSERT_EQUAL_INT(LINK_PHASE_DOWN, link_watcher_phase(NULL),
+                          "NULL watcher should be down");
+}
+
+int main(void) {
+    test_init("Link Watcher Tests");
+
+    test_initial_state();
+    test_wait();
+    test_neighbours();
+    test_phase_names();
+
+    return test_finish();
+}
@@ -0,0 +1,286 @@
+/**
+ * @file test_nat_engine.c
+ * @brief Tests for the hotspot NAT rule engine
+ *
+ * Rendering is checked everywhere. When nft or iptables-restore is
+ * installed, the rules are also loaded into a private network namespace,
+ * so the host's firewall is never touched.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "test_utils.h"
+#include "../src/core/nat_engine.h"
+#include "../src/utils/capability.h"
+#include "../src/utils/safe_exec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void test_rules_init(void) {
+    test_section("Rule description");
+
+    nat_rules_t rules;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nat_rules_init(&rules, "wlan0", "eth0", "10.42.0.1"),
+                          "Valid rules accepted");
+    TEST_ASSERT_EQUAL_STR("10.42.0.0/24", rules.subnet, "Gateway mapped to its /24");
+    TEST_ASSERT_EQUAL_STR("eth0", rules.uplink_iface, "Uplink kept");
+
+    nat_rules_init(&rules, "wlan0", "eth0", "192.168.12.77");
+    TEST_ASSERT_EQUAL_STR("192.168.12.0/24", rules.subnet, "Host bits cleared");
+
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nat_rules_init(&rules, "wlan0", NULL, NULL),
+                          "Interface alone is enough for removal");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT,
+                          nat_rules_init(&rules, "wlan0", "eth0", "not-an-ip"),
+                          "Bad gateway rejected");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT,
+                          nat_rules_init(&rules, "wlan0\n-F", "eth0", "10.42.0.1"),
+                          "Interface cannot inject script lines");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT,
+                          nat_rules_init(&rules, "wlan0", "eth0 -j DROP", "10.42.0.1"),
+                          "Uplink cannot inject arguments");
+}
+
+static void test_render(void) {
+    test_section("Rendered iptables-restore scripts");
+
+    nat_rules_t rules;
+    nat_rules_init(&rules, "wlan0", "eth0", "10.42.0.1");
+    char script[2048];
+
+    TEST_ASSERT(nat_render_apply(&rules, script, sizeof(script)) > 0, "Apply script rendered");
+    TEST_ASSERT_EQUAL_STR(
+        "*filter\n"
+        ":WTERM-FWD-wlan0 - [0:0]\n"
+        "-A FORWARD -m comment --comment wterm:wlan0 -j WTERM-FWD-wlan0\n"
+        "-A WTERM-FWD-wlan0 -i wlan0 -o eth0 -s 10.42.0.0/24 -j ACCEPT\n"
+        "-A WTERM-FWD-wlan0 -i eth0 -o wlan0 -d 10.42.0.0/24"
+        " -m conntrack --ctstate RELATED,ESTABLISHED -j ACCEPT\n"
+        "COMMIT\n"
+        "*nat\n"
+        ":WTERM-NAT-wlan0 - [0:0]\n"
+        "-A POSTROUTING -m comment --comment wterm:wlan0 -j WTERM-NAT-wlan0\n"
+        "-A WTERM-NAT-wlan0 -s 10.42.0.0/24 ! -d 10.42.0.0/24 -o eth0 -j MASQUERADE\n"
+        "COMMIT\n",
+        script, "Apply script");
+
+    TEST_ASSERT(nat_render_remove(&rules, "nat", script, sizeof(script)) > 0,
+                "Remove script rendered");
+    TEST_ASSERT_EQUAL_STR("*nat\n"
+                          "-D POSTROUTING -m comment --comment wterm:wlan0 -j WTERM-NAT-wlan0\n"
+                          "-F WTERM-NAT-wlan0\n"
+                          "-X WTERM-NAT-wlan0\n"
+                          "COMMIT\n",
+                          script, "Remove script for the nat table");
+    TEST_ASSERT_EQUAL_INT(0, (int)nat_render_remove(&rules, "raw", script, sizeof(script)),
+                          "Unknown table rejected");
+    TEST_ASSERT_EQUAL_INT(0, (int)nat_render_apply(&rules, script, 64),
+                          "Short buffer rejected");
+
+    nat_rules_init(&rules, "wlan0", NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(0, (int)nat_render_apply(&rules, script, sizeof(script)),
+                          "Apply needs an uplink");
+}
+
+static void test_render_nft(void) {
+    test_section("Rendered nft batch");
+
+    nat_rules_t rules;
+    nat_rules_init(&rules, "wlan0", "eth0", "10.42.0.1");
+    char script[2048];
+
+    TEST_ASSERT(nat_render_nft(&rules, script, sizeof(script)) > 0, "Batch rendered");
+    TEST_ASSERT_EQUAL_STR(
+        "table ip wterm-wlan0\n"
+        "delete table ip wterm-wlan0\n"
+        "table ip wterm-wlan0 {\n"
+        "  chain forward {\n"
+        "    type filter hook forward priority 0; policy accept;\n"
+        "    iifname \"wlan0\" oifname \"eth0\" ip saddr 10.42.0.0/24 accept\n"
+        "    iifname \"eth0\" oifname \"wlan0\" ip daddr 10.42.0.0/24"
+        " ct state related,established accept\n"
+        "  }\n"
+        "  chain postrouting {\n"
+        "    type nat hook postrouting priority 100; policy accept;\n"
+        "    oifname \"eth0\" ip saddr 10.42.0.0/24 ip daddr != 10.42.0.0/24 masquerade\n"
+        "  }\n"
+        "}\n",
+        script, "One table per hotspot, replaced as a whole");
+    TEST_ASSERT_EQUAL_INT(0, (int)nat_render_nft(&rules, script, 128), "Short buffer rejected");
+
+    rules.flowtable = true;
+    TEST_ASSERT(nat_render_nft(&rules, script, sizeof(script)) > 0, "Fast path batch rendered");
+    TEST_ASSERT_NOT_NULL(strstr(script, "  flowtable fastpath {\n"
+                                        "    hook ingress priority 0;"
+                                        " devices = { \"wlan0\", \"eth0\" };\n"
+                                        "  }\n"
+                                        "  chain forward {\n"),
+                         "Flowtable over both interfaces, before the chains");
+    TEST_ASSERT_NOT_NULL(strstr(script, "ip saddr 10.42.0.0/24"
+                                        " meta l4proto { tcp, udp } flow add @fastpath accept\n"),
+                         "Outbound flows offloaded");
+    TEST_ASSERT_EQUAL_INT(0, (int)nat_render_nft(&rules, script, 300),
+                          "Short buffer rejected with a flowtable");
+    rules.flowtable = false;
+
+    nat_rules_init(&rules, "wlan0", NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(0, (int)nat_render_nft(&rules, script, sizeof(script)),
+                          "Batch needs an uplink");
+}
+
+static int count_in_table(const char *table, const char *needle) {
+    char *const args[] = {"iptables-save", "-t", (char *)table, NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("iptables-save", args, &output)) {
+        return -1;
+    }
+    int count = 0;
+    for (const char *p = output.out; (p = strstr(p, needle)) != NULL; p++) {
+        count++;
+    }
+    safe_exec_output_free(&output);
+    return count;
+}
+
+static bool restore_script(const char *script) {
+    char *const args[] = {"iptables-restore", "--noflush", NULL};
+    safe_exec_options_t options = {.input = script, .input_len = strlen(script)};
+    safe_exec_output_t output;
+    if (safe_exec_capture_ex("iptables-restore", args, &options, &output) != WTERM_SUCCESS) {
+        return false;
+    }
+    bool ok = output.exit_code == 0;
+    safe_exec_output_free(&output);
+    return ok;
+}
+
+static int count_in_nft_table(const char *needle) {
+    char *const args[] = {"nft", "list", "table", "ip", "wterm-wlan0", NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("nft", args, &output)) {
+        return -1;
+    }
+    int count = 0;
+    for (const char *p = output.out; output.exit_code == 0 && (p = strstr(p, needle)); p++) {
+        count++;
+    }
+    safe_exec_output_free(&output);
+    return count;
+}
+
+// The checks below run in a forked child inside the namespace and return
+// nonzero if one failed
+static int run_nft_checks(void) {
+    nat_rules_t rules;
+    nat_rules_init(&rules, "wlan0", "eth0", "10.42.0.1");
+
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nat_engine_apply_backend(NAT_BACKEND_NFTABLES, &rules),
+                          "Table loaded");
+    TEST_ASSERT_EQUAL_INT(1, count_in_nft_table("masquerade"), "Masquerade rule");
+    TEST_ASSERT_EQUAL_INT(2, count_in_nft_table(" accept\n"), "Both forward rules");
+
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nat_engine_apply_backend(NAT_BACKEND_NFTABLES, &rules),
+                          "Table reloaded");
+    TEST_ASSERT_EQUAL_INT(1, count_in_nft_table("masquerade"),
+                          "Reloading replaces the table's rules");
+
+    // Flowtable devices must exist; the namespace starts with only lo
+    char *const hotspot_args[] = {"ip", "link", "add", "wlan0", "type", "dummy", NULL};
+    char *const uplink_args[] = {"ip", "link", "add", "eth0", "type", "dummy", NULL};
+    if (safe_exec_command("ip", hotspot_args) == 0 && safe_exec_command("ip", uplink_args) == 0) {
+        rules.flowtable = true;
+        TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                              nat_engine_apply_backend(NAT_BACKEND_NFTABLES, &rules),
+                              "Table with a flowtable loaded");
+        TEST_ASSERT_EQUAL_INT(1, count_in_nft_table("flow add @fastpath"), "Offload rule");
+    }
+
+    nat_rules_t removal;
+    nat_rules_init(&removal, "wlan0", NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          nat_engine_remove_backend(NAT_BACKEND_NFTABLES, &removal),
+                          "Table deleted");
+    TEST_ASSERT_EQUAL_INT(0, count_in_nft_table("wterm"), "Table gone");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_NETWORK,
+                          nat_engine_remove_backend(NAT_BACKEND_NFTABLES, &removal),
+                          "Deleting again reports nothing to remove");
+
+    return test_finish();
+}
+
+static int run_iptables_checks(void) {
+    nat_rules_t rules;
+    nat_rules_init(&rules, "wlan0", "eth0", "10.42.0.1");
+
+    TEST_ASSERT(restore_script("*filter\n-A FORWARD -i other0 -j DROP\nCOMMIT\n"),
+                "Unrelated rule added");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nat_engine_apply_backend(NAT_BACKEND_IPTABLES, &rules), "Rules applied");
+    TEST_ASSERT_EQUAL_INT(1, count_in_table("filter", "-j WTERM-FWD-wlan0"),
+                          "One FORWARD jump");
+    TEST_ASSERT_EQUAL_INT(2, count_in_table("filter", "-A WTERM-FWD-wlan0 "),
+                          "Both forward rules");
+    TEST_ASSERT_EQUAL_INT(1, count_in_table("nat", "-j MASQUERADE"), "Masquerade rule");
+
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nat_engine_apply_backend(NAT_BACKEND_IPTABLES, &rules), "Rules re-applied");
+    TEST_ASSERT_EQUAL_INT(1, count_in_table("filter", "-j WTERM-FWD-wlan0"),
+                          "Re-applying does not duplicate the jump");
+    TEST_ASSERT_EQUAL_INT(1, count_in_table("nat", "-j MASQUERADE"),
+                          "Re-applying does not duplicate the masquerade");
+
+    nat_rules_t removal;
+    nat_rules_init(&removal, "wlan0", NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nat_engine_remove_backend(NAT_BACKEND_IPTABLES, &removal), "Rules removed");
+    TEST_ASSERT_EQUAL_INT(0, count_in_table("filter", "WTERM"), "Filter table clean");
+    TEST_ASSERT_EQUAL_INT(0, count_in_table("nat", "WTERM"), "NAT table clean");
+    TEST_ASSERT_EQUAL_INT(1, count_in_table("filter", "-i other0 -j DROP"),
+                          "Unrelated rule untouched");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_NETWORK, nat_engine_remove_backend(NAT_BACKEND_IPTABLES, &removal),
+                          "Removing again reports nothing to remove");
+
+    return test_finish();
+}
+
+static void test_netns(void) {
+    test_section("nftables rules in a private network namespace");
+    if (capability_available(CAPABILITY_NFT)) {
+        test_run_in_netns(run_nft_checks);
+    } else {
+        printf("SKIP: nft is not installed\n");
+    }
+
+    test_section("iptables rules in a private network namespace");
+    if (capability_available(CAPABILITY_IPTABLES_RESTORE) &&
+        capability_resolve("iptables-save", NULL, 0)) {
+        test_run_in_netns(run_iptables_checks);
+    } else {
+        printf("SKIP: iptables-restore is not installed\n");
+    }
+}
+
+static void test_backend_selection(void) {
+    test_section("Backend selection");
+
+    nat_backend_t expected = capability_available(CAPABILITY_NFT) ? NAT_BACKEND_NFTABLES
+                             : capability_available(CAPABILITY_IPTABLES_RESTORE)
+                                 ? NAT_BACKEND_IPTABLES
+                                 : NAT_BACKEND_NONE;
+    TEST_ASSERT_EQUAL_INT(expected, nat_engine_backend(), "nft preferred over iptables");
+
+    nat_rules_t rules;
+    nat_rules_init(&rules, "wlan0", "eth0", "10.42.0.1");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_NETWORK, nat_engine_apply_backend(NAT_BACKEND_NONE, &rules),
+                          "No backend, no rules");
+}
+
+int main(void) {
+    test_init("NAT Engine");
+
+    test_rules_init();
+    test_render();
+    test_render_nft();
+    test_backend_selection();
+    test_netns();
+
+    return test_finish();
+}
@@ -3,10 +3,21 @@
  * @brief Unit tests for network scanner functionality
  */
 
+#define _POSIX_C_SOURCE 200809L
 #include "test_utils.h"
 #include "../src/core/network_scanner.h"
+#include "../src/core/scan_worker.h"
+#include "../src/utils/arena.h"
+#include "../src/utils/nl80211_helper.h"
+#include "../src/utils/network_list.h"
+#include "../src/utils/scan_cache.h"
 #include "../include/wterm/common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 static void test_parse_network_line(void) {
     test_section("Testing parse_network_line");
@@ -87,11 +98,7 @@ static void test_network_parsing_edge_cases(void) {
 static void test_network_list_initialization(void) {
     test_section("Testing network list operations");
 
-    network_list_t network_list;
-
-    // Initialize and verify clean state
-    network_list.count = -1; // Set to invalid value
-    memset(network_list.networks, 0xFF, sizeof(network_list.networks)); // Fill with junk
+    network_list_t network_list = {0};
 
     // The scan function should initialize properly
     // Note: This test might fail if nmcli is not available, which is expected
@@ -101,7 +108,7 @@ static void test_network_list_initialization(void) {
     // We don't test the specific result since nmcli might not be available in test environment
     // But we test that the structure is properly initialized
     TEST_ASSERT(network_list.count >= 0, "Network count should be non-negative");
-    TEST_ASSERT(network_list.count <= MAX_NETWORKS, "Network count within limits");
+    TEST_ASSERT(network_list.count <= network_list.capacity, "Network count within capacity");
 
     if (network_list.count > 0) {
         // Test that first network has been properly initialized
@@ -109,6 +116,436 @@ static void test_network_list_initialization(void) {
         TEST_ASSERT(strlen(network_list.networks[0].security) < MAX_STR_SECURITY, "First network security length");
         TEST_ASSERT(strlen(network_list.networks[0].signal) < MAX_STR_SIGNAL, "First network signal length");
     }
+
+    network_list_free(&network_list);
+    TEST_ASSERT_NULL(network_list.networks, "Free should reset the list");
+    TEST_ASSERT_EQUAL_INT(0, network_list.count, "Free should reset the count");
+}
+
+static void test_network_list_growth(void) {
+    test_section("Testing network list growth");
+
+    // Dense deployments report far more BSSIDs than the old 32-entry cap
+    const int total = 5000;
+    network_list_t list = {0};
+    bool appended = true;
+    for (int i = 0; i < total && appended; i++) {
+        network_info_t *network = network_list_append(&list);
+        appended = network != NULL;
+        if (network) {
+            snprintf(network->ssid, MAX_STR_SSID, "net-%d", i);
+            scan_record_t record = {.frequency = (uint16_t)(2412 + i % 13 * 5),
+                                    .quality = (uint8_t)(i % 101),
+                                    .max_rate = (uint16_t)i};
+            record.bssid[5] = (uint8_t)i;
+            network_list_set_record(&list, i, &record);
+        }
+    }
+    TEST_ASSERT(appended, "Append should not fail");
+    TEST_ASSERT_EQUAL_INT(total, list.count, "No entries dropped");
+    TEST_ASSERT_EQUAL_STR("net-0", list.networks[0].ssid, "First entry survives growth");
+    TEST_ASSERT_EQUAL_STR("net-4999", list.networks[total - 1].ssid, "Last entry stored");
+
+    // Every column must survive the relocations done while growing
+    bool columns_intact = true;
+    for (int i = 0; i < total; i++) {
+        if (list.quality[i] != i % 101 || list.max_rate[i] != i ||
+            list.frequency[i] != 2412 + i % 13 * 5 || list.bssid[i][5] != (uint8_t)i) {
+            columns_intact = false;
+            break;
+        }
+    }
+    TEST_ASSERT(columns_intact, "Columns preserved across growth");
+
+    // Whole-entry copies carry both the string view and the columns
+    network_list_t copy = {0};
+    TEST_ASSERT_EQUAL_INT(0, network_list_copy_entry(&copy, -1, &list, 42), "Copy appends");
+    TEST_ASSERT_EQUAL_STR("net-42", copy.networks[0].ssid, "Copied string view");
+    TEST_ASSERT_EQUAL_INT(42, copy.quality[0], "Copied quality column");
+    TEST_ASSERT_EQUAL_INT(0, network_list_copy_entry(&copy, 0, &list, 7), "Copy overwrites");
+    TEST_ASSERT_EQUAL_INT(7, copy.max_rate[0], "Overwritten column");
+    network_list_free(&copy);
+
+    // Clearing keeps the first arena block for the next scan
+    network_list_clear(&list);
+    TEST_ASSERT_EQUAL_INT(0, list.count, "Clear empties the list");
+    TEST_ASSERT_EQUAL_INT(1, (int)arena_block_count(list.arena), "Clear keeps one block");
+
+    // A typical scan fits the first block: one allocation in total
+    for (int i = 0; i < 300; i++) {
+        network_list_append(&list);
+    }
+    TEST_ASSERT_EQUAL_INT(300, list.count, "Rescan fills the list again");
+    TEST_ASSERT_EQUAL_INT(1, (int)arena_block_count(list.arena), "Typical scan is one allocation");
+
+    network_list_free(&list);
+    TEST_ASSERT_NULL(list.arena, "Free should release the arena");
+}
+
+static void test_parse_network_record(void) {
+    test_section("Testing parse_network_record");
+
+    network_info_t network;
+    scan_record_t record;
+
+    wterm_result_t result = parse_network_record(
+        "AA\\:BB\\:CC\\:DD\\:EE\\:0F:Cafe\\:Guest:WPA1 WPA2:72:5180 MHz:36:270 Mbit/s",
+        &network, &record);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result, "Escaped record parses");
+    TEST_ASSERT_EQUAL_STR("Cafe:Guest", network.ssid, "SSID with escaped colon");
+    TEST_ASSERT_EQUAL_STR("WPA1 WPA2", network.security, "Security string view");
+    TEST_ASSERT_EQUAL_STR("72", network.signal, "Signal string view");
+    static const uint8_t bssid[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0x0F};
+    TEST_ASSERT(memcmp(bssid, record.bssid, sizeof(bssid)) == 0, "BSSID bytes");
+    TEST_ASSERT_EQUAL_INT(72, record.quality, "Numeric quality");
+    TEST_ASSERT_EQUAL_INT(5180, record.frequency, "Frequency without unit");
+    TEST_ASSERT_EQUAL_INT(36, record.channel, "Channel");
+    TEST_ASSERT_EQUAL_INT(270, record.max_rate, "Rate without unit");
+    TEST_ASSERT_EQUAL_INT(NETWORK_SECURITY_WPA1 | NETWORK_SECURITY_WPA2, record.security_flags,
+                          "Security flags");
+
+    result = parse_network_record("00\\:11\\:22\\:33\\:44\\:55:Lobby::40:2437 MHz:6:54 Mbit/s",
+                                  &network, &record);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result, "Open record parses");
+    TEST_ASSERT_EQUAL_STR("Open", network.security, "Empty security is Open");
+    TEST_ASSERT_EQUAL_INT(0, record.security_flags, "Open network has no flags");
+
+    result = parse_network_record("Lobby::40", &network, &record);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_PARSE, result, "Short line rejected");
+
+    TEST_ASSERT_EQUAL_INT(1, network_frequency_to_channel(2412), "2.4 GHz channel 1");
+    TEST_ASSERT_EQUAL_INT(14, network_frequency_to_channel(2484), "2.4 GHz channel 14");
+    TEST_ASSERT_EQUAL_INT(149, network_frequency_to_channel(5745), "5 GHz channel 149");
+    TEST_ASSERT_EQUAL_INT(5, network_frequency_to_channel(5975), "6 GHz channel 5");
+    TEST_ASSERT_EQUAL_INT(0, network_frequency_to_channel(1000), "Not a WiFi frequency");
+
+    uint8_t parsed[6];
+    TEST_ASSERT(!network_parse_bssid("AA:BB:CC", parsed), "Short BSSID rejected");
+    TEST_ASSERT(!network_parse_bssid("", parsed), "Empty BSSID rejected");
+    TEST_ASSERT(!network_parse_bssid("a", parsed), "Single digit rejected");
+    TEST_ASSERT(!network_parse_bssid("aa:b", parsed), "Truncated octet rejected");
+    TEST_ASSERT(!network_parse_bssid("aa:bb:", parsed), "Trailing separator rejected");
+    TEST_ASSERT(!network_parse_bssid("AA:BB:CC:DD:EE:F", parsed), "Truncated last octet rejected");
+    TEST_ASSERT(!network_parse_bssid("AA:BB:CC:DD:EE:FF:00", parsed), "Long BSSID rejected");
+}
+
+static void test_arena(void) {
+    test_section("Testing arena allocator");
+
+    arena_t *arena = arena_create(256);
+    TEST_ASSERT_NOT_NULL(arena, "Arena creation");
+    if (!arena) {
+        return;
+    }
+
+    char *first = arena_alloc(arena, 10);
+    char *second = arena_alloc(arena, 10);
+    TEST_ASSERT(first && second && second > first, "Sequential allocations");
+    TEST_ASSERT_EQUAL_INT(0, (int)((uintptr_t)second % sizeof(void *)), "Allocations are aligned");
+
+    // Only the most recent allocation grows in place
+    memcpy(second, "abc", 4);
+    TEST_ASSERT(arena_resize(arena, second, 10, 100) == second, "Top allocation grows in place");
+    char *moved = arena_resize(arena, first, 10, 20);
+    TEST_ASSERT(moved && moved != first, "Older allocation is copied");
+
+    // Oversized requests get their own block
+    TEST_ASSERT_NOT_NULL(arena_alloc(arena, 4096), "Oversized allocation");
+    TEST_ASSERT(arena_block_count(arena) >= 2, "Oversized allocation adds a block");
+
+    arena_reset(arena);
+    TEST_ASSERT_EQUAL_INT(1, (int)arena_block_count(arena), "Reset keeps only the first block");
+    TEST_ASSERT(arena_alloc(arena, 10) == first, "Reset reuses the first block");
+
+    arena_destroy(arena);
+}
+
+static void test_nl80211_ie_parsing(void) {
+    test_section("Testing nl80211 information element parsing");
+
+    nl80211_bss_t bss;
+    char security[MAX_STR_SECURITY];
+
+    // SSID "Home" + RSN with CCMP pairwise and PSK AKM
+    const uint8_t wpa2_ies[] = {
+        0x00, 0x04, 'H', 'o', 'm', 'e',
+        0x30, 0x14, 0x01, 0x00,
+        0x00, 0x0F, 0xAC, 0x04,
+        0x01, 0x00, 0x00, 0x0F, 0xAC, 0x04,
+        0x01, 0x00, 0x00, 0x0F, 0xAC, 0x02,
+        0x00, 0x00};
+    memset(&bss, 0, sizeof(bss));
+    bss.privacy = true;
+    nl80211_parse_ies(wpa2_ies, sizeof(wpa2_ies), &bss);
+    TEST_ASSERT_EQUAL_STR("Home", bss.ssid, "SSID element parsing");
+    TEST_ASSERT(bss.rsn && bss.akm_psk && !bss.akm_sae, "RSN PSK AKM detected");
+    nl80211_bss_security_string(&bss, security, sizeof(security));
+    TEST_ASSERT_EQUAL_STR("WPA2", security, "WPA2-PSK security string");
+
+    // Transition mode: RSN advertising both PSK and SAE
+    const uint8_t transition_ies[] = {
+        0x00, 0x01, 'T',
+        0x30, 0x18, 0x01, 0x00,
+        0x00, 0x0F, 0xAC, 0x04,
+        0x01, 0x00, 0x00, 0x0F, 0xAC, 0x04,
+        0x02, 0x00, 0x00, 0x0F, 0xAC, 0x02, 0x00, 0x0F, 0xAC, 0x08,
+        0x00, 0x00};
+    memset(&bss, 0, sizeof(bss));
+    nl80211_parse_ies(transition_ies, sizeof(transition_ies), &bss);
+    nl80211_bss_security_string(&bss, security, sizeof(security));
+    TEST_ASSERT_EQUAL_STR("WPA2 WPA3", security, "WPA2/WPA3 transition mode");
+
+    // Vendor WPA1 element alongside RSN
+    const uint8_t wpa1_ies[] = {
+        0x00, 0x01, 'W',
+        0xDD, 0x16, 0x00, 0x50, 0xF2, 0x01, 0x01, 0x00,
+        0x00, 0x50, 0xF2, 0x02,
+        0x01, 0x00, 0x00, 0x50, 0xF2, 0x02,
+        0x01, 0x00, 0x00, 0x50, 0xF2, 0x02,
+        0x30, 0x14, 0x01, 0x00,
+        0x00, 0x0F, 0xAC, 0x04,
+        0x01, 0x00, 0x00, 0x0F, 0xAC, 0x04,
+        0x01, 0x00, 0x00, 0x0F, 0xAC, 0x02,
+        0x00, 0x00};
+    memset(&bss, 0, sizeof(bss));
+    nl80211_parse_ies(wpa1_ies, sizeof(wpa1_ies), &bss);
+    nl80211_bss_security_string(&bss, security, sizeof(security));
+    TEST_ASSERT_EQUAL_STR("WPA1 WPA2", security, "Mixed WPA1/WPA2 security");
+
+    // Enterprise network
+    const uint8_t eap_ies[] = {
+        0x00, 0x01, 'E',
+        0x30, 0x14, 0x01, 0x00,
+        0x00, 0x0F, 0xAC, 0x04,
+        0x01, 0x00, 0x00, 0x0F, 0xAC, 0x04,
+        0x01, 0x00, 0x00, 0x0F, 0xAC, 0x01,
+        0x00, 0x00};
+    memset(&bss, 0, sizeof(bss));
+    nl80211_parse_ies(eap_ies, sizeof(eap_ies), &bss);
+    nl80211_bss_security_string(&bss, security, sizeof(security));
+    TEST_ASSERT_EQUAL_STR("WPA2 802.1X", security, "WPA2-Enterprise security");
+
+    // Hidden SSID (zero-filled) and no security elements
+    const uint8_t hidden_ies[] = {0x00, 0x03, 0x00, 0x00, 0x00};
+    memset(&bss, 0, sizeof(bss));
+    nl80211_parse_ies(hidden_ies, sizeof(hidden_ies), &bss);
+    TEST_ASSERT_EQUAL_STR("", bss.ssid, "Hidden SSID is empty");
+    nl80211_bss_security_string(&bss, security, sizeof(security));
+    TEST_ASSERT_EQUAL_STR("Open", security, "Open network security");
+
+    bss.privacy = true;
+    nl80211_bss_security_string(&bss, security, sizeof(security));
+    TEST_ASSERT_EQUAL_STR("WEP", security, "Privacy bit without RSN is WEP");
+
+    // Rates: legacy 54 Mbit/s, then 2-stream HT40 with short GI (300 Mbit/s)
+    const uint8_t rate_ies[] = {
+        0x01, 0x04, 0x82, 0x84, 0x8B, 0x96,
+        0x32, 0x04, 0x0C, 0x12, 0x18, 0x6C,
+        0x2D, 0x1A, 0x62, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    memset(&bss, 0, sizeof(bss));
+    nl80211_parse_ies(rate_ies, 18, &bss);
+    TEST_ASSERT_EQUAL_INT(54, bss.max_rate, "Legacy maximum rate");
+    nl80211_parse_ies(rate_ies, sizeof(rate_ies), &bss);
+    TEST_ASSERT_EQUAL_INT(300, bss.max_rate, "HT maximum rate");
+
+    // Truncated element must not read past the buffer
+    const uint8_t truncated_ies[] = {0x00, 0x20, 'A', 'B'};
+    memset(&bss, 0, sizeof(bss));
+    nl80211_parse_ies(truncated_ies, sizeof(truncated_ies), &bss);
+    TEST_ASSERT_EQUAL_STR("", bss.ssid, "Truncated element ignored");
+}
+
+static void test_nl80211_signal_quality(void) {
+    test_section("Testing dBm to quality conversion");
+
+    TEST_ASSERT_EQUAL_INT(100, nl80211_dbm_to_quality(-30), "Strong signal clamps to 100");
+    TEST_ASSERT_EQUAL_INT(100, nl80211_dbm_to_quality(-40), "-40 dBm is 100");
+    TEST_ASSERT_EQUAL_INT(50, nl80211_dbm_to_quality(-70), "-70 dBm is 50");
+    TEST_ASSERT_EQUAL_INT(0, nl80211_dbm_to_quality(-100), "-100 dBm is 0");
+    TEST_ASSERT_EQUAL_INT(0, nl80211_dbm_to_quality(-110), "Weak signal clamps to 0");
+}
+
+typedef struct {
+    int scans;
+    bool last_rescan;
+    wterm_result_t result;
+} fake_scanner_t;
+
+static wterm_result_t fake_scan(network_list_t *list, bool rescan, void *user_data) {
+    fake_scanner_t *scanner = user_data;
+    scanner->scans++;
+    scanner->last_rescan = rescan;
+    if (scanner->result != WTERM_SUCCESS) {
+        return scanner->result;
+    }
+
+    network_list_clear(list);
+    for (int i = 0; i < scanner->scans; i++) {
+        network_info_t *network = network_list_append(list);
+        if (network) {
+            snprintf(network->ssid, MAX_STR_SSID, "scan-%d", i);
+        }
+    }
+    return WTERM_SUCCESS;
+}
+
+// Take the next published scan, waiting up to two seconds
+static bool wait_for_scan(scan_worker_t *worker, network_list_t *list, wterm_result_t *result) {
+    struct timespec delay = {0, 10000000}; // 10ms
+    for (int i = 0; i < 200; i++) {
+        if (scan_worker_take(worker, list, result)) {
+            return true;
+        }
+        nanosleep(&delay, NULL);
+    }
+    return false;
+}
+
+// Wait up to two seconds for requested scans to finish, without taking them
+static void wait_until_idle(scan_worker_t *worker) {
+    struct timespec delay = {0, 10000000}; // 10ms
+    for (int i = 0; i < 200 && scan_worker_is_scanning(worker); i++) {
+        nanosleep(&delay, NULL);
+    }
+}
+
+static void test_scan_worker(void) {
+    test_section("Background scan worker");
+
+    fake_scanner_t scanner = {0};
+    scan_worker_options_t options = {.interval_ms = 0, .scan = fake_scan, .user_data = &scanner};
+    scan_worker_t *worker = scan_worker_start(&options);
+    TEST_ASSERT_NOT_NULL(worker, "Worker starts");
+    if (!worker) {
+        return;
+    }
+
+    network_list_t list = {0};
+    wterm_result_t result = WTERM_ERROR_GENERAL;
+    TEST_ASSERT(!scan_worker_take(worker, &list, &result), "Nothing published before a request");
+
+    scan_worker_request(worker);
+    TEST_ASSERT(wait_for_scan(worker, &list, &result), "Requested scan published");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result, "Scan result reported");
+    TEST_ASSERT(scanner.last_rescan, "Requests trigger a fresh scan");
+    TEST_ASSERT_EQUAL_INT(1, list.count, "Results swapped into the caller's list");
+    TEST_ASSERT(!scan_worker_take(worker, &list, &result), "A scan is taken only once");
+    TEST_ASSERT(!scan_worker_is_scanning(worker), "Idle after the scan");
+
+    // A failed scan is reported without replacing the current results
+    scanner.result = WTERM_ERROR_NETWORK;
+    scan_worker_request(worker);
+    TEST_ASSERT(wait_for_scan(worker, &list, &result), "Failed scan published");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_NETWORK, result, "Failure reported");
+    TEST_ASSERT_EQUAL_INT(1, list.count, "Previous results kept on failure");
+
+    // Also when a good scan completed untaken before the failure
+    scanner.result = WTERM_SUCCESS;
+    scan_worker_request(worker);
+    wait_until_idle(worker);
+    scanner.result = WTERM_ERROR_NETWORK;
+    scan_worker_request(worker);
+    wait_until_idle(worker);
+    TEST_ASSERT(scan_worker_take(worker, &list, &result), "Latest scan taken");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_NETWORK, result, "Latest scan failed");
+    TEST_ASSERT_EQUAL_INT(1, list.count, "Untaken results dropped with the failure");
+
+    scanner.result = WTERM_SUCCESS;
+    scan_worker_request(worker);
+    TEST_ASSERT(wait_for_scan(worker, &list, &result), "Scan after a failure");
+    TEST_ASSERT_EQUAL_INT(5, list.count, "Recycled lists are refilled");
+    TEST_ASSERT_EQUAL_STR("scan-4", list.networks[4].ssid, "Latest results taken");
+
+    // A refresh re-reads results without forcing a radio scan
+    scan_worker_refresh(worker);
+    TEST_ASSERT(wait_for_scan(worker, &list, &result), "Refresh published");
+    TEST_ASSERT(!scanner.last_rescan, "Refresh does not force a rescan");
+    scan_worker_stop(worker);
+
+    // Periodic refreshes run without a request and re-read results only
+    scanner.scans = 0;
+    options.interval_ms = 20;
+    worker = scan_worker_start(&options);
+    TEST_ASSERT(worker && wait_for_scan(worker, &list, &result), "Periodic refresh published");
+    scan_worker_stop(worker);
+    TEST_ASSERT(!scanner.last_rescan, "Periodic refresh does not force a rescan");
+
+    network_list_free(&list);
+}
+
+static void test_scan_cache(void) {
+    test_section("Persisted scan snapshot");
+
+    char dir[] = "/tmp/wterm-scan-cache-XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir), "Temporary directory");
+    char path[256];
+    snprintf(path, sizeof(path), "%s/nested/%s", dir, SCAN_CACHE_FILE);
+
+    network_list_t list = {0};
+    for (int i = 0; i < 3; i++) {
+        network_info_t *network = network_list_append(&list);
+        snprintf(network->ssid, MAX_STR_SSID, "cached-%d", i);
+        snprintf(network->security, MAX_STR_SECURITY, "WPA2");
+        scan_record_t record = {.bssid = {0x02, 0, 0, 0, 0, (uint8_t)i},
+                                .frequency = 5180,
+                                .channel = 36,
+                                .signal_dbm = -60,
+                                .quality = (uint8_t)(40 + i),
+                                .security_flags = NETWORK_SECURITY_WPA2,
+                                .max_rate = 866};
+        network_list_set_record(&list, i, &record);
+    }
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_cache_save(path, &list),
+                          "Snapshot saved into missing directories");
+
+    network_list_t loaded = {0};
+    time_t saved_at = 0;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_cache_load(path, &loaded, &saved_at),
+                          "Snapshot loaded");
+    TEST_ASSERT_EQUAL_INT(3, loaded.count, "All entries restored");
+    TEST_ASSERT(loaded.is_stale, "Loaded snapshot is marked stale");
+    TEST_ASSERT(saved_at > 0, "Save time reported");
+    TEST_ASSERT_EQUAL_STR("cached-2", loaded.networks[2].ssid, "SSID restored");
+    TEST_ASSERT_EQUAL_STR("WPA2", loaded.networks[2].security, "Security restored");
+    TEST_ASSERT_EQUAL_STR("42", loaded.networks[2].signal, "Signal string rebuilt");
+    TEST_ASSERT_EQUAL_INT(2, loaded.bssid[2][5], "BSSID restored");
+    TEST_ASSERT_EQUAL_INT(866, loaded.max_rate[2], "Numeric columns restored");
+
+    // Truncated or foreign files are rejected
+    FILE *file = fopen(path, "r+");
+    TEST_ASSERT_NOT_NULL(file, "Snapshot reopened");
+    if (file) {
+        TEST_ASSERT(ftruncate(fileno(file), 40) == 0, "Snapshot truncated");
+        fclose(file);
+    }
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_GENERAL, scan_cache_load(path, &loaded, NULL),
+                          "Truncated snapshot rejected");
+    file = fopen(path, "w");
+    if (file) {
+        fputs("not a scan snapshot, just some text", file);
+        fclose(file);
+    }
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_GENERAL, scan_cache_load(path, &loaded, NULL),
+                          "Foreign file rejected");
+    unlink(path);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_GENERAL, scan_cache_load(path, &loaded, NULL),
+                          "Missing snapshot reported");
+
+    char default_path[256];
+    setenv("XDG_CACHE_HOME", dir, 1);
+    TEST_ASSERT(scan_cache_default_path(default_path, sizeof(default_path)),
+                "Default path resolved");
+    snprintf(path, sizeof(path), "%s/wterm/%s", dir, SCAN_CACHE_FILE);
+    TEST_ASSERT_EQUAL_STR(path, default_path, "XDG_CACHE_HOME honored");
+    unsetenv("XDG_CACHE_HOME");
+
+    snprintf(path, sizeof(path), "%s/nested", dir);
+    rmdir(path);
+    rmdir(dir);
+    network_list_free(&loaded);
+    network_list_free(&list);
 }
 
 int main(void) {
@@ -117,6 +554,13 @@ int main(void) {
     test_parse_network_line();
     test_network_parsing_edge_cases();
     test_network_list_initialization();
+    test_network_list_growth();
+    test_parse_network_record();
+    test_arena();
+    test_nl80211_ie_parsing();
+    test_nl80211_signal_quality();
+    test_scan_worker();
+    test_scan_cache();
 
     return test_finish();
 }
\ No newline at end of file
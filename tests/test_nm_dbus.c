@@ -0,0 +1,955 @@
+/**
+ * @file test_nm_dbus.c
+ * @brief Tests for the NetworkManager D-Bus backend
+ *
+ * Starts a private dbus-daemon, runs a small NetworkManager mock on it in a
+ * child process and drives nm_dbus_backend over that session bus.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "test_utils.h"
+#include "../src/core/network_backends/backend_interface.h"
+#include "../src/utils/network_list.h"
+#include "../include/wterm/common.h"
+#include <dbus/dbus.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NM_SERVICE "org.freedesktop.NetworkManager"
+#define NM_PATH "/org/freedesktop/NetworkManager"
+#define NM_DEVICE_WIFI NM_PATH "/Devices/1"
+#define NM_DEVICE_ETH NM_PATH "/Devices/2"
+#define NM_AP_PREFIX NM_PATH "/AccessPoint/"
+#define NM_IP4CONFIG NM_PATH "/IP4Config/1"
+#define NM_HOTSPOT_CONNECTION NM_PATH "/Settings/1"
+#define NM_WIFI_CONNECTION NM_PATH "/Settings/2"
+#define NM_SPARE_CONNECTION NM_PATH "/Settings/1%02d"
+#define MOCK_SPARE_PROFILES 100      // Saved ahead of the hotspot profile
+#define NM_WIFI_ACTIVE NM_PATH "/ActiveConnection/1"
+#define NM_HOTSPOT_ACTIVE NM_PATH "/ActiveConnection/2"
+#define MOCK_PASSWORD "correct-horse"
+#define MOCK_WIFI_UUID "5b1c9e4a-0000-4000-8000-000000000002"
+
+// ============================================================================
+// Mock NetworkManager (runs in a child process)
+// ============================================================================
+
+typedef struct {
+    const char *ssid;
+    uint8_t strength;
+    uint32_t flags;
+    uint32_t wpa_flags;
+    uint32_t rsn_flags;
+    const char *hw_address;
+    uint32_t frequency;
+    uint32_t max_bitrate;        // kbit/s
+} mock_ap_t;
+
+static const mock_ap_t mock_aps[] = {
+    {"HomeNet", 80, 0x1, 0x0, 0x188, "02:00:00:00:00:01", 5180, 866700},  // WPA2-PSK
+    {"CafeOpen", 45, 0x0, 0x0, 0x0, "02:00:00:00:00:02", 2437, 54000},    // Open
+    {"", 30, 0x1, 0x0, 0x188, "02:00:00:00:00:03", 2412, 54000},          // Hidden
+    {"Mixed", 60, 0x1, 0x108, 0x588, "02:00:00:00:00:04", 2462, 144000},  // WPA1 + WPA2 + WPA3
+    {"Wpa3Home", 70, 0x1, 0x0, 0x488, "02:00:00:00:00:05", 5500, 1201000}, // WPA3-SAE only
+};
+#define MOCK_AP_COUNT ((int)(sizeof(mock_aps) / sizeof(mock_aps[0])))
+
+typedef struct {
+    int wifi_ap;                 // Index of the active AP, -1 if none
+    uint32_t wifi_state;         // Active connection state
+    bool wifi_profile;           // Settings/2 exists
+    bool hotspot_profile;        // Settings/1 exists
+    uint32_t hotspot_state;      // 0 when not active
+    const char *pending_path;    // Activation to complete after next call
+    uint32_t pending_state;
+    uint32_t pending_reason;
+    int scan_requests;           // Every second RequestScan is refused
+    int scan_polls;              // LastScan reads until the scan completes
+    int64_t last_scan;
+} mock_state_t;
+
+static mock_state_t mock;
+
+static void append_variant(DBusMessageIter *iter, int type, const void *value) {
+    char signature[2] = {(char)type, '\0'};
+    DBusMessageIter variant;
+    dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, signature, &variant);
+    dbus_message_iter_append_basic(&variant, type, value);
+    dbus_message_iter_close_container(iter, &variant);
+}
+
+static void append_variant_string(DBusMessageIter *iter, const char *value) {
+    append_variant(iter, DBUS_TYPE_STRING, &value);
+}
+
+static void append_variant_path(DBusMessageIter *iter, const char *value) {
+    append_variant(iter, DBUS_TYPE_OBJECT_PATH, &value);
+}
+
+static void append_variant_u32(DBusMessageIter *iter, uint32_t value) {
+    append_variant(iter, DBUS_TYPE_UINT32, &value);
+}
+
+static void append_variant_paths(DBusMessageIter *iter, const char **paths, int count) {
+    DBusMessageIter variant, array;
+    dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, "ao", &variant);
+    dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, "o", &array);
+    for (int i = 0; i < count; i++) {
+        dbus_message_iter_append_basic(&array, DBUS_TYPE_OBJECT_PATH, &paths[i]);
+    }
+    dbus_message_iter_close_container(&variant, &array);
+    dbus_message_iter_close_container(iter, &variant);
+}
+
+static void append_variant_ssid(DBusMessageIter *iter, const char *ssid) {
+    DBusMessageIter variant, array;
+    int len = (int)strlen(ssid);
+    dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, "ay", &variant);
+    dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, "y", &array);
+    dbus_message_iter_append_fixed_array(&array, DBUS_TYPE_BYTE, &ssid, len);
+    dbus_message_iter_close_container(&variant, &array);
+    dbus_message_iter_close_container(iter, &variant);
+}
+
+static int ap_index(const char *path) {
+    size_t prefix = strlen(NM_AP_PREFIX);
+    if (strncmp(path, NM_AP_PREFIX, prefix) != 0) {
+        return -1;
+    }
+    int index = atoi(path + prefix) - 1;
+    return (index >= 0 && index < MOCK_AP_COUNT) ? index : -1;
+}
+
+static const char *ap_path(int index) {
+    static char paths[MOCK_AP_COUNT][64];
+    snprintf(paths[index], sizeof(paths[index]), NM_AP_PREFIX "%d", index + 1);
+    return paths[index];
+}
+
+static bool append_ap_property(DBusMessageIter *iter, int index, const char *name) {
+    const mock_ap_t *ap = &mock_aps[index];
+    if (strcmp(name, "Ssid") == 0) {
+        append_variant_ssid(iter, ap->ssid);
+    } else if (strcmp(name, "Strength") == 0) {
+        append_variant(iter, DBUS_TYPE_BYTE, &ap->strength);
+    } else if (strcmp(name, "Flags") == 0) {
+        append_variant_u32(iter, ap->flags);
+    } else if (strcmp(name, "WpaFlags") == 0) {
+        append_variant_u32(iter, ap->wpa_flags);
+    } else if (strcmp(name, "RsnFlags") == 0) {
+        append_variant_u32(iter, ap->rsn_flags);
+    } else if (strcmp(name, "HwAddress") == 0) {
+        append_variant_string(iter, ap->hw_address);
+    } else if (strcmp(name, "Frequency") == 0) {
+        append_variant_u32(iter, ap->frequency);
+    } else if (strcmp(name, "MaxBitrate") == 0) {
+        append_variant_u32(iter, ap->max_bitrate);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool append_property(DBusMessageIter *iter, const char *path, const char *name) {
+    int index = ap_index(path);
+    if (index >= 0) {
+        return append_ap_property(iter, index, name);
+    }
+
+    bool is_wifi = strcmp(path, NM_DEVICE_WIFI) == 0;
+    if (is_wifi || strcmp(path, NM_DEVICE_ETH) == 0) {
+        if (strcmp(name, "DeviceType") == 0) {
+            append_variant_u32(iter, is_wifi ? 2 : 1);
+        } else if (strcmp(name, "Interface") == 0) {
+            append_variant_string(iter, is_wifi ? "wlan0" : "eth0");
+        } else if (strcmp(name, "LastScan") == 0 && is_wifi) {
+            if (mock.scan_polls > 0 && --mock.scan_polls == 0) {
+                mock.last_scan += 5000;
+            }
+            append_variant(iter, DBUS_TYPE_INT64, &mock.last_scan);
+        } else if (strcmp(name, "WirelessCapabilities") == 0 && is_wifi) {
+            append_variant_u32(iter, 0x40 | 0x0F);
+        } else if (strcmp(name, "ActiveAccessPoint") == 0 && is_wifi) {
+            bool connected = mock.wifi_ap >= 0 && mock.wifi_state == 2;
+            append_variant_path(iter, connected ? ap_path(mock.wifi_ap) : "/");
+        } else if (strcmp(name, "ActiveConnection") == 0 && is_wifi) {
+            bool connected = mock.wifi_ap >= 0 && mock.wifi_state == 2;
+            append_variant_path(iter, connected ? NM_WIFI_ACTIVE : "/");
+        } else if (strcmp(name, "Ip4Config") == 0) {
+            bool connected = is_wifi && mock.wifi_ap >= 0 && mock.wifi_state == 2;
+            append_variant_path(iter, connected ? NM_IP4CONFIG : "/");
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    if (strcmp(path, NM_PATH) == 0 && strcmp(name, "ActiveConnections") == 0) {
+        const char *active[2];
+        int count = 0;
+        if (mock.wifi_state != 0) {
+            active[count++] = NM_WIFI_ACTIVE;
+        }
+        if (mock.hotspot_state != 0) {
+            active[count++] = NM_HOTSPOT_ACTIVE;
+        }
+        append_variant_paths(iter, active, count);
+        return true;
+    }
+
+    bool wifi_active = strcmp(path, NM_WIFI_ACTIVE) == 0;
+    if (wifi_active || strcmp(path, NM_HOTSPOT_ACTIVE) == 0) {
+        if (strcmp(name, "Id") == 0) {
+            append_variant_string(iter, wifi_active ? mock_aps[mock.wifi_ap].ssid : "MyHotspot");
+        } else if (strcmp(name, "Uuid") == 0 && wifi_active) {
+            append_variant_string(iter, MOCK_WIFI_UUID);
+        } else if (strcmp(name, "State") == 0) {
+            append_variant_u32(iter, wifi_active ? mock.wifi_state : mock.hotspot_state);
+        } else if (strcmp(name, "Connection") == 0) {
+            append_variant_path(iter, wifi_active ? NM_WIFI_CONNECTION : NM_HOTSPOT_CONNECTION);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    if (strcmp(path, NM_IP4CONFIG) == 0 && strcmp(name, "AddressData") == 0) {
+        // aa{sv}: [{"address": "192.168.1.42", "prefix": 24}]
+        DBusMessageIter variant, outer, dict, entry;
+        const char *key = "address";
+        const char *prefix_key = "prefix";
+        dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, "aa{sv}", &variant);
+        dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, "a{sv}", &outer);
+        dbus_message_iter_open_container(&outer, DBUS_TYPE_ARRAY, "{sv}", &dict);
+        dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+        dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+        append_variant_string(&entry, "192.168.1.42");
+        dbus_message_iter_close_container(&dict, &entry);
+        dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+        dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &prefix_key);
+        append_variant_u32(&entry, 24);
+        dbus_message_iter_close_container(&dict, &entry);
+        dbus_message_iter_close_container(&outer, &dict);
+        dbus_message_iter_close_container(&variant, &outer);
+        dbus_message_iter_close_container(iter, &variant);
+        return true;
+    }
+
+    return false;
+}
+
+static void append_settings_group(DBusMessageIter *settings, const char *group,
+                                  const char *key1, const char *value1,
+                                  const char *key2, const char *value2) {
+    DBusMessageIter group_entry, dict, entry;
+    dbus_message_iter_open_container(settings, DBUS_TYPE_DICT_ENTRY, NULL, &group_entry);
+    dbus_message_iter_append_basic(&group_entry, DBUS_TYPE_STRING, &group);
+    dbus_message_iter_open_container(&group_entry, DBUS_TYPE_ARRAY, "{sv}", &dict);
+
+    dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+    dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key1);
+    append_variant_string(&entry, value1);
+    dbus_message_iter_close_container(&dict, &entry);
+
+    if (key2) {
+        dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+        dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key2);
+        append_variant_string(&entry, value2);
+        dbus_message_iter_close_container(&dict, &entry);
+    }
+
+    dbus_message_iter_close_container(&group_entry, &dict);
+    dbus_message_iter_close_container(settings, &group_entry);
+}
+
+// Find a string setting in an incoming a{sa{sv}} argument
+static const char *find_setting(DBusMessage *message, const char *group, const char *key) {
+    DBusMessageIter iter, groups;
+    dbus_message_iter_init(message, &iter);
+    dbus_message_iter_recurse(&iter, &groups);
+
+    while (dbus_message_iter_get_arg_type(&groups) == DBUS_TYPE_DICT_ENTRY) {
+        DBusMessageIter group_entry, entries;
+        const char *name = NULL;
+        dbus_message_iter_recurse(&groups, &group_entry);
+        dbus_message_iter_get_basic(&group_entry, &name);
+        dbus_message_iter_next(&group_entry);
+
+        if (strcmp(name, group) == 0) {
+            dbus_message_iter_recurse(&group_entry, &entries);
+            while (dbus_message_iter_get_arg_type(&entries) == DBUS_TYPE_DICT_ENTRY) {
+                DBusMessageIter entry, value;
+                const char *entry_key = NULL;
+                dbus_message_iter_recurse(&entries, &entry);
+                dbus_message_iter_get_basic(&entry, &entry_key);
+                dbus_message_iter_next(&entry);
+                dbus_message_iter_recurse(&entry, &value);
+                if (strcmp(entry_key, key) == 0 &&
+                    dbus_message_iter_get_arg_type(&value) == DBUS_TYPE_STRING) {
+                    const char *result = NULL;
+                    dbus_message_iter_get_basic(&value, &result);
+                    return result;
+                }
+                dbus_message_iter_next(&entries);
+            }
+        }
+        dbus_message_iter_next(&groups);
+    }
+    return NULL;
+}
+
+static void emit_state_changed(DBusConnection *conn, const char *path,
+                               uint32_t state, uint32_t reason) {
+    DBusMessage *signal = dbus_message_new_signal(
+        path, NM_SERVICE ".Connection.Active", "StateChanged");
+    dbus_message_append_args(signal, DBUS_TYPE_UINT32, &state,
+                             DBUS_TYPE_UINT32, &reason, DBUS_TYPE_INVALID);
+    dbus_connection_send(conn, signal, NULL);
+    dbus_message_unref(signal);
+}
+
+static DBusMessage *handle_properties(DBusMessage *message) {
+    const char *iface = NULL;
+    const char *name = NULL;
+    const char *path = dbus_message_get_path(message);
+    DBusMessage *reply = dbus_message_new_method_return(message);
+    DBusMessageIter iter;
+    dbus_message_iter_init_append(reply, &iter);
+
+    if (dbus_message_has_member(message, "Get")) {
+        dbus_message_get_args(message, NULL, DBUS_TYPE_STRING, &iface,
+                              DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID);
+        if (!append_property(&iter, path, name)) {
+            dbus_message_unref(reply);
+            return dbus_message_new_error(message, DBUS_ERROR_UNKNOWN_PROPERTY, name);
+        }
+        return reply;
+    }
+
+    // GetAll is only used for access points
+    static const char *ap_properties[] = {"Ssid", "Strength", "Flags", "WpaFlags", "RsnFlags",
+                                          "HwAddress", "Frequency", "MaxBitrate"};
+    int index = ap_index(path);
+    DBusMessageIter dict, entry;
+    dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &dict);
+    for (size_t i = 0; index >= 0 && i < sizeof(ap_properties) / sizeof(ap_properties[0]); i++) {
+        dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+        dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &ap_properties[i]);
+        append_ap_property(&entry, index, ap_properties[i]);
+        dbus_message_iter_close_container(&dict, &entry);
+    }
+    dbus_message_iter_close_container(&iter, &dict);
+    return reply;
+}
+
+static DBusMessage *reply_paths(DBusMessage *message, const char **paths, int count) {
+    DBusMessage *reply = dbus_message_new_method_return(message);
+    DBusMessageIter iter, array;
+    dbus_message_iter_init_append(reply, &iter);
+    dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "o", &array);
+    for (int i = 0; i < count; i++) {
+        dbus_message_iter_append_basic(&array, DBUS_TYPE_OBJECT_PATH, &paths[i]);
+    }
+    dbus_message_iter_close_container(&iter, &array);
+    return reply;
+}
+
+static DBusMessage *handle_add_and_activate(DBusMessage *message) {
+    DBusMessageIter iter;
+    const char *device = NULL;
+    const char *ap = NULL;
+    dbus_message_iter_init(message, &iter);
+    dbus_message_iter_next(&iter);
+    dbus_message_iter_get_basic(&iter, &device);
+    dbus_message_iter_next(&iter);
+    dbus_message_iter_get_basic(&iter, &ap);
+
+    int index = ap_index(ap);
+    if (strcmp(device, NM_DEVICE_WIFI) != 0 || index < 0) {
+        return dbus_message_new_error(message, DBUS_ERROR_INVALID_ARGS, "Bad device or AP");
+    }
+
+    const char *psk = find_setting(message, "802-11-wireless-security", "psk");
+    const char *key_mgmt = find_setting(message, "802-11-wireless-security", "key-mgmt");
+    bool secured = mock_aps[index].flags != 0;
+    bool has_psk = ((mock_aps[index].wpa_flags | mock_aps[index].rsn_flags) & 0x100) != 0;
+    if (key_mgmt && strcmp(key_mgmt, "wpa-psk") == 0 && !has_psk) {
+        return dbus_message_new_error(message, NM_SERVICE ".Settings.InvalidSetting",
+                                      "802-11-wireless-security.key-mgmt: not supported by the AP");
+    }
+
+    mock.wifi_ap = index;
+    mock.wifi_profile = true;
+    mock.wifi_state = 1; // Activating
+    if (strcmp(mock_aps[index].ssid, "Mixed") == 0) {
+        // Never completes, so only cancellation or the deadline ends the wait
+        mock.pending_path = NULL;
+    } else {
+        mock.pending_path = NM_WIFI_ACTIVE;
+    }
+    if (!secured || (psk && strcmp(psk, MOCK_PASSWORD) == 0)) {
+        mock.pending_state = 2;
+        mock.pending_reason = 1;
+    } else {
+        mock.pending_state = 4;
+        mock.pending_reason = 9; // No secrets
+    }
+
+    const char *connection = NM_WIFI_CONNECTION;
+    const char *active = NM_WIFI_ACTIVE;
+    DBusMessage *reply = dbus_message_new_method_return(message);
+    dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &connection,
+                             DBUS_TYPE_OBJECT_PATH, &active, DBUS_TYPE_INVALID);
+    return reply;
+}
+
+static DBusMessage *handle_nm_call(DBusMessage *message) {
+    const char *path = dbus_message_get_path(message);
+    const char *member = dbus_message_get_member(message);
+
+    if (dbus_message_has_interface(message, "org.freedesktop.DBus.Properties")) {
+        return handle_properties(message);
+    }
+
+    if (strcmp(path, NM_PATH) == 0) {
+        if (strcmp(member, "GetDevices") == 0) {
+            const char *devices[] = {NM_DEVICE_ETH, NM_DEVICE_WIFI};
+            return reply_paths(message, devices, 2);
+        }
+        if (strcmp(member, "GetDeviceByIpIface") == 0) {
+            const char *iface = NULL;
+            dbus_message_get_args(message, NULL, DBUS_TYPE_STRING, &iface, DBUS_TYPE_INVALID);
+            const char *device = strcmp(iface, "wlan0") == 0 ? NM_DEVICE_WIFI
+                               : strcmp(iface, "eth0") == 0  ? NM_DEVICE_ETH
+                                                             : NULL;
+            if (!device) {
+                return dbus_message_new_error(message, NM_SERVICE ".UnknownDevice", "No such device");
+            }
+            DBusMessage *reply = dbus_message_new_method_return(message);
+            dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &device, DBUS_TYPE_INVALID);
+            return reply;
+        }
+        if (strcmp(member, "AddAndActivateConnection") == 0) {
+            return handle_add_and_activate(message);
+        }
+        if (strcmp(member, "ActivateConnection") == 0) {
+            const char *connection = NULL;
+            dbus_message_get_args(message, NULL, DBUS_TYPE_OBJECT_PATH, &connection,
+                                  DBUS_TYPE_INVALID);
+            bool wifi = strcmp(connection, NM_WIFI_CONNECTION) == 0 && mock.wifi_profile;
+            if (!wifi && (strcmp(connection, NM_HOTSPOT_CONNECTION) != 0 || !mock.hotspot_profile)) {
+                return dbus_message_new_error(message, NM_SERVICE ".UnknownConnection", "Unknown");
+            }
+            if (wifi) {
+                mock.wifi_ap = 0; // The saved profile is HomeNet's
+                mock.wifi_state = 1;
+            } else {
+                mock.hotspot_state = 1;
+            }
+            mock.pending_path = wifi ? NM_WIFI_ACTIVE : NM_HOTSPOT_ACTIVE;
+            mock.pending_state = 2;
+            mock.pending_reason = 1;
+            const char *active = mock.pending_path;
+            DBusMessage *reply = dbus_message_new_method_return(message);
+            dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &active, DBUS_TYPE_INVALID);
+            return reply;
+        }
+        if (strcmp(member, "DeactivateConnection") == 0) {
+            const char *active = NULL;
+            dbus_message_get_args(message, NULL, DBUS_TYPE_OBJECT_PATH, &active, DBUS_TYPE_INVALID);
+            if (strcmp(active, NM_HOTSPOT_ACTIVE) == 0) {
+                mock.hotspot_state = 0;
+            } else if (strcmp(active, NM_WIFI_ACTIVE) == 0) {
+                mock.wifi_state = 0;
+            }
+            return dbus_message_new_method_return(message);
+        }
+    }
+
+    if (strcmp(path, NM_DEVICE_WIFI) == 0) {
+        if (strcmp(member, "GetAllAccessPoints") == 0) {
+            const char *aps[MOCK_AP_COUNT];
+            for (int i = 0; i < MOCK_AP_COUNT; i++) {
+                aps[i] = ap_path(i);
+            }
+            return reply_paths(message, aps, MOCK_AP_COUNT);
+        }
+        if (strcmp(member, "RequestScan") == 0) {
+            // NetworkManager rate-limits scans
+            if (++mock.scan_requests % 2 == 0) {
+                return dbus_message_new_error(message, NM_SERVICE ".Device.NotAllowed",
+                                              "Scanning not allowed immediately following previous scan");
+            }
+            mock.scan_polls = 3;
+            return dbus_message_new_method_return(message);
+        }
+        if (strcmp(member, "Disconnect") == 0) {
+            mock.wifi_state = 0;
+            mock.wifi_ap = -1;
+            return dbus_message_new_method_return(message);
+        }
+    }
+
+    if (strcmp(path, NM_PATH "/Settings") == 0 && strcmp(member, "ListConnections") == 0) {
+        static char spare[MOCK_SPARE_PROFILES][64];
+        const char *connections[MOCK_SPARE_PROFILES + 2];
+        int count = 0;
+        for (int i = 0; i < MOCK_SPARE_PROFILES; i++) {
+            snprintf(spare[i], sizeof(spare[i]), NM_SPARE_CONNECTION, i);
+            connections[count++] = spare[i];
+        }
+        if (mock.hotspot_profile) {
+            connections[count++] = NM_HOTSPOT_CONNECTION;
+        }
+        if (mock.wifi_profile) {
+            connections[count++] = NM_WIFI_CONNECTION;
+        }
+        return reply_paths(message, connections, count);
+    }
+
+    if (strcmp(path, NM_PATH "/Settings") == 0 && strcmp(member, "GetConnectionByUuid") == 0) {
+        const char *uuid = NULL;
+        dbus_message_get_args(message, NULL, DBUS_TYPE_STRING, &uuid, DBUS_TYPE_INVALID);
+        if (!mock.wifi_profile || strcmp(uuid, MOCK_WIFI_UUID) != 0) {
+            return dbus_message_new_error(message, NM_SERVICE ".Settings.InvalidConnection",
+                                          "No connection with the UUID was found.");
+        }
+        const char *connection = NM_WIFI_CONNECTION;
+        DBusMessage *reply = dbus_message_new_method_return(message);
+        dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &connection, DBUS_TYPE_INVALID);
+        return reply;
+    }
+
+    int spare = -1;
+    if (sscanf(path, NM_SPARE_CONNECTION, &spare) == 1 && strcmp(member, "GetSettings") == 0) {
+        char id[32];
+        snprintf(id, sizeof(id), "Saved%d", spare);
+        DBusMessage *reply = dbus_message_new_method_return(message);
+        DBusMessageIter iter, settings;
+        dbus_message_iter_init_append(reply, &iter);
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sa{sv}}", &settings);
+        append_settings_group(&settings, "connection", "id", id, "type", "802-3-ethernet");
+        dbus_message_iter_close_container(&iter, &settings);
+        return reply;
+    }
+
+    bool hotspot = strcmp(path, NM_HOTSPOT_CONNECTION) == 0;
+    if (hotspot || strcmp(path, NM_WIFI_CONNECTION) == 0) {
+        if (strcmp(member, "GetSettings") == 0) {
+            DBusMessage *reply = dbus_message_new_method_return(message);
+            DBusMessageIter iter, settings;
+            dbus_message_iter_init_append(reply, &iter);
+            dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sa{sv}}", &settings);
+            append_settings_group(&settings, "connection",
+                                  "id", hotspot ? "MyHotspot" : "HomeNet",
+                                  "type", "802-11-wireless");
+            append_settings_group(&settings, "802-11-wireless",
+                                  "mode", hotspot ? "ap" : "infrastructure", NULL, NULL);
+            dbus_message_iter_close_container(&iter, &settings);
+            return reply;
+        }
+        if (strcmp(member, "Delete") == 0) {
+            if (hotspot) {
+                mock.hotspot_profile = false;
+            } else {
+                mock.wifi_profile = false;
+            }
+            return dbus_message_new_method_return(message);
+        }
+    }
+
+    return dbus_message_new_error(message, DBUS_ERROR_UNKNOWN_METHOD, member);
+}
+
+static void run_mock_network_manager(void) {
+    DBusConnection *conn = dbus_bus_get_private(DBUS_BUS_SESSION, NULL);
+    if (!conn) {
+        _exit(1);
+    }
+    dbus_connection_set_exit_on_disconnect(conn, TRUE);
+
+    if (dbus_bus_request_name(conn, NM_SERVICE, DBUS_NAME_FLAG_DO_NOT_QUEUE, NULL) !=
+        DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+        _exit(1);
+    }
+
+    memset(&mock, 0, sizeof(mock));
+    mock.wifi_ap = -1;
+    mock.hotspot_profile = true;
+
+    while (dbus_connection_read_write(conn, -1)) {
+        DBusMessage *message;
+        while ((message = dbus_connection_pop_message(conn)) != NULL) {
+            if (dbus_message_get_type(message) == DBUS_MESSAGE_TYPE_METHOD_CALL) {
+                // Complete an activation only after the client has had a
+                // chance to read the initial state, so the signal path is used
+                const char *pending = mock.pending_path;
+                mock.pending_path = NULL;
+
+                DBusMessage *reply = handle_nm_call(message);
+                dbus_connection_send(conn, reply, NULL);
+                dbus_message_unref(reply);
+
+                if (pending) {
+                    // A deactivated connection disappears from ActiveConnections
+                    uint32_t state = mock.pending_state == 4 ? 0 : mock.pending_state;
+                    if (strcmp(pending, NM_WIFI_ACTIVE) == 0) {
+                        mock.wifi_state = state;
+                    } else {
+                        mock.hotspot_state = state;
+                    }
+                    emit_state_changed(conn, pending, mock.pending_state, mock.pending_reason);
+                }
+                dbus_connection_flush(conn);
+            }
+            dbus_message_unref(message);
+        }
+    }
+    _exit(0);
+}
+
+// ============================================================================
+// Test harness
+// ============================================================================
+
+static pid_t daemon_pid = -1;
+static pid_t mock_pid = -1;
+
+static bool start_private_bus(void) {
+    int pipefd[2];
+    if (pipe(pipefd) < 0) {
+        return false;
+    }
+
+    daemon_pid = fork();
+    if (daemon_pid == 0) {
+        char print_address[32];
+        snprintf(print_address, sizeof(print_address), "--print-address=%d", pipefd[1]);
+        close(pipefd[0]);
+        execl(DBUS_DAEMON_EXECUTABLE, "dbus-daemon", "--session", "--nofork",
+              print_address, (char *)NULL);
+        _exit(127);
+    }
+    close(pipefd[1]);
+
+    char address[512] = {0};
+    ssize_t len = read(pipefd[0], address, sizeof(address) - 1);
+    close(pipefd[0]);
+    if (len <= 0) {
+        return false;
+    }
+
+    address[strcspn(address, "\n")] = '\0';
+    setenv("DBUS_SESSION_BUS_ADDRESS", address, 1);
+    setenv("WTERM_NM_BUS", "session", 1);
+    return true;
+}
+
+static void stop_process(pid_t pid) {
+    if (pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+    }
+}
+
+static bool wait_for_mock(void) {
+    for (int i = 0; i < 100; i++) {
+        if (nm_dbus_backend.is_available()) {
+            return true;
+        }
+        struct timespec delay = {0, 50 * 1000000L};
+        nanosleep(&delay, NULL);
+    }
+    return false;
+}
+
+static network_info_t *find_network(network_list_t *list, const char *ssid) {
+    for (int i = 0; i < list->count; i++) {
+        if (strcmp(list->networks[i].ssid, ssid) == 0) {
+            return &list->networks[i];
+        }
+    }
+    return NULL;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_scan(void) {
+    test_section("Testing D-Bus scan");
+
+    network_list_t list = {0};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_dbus_backend.scan_networks(&list), "Scan succeeds");
+    TEST_ASSERT_EQUAL_INT(4, list.count, "Hidden access point skipped");
+
+    network_info_t *home = find_network(&list, "HomeNet");
+    TEST_ASSERT_NOT_NULL(home, "HomeNet listed");
+    if (home) {
+        TEST_ASSERT_EQUAL_STR("WPA2", home->security, "HomeNet security");
+        TEST_ASSERT_EQUAL_STR("80", home->signal, "HomeNet signal");
+
+        scan_record_t record;
+        network_list_get_record(&list, (int)(home - list.networks), &record);
+        static const uint8_t bssid[6] = {0x02, 0, 0, 0, 0, 0x01};
+        TEST_ASSERT(memcmp(bssid, record.bssid, sizeof(bssid)) == 0, "HomeNet BSSID");
+        TEST_ASSERT_EQUAL_INT(5180, record.frequency, "HomeNet frequency");
+        TEST_ASSERT_EQUAL_INT(36, record.channel, "HomeNet channel");
+        TEST_ASSERT_EQUAL_INT(80, record.quality, "HomeNet quality column");
+        TEST_ASSERT_EQUAL_INT(866, record.max_rate, "HomeNet max rate in Mbit/s");
+        TEST_ASSERT_EQUAL_INT(NETWORK_SECURITY_WPA2, record.security_flags, "HomeNet flags");
+    }
+
+    network_info_t *cafe = find_network(&list, "CafeOpen");
+    TEST_ASSERT_NOT_NULL(cafe, "CafeOpen listed");
+    if (cafe) {
+        TEST_ASSERT_EQUAL_STR("Open", cafe->security, "Open network security");
+    }
+
+    network_info_t *mixed = find_network(&list, "Mixed");
+    TEST_ASSERT_NOT_NULL(mixed, "Mixed listed");
+    if (mixed) {
+        TEST_ASSERT_EQUAL_STR("WPA1 WPA2 WPA3", mixed->security, "Mixed security");
+    }
+
+    network_info_t *wpa3 = find_network(&list, "Wpa3Home");
+    TEST_ASSERT_NOT_NULL(wpa3, "Wpa3Home listed");
+    if (wpa3) {
+        TEST_ASSERT_EQUAL_STR("WPA3", wpa3->security, "WPA3-only security");
+    }
+    network_list_free(&list);
+
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_dbus_backend.rescan_networks(), "RequestScan succeeds");
+}
+
+static void test_fresh_scan(void) {
+    test_section("Testing D-Bus scan with completion wait");
+
+    // The previous test's RequestScan was accepted, so this one is refused
+    network_list_t list = {0};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_dbus_backend.scan_networks_fresh(&list, 2000),
+                          "Refused scan still returns results");
+    TEST_ASSERT(list.is_stale, "Refused scan is marked stale");
+    TEST_ASSERT_EQUAL_INT(4, list.count, "Cached results served");
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_dbus_backend.scan_networks_fresh(&list, 5000),
+                          "Fresh scan succeeds");
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long elapsed_ms = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000;
+    TEST_ASSERT(!list.is_stale, "Completed scan is fresh");
+    TEST_ASSERT_EQUAL_INT(4, list.count, "Fresh results served");
+    TEST_ASSERT(elapsed_ms < 2000, "Returns once LastScan moves, not at the deadline");
+
+    network_list_free(&list);
+}
+
+static void test_connect(void) {
+    test_section("Testing D-Bus connect and disconnect");
+
+    char ssid[MAX_STR_SSID] = {0};
+    char ip[MAX_STR_IP_ADDR] = {0};
+
+    TEST_ASSERT(!nm_dbus_backend.is_connected(ssid, sizeof(ssid)), "Initially disconnected");
+
+    backend_result_t result = nm_dbus_backend.connect_secured_network("HomeNet", "wrong-password", -1);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_NETWORK, result.result, "Wrong password fails");
+    TEST_ASSERT_EQUAL_STR("Secrets were required, but not provided", result.error_message,
+                          "Failure reason reported");
+
+    result = nm_dbus_backend.connect_secured_network("Missing", MOCK_PASSWORD, -1);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_NETWORK, result.result, "Unknown SSID fails");
+    TEST_ASSERT_EQUAL_STR("No network with SSID 'Missing' found.", result.error_message,
+                          "Unknown SSID message");
+
+    result = nm_dbus_backend.connect_secured_network("HomeNet", MOCK_PASSWORD, -1);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result.result, "Correct password connects");
+
+    TEST_ASSERT(nm_dbus_backend.is_connected(ssid, sizeof(ssid)), "Connected after activation");
+    TEST_ASSERT_EQUAL_STR("HomeNet", ssid, "Connected SSID");
+    TEST_ASSERT(nm_dbus_backend.get_ip_address(ip, sizeof(ip)), "IP address available");
+    TEST_ASSERT_EQUAL_STR("192.168.1.42", ip, "IP address from AddressData");
+
+    connection_status_t status;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_dbus_backend.get_connection_status(&status),
+                          "Connection status succeeds");
+    TEST_ASSERT(status.is_connected, "Status reports the connection");
+    TEST_ASSERT_EQUAL_STR("HomeNet", status.connected_ssid, "Status SSID");
+    TEST_ASSERT_EQUAL_STR("HomeNet", status.connection_name, "Status profile name");
+    TEST_ASSERT_EQUAL_STR(MOCK_WIFI_UUID, status.connection_uuid, "Status profile UUID");
+    TEST_ASSERT_EQUAL_STR("wlan0", status.device, "Status device");
+    TEST_ASSERT_EQUAL_STR("192.168.1.42", status.ip_address, "Status IP address");
+
+    result = nm_dbus_backend.disconnect_network();
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result.result, "Disconnect succeeds");
+    TEST_ASSERT(!nm_dbus_backend.is_connected(ssid, sizeof(ssid)), "Disconnected");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_dbus_backend.get_connection_status(&status),
+                          "Status succeeds while disconnected");
+    TEST_ASSERT(!status.is_connected, "Status reports no connection");
+
+    result = nm_dbus_backend.connect_saved_network("no-such-uuid", -1);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_NETWORK, result.result, "Unknown profile fails");
+
+    result = nm_dbus_backend.connect_saved_network(MOCK_WIFI_UUID, -1);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result.result, "Saved profile connects");
+    TEST_ASSERT(nm_dbus_backend.is_connected(ssid, sizeof(ssid)), "Connected through the profile");
+    TEST_ASSERT_EQUAL_STR("HomeNet", ssid, "Saved profile SSID");
+    nm_dbus_backend.disconnect_network();
+
+    result = nm_dbus_backend.connect_secured_network("Wpa3Home", MOCK_PASSWORD, -1);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result.result, "WPA3-only network connects");
+    TEST_ASSERT(nm_dbus_backend.is_connected(ssid, sizeof(ssid)), "Connected over SAE");
+    TEST_ASSERT_EQUAL_STR("Wpa3Home", ssid, "WPA3 SSID");
+    nm_dbus_backend.disconnect_network();
+
+    result = nm_dbus_backend.connect_open_network("CafeOpen", -1);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result.result, "Open network connects");
+    nm_dbus_backend.disconnect_network();
+}
+
+typedef struct {
+    int cancel_write;
+    bool answered;               // Another call went through meanwhile
+} cancel_probe_t;
+
+static void *cancel_after_probe(void *arg) {
+    cancel_probe_t *probe = arg;
+    struct timespec delay = {0, 300 * 1000000L};
+    nanosleep(&delay, NULL);
+
+    char ssid[MAX_STR_SSID];
+    nm_dbus_backend.is_connected(ssid, sizeof(ssid));
+    probe->answered = true;
+
+    if (write(probe->cancel_write, "x", 1) != 1) {
+        perror("write");
+    }
+    return NULL;
+}
+
+static void test_connect_cancel(void) {
+    test_section("Testing D-Bus connect cancellation");
+
+    int fds[2];
+    TEST_ASSERT(pipe(fds) == 0, "Cancel pipe created");
+
+    cancel_probe_t probe = {.cancel_write = fds[1], .answered = false};
+    pthread_t thread;
+    pthread_create(&thread, NULL, cancel_after_probe, &probe);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    backend_result_t result = nm_dbus_backend.connect_secured_network("Mixed", MOCK_PASSWORD, fds[0]);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_join(thread, NULL);
+    long elapsed_ms = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000;
+
+    TEST_ASSERT(probe.answered, "Other calls are served while an activation is pending");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_CANCELLED, result.result, "Pending activation cancelled");
+    TEST_ASSERT(elapsed_ms < 5000, "Cancel ends the wait promptly");
+
+    char ssid[MAX_STR_SSID] = {0};
+    TEST_ASSERT(!nm_dbus_backend.is_connected(ssid, sizeof(ssid)),
+                "Cancelled activation deactivated");
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_interfaces(void) {
+    test_section("Testing D-Bus interface queries");
+
+    char interfaces[4][MAX_STR_INTERFACE];
+    int count = 0;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          nm_dbus_backend.get_available_wifi_interfaces(interfaces, 4, &count),
+                          "Interface listing succeeds");
+    TEST_ASSERT_EQUAL_INT(1, count, "Only WiFi devices listed");
+    if (count > 0) {
+        TEST_ASSERT_EQUAL_STR("wlan0", interfaces[0], "WiFi interface name");
+    }
+
+    bool supports_ap = false;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          nm_dbus_backend.check_interface_ap_support("wlan0", &supports_ap),
+                          "AP check on WiFi device");
+    TEST_ASSERT(supports_ap, "AP capability from WirelessCapabilities");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_GENERAL,
+                          nm_dbus_backend.check_interface_ap_support("eth0", &supports_ap),
+                          "AP check rejects non-WiFi device");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_GENERAL,
+                          nm_dbus_backend.check_interface_ap_support("nope0", &supports_ap),
+                          "AP check rejects unknown device");
+}
+
+static void test_hotspot(void) {
+    test_section("Testing D-Bus hotspot control");
+
+    hotspot_status_t status;
+    char active[4][MAX_STR_SSID];
+    int count = -1;
+
+    nm_dbus_backend.get_hotspot_status("MyHotspot", &status);
+    TEST_ASSERT_EQUAL_INT(HOTSPOT_STATE_STOPPED, status.state, "Hotspot initially stopped");
+
+    backend_result_t result = nm_dbus_backend.start_hotspot("MyHotspot");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result.result, "Hotspot starts");
+
+    nm_dbus_backend.get_hotspot_status("MyHotspot", &status);
+    TEST_ASSERT_EQUAL_INT(HOTSPOT_STATE_ACTIVE, status.state, "Hotspot active");
+
+    nm_dbus_backend.list_active_hotspots(active, 4, &count);
+    TEST_ASSERT_EQUAL_INT(1, count, "One active hotspot");
+    if (count > 0) {
+        TEST_ASSERT_EQUAL_STR("MyHotspot", active[0], "Active hotspot name");
+    }
+
+    result = nm_dbus_backend.stop_hotspot("MyHotspot");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result.result, "Hotspot stops");
+    nm_dbus_backend.list_active_hotspots(active, 4, &count);
+    TEST_ASSERT_EQUAL_INT(0, count, "No active hotspots");
+
+    result = nm_dbus_backend.start_hotspot("Unknown");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_HOTSPOT, result.result, "Unknown hotspot fails");
+
+    result = nm_dbus_backend.delete_hotspot("MyHotspot");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, result.result, "Hotspot deleted");
+    nm_dbus_backend.get_hotspot_status("MyHotspot", &status);
+    TEST_ASSERT_EQUAL_STR("Hotspot configuration not found", status.status_message,
+                          "Deleted hotspot not found");
+}
+
+int main(void) {
+    test_init("NetworkManager D-Bus Backend");
+
+    if (!start_private_bus()) {
+        printf("SKIP: could not start a private dbus-daemon\n");
+        stop_process(daemon_pid);
+        return test_finish();
+    }
+
+    mock_pid = fork();
+    if (mock_pid == 0) {
+        run_mock_network_manager();
+    }
+
+    TEST_ASSERT(wait_for_mock(), "Mock NetworkManager owns its bus name");
+
+    test_scan();
+    test_fresh_scan();
+    test_connect();
+    test_connect_cancel();
+    test_interfaces();
+    test_hotspot();
+
+    stop_process(mock_pid);
+    stop_process(daemon_pid);
+    return test_finish();
+}
@@ -0,0 +1,235 @@
+/**
+ * @file test_profile_index.c
+ * @brief Tests for the saved connection profile index and keyfile reader
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "test_utils.h"
+#include "../src/core/profile_index.h"
+#include "../src/utils/nm_keyfile.h"
+#include "../include/wterm/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void test_lookup(void) {
+    test_section("Profile lookup by SSID and name");
+
+    char list[] =
+        "Home:0a1b-home:802-11-wireless:0\n"
+        "Office Wi\\:Fi:0a1b-office:802-11-wireless:5\n"
+        "Renamed:0a1b-renamed:802-11-wireless:0\n"
+        "Office backup:0a1b-backup:802-11-wireless:-1\n"
+        "Wired connection 1:0a1b-wired:802-3-ethernet:0\n";
+    char details[] =
+        "connection.uuid:0a1b-home\n"
+        "802-11-wireless.ssid:Home\n"
+        "\n"
+        "connection.uuid:0a1b-office\n"
+        "802-11-wireless.ssid:Office\\:Net\n"
+        "\n"
+        "connection.uuid:0a1b-renamed\n"
+        "802-11-wireless.ssid:Cafe\n"
+        "\n"
+        "connection.uuid:0a1b-backup\n"
+        "802-11-wireless.ssid:Office\\:Net\n";
+
+    profile_index_t index = {0};
+    TEST_ASSERT_NULL(profile_index_find_ssid(&index, "Home"), "Empty index finds nothing");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, profile_index_parse(&index, list, details),
+                          "Profiles parsed");
+    TEST_ASSERT_EQUAL_INT(5, index.count, "All profiles indexed");
+
+    const saved_profile_t *profile = profile_index_find_ssid(&index, "Cafe");
+    TEST_ASSERT_NOT_NULL(profile, "Profile found by SSID");
+    if (profile) {
+        TEST_ASSERT_EQUAL_STR("Renamed", profile->name, "SSID differs from profile name");
+        TEST_ASSERT_EQUAL_STR("0a1b-renamed", profile->uuid, "UUID recorded");
+    }
+    TEST_ASSERT_NULL(profile_index_find_ssid(&index, "Renamed"), "Name is not the SSID");
+
+    profile = profile_index_find_ssid(&index, "Office:Net");
+    TEST_ASSERT(profile && strcmp(profile->name, "Office Wi:Fi") == 0,
+                "Highest autoconnect priority wins an SSID");
+    if (profile) {
+        TEST_ASSERT_EQUAL_INT(5, profile->autoconnect_priority, "Priority recorded");
+    }
+
+    profile = profile_index_find_name(&index, "Wired connection 1");
+    TEST_ASSERT(profile && strcmp(profile->type, "802-3-ethernet") == 0, "Lookup by name");
+    TEST_ASSERT_NULL(profile_index_find_ssid(&index, "Wired connection 1"),
+                     "Non-wireless profiles have no SSID");
+    TEST_ASSERT_NULL(profile_index_find_ssid(&index, "Unknown"), "Unknown SSID");
+
+    // Without details, wireless profiles are assumed to be named after their SSID
+    char names_only[] = "Home:0a1b-home:802-11-wireless:0\n";
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, profile_index_parse(&index, names_only, NULL),
+                          "Rebuilt without details");
+    TEST_ASSERT_EQUAL_INT(1, index.count, "Previous profiles dropped");
+    TEST_ASSERT_NOT_NULL(profile_index_find_ssid(&index, "Home"), "Name used as SSID");
+    TEST_ASSERT_NULL(profile_index_find_ssid(&index, "Cafe"), "Stale entries gone");
+
+    profile_index_free(&index);
+    TEST_ASSERT_NULL(index.profiles, "Free resets the index");
+}
+
+static void test_many_profiles(void) {
+    test_section("Many saved profiles");
+
+    const int total = 1000;
+    size_t size = (size_t)total * 64;
+    char *list = malloc(size);
+    TEST_ASSERT_NOT_NULL(list, "Buffer allocated");
+    if (!list) {
+        return;
+    }
+
+    size_t offset = 0;
+    for (int i = 0; i < total; i++) {
+        offset += (size_t)snprintf(list + offset, size - offset,
+                                   "net-%d:uuid-%d:802-11-wireless:0\n", i, i);
+    }
+
+    profile_index_t index = {0};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, profile_index_parse(&index, list, NULL),
+                          "Large profile list parsed");
+    TEST_ASSERT_EQUAL_INT(total, index.count, "No profiles dropped");
+
+    bool all_found = true;
+    char ssid[MAX_STR_SSID];
+    for (int i = 0; i < total; i++) {
+        snprintf(ssid, sizeof(ssid), "net-%d", i);
+        const saved_profile_t *profile = profile_index_find_ssid(&index, ssid);
+        if (!profile || strcmp(profile->name, ssid) != 0) {
+            all_found = false;
+        }
+    }
+    TEST_ASSERT(all_found, "Every profile found by SSID");
+    TEST_ASSERT(index.slot_count >= total * 2, "Tables stay at most half full");
+
+    profile_index_free(&index);
+    free(list);
+}
+
+static void test_keyfile_parse(void) {
+    test_section("NetworkManager keyfile parsing");
+
+    const char hotspot[] =
+        "# written by NetworkManager\n"
+        "[connection]\n"
+        "id=Cafe\\sHotspot\n"
+        "uuid=5f3c-hotspot\n"
+        "type=wifi\n"
+        "autoconnect-priority=3\n"
+        "\n"
+        "[wifi]\n"
+        "mode=ap\n"
+        "ssid=Cafe Guest\n"
+        "\n"
+        "[wifi-security]\n"
+        "psk=secret\n";
+    nm_keyfile_profile_t profile;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_keyfile_parse(hotspot, strlen(hotspot), &profile),
+                          "Hotspot keyfile parsed");
+    TEST_ASSERT_EQUAL_STR("Cafe Hotspot", profile.name, "Escaped id");
+    TEST_ASSERT_EQUAL_STR("5f3c-hotspot", profile.uuid, "UUID");
+    TEST_ASSERT_EQUAL_STR("802-11-wireless", profile.type, "Short type name expanded");
+    TEST_ASSERT_EQUAL_STR("Cafe Guest", profile.ssid, "SSID");
+    TEST_ASSERT_EQUAL_INT(3, profile.autoconnect_priority, "Autoconnect priority");
+    TEST_ASSERT(nm_keyfile_profile_is_ap(&profile), "AP mode detected");
+
+    const char bytes[] = "[connection]\ntype=802-11-wireless\n[802-11-wireless]\nssid=72;105;\n";
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_keyfile_parse(bytes, strlen(bytes), &profile),
+                          "Long section names accepted");
+    TEST_ASSERT_EQUAL_STR("Hi", profile.ssid, "SSID byte list decoded");
+    TEST_ASSERT(!nm_keyfile_profile_is_ap(&profile), "Client profile is not an AP");
+
+    const char not_a_profile[] = "[wifi]\nmode=ap\n";
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_PARSE,
+                          nm_keyfile_parse(not_a_profile, strlen(not_a_profile), &profile),
+                          "Keyfile without a connection type rejected");
+}
+
+static void write_file(const char *dir, const char *name, const char *content) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *file = fopen(path, "w");
+    if (file) {
+        fputs(content, file);
+        fclose(file);
+    }
+}
+
+static void test_keyfile_store(void) {
+    test_section("Keyfile directory store");
+
+    char dir[] = "/tmp/wterm-keyfiles-XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir), "Temporary directory");
+
+    write_file(dir, "Home.nmconnection",
+               "[connection]\nid=Home\ntype=wifi\n[wifi]\nssid=Home\n");
+    write_file(dir, "Share.nmconnection",
+               "[connection]\nid=Share\ntype=wifi\n[wifi]\nmode=ap\nssid=Share\n");
+    write_file(dir, "notes.txt", "[connection]\nid=Ignored\ntype=wifi\n");
+
+    nm_keyfile_store_t store;
+    nm_keyfile_store_init(&store, dir);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_keyfile_store_refresh(&store), "Directory read");
+    TEST_ASSERT_EQUAL_INT(2, store.count, "Only keyfiles loaded");
+    TEST_ASSERT(nm_keyfile_profile_is_ap(nm_keyfile_store_find(&store, "Share")),
+                "Hotspot found by name");
+    TEST_ASSERT_NULL(nm_keyfile_store_find(&store, "Ignored"), "Other files skipped");
+
+    // Unchanged directory: nothing is re-read
+    nm_keyfile_profile_t *first = store.profiles;
+    store.profiles[0].autoconnect_priority = 42;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_keyfile_store_refresh(&store), "Refresh");
+    TEST_ASSERT(store.inotify_fd < 0 || (store.profiles == first &&
+                                         store.profiles[0].autoconnect_priority == 42),
+                "Unchanged directory not re-read");
+
+    // A new profile is picked up by the watch
+    write_file(dir, "Lab.nmconnection",
+               "[connection]\nid=Lab\ntype=wifi\n[wifi]\nmode=ap\nssid=Lab\n");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, nm_keyfile_store_refresh(&store), "Refresh after change");
+    TEST_ASSERT_EQUAL_INT(3, store.count, "New keyfile loaded");
+    TEST_ASSERT_NOT_NULL(nm_keyfile_store_find(&store, "Lab"), "New profile found");
+
+    // Unreadable keyfiles make the caller fall back to nmcli
+    if (geteuid() != 0) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/Lab.nmconnection", dir);
+        chmod(path, 0);
+        TEST_ASSERT_EQUAL_INT(WTERM_ERROR_PERMISSION, nm_keyfile_store_refresh(&store),
+                              "Unreadable keyfile reported");
+        TEST_ASSERT_NULL(nm_keyfile_store_find(&store, "Home"), "No partial listing");
+    }
+
+    nm_keyfile_store_free(&store);
+    const char *names[] = {"Home.nmconnection", "Share.nmconnection", "Lab.nmconnection",
+                           "notes.txt"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        unlink(path);
+    }
+    rmdir(dir);
+
+    nm_keyfile_store_init(&store, "/nonexistent/wterm");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_GENERAL, nm_keyfile_store_refresh(&store),
+                          "Missing directory reported");
+    nm_keyfile_store_free(&store);
+}
+
+int main(void) {
+    test_init("Profile Index");
+
+    test_lookup();
+    test_many_profiles();
+    test_keyfile_parse();
+    test_keyfile_store();
+
+    return test_finish();
+}
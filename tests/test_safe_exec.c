@@ -0,0 +1,339 @@
+/**
+ * @file test_safe_exec.c
+ * @brief Tests for shell-free subprocess execution and output capture
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include "../src/utils/safe_exec.h"
+#include "../src/utils/capability.h"
+#include "../src/utils/query_cache.h"
+#include "test_utils.h"
+
+static long elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+static void test_capture_stdout_stderr(void) {
+    test_section("Capture stdout, stderr and exit code");
+
+    char *const args[] = {"sh", "-c", "echo out; echo err >&2; exit 3", NULL};
+    safe_exec_output_t output;
+
+    TEST_ASSERT(safe_exec_capture("sh", args, &output), "Capture failed");
+    TEST_ASSERT_EQUAL_STR("out\n", output.out, "Stdout not captured");
+    TEST_ASSERT_EQUAL_STR("err\n", output.err, "Stderr not captured separately");
+    TEST_ASSERT_EQUAL_INT(4, (int)output.out_len, "Stdout length wrong");
+    TEST_ASSERT_EQUAL_INT(3, output.exit_code, "Exit code not reported");
+    safe_exec_output_free(&output);
+
+    TEST_ASSERT_NULL(output.out, "Free should reset stdout buffer");
+    TEST_ASSERT_NULL(output.err, "Free should reset stderr buffer");
+}
+
+static void test_capture_verbatim_arguments(void) {
+    test_section("Arguments are passed verbatim");
+
+    // Characters that a shell would interpret must arrive unchanged
+    const char *tricky = "My \"Net\" 'x' $(id) `id`; rm -rf / | cat";
+    char *const args[] = {"printf", "%s", (char *)tricky, NULL};
+    safe_exec_output_t output;
+
+    TEST_ASSERT(safe_exec_capture("printf", args, &output), "Capture failed");
+    TEST_ASSERT_EQUAL_STR(tricky, output.out, "Argument was altered");
+    TEST_ASSERT_EQUAL_INT(0, output.exit_code, "printf should succeed");
+    safe_exec_output_free(&output);
+}
+
+static void test_capture_empty_and_missing(void) {
+    test_section("Empty output and missing programs");
+
+    char *const false_args[] = {"false", NULL};
+    safe_exec_output_t output;
+
+    TEST_ASSERT(safe_exec_capture("false", false_args, &output), "Capture failed");
+    TEST_ASSERT_NOT_NULL(output.out, "Empty stdout should be an empty string");
+    TEST_ASSERT_NOT_NULL(output.err, "Empty stderr should be an empty string");
+    TEST_ASSERT_EQUAL_STR("", output.out, "Stdout should be empty");
+    TEST_ASSERT(output.exit_code != 0, "false should fail");
+    safe_exec_output_free(&output);
+
+    char *const missing_args[] = {"wterm-no-such-program", NULL};
+    TEST_ASSERT(safe_exec_capture("wterm-no-such-program", missing_args, &output),
+                "Capture of missing program should still run");
+    TEST_ASSERT_EQUAL_INT(127, output.exit_code, "Missing program should exit 127");
+    safe_exec_output_free(&output);
+
+    TEST_ASSERT(!safe_exec_capture(NULL, missing_args, &output), "NULL program accepted");
+    TEST_ASSERT(!safe_exec_capture("false", NULL, &output), "NULL args accepted");
+}
+
+static void test_next_line(void) {
+    test_section("Line iteration");
+
+    char *const args[] = {"printf", "first\nsecond\n\nlast", NULL};
+    safe_exec_output_t output;
+
+    TEST_ASSERT(safe_exec_capture("printf", args, &output), "Capture failed");
+
+    char *cursor = output.out;
+    const char *expected[] = {"first", "second", "", "last"};
+    int line_count = 0;
+    char *line;
+    while ((line = safe_exec_next_line(&cursor)) && line_count < 4) {
+        TEST_ASSERT_EQUAL_STR(expected[line_count], line, "Line content wrong");
+        line_count++;
+    }
+    TEST_ASSERT_EQUAL_INT(4, line_count, "Empty or unterminated lines lost");
+    TEST_ASSERT_NULL(safe_exec_next_line(&cursor), "Iteration should end");
+
+    safe_exec_output_free(&output);
+}
+
+static void test_deadline(void) {
+    test_section("Deadline and kill escalation");
+
+    safe_exec_options_t options = {.timeout_ms = 200};
+    safe_exec_output_t output;
+    struct timespec start;
+
+    char *const sleep_args[] = {"sleep", "10", NULL};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_TIMEOUT,
+                          safe_exec_capture_ex("sleep", sleep_args, &options, &output),
+                          "Hung command should time out");
+    TEST_ASSERT(elapsed_ms(&start) < 2000, "Timeout should not wait for the child");
+    TEST_ASSERT_NULL(output.out, "No output is returned on timeout");
+
+    // A child ignoring SIGTERM is killed after the grace period
+    char *const stubborn_args[] = {"sh", "-c", "trap '' TERM; exec sleep 10", NULL};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_TIMEOUT,
+                          safe_exec_capture_ex("sh", stubborn_args, &options, &output),
+                          "SIGTERM-ignoring command should time out");
+    TEST_ASSERT(elapsed_ms(&start) < 200 + SAFE_EXEC_KILL_GRACE_MS + 1500,
+                "SIGKILL should follow the grace period");
+
+    // Output from a command that finishes in time is kept
+    char *const echo_args[] = {"echo", "quick", NULL};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          safe_exec_capture_ex("echo", echo_args, &options, &output),
+                          "Fast command should complete");
+    TEST_ASSERT_EQUAL_STR("quick\n", output.out, "Output lost under a deadline");
+    safe_exec_output_free(&output);
+}
+
+static void *cancel_after_delay(void *arg) {
+    int fd = *(int *)arg;
+    struct timespec delay = {0, 100000000}; // 100ms
+    nanosleep(&delay, NULL);
+    ssize_t written = write(fd, "x", 1);
+    (void)written;
+    return NULL;
+}
+
+static void test_cancellation(void) {
+    test_section("Cancellation");
+
+    int cancel_pipe[2];
+    TEST_ASSERT(pipe(cancel_pipe) == 0, "pipe() failed");
+
+    safe_exec_options_t options = {.timeout_ms = 10000, .cancel_fd = cancel_pipe[0]};
+    safe_exec_output_t output;
+    char *const args[] = {"sleep", "10", NULL};
+    struct timespec start;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, cancel_after_delay, &cancel_pipe[1]);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_CANCELLED,
+                          safe_exec_capture_ex("sleep", args, &options, &output),
+                          "Cancel descriptor should abort the command");
+    TEST_ASSERT(elapsed_ms(&start) < 2000, "Cancellation should be immediate");
+    pthread_join(thread, NULL);
+
+    // Already-cancelled requests never spawn
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_CANCELLED,
+                          safe_exec_capture_ex("sleep", args, &options, &output),
+                          "Pending cancellation should short-circuit");
+
+    close(cancel_pipe[0]);
+    close(cancel_pipe[1]);
+}
+
+static void test_capture_input(void) {
+    test_section("Input on stdin");
+
+    const char *text = "line one\nline two\n";
+    safe_exec_options_t options = {.input = text, .input_len = strlen(text)};
+    safe_exec_output_t output;
+    char *const cat_args[] = {"cat", NULL};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          safe_exec_capture_ex("cat", cat_args, &options, &output),
+                          "Capture with input failed");
+    TEST_ASSERT_EQUAL_STR(text, output.out, "Input not passed through");
+    safe_exec_output_free(&output);
+
+    // Larger than a pipe buffer, so it is written from the poll loop
+    size_t big_len = 1024 * 1024;
+    char *big = malloc(big_len);
+    TEST_ASSERT_NOT_NULL(big, "Allocation failed");
+    if (!big) {
+        return;
+    }
+    memset(big, 'x', big_len);
+    options.input = big;
+    options.input_len = big_len;
+    char *const wc_args[] = {"wc", "-c", NULL};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, safe_exec_capture_ex("wc", wc_args, &options, &output),
+                          "Capture with large input failed");
+    TEST_ASSERT_EQUAL_INT((int)big_len, atoi(output.out), "Large input truncated");
+    safe_exec_output_free(&output);
+
+    // A child that never reads its input exits normally
+    char *const true_args[] = {"true", NULL};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS,
+                          safe_exec_capture_ex("true", true_args, &options, &output),
+                          "Unread input should not fail the command");
+    TEST_ASSERT_EQUAL_INT(0, output.exit_code, "true should succeed");
+    safe_exec_output_free(&output);
+    free(big);
+}
+
+static void test_capability_registry(void) {
+    test_section("Capability registry");
+
+    char path[256];
+    TEST_ASSERT(capability_resolve("sh", path, sizeof(path)), "sh should resolve in PATH");
+    TEST_ASSERT(path[0] == '/', "Resolved path should be absolute");
+    TEST_ASSERT(!capability_resolve("wterm-no-such-program", path, sizeof(path)),
+                "Missing program should not resolve");
+    TEST_ASSERT(capability_resolve("/bin/sh", NULL, 0), "Absolute path should resolve");
+    TEST_ASSERT(!capability_resolve("/etc/passwd", NULL, 0), "Non-executable should not resolve");
+
+    // Lookups must not spawn anything
+    unsigned long spawns = safe_exec_spawn_count();
+    TEST_ASSERT(safe_command_exists("sh"), "safe_command_exists(sh) failed");
+    TEST_ASSERT(!safe_command_exists("wterm-no-such-program"), "Missing program reported");
+    capability_available(CAPABILITY_NMCLI);
+    capability_available(CAPABILITY_IW);
+    TEST_ASSERT_EQUAL_INT(spawns, safe_exec_spawn_count(), "Lookups should not fork");
+
+    capability_t capability;
+    TEST_ASSERT(capability_from_name("iw", &capability), "iw should be a known capability");
+    TEST_ASSERT_EQUAL_INT(CAPABILITY_IW, capability, "iw maps to CAPABILITY_IW");
+    TEST_ASSERT_EQUAL_STR("nmcli", capability_name(CAPABILITY_NMCLI), "Capability name wrong");
+
+    // Results are cached until reset, even if PATH changes
+    const char *old_path = getenv("PATH");
+    char saved_path[4096];
+    snprintf(saved_path, sizeof(saved_path), "%s", old_path ? old_path : "");
+    bool had_ip = capability_available(CAPABILITY_IP);
+    if (had_ip) {
+        char ip_path[CAPABILITY_PATH_MAX];
+        TEST_ASSERT(capability_path(CAPABILITY_IP, ip_path, sizeof(ip_path)) && ip_path[0] == '/',
+                    "Path copied out of the registry");
+        TEST_ASSERT(!capability_path(CAPABILITY_IP, ip_path, 2), "Short buffer rejected");
+    }
+    setenv("PATH", "/nonexistent", 1);
+    TEST_ASSERT(capability_available(CAPABILITY_IP) == had_ip, "Lookup should be cached");
+    capability_reset();
+    TEST_ASSERT(!capability_available(CAPABILITY_IP), "Reset should re-resolve");
+    setenv("PATH", saved_path, 1);
+    capability_reset();
+
+    // Spawns are counted
+    char *const args[] = {"true", NULL};
+    safe_exec_check_silent("true", args);
+    TEST_ASSERT_EQUAL_INT(spawns + 1, safe_exec_spawn_count(), "Spawn should be counted");
+}
+
+static void test_query_cache(void) {
+    test_section("Query cache");
+
+    query_cache_invalidate();
+    query_cache_stats_t before;
+    query_cache_get_stats(&before);
+    unsigned long spawns = safe_exec_spawn_count();
+
+    char *const args[] = {"sh", "-c", "echo cached", NULL};
+    safe_exec_output_t output;
+    TEST_ASSERT(query_cache_capture("sh", args, 10000, &output), "First query runs");
+    TEST_ASSERT_EQUAL_STR("cached\n", output.out, "First query output");
+    output.out[0] = 'X'; // Callers may split output in place
+    safe_exec_output_free(&output);
+
+    TEST_ASSERT(query_cache_capture("sh", args, 10000, &output), "Repeated query served");
+    TEST_ASSERT_EQUAL_STR("cached\n", output.out, "Cached output is a private copy");
+    TEST_ASSERT_EQUAL_INT(0, output.exit_code, "Cached exit code");
+    safe_exec_output_free(&output);
+    TEST_ASSERT_EQUAL_INT(spawns + 1, safe_exec_spawn_count(), "Repeated query did not spawn");
+
+    // Arguments are part of the key
+    char *const other_args[] = {"sh", "-c", "echo other", NULL};
+    TEST_ASSERT(query_cache_capture("sh", other_args, 10000, &output), "Other query runs");
+    TEST_ASSERT_EQUAL_STR("other\n", output.out, "Other query output");
+    safe_exec_output_free(&output);
+
+    // Failures are not cached
+    char *const failing_args[] = {"sh", "-c", "exit 4", NULL};
+    query_cache_capture("sh", failing_args, 10000, &output);
+    safe_exec_output_free(&output);
+    query_cache_capture("sh", failing_args, 10000, &output);
+    TEST_ASSERT_EQUAL_INT(4, output.exit_code, "Failed query exit code");
+    safe_exec_output_free(&output);
+    TEST_ASSERT_EQUAL_INT(spawns + 4, safe_exec_spawn_count(), "Failed query re-run");
+
+    // Expired entries and invalidation force a re-run
+    char *const short_args[] = {"sh", "-c", "echo short", NULL};
+    struct timespec delay = {0, 30000000}; // 30ms
+    query_cache_capture("sh", short_args, 10, &output);
+    safe_exec_output_free(&output);
+    nanosleep(&delay, NULL);
+    query_cache_capture("sh", short_args, 10, &output);
+    safe_exec_output_free(&output);
+    TEST_ASSERT_EQUAL_INT(spawns + 6, safe_exec_spawn_count(), "Expired entry re-run");
+
+    query_cache_invalidate();
+    query_cache_capture("sh", args, 10000, &output);
+    safe_exec_output_free(&output);
+    TEST_ASSERT_EQUAL_INT(spawns + 7, safe_exec_spawn_count(), "Invalidated entry re-run");
+
+    query_cache_stats_t after;
+    query_cache_get_stats(&after);
+    TEST_ASSERT_EQUAL_INT(1, (int)(after.hits - before.hits), "Hits counted");
+    TEST_ASSERT_EQUAL_INT(7, (int)(after.misses - before.misses), "Misses counted");
+    TEST_ASSERT_EQUAL_INT(1, (int)(after.invalidations - before.invalidations),
+                          "Invalidations counted");
+    TEST_ASSERT_EQUAL_INT(1, after.entries, "Only the latest result held");
+
+    // A zero TTL bypasses the cache
+    query_cache_capture("sh", args, 0, &output);
+    safe_exec_output_free(&output);
+    TEST_ASSERT_EQUAL_INT(spawns + 8, safe_exec_spawn_count(), "Zero TTL spawns");
+    query_cache_invalidate();
+}
+
+int main(void) {
+    test_init("Safe Exec Tests");
+
+    test_capture_stdout_stderr();
+    test_capture_verbatim_arguments();
+    test_capture_empty_and_missing();
+    test_next_line();
+    test_deadline();
+    test_cancellation();
+    test_capture_input();
+    test_capability_registry();
+    test_query_cache();
+
+    return test_finish();
+}
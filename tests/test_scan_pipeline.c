@@ -0,0 +1,246 @@
+/**
+ * @file test_scan_pipeline.c
+ * @brief Tests for SSID grouping, ranking and diffing of scan results
+ */
+
+#include "test_utils.h"
+#include "../src/core/scan_delta.h"
+#include "../src/core/scan_pipeline.h"
+#include "../src/utils/network_list.h"
+#include "../include/wterm/common.h"
+#include <stdio.h>
+#include <string.h>
+
+static void add_network(network_list_t *list, const char *ssid, int quality, uint8_t flags) {
+    network_info_t *network = network_list_append(list);
+    if (!network) {
+        return;
+    }
+    snprintf(network->ssid, MAX_STR_SSID, "%s", ssid);
+    snprintf(network->signal, MAX_STR_SIGNAL, "%d", quality);
+    scan_record_t record = {.quality = (uint8_t)quality, .security_flags = flags};
+    network_list_set_record(list, list->count - 1, &record);
+}
+
+static void add_bss(network_list_t *list, const char *ssid, uint8_t last_octet,
+                    int quality, uint8_t flags) {
+    add_network(list, ssid, quality, flags);
+    list->bssid[list->count - 1][0] = 0x02;
+    list->bssid[list->count - 1][5] = last_octet;
+}
+
+static const scan_change_t *find_change(const scan_delta_t *delta, const network_list_t *list,
+                                        uint8_t flag, const char *ssid) {
+    for (int i = 0; i < delta->change_count; i++) {
+        const scan_change_t *change = &delta->changes[i];
+        const network_list_t *source = (change->flags & SCAN_CHANGE_REMOVED) ? &delta->removed : list;
+        if ((change->flags & flag) && strcmp(source->networks[change->index].ssid, ssid) == 0) {
+            return change;
+        }
+    }
+    return NULL;
+}
+
+static bool known_office(const char *ssid, void *user_data) {
+    int *calls = user_data;
+    (*calls)++;
+    return strcmp(ssid, "Office") == 0;
+}
+
+static void test_grouping(void) {
+    test_section("Grouping BSSIDs by SSID");
+
+    network_list_t list = {0};
+    add_network(&list, "Cafe", 40, 0);
+    add_network(&list, "Home", 60, NETWORK_SECURITY_WPA2);
+    add_network(&list, "", 90, 0);                          // Hidden
+    add_network(&list, "Home", 85, NETWORK_SECURITY_WPA2);  // Stronger BSSID
+    add_network(&list, "Cafe", 20, 0);
+    add_network(&list, "Home", 70, NETWORK_SECURITY_WPA2);
+
+    scan_view_t view = {0};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_view_build(&view, &list, NULL), "Build succeeds");
+    TEST_ASSERT_EQUAL_INT(2, view.count, "One entry per SSID, hidden skipped");
+    TEST_ASSERT_EQUAL_INT(3, view.order[0], "Strongest Home BSSID represents the group");
+    TEST_ASSERT_EQUAL_INT(3, view.group_size[0], "Home group size");
+    TEST_ASSERT_EQUAL_INT(0, view.order[1], "Strongest Cafe BSSID represents the group");
+    TEST_ASSERT_EQUAL_INT(2, view.group_size[1], "Cafe group size");
+
+    // Empty lists produce empty views, and views are reusable
+    network_list_t empty = {0};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_view_build(&view, &empty, NULL), "Empty build");
+    TEST_ASSERT_EQUAL_INT(0, view.count, "Empty view");
+
+    scan_view_free(&view);
+    network_list_free(&list);
+}
+
+static void test_ranking(void) {
+    test_section("Ranking by known status, signal and security");
+
+    network_list_t list = {0};
+    add_network(&list, "OpenA", 50, 0);
+    add_network(&list, "Secure", 50, NETWORK_SECURITY_WPA2 | NETWORK_SECURITY_WPA3);
+    add_network(&list, "OpenB", 50, 0);
+    add_network(&list, "Strong", 80, 0);
+    add_network(&list, "Office", 10, NETWORK_SECURITY_WPA2);
+
+    int calls = 0;
+    scan_pipeline_options_t options = {.is_known = known_office, .user_data = &calls};
+    scan_view_t view = {0};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_view_build(&view, &list, &options), "Build succeeds");
+    TEST_ASSERT_EQUAL_INT(5, calls, "Known callback runs once per SSID");
+
+    const char *expected[] = {"Office", "Strong", "Secure", "OpenA", "OpenB"};
+    for (int i = 0; i < 5 && i < view.count; i++) {
+        TEST_ASSERT_EQUAL_STR(expected[i], list.networks[view.order[i]].ssid, "Rank order");
+    }
+    TEST_ASSERT(view.known[0] && !view.known[1], "Known flags follow the ranking");
+
+    TEST_ASSERT(scan_security_rank(NETWORK_SECURITY_WPA3) > scan_security_rank(NETWORK_SECURITY_WPA2),
+                "WPA3 outranks WPA2");
+    TEST_ASSERT_EQUAL_INT(0, scan_security_rank(0), "Open has the lowest rank");
+
+    scan_view_free(&view);
+    network_list_free(&list);
+}
+
+static void test_dense_environment(void) {
+    test_section("Dense environment");
+
+    // 4000 BSSIDs across 1000 SSIDs
+    network_list_t list = {0};
+    char ssid[MAX_STR_SSID];
+    for (int i = 0; i < 4000; i++) {
+        snprintf(ssid, sizeof(ssid), "corp-%d", i % 1000);
+        add_network(&list, ssid, i % 100, 0);
+    }
+
+    scan_view_t view = {0};
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_view_build(&view, &list, NULL), "Build succeeds");
+    TEST_ASSERT_EQUAL_INT(1000, view.count, "Every SSID grouped once");
+
+    bool sorted = true;
+    bool sizes_ok = true;
+    for (int i = 0; i < view.count; i++) {
+        if (i > 0 && list.quality[view.order[i - 1]] < list.quality[view.order[i]]) {
+            sorted = false;
+        }
+        if (view.group_size[i] != 4) {
+            sizes_ok = false;
+        }
+    }
+    TEST_ASSERT(sorted, "Ranked by signal");
+    TEST_ASSERT(sizes_ok, "Four BSSIDs per SSID");
+
+    scan_view_free(&view);
+    network_list_free(&list);
+}
+
+static void test_delta_by_bssid(void) {
+    test_section("Scan delta keyed by BSSID");
+
+    scan_delta_t delta;
+    scan_delta_init(&delta, SCAN_DELTA_KEY_BSSID, 10);
+
+    network_list_t scan = {0};
+    add_bss(&scan, "Home", 1, 70, NETWORK_SECURITY_WPA2);
+    add_bss(&scan, "Home", 2, 40, NETWORK_SECURITY_WPA2);
+    add_bss(&scan, "Cafe", 3, 50, 0);
+
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_delta_update(&delta, &scan), "First update");
+    TEST_ASSERT(delta.primed, "Delta primed after the first update");
+    TEST_ASSERT_EQUAL_INT(3, delta.change_count, "Everything is added on the first scan");
+
+    // Identical rescan reports nothing
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_delta_update(&delta, &scan), "Same scan");
+    TEST_ASSERT_EQUAL_INT(0, delta.change_count, "No changes for an identical scan");
+
+    // Cafe gone, a new Home BSSID, signal and security changes
+    network_list_clear(&scan);
+    add_bss(&scan, "Home", 1, 75, NETWORK_SECURITY_WPA2);                          // Below threshold
+    add_bss(&scan, "Home", 2, 60, NETWORK_SECURITY_WPA2 | NETWORK_SECURITY_WPA3);  // Both
+    add_bss(&scan, "Home", 4, 30, NETWORK_SECURITY_WPA2);                          // New
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_delta_update(&delta, &scan), "Changed scan");
+    TEST_ASSERT_EQUAL_INT(3, delta.change_count, "Added, changed and removed");
+
+    const scan_change_t *change = find_change(&delta, &scan, SCAN_CHANGE_SIGNAL, "Home");
+    TEST_ASSERT_NOT_NULL(change, "Signal change reported");
+    if (change) {
+        TEST_ASSERT_EQUAL_INT(1, change->index, "Change refers to the scan entry");
+        TEST_ASSERT_EQUAL_INT(40, change->previous_quality, "Previous quality kept");
+        TEST_ASSERT(change->flags & SCAN_CHANGE_SECURITY, "Security change reported");
+    }
+    change = find_change(&delta, &scan, SCAN_CHANGE_ADDED, "Home");
+    TEST_ASSERT(change && change->index == 2, "New BSSID added");
+    change = find_change(&delta, &scan, SCAN_CHANGE_REMOVED, "Cafe");
+    TEST_ASSERT_NOT_NULL(change, "Missing BSSID removed");
+    if (change) {
+        TEST_ASSERT_EQUAL_INT(3, delta.removed.bssid[change->index][5], "Removed entry kept");
+    }
+
+    // Drift accumulates from the last reported value (70 -> 75 -> 81)
+    scan.quality[0] = 81;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_delta_update(&delta, &scan), "Drifted scan");
+    TEST_ASSERT_EQUAL_INT(1, delta.change_count, "Accumulated drift reported");
+    TEST_ASSERT(delta.change_count == 1 && delta.changes[0].previous_quality == 70,
+                "Drift measured from the reported value");
+
+    scan_delta_reset(&delta);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_delta_update(&delta, &scan), "Update after reset");
+    TEST_ASSERT_EQUAL_INT(3, delta.change_count, "Reset reports everything again");
+
+    scan_delta_free(&delta);
+    network_list_free(&scan);
+}
+
+static void test_delta_by_ssid(void) {
+    test_section("Scan delta keyed by SSID");
+
+    scan_delta_t delta;
+    scan_delta_init(&delta, SCAN_DELTA_KEY_SSID, 5);
+
+    network_list_t scan = {0};
+    add_bss(&scan, "Home", 1, 40, NETWORK_SECURITY_WPA2);
+    add_bss(&scan, "Home", 2, 70, NETWORK_SECURITY_WPA2);
+    add_bss(&scan, "", 3, 90, 0);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_delta_update(&delta, &scan), "First update");
+    TEST_ASSERT_EQUAL_INT(1, delta.change_count, "One entry per SSID, hidden ignored");
+    TEST_ASSERT(delta.change_count == 1 && delta.changes[0].index == 1,
+                "Strongest BSSID represents the SSID");
+
+    // Roaming between BSSIDs of similar strength is not a change
+    network_list_clear(&scan);
+    add_bss(&scan, "Home", 5, 72, NETWORK_SECURITY_WPA2);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_delta_update(&delta, &scan), "Roamed scan");
+    TEST_ASSERT_EQUAL_INT(0, delta.change_count, "BSSID change alone is not reported");
+
+    // Many networks appearing at once
+    char ssid[MAX_STR_SSID];
+    for (int i = 0; i < 2000; i++) {
+        snprintf(ssid, sizeof(ssid), "net-%d", i);
+        add_bss(&scan, ssid, (uint8_t)i, 50, 0);
+    }
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_delta_update(&delta, &scan), "Large scan");
+    TEST_ASSERT_EQUAL_INT(2000, delta.change_count, "Only the new networks are reported");
+
+    network_list_clear(&scan);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, scan_delta_update(&delta, &scan), "Empty scan");
+    TEST_ASSERT_EQUAL_INT(2001, delta.change_count, "Everything removed");
+    TEST_ASSERT_EQUAL_INT(2001, delta.removed.count, "Removed entries retained");
+
+    scan_delta_free(&delta);
+    network_list_free(&scan);
+}
+
+int main(void) {
+    test_init("Scan Pipeline");
+
+    test_grouping();
+    test_ranking();
+    test_dense_environment();
+    test_delta_by_bssid();
+    test_delta_by_ssid();
+
+    return test_finish();
+}
@@ -98,6 +98,26 @@ static void test_find_nth_char(void) {
     TEST_ASSERT_NULL(result, "Zero index");
 }
 
+static void test_split_terse_fields(void) {
+    test_section("Testing split_terse_fields");
+
+    char *fields[4];
+    char line[] = "AA\\:BB:My\\:Net:back\\\\slash:";
+    int count = split_terse_fields(line, fields, 4);
+    TEST_ASSERT_EQUAL_INT(4, count, "Escaped colons do not split");
+    TEST_ASSERT_EQUAL_STR("AA:BB", fields[0], "Escaped colon unescaped");
+    TEST_ASSERT_EQUAL_STR("My:Net", fields[1], "Escaped colon in second field");
+    TEST_ASSERT_EQUAL_STR("back\\slash", fields[2], "Escaped backslash unescaped");
+    TEST_ASSERT_EQUAL_STR("", fields[3], "Trailing empty field");
+
+    char rest[] = "a:b:c:d";
+    count = split_terse_fields(rest, fields, 2);
+    TEST_ASSERT_EQUAL_INT(2, count, "Field count capped");
+    TEST_ASSERT_EQUAL_STR("b:c:d", fields[1], "Last field keeps the rest");
+
+    TEST_ASSERT_EQUAL_INT(0, split_terse_fields(NULL, fields, 2), "NULL line");
+}
+
 int main(void) {
     test_init("String Utilities");
 
@@ -105,6 +125,7 @@ int main(void) {
     test_trim_functions();
     test_is_string_empty();
     test_find_nth_char();
+    test_split_terse_fields();
 
     return test_finish();
 }
\ No newline at end of file
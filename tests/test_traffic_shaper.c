@@ -0,0 +1,505 @@
+/**
+ * @file test_traffic_shaper.c
+ * @brief Tests for hotspot rate limits
+ *
+ * Plans and the rendered `tc -batch` scripts are checked everywhere. With
+ * ip and tc installed, a bridge in a private network namespace stands in
+ * for the AP, with two clients in namespaces of their own behind it. Bulk
+ * TCP transfers to the clients then check that the limits hold and that
+ * a light client keeps a short round trip while a heavy one saturates.
+ */
+
+#define _GNU_SOURCE
+#include "test_utils.h"
+#include "../src/core/traffic_shaper.h"
+#include "../src/utils/capability.h"
+#include "../src/utils/safe_exec.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SINK_PORT 5001
+#define ECHO_PORT 5002
+#define CLIENT_RATE_KBIT 2000
+#define HOTSPOT_RATE_KBIT 3000
+#define LOAD_MS 3000
+#define WARMUP_MS 1000
+#define MAX_RTT_MS 100.0
+
+static void test_plan(void) {
+    test_section("Plans");
+
+    shaper_plan_t plan;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, shaper_plan_init(&plan, "wlan0", 0, 0), "Plan created");
+    TEST_ASSERT(!shaper_plan_active(&plan), "No limits, nothing to shape");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT, shaper_plan_init(&plan, "wlan0 root", 1, 0),
+                          "Interface cannot inject batch commands");
+
+    shaper_plan_init(&plan, "wlan0", 0, 1000);
+    TEST_ASSERT(shaper_plan_active(&plan), "A client limit alone is enough");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, shaper_plan_add_client(&plan, "AA:BB:CC:DD:EE:0F", 0),
+                          "MAC key accepted");
+    TEST_ASSERT_EQUAL_STR("aa:bb:cc:dd:ee:0f", plan.clients[0].key, "MAC normalised");
+    TEST_ASSERT(plan.clients[0].is_mac, "MAC key recognised");
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, shaper_plan_add_client(&plan, "192.168.12.34", 500),
+                          "IP key accepted");
+    TEST_ASSERT(!plan.clients[1].is_mac, "IP key recognised");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT,
+                          shaper_plan_add_client(&plan, "aa:bb:cc:dd:ee:ff flowid 1:1", 0),
+                          "Key cannot inject filter arguments");
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_INVALID_INPUT, shaper_plan_add_client(&plan, "Unknown", 0),
+                          "Unknown key rejected");
+
+    hotspot_client_t stations[3] = {
+        {.mac_address = "02:00:00:00:00:01", .ip_address = "Unknown"},
+        {.mac_address = "Unknown", .ip_address = "10.0.0.7"},
+        {.mac_address = "Unknown", .ip_address = "Unknown"},
+    };
+    shaper_plan_init(&plan, "wlan0", 0, 1000);
+    shaper_plan_add_stations(&plan, stations, 3);
+    TEST_ASSERT_EQUAL_INT(2, plan.client_count, "Stations without a key stay in the default class");
+    TEST_ASSERT_EQUAL_STR("02:00:00:00:00:01", plan.clients[0].key, "Station keyed by MAC");
+    TEST_ASSERT_EQUAL_STR("10.0.0.7", plan.clients[1].key, "Station keyed by IP");
+}
+
+static void test_render(void) {
+    test_section("Rendered tc batches");
+
+    shaper_plan_t plan;
+    shaper_plan_init(&plan, "wlan0", 3000, 2000);
+    shaper_plan_add_client(&plan, "02:00:00:00:00:01", 0);
+    shaper_plan_add_client(&plan, "10.0.0.7", 500);
+    char script[2048];
+
+    TEST_ASSERT(shaper_render(&plan, SHAPER_LEAF_FQ_CODEL, true, script, sizeof(script)) > 0,
+                "Tree rendered");
+    TEST_ASSERT_EQUAL_STR(
+        "qdisc add dev wlan0 root handle 1: htb default 2\n"
+        "class add dev wlan0 parent 1: classid 1:1 htb rate 3000kbit ceil 3000kbit\n"
+        "class replace dev wlan0 parent 1:1 classid 1:2 htb rate 1000kbit ceil 3000kbit\n"
+        "qdisc replace dev wlan0 parent 1:2 handle 2: fq_codel\n"
+        "class replace dev wlan0 parent 1:1 classid 1:100 htb rate 1000kbit ceil 2000kbit\n"
+        "qdisc replace dev wlan0 parent 1:100 handle 100: fq_codel\n"
+        "filter replace dev wlan0 parent 1: protocol all prio 1 handle 800::1 u32"
+        " match ether dst 02:00:00:00:00:01 flowid 1:100\n"
+        "class replace dev wlan0 parent 1:1 classid 1:101 htb rate 500kbit ceil 500kbit\n"
+        "qdisc replace dev wlan0 parent 1:101 handle 101: fq_codel\n"
+        "filter replace dev wlan0 parent 1: protocol all prio 1 handle 800::2 u32"
+        " match u16 0x0800 0xffff at -2 match ip dst 10.0.0.7/32 flowid 1:101\n",
+        script, "Equal shares, each client capped at its own limit, unknown ones at the hotspot's");
+
+    shaper_plan_init(&plan, "wlan0", 0, 0);
+    shaper_plan_add_client(&plan, "10.0.0.7", 0);
+    TEST_ASSERT(shaper_render(&plan, SHAPER_LEAF_FIFO, false, script, sizeof(script)) > 0,
+                "Station update rendered");
+    TEST_ASSERT_EQUAL_STR(
+        "class replace dev wlan0 parent 1:1 classid 1:2 htb rate 5000000kbit ceil 10000000kbit\n"
+        "qdisc replace dev wlan0 parent 1:2 handle 2: pfifo limit 1000\n"
+        "class replace dev wlan0 parent 1:1 classid 1:100 htb rate 5000000kbit ceil 10000000kbit\n"
+        "qdisc replace dev wlan0 parent 1:100 handle 100: pfifo limit 1000\n"
+        "filter replace dev wlan0 parent 1: protocol all prio 1 handle 800::1 u32"
+        " match u16 0x0800 0xffff at -2 match ip dst 10.0.0.7/32 flowid 1:100\n",
+        script, "Update leaves the root alone; FIFO depth capped");
+
+    shaper_plan_init(&plan, "wlan0", 0, 1000);
+    shaper_plan_add_client(&plan, "10.0.0.7", 0);
+    TEST_ASSERT(shaper_render(&plan, SHAPER_LEAF_CAKE, false, script, sizeof(script)) > 0 &&
+                    strstr(script, "handle 2: cake unlimited besteffort\n") != NULL,
+                "CAKE leaf rendered");
+    TEST_ASSERT(shaper_render(&plan, SHAPER_LEAF_FIFO, false, script, sizeof(script)) > 0 &&
+                    strstr(script, "handle 100: pfifo limit 4\n") != NULL,
+                "Slow FIFO keeps a minimum depth");
+    TEST_ASSERT(strstr(script, "classid 1:2 htb rate 5000000kbit ceil 10000000kbit\n") != NULL,
+                "Without a hotspot limit, unknown clients are not capped");
+
+    int slots[] = {1, 2};
+    TEST_ASSERT(shaper_render_prune("wlan0", slots, 2, script, sizeof(script)) > 0,
+                "Prune rendered");
+    TEST_ASSERT_EQUAL_STR(
+        "filter del dev wlan0 parent 1: protocol all prio 1 handle 800::2 u32\n"
+        "class del dev wlan0 classid 1:101\n"
+        "filter del dev wlan0 parent 1: protocol all prio 1 handle 800::3 u32\n"
+        "class del dev wlan0 classid 1:102\n",
+        script, "Filters go before their classes");
+
+    TEST_ASSERT_EQUAL_INT(0, (int)shaper_render(&plan, SHAPER_LEAF_FQ_CODEL, true, script, 40),
+                          "Short buffer rejected");
+}
+
+static bool ip_run(const char *a, const char *b, const char *c, const char *d, const char *e,
+                   const char *f, const char *g) {
+    char *const args[] = {"ip", (char *)a, (char *)b, (char *)c, (char *)d, (char *)e,
+                          (char *)f, (char *)g, NULL};
+    return safe_exec_command("ip", args) == 0;
+}
+
+// Does the output of `tc <object> show dev <iface>` contain needle?
+static bool tc_shows(const char *needle, const char *object, const char *iface) {
+    char *const args[] = {"tc", (char *)object, "show", "dev", (char *)iface, NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("tc", args, &output)) {
+        return false;
+    }
+    bool found = strstr(output.out, needle) != NULL;
+    safe_exec_output_free(&output);
+    return found;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int bound_socket(int type, const char *ip, int port) {
+    int fd = socket(AF_INET, type, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(port)};
+    inet_pton(AF_INET, ip, &addr.sin_addr);
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        (type == SOCK_STREAM && listen(fd, 8) != 0)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+// Client side: discard TCP data and echo UDP probes until killed
+static void serve_client(int ready, const char *ip) {
+    int sink = bound_socket(SOCK_STREAM, ip, SINK_PORT);
+    int echo = bound_socket(SOCK_DGRAM, ip, ECHO_PORT);
+    if (sink < 0 || echo < 0 || write(ready, "r", 1) != 1) {
+        _exit(1);
+    }
+
+    struct pollfd fds[16] = {{.fd = sink, .events = POLLIN}, {.fd = echo, .events = POLLIN}};
+    int count = 2;
+    char buffer[65536];
+    for (;;) {
+        if (poll(fds, count, -1) < 0 && errno != EINTR) {
+            _exit(1);
+        }
+        if ((fds[0].revents & POLLIN) && count < 16) {
+            int conn = accept(sink, NULL, NULL);
+            if (conn >= 0) {
+                fds[count++] = (struct pollfd){.fd = conn, .events = POLLIN};
+            }
+        }
+        if (fds[1].revents & POLLIN) {
+            struct sockaddr_in from;
+            socklen_t from_len = sizeof(from);
+            ssize_t len = recvfrom(echo, buffer, sizeof(buffer), 0,
+                                   (struct sockaddr *)&from, &from_len);
+            if (len > 0) {
+                sendto(echo, buffer, (size_t)len, 0, (struct sockaddr *)&from, from_len);
+            }
+        }
+        for (int i = 2; i < count; i++) {
+            if (fds[i].revents && read(fds[i].fd, buffer, sizeof(buffer)) <= 0) {
+                close(fds[i].fd);
+                fds[i--] = fds[--count];
+            }
+        }
+    }
+}
+
+typedef struct {
+    pid_t pid;
+    char ip[16];
+    char mac[18];
+} client_ns_t;
+
+// Start a client in a namespace of its own, moving iface into it
+static bool start_client(client_ns_t *client, const char *iface, const char *ip) {
+    snprintf(client->ip, sizeof(client->ip), "%s", ip);
+
+    // The MAC moves with the interface
+    char *const link_args[] = {"ip", "-o", "link", "show", "dev", (char *)iface, NULL};
+    safe_exec_output_t output;
+    if (!safe_exec_capture("ip", link_args, &output)) {
+        return false;
+    }
+    const char *ether = strstr(output.out, "link/ether ");
+    bool have_mac = ether && sscanf(ether, "link/ether %17s", client->mac) == 1;
+    safe_exec_output_free(&output);
+
+    int to_child[2];
+    int from_child[2];
+    if (!have_mac || pipe(to_child) != 0) {
+        return false;
+    }
+    if (pipe(from_child) != 0) {
+        close(to_child[0]);
+        close(to_child[1]);
+        return false;
+    }
+
+    fflush(stdout);
+    client->pid = fork();
+    if (client->pid == 0) {
+        close(to_child[1]);
+        close(from_child[0]);
+        char go;
+        if (unshare(CLONE_NEWNET) != 0 || write(from_child[1], "n", 1) != 1 ||
+            read(to_child[0], &go, 1) != 1) {
+            _exit(1);
+        }
+        char address[24];
+        snprintf(address, sizeof(address), "%s/24", ip);
+        if (!ip_run("link", "set", "lo", "up", NULL, NULL, NULL) ||
+            !ip_run("link", "set", iface, "up", NULL, NULL, NULL) ||
+            !ip_run("addr", "add", address, "dev", iface, NULL, NULL)) {
+            _exit(1);
+        }
+        serve_client(from_child[1], ip);
+    }
+    close(to_child[0]);
+    close(from_child[1]);
+
+    // Child unshared, interface moved, child listening
+    char pid[16];
+    char state;
+    snprintf(pid, sizeof(pid), "%d", (int)client->pid);
+    bool ok = client->pid > 0 && read(from_child[0], &state, 1) == 1 &&
+              ip_run("link", "set", iface, "netns", pid, NULL, NULL) &&
+              write(to_child[1], "g", 1) == 1 && read(from_child[0], &state, 1) == 1;
+    close(to_child[1]);
+    close(from_child[0]);
+    return ok;
+}
+
+static void stop_client(client_ns_t *client) {
+    if (client->pid > 0) {
+        kill(client->pid, SIGKILL);
+        waitpid(client->pid, NULL, 0);
+        client->pid = 0;
+    }
+}
+
+typedef struct {
+    const char *ip;
+    int fd;
+    unsigned long long sent;
+    unsigned long long warm; // Sent when the warmup ended
+} flow_t;
+
+/**
+ * Push bulk TCP to every flow for LOAD_MS while probing one client's UDP
+ * echo every 50 ms. Rates (kbit/s) and the worst probe round trip are
+ * measured after WARMUP_MS.
+ */
+static bool run_load(flow_t *flows, int count, const char *probe_ip, double *max_rtt_ms) {
+    *max_rtt_ms = 0;
+    for (int i = 0; i < count; i++) {
+        flows[i].fd = socket(AF_INET, SOCK_STREAM, 0);
+        int sndbuf = 16384;
+        setsockopt(flows[i].fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(SINK_PORT)};
+        inet_pton(AF_INET, flows[i].ip, &addr.sin_addr);
+        if (connect(flows[i].fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            return false;
+        }
+        fcntl(flows[i].fd, F_SETFL, O_NONBLOCK);
+        flows[i].sent = flows[i].warm = 0;
+    }
+
+    int probe = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in echo = {.sin_family = AF_INET, .sin_port = htons(ECHO_PORT)};
+    inet_pton(AF_INET, probe_ip, &echo.sin_addr);
+    connect(probe, (struct sockaddr *)&echo, sizeof(echo));
+
+    static char payload[65536];
+    struct pollfd fds[9];
+    double start = now_ms();
+    double probe_sent = 0;
+    bool warm = false;
+    int answered = 0;
+    for (double t = 0; t < LOAD_MS; t = now_ms() - start) {
+        if (!warm && t >= WARMUP_MS) {
+            for (int i = 0; i < count; i++) {
+                flows[i].warm = flows[i].sent;
+            }
+            warm = true;
+        }
+        if (t - probe_sent >= 50) {
+            double stamp = now_ms();
+            send(probe, &stamp, sizeof(stamp), 0);
+            probe_sent = t;
+        }
+
+        for (int i = 0; i < count; i++) {
+            fds[i] = (struct pollfd){.fd = flows[i].fd, .events = POLLOUT};
+        }
+        fds[count] = (struct pollfd){.fd = probe, .events = POLLIN};
+        poll(fds, (nfds_t)count + 1, 10);
+
+        for (int i = 0; i < count; i++) {
+            if (fds[i].revents & POLLOUT) {
+                ssize_t len = send(flows[i].fd, payload, sizeof(payload), MSG_NOSIGNAL);
+                flows[i].sent += len > 0 ? (unsigned long long)len : 0;
+            }
+        }
+        double stamp;
+        if ((fds[count].revents & POLLIN) &&
+            recv(probe, &stamp, sizeof(stamp), 0) == sizeof(stamp) && warm) {
+            double rtt = now_ms() - stamp;
+            *max_rtt_ms = rtt > *max_rtt_ms ? rtt : *max_rtt_ms;
+            answered++;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        close(flows[i].fd);
+    }
+    close(probe);
+    return answered > 0;
+}
+
+static double rate_kbit(const flow_t *flows, int count, const char *ip) {
+    unsigned long long bytes = 0;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(flows[i].ip, ip) == 0) {
+            bytes += flows[i].sent - flows[i].warm;
+        }
+    }
+    return bytes * 8.0 / (LOAD_MS - WARMUP_MS);
+}
+
+static void check_sync(client_ns_t *clients) {
+    shaper_plan_t plan;
+    shaper_plan_init(&plan, "wtap0", HOTSPOT_RATE_KBIT, CLIENT_RATE_KBIT);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, traffic_shaper_apply(&plan), "Tree applied");
+    TEST_ASSERT(tc_shows("class htb 1:2 ", "class", "wtap0"), "Default class present");
+    TEST_ASSERT(!tc_shows("class htb 1:100 ", "class", "wtap0"), "No station classes yet");
+
+    shaper_plan_add_client(&plan, clients[0].mac, 0);
+    shaper_plan_add_client(&plan, clients[1].ip, 0);
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, traffic_shaper_sync(&plan), "Stations synced");
+    TEST_ASSERT(tc_shows("class htb 1:100 ", "class", "wtap0") &&
+                    tc_shows("class htb 1:101 ", "class", "wtap0"),
+                "A class per station");
+    TEST_ASSERT(tc_shows("rate 1Mbit ceil 2Mbit", "class", "wtap0"), "Shares and ceilings set");
+
+    plan.client_count = 1;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, traffic_shaper_sync(&plan), "Departure synced");
+    TEST_ASSERT(!tc_shows("class htb 1:101 ", "class", "wtap0"), "Departed station dropped");
+    TEST_ASSERT(!tc_shows("800::2 ", "filter", "wtap0"), "Its filter dropped");
+
+    plan.client_count = 2;
+    TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, traffic_shaper_sync(&plan), "Station back");
+
+    shaper_plan_t other;
+    shaper_plan_init(&other, "wtc0p", 1000, 0);
+    TEST_ASSERT_EQUAL_INT(WTERM_ERROR_GENERAL, traffic_shaper_sync(&other),
+                          "Nothing to sync without a tree");
+}
+
+static void check_load(client_ns_t *clients) {
+    flow_t flows[5];
+    double rtt;
+
+    // A heavy client with four flows is held to the client limit, and an
+    // idle client next to it keeps a short round trip
+    for (int i = 0; i < 4; i++) {
+        flows[i] = (flow_t){.ip = clients[0].ip};
+    }
+    TEST_ASSERT(run_load(flows, 4, clients[1].ip, &rtt), "Load on one client ran");
+    double alone = rate_kbit(flows, 4, clients[0].ip);
+    printf("  heavy client: %.0f kbit/s, idle client round trip %.1f ms\n", alone, rtt);
+    TEST_ASSERT(alone <= CLIENT_RATE_KBIT * 1.15, "Client limit holds");
+    TEST_ASSERT(alone >= CLIENT_RATE_KBIT * 0.5, "Client gets its limit");
+    TEST_ASSERT(rtt < MAX_RTT_MS, "Idle client keeps a short round trip");
+
+    // Next to a light client with one flow, both share the hotspot limit
+    flows[4] = (flow_t){.ip = clients[1].ip};
+    TEST_ASSERT(run_load(flows, 5, clients[1].ip, &rtt), "Load on both clients ran");
+    double heavy = rate_kbit(flows, 5, clients[0].ip);
+    double light = rate_kbit(flows, 5, clients[1].ip);
+    printf("  heavy client: %.0f kbit/s, light client: %.0f kbit/s, round trip %.1f ms\n",
+           heavy, light, rtt);
+    TEST_ASSERT(heavy + light <= HOTSPOT_RATE_KBIT * 1.15, "Hotspot limit holds");
+    TEST_ASSERT(light >= HOTSPOT_RATE_KBIT * 0.35, "Light client is not starved");
+
+    // Probes only pass a busy client's own bulk flow with a flow-queueing
+    // leaf; the FIFO fallback cannot do that
+    if (tc_shows("fq_codel", "qdisc", "wtap0") || tc_shows("cake", "qdisc", "wtap0")) {
+        TEST_ASSERT(rtt < MAX_RTT_MS, "Busy client keeps a short round trip");
+    } else {
+        printf("SKIP: busy client round trip needs fq_codel or CAKE\n");
+    }
+}
+
+// Runs in a forked child inside the namespace; nonzero if a check failed
+static int run_netns_checks(void) {
+    bool ok = ip_run("link", "set", "lo", "up", NULL, NULL, NULL) &&
+              ip_run("link", "add", "wtap0", "type", "bridge", NULL, NULL) &&
+              ip_run("addr", "add", "10.77.0.1/24", "dev", "wtap0", NULL, NULL) &&
+              ip_run("link", "set", "wtap0", "up", NULL, NULL, NULL);
+    client_ns_t clients[2] = {{0}, {0}};
+    for (int i = 0; ok && i < 2; i++) {
+        char iface[8];
+        char peer[8];
+        char address[16];
+        snprintf(iface, sizeof(iface), "wtc%d", i);
+        snprintf(peer, sizeof(peer), "wtc%dp", i);
+        snprintf(address, sizeof(address), "10.77.0.%d", 11 + i);
+        ok = ip_run("link", "add", iface, "type", "veth", "peer", peer) &&
+             ip_run("link", "set", peer, "master", "wtap0", NULL, NULL) &&
+             ip_run("link", "set", peer, "up", NULL, NULL, NULL) &&
+             start_client(&clients[i], iface, address);
+    }
+    TEST_ASSERT(ok, "AP bridge and client namespaces created");
+
+    if (ok) {
+        check_sync(clients);
+        check_load(clients);
+
+        TEST_ASSERT_EQUAL_INT(WTERM_SUCCESS, traffic_shaper_remove("wtap0"), "Tree removed");
+        TEST_ASSERT(!tc_shows("htb", "qdisc", "wtap0"), "Root qdisc gone");
+
+        // A root qdisc wterm did not build is left alone
+        char *const args[] = {"tc", "qdisc", "add", "dev", "wtc1p", "root", "handle", "1:",
+                              "htb", NULL};
+        safe_exec_command("tc", args);
+        traffic_shaper_remove("wtc1p");
+        TEST_ASSERT(tc_shows("htb", "qdisc", "wtc1p"), "Foreign qdisc kept");
+    }
+
+    stop_client(&clients[0]);
+    stop_client(&clients[1]);
+    return test_finish();
+}
+
+static void test_netns(void) {
+    test_section("Rate limits in private network namespaces");
+
+    if (!capability_available(CAPABILITY_IP) || !capability_available(CAPABILITY_TC)) {
+        printf("SKIP: ip or tc is not installed\n");
+        return;
+    }
+    test_run_in_netns(run_netns_checks);
+}
+
+int main(void) {
+    test_init("Traffic Shaper");
+
+    test_plan();
+    test_render();
+    test_netns();
+
+    return test_finish();
+}
@@ -3,8 +3,13 @@
  * @brief Testing utilities implementation
  */
 
+#define _GNU_SOURCE
 #include "test_utils.h"
+#include <fcntl.h>
+#include <sched.h>
 #include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // Global test counters
 int tests_run = 0;
@@ -42,4 +47,55 @@ int test_finish(void) {
 
 void test_section(const char *section_name) {
     printf("\n--- %s ---\n", section_name);
-}
\ No newline at end of file
+}
+
+// Write a whole string to an existing file, such as a /proc map
+static bool write_file(const char *path, const char *text) {
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = write(fd, text, strlen(text)) == (ssize_t)strlen(text);
+    close(fd);
+    return ok;
+}
+
+// Move this process into its own network namespace, as root inside it
+static bool enter_private_netns(void) {
+    if (geteuid() == 0) {
+        return unshare(CLONE_NEWNET) == 0;
+    }
+
+    uid_t uid = geteuid();
+    gid_t gid = getegid();
+    if (unshare(CLONE_NEWUSER | CLONE_NEWNET) != 0) {
+        return false;
+    }
+    char map[64];
+    snprintf(map, sizeof(map), "0 %u 1", (unsigned)uid);
+    if (!write_file("/proc/self/uid_map", map)) {
+        return false;
+    }
+    write_file("/proc/self/setgroups", "deny");
+    snprintf(map, sizeof(map), "0 %u 1", (unsigned)gid);
+    return write_file("/proc/self/gid_map", map);
+}
+
+void test_run_in_netns(int (*checks)(void)) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (!enter_private_netns()) {
+            printf("SKIP: cannot create a network namespace\n");
+            fflush(stdout);
+            _exit(0);
+        }
+        int status = checks();
+        fflush(stdout);
+        _exit(status == 0 ? 0 : 1);
+    }
+
+    int status = 0;
+    TEST_ASSERT(pid > 0 && waitpid(pid, &status, 0) == pid, "Namespace child ran");
+    TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0, "Namespace checks passed");
+}
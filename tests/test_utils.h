@@ -59,4 +59,16 @@ extern int tests_failed;
 // Test framework functions
 void test_init(const char *test_suite_name);
 int test_finish(void);
-void test_section(const char *section_name);
\ No newline at end of file
+void test_section(const char *section_name);
+
+/**
+ * @brief Run checks in a forked child inside a private network namespace
+ *
+ * The child is root in its namespace (through a user namespace when the
+ * tests do not run as root), so it can change interfaces, routes and
+ * firewall rules without touching the host. Its asserts count as one
+ * pass or fail here; prints SKIP if no namespace can be created.
+ *
+ * @param checks Returns test_finish()'s status
+ */
+void test_run_in_netns(int (*checks)(void));
\ No newline at end of file